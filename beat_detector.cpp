@@ -0,0 +1,150 @@
+#include "beat_detector.h"
+
+// Баттерворт 2-го порядка, срез 3 Гц при 100 Гц: b0 b1 b2 a1 a2 в Q14.
+// Сумма b равна 1 + a1 + a2, поэтому усиление на нуле частот ровно 1
+static const q15_t beatLowPass[5] = { 128, 256, 128, -28422, 12550 };
+
+BeatDetector::BeatDetector() {
+  reset();
+}
+
+void BeatDetector::reset() {
+  dspDcRemoveInit(&_dc, BEAT_DC_SHIFT);
+  dspBiquadInit(&_lowPass, beatLowPass);
+  _slope.previous = 0;
+  dspPeakDetectInit(&_peaks);
+  _intervals.clear();
+  _envelope = 0;
+  _lastTimestamp = 0;
+  _lastBeatTime = 0;
+  _hasBeat = false;
+  _earlyBeats = 0;
+  _beatCount = 0;
+}
+
+size_t BeatDetector::addBlock(const uint32_t* ir, const uint32_t* timestamps, size_t count) {
+  if (count == 0) {
+    return 0;
+  }
+  if (count > DSP_MAX_BLOCK) {
+    count = DSP_MAX_BLOCK;
+  }
+
+  q15_t ac[DSP_MAX_BLOCK];
+  q15_t filtered[DSP_MAX_BLOCK];
+  dspDcRemove(&_dc, ir, ac, count);
+  for (size_t i = 0; i < count; i++) {
+    ac[i] = dspSaturateQ15(-(int32_t)ac[i] * (1 << BEAT_GAIN_SHIFT));
+  }
+  dspBiquad(&_lowPass, ac, filtered, count);
+  dspDerivative(&_slope, filtered, filtered, count);
+
+  // Порог адаптивный, но не ниже уровня шума
+  _envelope -= (_envelope * (int32_t)count) >> BEAT_ENVELOPE_DECAY;
+  int32_t threshold = _envelope * BEAT_THRESHOLD_PERCENT / 100;
+  if (threshold < BEAT_MIN_AMPLITUDE) {
+    threshold = BEAT_MIN_AMPLITUDE;
+  }
+
+  // Пик может прийтись на последний отсчёт прошлого блока (номер first - 1)
+  uint32_t first = _peaks.sampleIndex;
+  q15_t lastOfPrevious = _peaks.previous;
+  uint32_t peaks[DSP_MAX_BLOCK];
+  size_t found = dspFindPeaks(&_peaks, filtered, count, (q15_t)threshold,
+                              BEAT_REFRACTORY_SAMPLES, peaks, DSP_MAX_BLOCK);
+  _beatCount = 0;
+  for (size_t i = 0; i < found; i++) {
+    int8_t position = (int8_t)(peaks[i] - first);
+    bool accepted = position < 0 ? addBeat(_lastTimestamp, lastOfPrevious)
+                                 : addBeat(timestamps[position], filtered[position]);
+    if (accepted) {
+      _beatPositions[_beatCount++] = position;
+    }
+  }
+  _lastTimestamp = timestamps[count - 1];
+  return _beatCount;
+}
+
+bool BeatDetector::addBeat(uint32_t time, q15_t amplitude) {
+  if (_hasBeat) {
+    uint32_t interval = time - _lastBeatTime;
+    // Удар намного раньше привычного ритма - скорее помеха. Если таких несколько
+    // подряд, ритм действительно сменился и старые интервалы отбрасываются
+    if (_intervals.size() >= BEAT_MIN_INTERVALS &&
+        interval * 100 < (uint32_t)medianInterval(nullptr) * BEAT_EARLY_PERCENT) {
+      if (++_earlyBeats < BEAT_EARLY_LIMIT) {
+        return false;
+      }
+      _intervals.clear();
+    }
+  }
+  _earlyBeats = 0;
+  // Огибающая следует за амплитудой ударов с весом 1/4
+  _envelope += (amplitude - _envelope) / 4;
+
+  if (_hasBeat) {
+    uint32_t interval = time - _lastBeatTime;
+    if (interval > BEAT_MAX_RR) {
+      // Долгий разрыв (палец сдвинули, сигнал пропал) - старые интервалы уже не про этот ритм
+      _intervals.clear();
+    } else if (interval >= BEAT_MIN_RR) {
+      _intervals.push((uint16_t)interval);
+    }
+  }
+  _lastBeatTime = time;
+  _hasBeat = true;
+  return true;
+}
+
+// Медиана интервалов и медиана отклонений от неё
+uint16_t BeatDetector::medianInterval(uint16_t* deviation) const {
+  uint16_t sorted[BEAT_RR_HISTORY] = {};
+  uint16_t count = _intervals.size();
+  for (uint16_t i = 0; i < count; i++) {
+    // Вставками: интервалов не больше BEAT_RR_HISTORY
+    uint16_t value = _intervals[i];
+    uint16_t j = i;
+    for (; j > 0 && sorted[j - 1] > value; j--) {
+      sorted[j] = sorted[j - 1];
+    }
+    sorted[j] = value;
+  }
+  uint16_t median = (count % 2) ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+
+  if (deviation != nullptr) {
+    uint16_t deviations[BEAT_RR_HISTORY] = {};
+    for (uint16_t i = 0; i < count; i++) {
+      uint16_t value = sorted[i] > median ? sorted[i] - median : median - sorted[i];
+      uint16_t j = i;
+      for (; j > 0 && deviations[j - 1] > value; j--) {
+        deviations[j] = deviations[j - 1];
+      }
+      deviations[j] = value;
+    }
+    *deviation = deviations[count / 2];
+  }
+  return median;
+}
+
+uint16_t BeatDetector::bpm() const {
+  if (_intervals.size() < BEAT_MIN_INTERVALS) {
+    return 0;
+  }
+  uint16_t median = medianInterval(nullptr);
+  return (60000 + median / 2) / median;
+}
+
+uint8_t BeatDetector::confidence() const {
+  uint16_t count = _intervals.size();
+  if (count < BEAT_MIN_INTERVALS) {
+    return 0;
+  }
+  uint16_t deviation;
+  uint16_t median = medianInterval(&deviation);
+  // Разброс 25% от медианы и больше - уверенности нет
+  int32_t spread = 100 - (int32_t)deviation * 400 / median;
+  if (spread < 0) {
+    spread = 0;
+  }
+  return (uint8_t)(spread * count / BEAT_RR_HISTORY);
+}
@@ -0,0 +1,76 @@
+// Поиск ударов сердца по ИК-каналу на каждом отсчёте датчика.
+//
+// Переменная составляющая (dspDcRemove) сглаживается фильтром нижних частот
+// 3 Гц и переворачивается: систола - минимум отражённого света, здесь она
+// становится пиком. Пики ищет dspFindPeaks с адаптивным порогом (доля
+// огибающей амплитуд прошлых ударов) и рефрактерным периодом. Время удара
+// берётся из метки отсчёта, а не из времени обработки. Интервалы RR копятся
+// в кольце; пульс - медиана кольца, поэтому один ложный или пропущенный
+// удар не сдвигает показание. Уверенность падает при разбросе интервалов.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ppg_dsp.h"
+#include "fixed_ring.h"
+
+#define BEAT_DC_SHIFT 6              // ФВЧ около 0.25 Гц при 100 Гц
+#define BEAT_GAIN_SHIFT 3            // усиление x8 до фильтра, чтобы крутизна слабого сигнала не терялась в округлении
+#define BEAT_REFRACTORY_SAMPLES 30   // 300 мс при 100 Гц: не чаще 200 уд/мин
+#define BEAT_MIN_RR 300              // мс
+#define BEAT_MAX_RR 2000             // мс; более длинный разрыв начинает ряд заново
+#define BEAT_RR_HISTORY 8
+#define BEAT_MIN_INTERVALS 3         // меньше интервалов - пульс ещё не известен
+#define BEAT_EARLY_PERCENT 60        // удар раньше 60% медианы RR считается помехой...
+#define BEAT_EARLY_LIMIT 3           // ...пока таких не наберётся 3 подряд
+#define BEAT_MIN_AMPLITUDE 20        // отсчётов АЦП: ниже - шум, а не пульс
+#define BEAT_THRESHOLD_PERCENT 50    // порог - доля огибающей амплитуд пиков
+#define BEAT_ENVELOPE_DECAY 8        // огибающая тает на 1/256 за отсчёт (вдвое за ~1.8 с), порог догоняет ослабший сигнал
+
+class BeatDetector {
+public:
+  BeatDetector();
+
+  void reset();
+
+  // Блок ИК-отсчётов с метками времени (мс), не больше DSP_MAX_BLOCK.
+  // Возвращает число принятых ударов
+  size_t addBlock(const uint32_t* ir, const uint32_t* timestamps, size_t count);
+
+  // Номера отсчётов с ударами в последнем блоке; -1 - последний отсчёт предыдущего
+  const int8_t* beatPositions() const {
+    return _beatPositions;
+  }
+
+  // Медиана RR в уд/мин или 0, если интервалов пока мало
+  uint16_t bpm() const;
+
+  // 0..100: заполненность кольца RR и согласованность интервалов
+  uint8_t confidence() const;
+
+  uint32_t lastBeatTime() const {
+    return _lastBeatTime;
+  }
+
+  const FixedRing<uint16_t, BEAT_RR_HISTORY>& intervals() const {
+    return _intervals;
+  }
+
+private:
+  // false - удар отброшен как ранний
+  bool addBeat(uint32_t time, q15_t amplitude);
+  uint16_t medianInterval(uint16_t* deviation) const;
+
+  DcRemoveState _dc;
+  BiquadStateQ15 _lowPass;
+  DerivativeStateQ15 _slope;
+  PeakDetectStateQ15 _peaks;
+  FixedRing<uint16_t, BEAT_RR_HISTORY> _intervals;
+  int32_t _envelope = 0;        // огибающая амплитуд пиков
+  uint32_t _lastTimestamp = 0;  // метка последнего отсчёта прошлого блока
+  uint32_t _lastBeatTime = 0;
+  uint8_t _earlyBeats = 0;       // подряд отброшенных ранних ударов
+  int8_t _beatPositions[DSP_MAX_BLOCK];
+  uint8_t _beatCount = 0;
+  bool _hasBeat = false;
+};
@@ -0,0 +1,8 @@
+// CRC-32 (тот же, что zlib.crc32 и Ethernet) для проверки целостности данных на флеш-памяти и в выгрузке.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Продолжает расчёт: crc32Update(crc32Update(0, a), b) == crc32Update(0, a + b)
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length);
@@ -0,0 +1,171 @@
+#include "event_stream.h"
+#include "json_writer.h"
+
+EventStream::EventStream(const char* url)
+  : _source(url) {
+}
+
+void EventStream::begin(AsyncWebServer& server) {
+  _source.onConnect([this](AsyncEventSourceClient* client) {
+    addClient(client);
+  });
+  _source.onDisconnect([this](AsyncEventSourceClient* client) {
+    removeClient(client);
+  });
+  server.addHandler(&_source);
+}
+
+void EventStream::addClient(AsyncEventSourceClient* client) {
+  for (EventClientSlot& slot : _clients) {
+    if (slot.client == nullptr) {
+      // Подсказываем браузеру переподключаться через 3 с; полный снимок
+      // новый клиент получит при следующей рассылке
+      client->send("hello", nullptr, 0, 3000);
+      slot.needsKeyframe = true;
+      slot.client = client;
+      return;
+    }
+  }
+  client->close();
+}
+
+void EventStream::removeClient(AsyncEventSourceClient* client) {
+  for (EventClientSlot& slot : _clients) {
+    if (slot.client == client) {
+      slot.client = nullptr;
+    }
+  }
+}
+
+bool EventStream::buildVitalsFrame(const LiveVitals& vitals, bool full) {
+  JsonWriter json(_frame, sizeof(_frame));
+  const LiveVitals& last = _lastSent;
+  bool changed = false;
+
+  json.beginObject();
+  if (full || vitals.hours != last.hours || vitals.minutes != last.minutes ||
+      vitals.seconds != last.seconds) {
+    json.key("time");
+    json.time(vitals.hours, vitals.minutes, vitals.seconds);
+    changed = true;
+  }
+  if (full || vitals.pulse != last.pulse) {
+    json.key("pulse");
+    json.value((int32_t)vitals.pulse);
+    changed = true;
+  }
+  if (full || vitals.spo2 != last.spo2) {
+    json.key("spo2");
+    json.value((int32_t)vitals.spo2);
+    changed = true;
+  }
+  if (full || vitals.fingerPresent != last.fingerPresent) {
+    json.key("finger_present");
+    json.value(vitals.fingerPresent);
+    changed = true;
+  }
+  if (full || vitals.sensorActive != last.sensorActive) {
+    json.key("sensor_active");
+    json.value(vitals.sensorActive);
+    changed = true;
+  }
+  if (full || vitals.alarmEnabled != last.alarmEnabled) {
+    json.key("alarmEnabled");
+    json.value(vitals.alarmEnabled);
+    changed = true;
+  }
+  if (full || vitals.alarmTriggered != last.alarmTriggered) {
+    json.key("alarmTriggered");
+    json.value(vitals.alarmTriggered);
+    changed = true;
+  }
+  json.endObject();
+
+  return changed && !json.overflow();
+}
+
+bool EventStream::buildWaveFrame(const int16_t* wave, size_t waveCount) {
+  JsonWriter json(_frame, sizeof(_frame));
+  json.beginObject();
+  json.key("seq");
+  json.value(_waveSequence++);
+  json.key("rate");
+  json.value((int32_t)EVENT_WAVE_RATE);
+  json.key("samples");
+  json.beginArray();
+  for (size_t i = 0; i < waveCount; i++) {
+    json.value((int32_t)wave[i]);
+  }
+  json.endArray();
+  json.endObject();
+  return !json.overflow();
+}
+
+void EventStream::publish(const LiveVitals& vitals, const int16_t* wave, size_t waveCount, unsigned long now) {
+  if (_source.count() == 0) {
+    _hasSent = false;
+    return;
+  }
+
+  bool keyframe = !_hasSent || now - _lastKeyframe >= EVENT_KEYFRAME_INTERVAL;
+  if (keyframe) {
+    _lastKeyframe = now;
+  }
+  // Клиенту, который не забрал предыдущие кадры, новые не ставим: рассылка
+  // для него пропускается, а дельта после пропуска уже не годится
+  bool ready[EVENT_MAX_CLIENTS];
+  bool anyReady = false;
+  for (uint8_t i = 0; i < EVENT_MAX_CLIENTS; i++) {
+    EventClientSlot& slot = _clients[i];
+    ready[i] = slot.client != nullptr && slot.client->packetsWaiting() < EVENT_MAX_PENDING;
+    if (slot.client != nullptr && (keyframe || !ready[i])) {
+      slot.needsKeyframe = true;
+    }
+    if (slot.client != nullptr && !ready[i]) {
+      _droppedFrames++;
+    }
+    anyReady = anyReady || ready[i];
+  }
+  if (!anyReady) {
+    return;
+  }
+
+  // Дельта - клиентам, получившим прошлый кадр; полный снимок - новым,
+  // отставшим и всем раз в EVENT_KEYFRAME_INTERVAL
+  bool full = false;
+  bool delta = buildVitalsFrame(vitals, false);
+  for (uint8_t i = 0; i < EVENT_MAX_CLIENTS; i++) {
+    if (ready[i] && _clients[i].needsKeyframe) {
+      full = true;
+    } else if (ready[i] && delta) {
+      sendFrame(i, "vitals");
+    }
+  }
+  if (full && buildVitalsFrame(vitals, true)) {
+    for (uint8_t i = 0; i < EVENT_MAX_CLIENTS; i++) {
+      if (ready[i] && _clients[i].needsKeyframe) {
+        sendFrame(i, "vitals");
+        _clients[i].needsKeyframe = false;
+      }
+    }
+  }
+  _lastSent = vitals;
+  _hasSent = true;
+
+  if (waveCount > 0 && buildWaveFrame(wave, waveCount)) {
+    for (uint8_t i = 0; i < EVENT_MAX_CLIENTS; i++) {
+      if (ready[i]) {
+        sendFrame(i, "wave");
+      }
+    }
+  }
+}
+
+void EventStream::sendFrame(uint8_t index, const char* event) {
+  _clients[index].client->send(_frame, event);
+  _framesSent++;
+}
+
+uint8_t EventStream::clientCount() const {
+  return _source.count();
+}
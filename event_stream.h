@@ -0,0 +1,76 @@
+// Поток Server-Sent Events на /events для живых показаний.
+//
+// Соединения держит AsyncEventSource асинхронного сервера. Показатели
+// отправляются дельтой - только изменившиеся поля; при подключении нового
+// клиента и раз в EVENT_KEYFRAME_INTERVAL уходит полный снимок, чтобы
+// клиент, потерявший кадр, снова получил всё. Пульсовая волна идёт пачками
+// отсчётов 25 Гц. Если у клиента копятся неотправленные кадры, новые
+// пропускаются только для него, а после он получает полный снимок:
+// медленный телефон не задерживает ни основной цикл, ни других клиентов.
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+#define EVENT_FRAME_BUFFER 192
+#define EVENT_WAVE_MAX 16              // отсчётов волны в одном кадре
+#define EVENT_WAVE_RATE 25             // Гц
+#define EVENT_KEYFRAME_INTERVAL 10000  // мс
+#define EVENT_MAX_PENDING 4            // кадров в очереди клиента, после которых пропускаем
+#define EVENT_MAX_CLIENTS 4            // подписчиков сверх этого сервер отключает
+
+// Снимок показателей, которые видит панель
+struct LiveVitals {
+  int16_t pulse;
+  int16_t spo2;
+  uint8_t hours;
+  uint8_t minutes;
+  uint8_t seconds;
+  bool fingerPresent;
+  bool sensorActive;
+  bool alarmEnabled;
+  bool alarmTriggered;
+};
+
+// Подписчик и признак того, что дельта ему не подходит
+struct EventClientSlot {
+  AsyncEventSourceClient* client;
+  bool needsKeyframe;  // новый или пропустил кадр
+};
+
+class EventStream {
+public:
+  explicit EventStream(const char* url);
+
+  void begin(AsyncWebServer& server);
+
+  // Рассылает дельту показателей и накопленную волну клиентам, успевающим забирать кадры
+  void publish(const LiveVitals& vitals, const int16_t* wave, size_t waveCount, unsigned long now);
+
+  uint8_t clientCount() const;
+  // Рассылки, пропущенные для медленных клиентов, по одной на клиента
+  uint32_t droppedFrames() const {
+    return _droppedFrames;
+  }
+  // Кадры, поставленные в очереди клиентов
+  uint32_t framesSent() const {
+    return _framesSent;
+  }
+
+private:
+  bool buildVitalsFrame(const LiveVitals& vitals, bool full);
+  bool buildWaveFrame(const int16_t* wave, size_t waveCount);
+  void sendFrame(uint8_t index, const char* event);
+  void addClient(AsyncEventSourceClient* client);
+  void removeClient(AsyncEventSourceClient* client);
+
+  AsyncEventSource _source;
+  char _frame[EVENT_FRAME_BUFFER];
+  LiveVitals _lastSent;
+  bool _hasSent = false;
+  EventClientSlot _clients[EVENT_MAX_CLIENTS] = {};  // меняется из контекста сервера
+  unsigned long _lastKeyframe = 0;
+  uint32_t _waveSequence = 0;
+  uint32_t _framesSent = 0;
+  uint32_t _droppedFrames = 0;
+};
@@ -0,0 +1,144 @@
+#include "export_stream.h"
+#include <ESPAsyncWebServer.h>
+#include "crc32.h"
+
+static size_t putVarint(uint8_t* out, uint32_t value) {
+  size_t length = 0;
+  while (value >= 0x80) {
+    out[length++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[length++] = (uint8_t)value;
+  return length;
+}
+
+static uint32_t zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static void putU16(uint8_t* out, uint16_t value) {
+  out[0] = value;
+  out[1] = value >> 8;
+}
+
+static void putU32(uint8_t* out, uint32_t value) {
+  putU16(out, value);
+  putU16(out + 2, value >> 16);
+}
+
+ExportSession::ExportSession(PulseLog& log, uint16_t userId, uint32_t from, uint32_t to, uint32_t offset)
+  : _reader(log, userId, from, to), _userId(userId), _from(from), _to(to), _skip(offset) {
+}
+
+size_t ExportSession::freeSpace() const {
+  return EXPORT_FIFO_SIZE - (uint16_t)(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire));
+}
+
+// Кладёт байты в буфер, сначала отбрасывая уже переданные до offset
+void ExportSession::emit(const uint8_t* data, size_t length) {
+  if (_skip >= length) {
+    _skip -= length;
+    return;
+  }
+  data += _skip;
+  length -= _skip;
+  _skip = 0;
+
+  uint16_t head = _head.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < length; i++) {
+    _fifo[(uint16_t)(head + i) & (EXPORT_FIFO_SIZE - 1)] = data[i];
+  }
+  _head.store(head + length, std::memory_order_release);
+}
+
+// Кодирует до EXPORT_BLOCK_RECORDS записей; пустой блок завершает поток
+size_t ExportSession::encodeBlock() {
+  uint8_t* payload = _block + EXPORT_BLOCK_HEADER_BYTES;
+  size_t length = 0;
+  uint16_t count = 0;
+  uint32_t firstTime = 0;
+  uint32_t previousTime = 0;
+  int32_t previousPulse = 0;
+  int32_t previousSpo2 = 0;
+
+  PulseSample sample;
+  while (count < EXPORT_BLOCK_RECORDS) {
+    if (_haveSample) {
+      sample = _pending;
+      _haveSample = false;
+    } else if (!_reader.next(sample)) {
+      break;
+    }
+    // Разность времени должна помещаться в 16 бит (как в журнале) - иначе новый блок;
+    // время после перезагрузки устройства может пойти назад - тоже новый блок
+    if (count > 0 && (sample.time < previousTime || sample.time - previousTime > UINT16_MAX)) {
+      _pending = sample;
+      _haveSample = true;
+      break;
+    }
+    if (count == 0) {
+      firstTime = sample.time;
+      previousTime = sample.time;
+    }
+    length += putVarint(payload + length, ((sample.time - previousTime) << 1) | (sample.quality ? 1 : 0));
+    length += putVarint(payload + length, zigzag((int32_t)sample.pulse - previousPulse));
+    length += putVarint(payload + length, zigzag((int32_t)sample.spo2 - previousSpo2));
+    previousTime = sample.time;
+    previousPulse = sample.pulse;
+    previousSpo2 = sample.spo2;
+    _lastTime = sample.time;
+    count++;
+  }
+
+  if (count == 0) {
+    // Время пустого блока - с какого from продолжить выгрузку
+    firstTime = _records > 0 ? _lastTime + 1 : _from;
+  }
+  putU32(_block, firstTime);
+  putU16(_block + 4, count);
+  putU16(_block + 6, length);
+  size_t total = EXPORT_BLOCK_HEADER_BYTES + length;
+  putU32(_block + total, crc32Update(0, _block, total));
+  _records += count;
+  return total + 4;
+}
+
+void ExportSession::pump() {
+  if (_finished) {
+    return;
+  }
+  if (!_headerSent) {
+    uint8_t header[EXPORT_HEADER_BYTES];
+    memcpy(header, EXPORT_MAGIC, 4);
+    header[4] = EXPORT_FORMAT_VERSION;
+    header[5] = 0;
+    putU16(header + 6, _userId);
+    putU32(header + 8, _from);
+    putU32(header + 12, _to);
+    emit(header, sizeof(header));
+    _headerSent = true;
+  }
+  if (freeSpace() < EXPORT_BLOCK_MAX_BYTES) {
+    return;
+  }
+  size_t length = encodeBlock();
+  bool last = length == EXPORT_BLOCK_HEADER_BYTES + 4;
+  emit(_block, length);
+  if (last) {
+    _finished.store(true, std::memory_order_release);
+  }
+}
+
+size_t ExportSession::read(uint8_t* buffer, size_t maxLength) {
+  uint16_t tail = _tail.load(std::memory_order_relaxed);
+  uint16_t available = _head.load(std::memory_order_acquire) - tail;
+  if (available == 0) {
+    return _finished.load(std::memory_order_acquire) ? 0 : RESPONSE_TRY_AGAIN;
+  }
+  size_t length = available < maxLength ? available : maxLength;
+  for (size_t i = 0; i < length; i++) {
+    buffer[i] = _fifo[(uint16_t)(tail + i) & (EXPORT_FIFO_SIZE - 1)];
+  }
+  _tail.store(tail + length, std::memory_order_release);
+  return length;
+}
@@ -0,0 +1,71 @@
+// Двоичная выгрузка журнала измерений для /export.
+//
+// Формат (все числа little-endian), версия EXPORT_FORMAT_VERSION:
+//   заголовок 16 байт: "PPGX", версия (1), флаги (0), id пользователя (2),
+//                      from (4), to (4)
+//   блоки: время первой записи (4), число записей (2), длина данных (2),
+//          данные, CRC32 заголовка блока и данных (4)
+//   в данных на запись: varint((dt << 1) | качество), затем zig-zag varint
+//   разностей пульса и SpO2 с предыдущей записью блока (у первой записи
+//   блока dt = 0, разности от нуля)
+//   последний блок пустой (0 записей); его время - с какого from продолжать
+// Декодер и конвертер в CSV - tools/ppg_export.py.
+//
+// Блоки кодирует основной цикл (pump()), а сервер забирает готовые байты
+// через read() из своего контекста; между ними - кольцевой буфер.
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "pulse_log.h"
+
+#define EXPORT_MAGIC "PPGX"
+#define EXPORT_FORMAT_VERSION 1
+#define EXPORT_HEADER_BYTES 16
+#define EXPORT_BLOCK_RECORDS 128
+#define EXPORT_BLOCK_HEADER_BYTES 8
+// varint времени до 3 байт, разности до 2 байт каждая
+#define EXPORT_BLOCK_MAX_BYTES (EXPORT_BLOCK_HEADER_BYTES + EXPORT_BLOCK_RECORDS * 7 + 4)
+#define EXPORT_FIFO_SIZE 2048  // степень двойки
+
+class ExportSession {
+public:
+  // offset - сколько байт потока пропустить (докачка прерванной выгрузки)
+  ExportSession(PulseLog& log, uint16_t userId, uint32_t from, uint32_t to, uint32_t offset);
+
+  // Основной цикл: кодирует следующий блок, если в буфере есть место
+  void pump();
+
+  // Контекст сервера: отдаёт готовые байты. 0 - поток закончен,
+  // RESPONSE_TRY_AGAIN - данные ещё не готовы
+  size_t read(uint8_t* buffer, size_t maxLength);
+
+  bool finished() const {
+    return _finished;
+  }
+
+  uint32_t records() const {
+    return _records;
+  }
+
+private:
+  size_t encodeBlock();
+  void emit(const uint8_t* data, size_t length);
+  size_t freeSpace() const;
+
+  PulseLogReader _reader;
+  uint16_t _userId;
+  uint32_t _from;
+  uint32_t _to;
+  uint32_t _skip;          // байты до offset ещё не отброшены
+  uint32_t _lastTime = 0;
+  uint32_t _records = 0;
+  bool _headerSent = false;
+  bool _haveSample = false;
+  PulseSample _pending;    // прочитана, но не вошла в предыдущий блок
+  uint8_t _block[EXPORT_BLOCK_MAX_BYTES];
+  uint8_t _fifo[EXPORT_FIFO_SIZE];
+  std::atomic<uint16_t> _head{0};
+  std::atomic<uint16_t> _tail{0};
+  std::atomic<bool> _finished{false};
+};
@@ -1,22 +1,59 @@
 #include <ESP8266WiFi.h>
-#include <ESP8266WebServer.h>
+#include <ESPAsyncTCP.h>
+#include <ESPAsyncWebServer.h>
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
-#include "MAX30105.h"
-#include "heartRate.h"
-#include "spo2_algorithm.h"
 #include <DNSServer.h>
 #include <LittleFS.h>
 #include <ArduinoJson.h>
+#include <atomic>
+#include "ppg_dsp.h"
+#include "beat_detector.h"
+#include "signal_quality.h"
+#include "task_scheduler.h"
+#include "oled_renderer.h"
+#include "toast_queue.h"
+#include "http_response.h"
+#include "json_writer.h"
+#include "event_stream.h"
+#include "request_queue.h"
+#include "pulse_log.h"
+#include "log_clock.h"
+#include "fixed_ring.h"
+#include "pulse_rollup.h"
+#include "export_stream.h"
+#include "user_index.h"
+#include "session_table.h"
+#include "user_table.h"
+#include "safe_file.h"
+#include "hal.h"
+#include "max30102_sensor.h"
+#include <memory>
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 #define OLED_RESET    -1
+#define OLED_ADDRESS  0x3C
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
-
-MAX30105 particleSensor;
-ESP8266WebServer server(80);
+OledFlusher displayFlusher(Wire, OLED_ADDRESS);
+
+// Оборудование за интерфейсами hal.h; логика ниже обращается только к ним.
+// Сборка на компьютере (host/) подменяет эти указатели до setup()
+SystemClock systemClock;
+Max30102Sensor max30102(Wire, systemClock);
+Clock* deviceClock = &systemClock;
+PpgSensor* sensor = &max30102;
+FrameSink* frameSink = &displayFlusher;
+
+// Время прошивки идёт только через deviceClock, чтобы его можно было подменить
+SchedulerClock nowMs = []() -> unsigned long { return deviceClock->millis(); };
+SchedulerClock nowUs = []() -> unsigned long { return deviceClock->micros(); };
+
+// Асинхронный сервер разбирает запросы сам; обработчики маршрутов,
+// меняющих общее состояние, выполняются в основном цикле через очередь
+AsyncWebServer server(80);
+RequestQueue webRequests;
 DNSServer dnsServer;
 
 // Wi-Fi AP settings
@@ -28,11 +65,70 @@ const byte DNS_PORT = 53;
 volatile int pulse = 0;
 volatile int spo2 = 0;
 bool beatDetected = false;
-uint32_t redBuffer[100], irBuffer[100];
 uint32_t irValue = 0;
-unsigned long lastBeat = 0;
 bool fingerPresent = false;
 
+// Пульс по медиане интервалов RR; при низкой уверенности не показывается и не сохраняется
+#define PULSE_MIN_CONFIDENCE 30
+BeatDetector beatDetector;
+uint8_t pulseConfidence = 0;
+
+// Индекс качества сигнала (signal_quality.h): в плохих окнах пульс и SpO2
+// не публикуются и не сохраняются, хорошие записи помечаются флагом качества
+#define SQI_MIN_PUBLISH 50
+#define SQI_GOOD 80
+SignalQuality signalQuality;
+
+// Sensor FIFO acquisition
+#define SAMPLE_RING_SIZE 128        // степень двойки, ~1.3 с при 100 Гц
+const unsigned long fifoPollInterval = 40; // FIFO переполняется за 320 мс, опрашиваем с запасом
+
+// Кольцевой буфер без блокировок для одного производителя и одного потребителя
+template <typename T, uint16_t N>
+class SpscRing {
+  static_assert((N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+  bool push(const T& item) {
+    uint16_t head = _head.load(std::memory_order_relaxed);
+    if ((uint16_t)(head - _tail.load(std::memory_order_acquire)) >= N) {
+      return false; // буфер полон
+    }
+    _items[head & (N - 1)] = item;
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T& item) {
+    uint16_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) {
+      return false; // буфер пуст
+    }
+    item = _items[tail & (N - 1)];
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  uint16_t size() const {
+    return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+  }
+
+  void clear() {
+    _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+private:
+  T _items[N];
+  std::atomic<uint16_t> _head{0};
+  std::atomic<uint16_t> _tail{0};
+};
+
+SpscRing<PpgSample, SAMPLE_RING_SIZE> sampleRing;
+
+// Счётчики потерь для диагностики
+uint32_t samplesAcquired = 0;
+uint32_t ringDroppedSamples = 0;  // потеряно из-за переполнения кольцевого буфера
+
 // Time & Alarm
 volatile unsigned long timeBase = 0;
 volatile bool alarmTriggered = false;
@@ -40,12 +136,43 @@ volatile bool blinkState = true;
 volatile unsigned long lastBlink = 0;
 
 // Loops timing
-unsigned long lastSensorRead = 0;
-unsigned long lastSpO2Check = 0;
-unsigned long lastWifiCheck = 0;
-const unsigned long sensorInterval = 20;
-const unsigned long spo2Interval = 5000;
+const unsigned long clockInterval = 1000;
+const unsigned long networkInterval = 5;
 const unsigned long wifiCheckInterval = 10000;
+const unsigned long notificationInterval = 3000;
+const unsigned long motivationCheckInterval = 60000;
+
+TaskScheduler scheduler(nowMs, nowUs);
+
+// Замеры кучи для маршрутов с потоковыми ответами
+enum RouteId {
+  ROUTE_ADMIN,
+  ROUTE_HISTORY,
+  ROUTE_COUNT
+};
+
+RouteHeapStats routeHeapStats[ROUTE_COUNT] = {
+  {"/admin", 0, 0, 0},
+  {"/history", 0, 0, 0}
+};
+
+// Статический интерфейс: сжатые при сборке файлы в LittleFS (см. tools/build_assets.py)
+struct StaticAsset {
+  const char* path;        // файл в LittleFS
+  const char* contentType;
+  char etag[11];           // "xxxxxxxx" - хеш содержимого в кавычках
+  uint32_t size;
+};
+
+enum AssetId {
+  ASSET_INDEX,
+  ASSET_COUNT
+};
+
+StaticAsset staticAssets[ASSET_COUNT] = {
+  {"/www/index.html.gz", "text/html", "", 0}
+};
+int sensorTaskId = -1;
 
 // Alarm variables
 int alarmHour = -1;
@@ -54,28 +181,84 @@ int alarmMinute = -1;
 // WiFi status
 bool wifiInitialized = false;
 
-// User data structures
-struct PulseRecord {
-  unsigned long timestamp;
-  int pulseValue;
-  int spo2Value;
+// Учётные записи; id - постоянный номер, по нему находится журнал измерений
+UserTable users;
+uint16_t nextUserId = 1;
+
+// users.json пишется не сразу: изменения за usersSaveDelay собираются в одну
+// запись, но не позже usersSaveMaxLatency после первого несохранённого изменения
+#define USERS_FILE "/users.json"
+const unsigned long usersSaveDelay = 2000;
+const unsigned long usersSaveMaxLatency = 10000;
+const unsigned long persistInterval = 500;
+bool usersDirty = false;
+unsigned long usersFirstChange = 0;
+unsigned long usersLastChange = 0;
+uint32_t usersGeneration = 0;   // растёт с каждой записью; при загрузке берётся новейшая копия
+uint32_t usersFileBytes = 0;    // размер users.json без подписи
+
+// Поиск по имени через хеш-индекс; его таблица вдвое больше MAX_USERS,
+// чтобы цепочки пробирования оставались короткими
+#define USER_INDEX_SIZE 32
+static_assert(USER_INDEX_SIZE >= 2 * MAX_USERS, "USER_INDEX_SIZE must be at least twice MAX_USERS");
+static_assert(MAX_USERS <= UINT16_MAX, "PulseLog::begin takes the user count as uint16_t");
+UserIndex<USER_INDEX_SIZE> userNameIndex([](int16_t slot) -> const char* {
+  return users.name(slot);
+});
+
+// Вошедшие клиенты; каждый запрос находит своего пользователя по cookie
+SessionTable sessions;
+
+// История измерений хранится не в users.json, а в двоичном журнале;
+// записи и сводки помечаются временем журнала, а не часами на экране
+PulseLog pulseLog;
+LogClock logClock;
+const unsigned long recordInterval = 5000; // не чаще одной записи в 5 секунд
+
+// Последние измерения текущего пользователя в ОЗУ по 4 байта: 600 записей
+// занимают столько же, сколько раньше 10 пользователей по 20 записей по 12 байт
+#define RECENT_RECORDS 600
+FixedRing<PulseRecord, RECENT_RECORDS> recentRecords;
+uint32_t recentOldestTime = 0; // с, время recentRecords[0]
+uint32_t recentNewestTime = 0;
+uint32_t recentPushed = 0;     // записей, попавших в кольцо за всё время: номер recentRecords[0] - recentPushed - size()
+
+// Сводки по минутам, часам и суткам для графиков за ночь, неделю, год
+PulseRollup pulseRollup;
+#define HISTORY_MAX_ROWS 120   // строк в одном ответе /history, дальше - по next
+#define HISTORY_PAGE 16        // корзин за одно чтение из файла
+
+// Место, где остановилась печать строк /history: строки дописываются пакетами,
+// пока клиент забирает ответ (см. ChunkedResponse::end(rows))
+struct HistoryRows {
+  uint16_t userId;
+  int level;              // уровень сводок, -1 - сырые записи
+  uint32_t from;
+  uint32_t to;
+  size_t rows = 0;
+  uint32_t next = 0;      // с какого времени продолжить следующим запросом
+  // Сырые записи пользователя на датчике - из кольца в ОЗУ; между пакетами
+  // кольцо сдвигается, поэтому позиция - номер записи, а не индекс
+  bool recent = false;
+  bool recentStarted = false;
+  uint32_t recentSequence = 0;  // номер последней отданной записи
+  uint32_t recentTime = 0;      // и её время
+  // Остальные - из журнала
+  std::unique_ptr<PulseLogReader> reader;
+  // Сводки - страницами из файла
+  RollupBucket buckets[HISTORY_PAGE];
+  size_t bucketCount = 0;
+  size_t bucketIndex = 0;
+  bool queried = false;
 };
 
-struct User {
-  String username;
-  String password;
-  int bedtimeHour;
-  int bedtimeMinute;
-  int wakeupHour;
-  int wakeupMinute;
-  PulseRecord records[20];
-  int recordCount;
-  bool isAdmin;
-};
-
-#define MAX_USERS 10
-User users[MAX_USERS];
-int userCount = 0;
+// Двоичная выгрузка журнала (/export): одна за раз, блоки готовит основной цикл.
+// Сессией владеет ответ сервера - после отключения клиента weak_ptr пустеет
+std::weak_ptr<ExportSession> activeExport;
+const unsigned long exportInterval = 10;
+int exportTaskId = -1;
+// Пользователь на датчике: последний вошедший. На него пишутся измерения,
+// его имя и расписание сна - на экране. Веб-запросы берут пользователя из сессии
 int currentUserIndex = -1;
 
 // Health norms
@@ -104,29 +287,221 @@ const unsigned long messageInterval = 3600000;
 int currentMessageIndex = 0;
 
 // SpO2 variables
-uint8_t spo2BufferIndex = 0;
-bool collectingData = false;
-unsigned long lastSampleTime = 0;
-const unsigned long sampleInterval = 10;
+#define SPO2_WINDOW_SIZE 100    // скользящее окно расчета SpO2, 1 с при 100 Гц
+#define SPO2_UPDATE_SAMPLES 25  // новое значение SpO2 каждые 25 отсчётов (4 раза в секунду)
+#define SPO2_DC_SHIFT 5         // постоянная времени фильтра DC: 2^5 = 32 отсчёта
+#define SPO2_MIN_AC_IR 20       // минимальный размах пульсовой волны IR для валидного расчета
+
+// Максимум или минимум по скользящему окну на монотонной очереди:
+// каждый отсчёт добавляется и удаляется не более одного раза
+template <uint16_t N, bool IsMax>
+class SlidingExtremum {
+public:
+  void reset() {
+    _head = 0;
+    _count = 0;
+  }
+
+  void push(uint32_t seq, int32_t value) {
+    // Отбрасываем отсчёты, вышедшие за пределы окна
+    while (_count > 0 && seq - _seq[_head] >= N) {
+      _head = (_head + 1) % N;
+      _count--;
+    }
+    // Отбрасываем отсчёты, которые уже не смогут стать экстремумом
+    while (_count > 0) {
+      uint16_t last = (_head + _count - 1) % N;
+      if (IsMax ? _values[last] > value : _values[last] < value) {
+        break;
+      }
+      _count--;
+    }
+    uint16_t tail = (_head + _count) % N;
+    _seq[tail] = seq;
+    _values[tail] = value;
+    _count++;
+  }
+
+  int32_t value() const {
+    return _values[_head];
+  }
+
+private:
+  uint32_t _seq[N];
+  int32_t _values[N];
+  uint16_t _head = 0;
+  uint16_t _count = 0;
+};
+
+// Потоковый расчет SpO2: скользящие оценки DC и AC для каналов RED и IR,
+// постоянная стоимость на отсчёт без пересчета всего буфера.
+// Вся арифметика целочисленная (у ESP8266 нет FPU).
+class Spo2Engine {
+public:
+  Spo2Engine() {
+    reset();
+  }
+
+  void reset() {
+    dspDcRemoveInit(&_redDc, SPO2_DC_SHIFT);
+    dspDcRemoveInit(&_irDc, SPO2_DC_SHIFT);
+    _count = 0;
+    _sinceUpdate = 0;
+    _redSum = 0;
+    _irSum = 0;
+    _redPeak.reset();
+    _redValley.reset();
+    _irPeak.reset();
+    _irValley.reset();
+    _value = 0;
+    _valid = false;
+  }
+
+  // Обрабатывает блок отсчётов (не больше DSP_MAX_BLOCK).
+  // Возвращает true, если в блоке рассчитано новое значение SpO2.
+  bool addBlock(const uint32_t* red, const uint32_t* ir, size_t count) {
+    q15_t redAc[DSP_MAX_BLOCK];
+    q15_t irAc[DSP_MAX_BLOCK];
+    dspDcRemove(&_redDc, red, redAc, count);
+    dspDcRemove(&_irDc, ir, irAc, count);
+
+    bool updated = false;
+    for (size_t i = 0; i < count; i++) {
+      uint16_t slot = _count % SPO2_WINDOW_SIZE;
+      if (_count >= SPO2_WINDOW_SIZE) {
+        _redSum -= _red[slot];
+        _irSum -= _ir[slot];
+      }
+      _red[slot] = red[i];
+      _ir[slot] = ir[i];
+      _redSum += red[i];
+      _irSum += ir[i];
+
+      // Пики и впадины пульсовой волны по скользящему окну
+      _redPeak.push(_count, redAc[i]);
+      _redValley.push(_count, redAc[i]);
+      _irPeak.push(_count, irAc[i]);
+      _irValley.push(_count, irAc[i]);
+      _count++;
+
+      if (_count >= SPO2_WINDOW_SIZE && ++_sinceUpdate >= SPO2_UPDATE_SAMPLES) {
+        _sinceUpdate = 0;
+        update();
+        updated = true;
+      }
+    }
+    return updated;
+  }
+
+  bool isValid() const {
+    return _valid;
+  }
+
+  int value() const {
+    return _value;
+  }
+
+private:
+  void update() {
+    int32_t redAc = _redPeak.value() - _redValley.value();
+    int32_t irAc = _irPeak.value() - _irValley.value();
+    _valid = false;
+    if (irAc < SPO2_MIN_AC_IR || redAc <= 0 || _redSum == 0 || _irSum == 0) {
+      return;
+    }
+
+    // R = (AC_red / DC_red) / (AC_ir / DC_ir) в Q15; DC - среднее по окну
+    uint64_t numerator = ((uint64_t)redAc * _irSum) << 15;
+    uint64_t denominator = (uint64_t)irAc * _redSum;
+    int64_t ratio = (int64_t)(numerator / denominator);
+    if (ratio < 6554 || ratio > 58982) { // допустимый диапазон R: 0.2 .. 1.8
+      return;
+    }
+
+    // Калибровочная кривая Maxim -45.060*R^2 + 30.354*R + 94.845 в Q15
+    const int64_t a = -1476526; // -45.060 * 2^15
+    const int64_t b = 994640;   //  30.354 * 2^15
+    const int64_t c = 3107881;  //  94.845 * 2^15
+    int64_t value = ((a * ratio * ratio) >> 30) + ((b * ratio) >> 15) + c;
+    value = (value + (1 << 14)) >> 15;
+    if (value <= 0 || value > 100) {
+      return;
+    }
+    _value = (int)value;
+    _valid = true;
+  }
+
+  DcRemoveState _redDc;
+  DcRemoveState _irDc;
+  uint32_t _red[SPO2_WINDOW_SIZE];
+  uint32_t _ir[SPO2_WINDOW_SIZE];
+  uint32_t _redSum = 0;
+  uint32_t _irSum = 0;
+  SlidingExtremum<SPO2_WINDOW_SIZE, true> _redPeak;
+  SlidingExtremum<SPO2_WINDOW_SIZE, false> _redValley;
+  SlidingExtremum<SPO2_WINDOW_SIZE, true> _irPeak;
+  SlidingExtremum<SPO2_WINDOW_SIZE, false> _irValley;
+  uint32_t _count = 0;
+  uint16_t _sinceUpdate = 0;
+  int _value = 0;
+  bool _valid = false;
+};
+
+Spo2Engine spo2Engine;
+
+// Живой поток для панели: показатели и пульсовая волна 25 Гц (100 Гц / 4)
+#define WAVE_DECIMATION 4
+EventStream eventStream("/events");
+const unsigned long eventsInterval = 200; // 5 отсчётов волны в кадре
+DcRemoveState waveDc;
+int16_t waveSamples[EVENT_WAVE_MAX];
+size_t waveCount = 0;
+int32_t waveSum = 0;
+uint8_t wavePhase = 0;
 
 // Display update
-unsigned long lastDisplayUpdate = 0;
-const unsigned long displayUpdateInterval = 100;
+const unsigned long displayInterval = 500;
+int displayTaskId = -1;
+
+// Всплывающие уведомления поверх основного экрана (toast_queue.h)
+ToastQueue toasts;
 
 // Sensor reading flag
 bool activeSensorReading = false;
 
 #define FINGER_THRESHOLD 5000 // порог обнаружения пальца
-#define SPO2_BUFFER_SIZE 100 // размер буфера для расчета SpO2
 
 // Добавьте переменные времени
 int seconds = 0;
 int minutes = 0;
 int hours = 0;
 
+// Забирает отсчёты из FIFO датчика в sampleRing; вызывается задачей датчика
+// по таймеру или по прерыванию INT
+void pollSensorFifo() {
+  PpgSample block[MAX30102_FIFO_DEPTH];
+  size_t count = sensor->read(block, MAX30102_FIFO_DEPTH);
+  for (size_t i = 0; i < count; i++) {
+    if (sampleRing.push(block[i])) {
+      samplesAcquired++;
+    } else {
+      ringDroppedSamples++;
+    }
+  }
+}
+
+// Забирает из sampleRing до maxCount отсчётов для блочной обработки
+size_t popSampleBlock(PpgSample* block, size_t maxCount) {
+  size_t count = 0;
+  while (count < maxCount && sampleRing.pop(block[count])) {
+    count++;
+  }
+  return count;
+}
+
 // Изменённая функция проверки наличия пальца
-void checkFingerPresence() {
-  irValue = particleSensor.getIR();
+void checkFingerPresence(const PpgSample& sample) {
+  irValue = sample.ir;
   
   // Просто обновляем статус наличия пальца, но не останавливаем чтение сенсора
   if (irValue < FINGER_THRESHOLD) {
@@ -151,29 +526,27 @@ void setup() {
   Wire.begin();
 
   // OLED init
-  if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
+  if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDRESS)) {
     Serial.println("OLED init failed");
     while (1);
   }
   display.clearDisplay();
   display.setTextSize(1);
   display.setTextColor(WHITE);
+  oledGlyphCacheInit();
   display.setCursor(0, 0);
   display.println("Initializing...");
   display.display();
 
   // MAX30105 init
-  if (!particleSensor.begin(Wire, I2C_SPEED_FAST)) {
+  if (!sensor->begin()) {
     display.clearDisplay();
     display.setCursor(0, 0);
     display.println("Sensor error!");
     display.display();
     while (1);
   }
-  
-  particleSensor.setup(50, 4, 2, 100, 411, 4096);
-  particleSensor.setPulseAmplitudeRed(0x0A);
-  particleSensor.setPulseAmplitudeIR(0x0A);
+  dspDcRemoveInit(&waveDc, SPO2_DC_SHIFT);
 
   // Filesystem init
   if (!LittleFS.begin()) {
@@ -184,33 +557,59 @@ void setup() {
     display.display();
     delay(2000);
   } else {
+    loadStaticAssets();
+    pulseRollup.begin(LittleFS);
+    pulseLog.begin(LittleFS, MAX_USERS, PulseRollup::bytesPerUser());
     loadUsers();
     createAdminIfNeeded();
+    if (!logClock.begin(LittleFS, nowMs())) {
+      // Границы времени нет - продолжаем хотя бы после последних записей журнала
+      for (int i = 0; i < users.count(); i++) {
+        logClock.notBefore(pulseLog.lastTime(users.id(i)) + 1, nowMs());
+      }
+    }
   }
 
   setupWiFi();
 
   // Server routes
-  server.on("/", handleRoot);
-  server.on("/data", handleData);
-  server.on("/setTime", HTTP_GET, handleSetTime);
-  server.on("/setAlarm", HTTP_GET, handleSetAlarm);
-  server.on("/clearAlarm", HTTP_GET, handleClearAlarm);
-  server.on("/login", HTTP_POST, handleLogin);
-  server.on("/register", HTTP_POST, handleRegister);
-  server.on("/logout", HTTP_GET, handleLogout);
-  server.on("/setSleep", HTTP_POST, handleSetSleep);
-  server.on("/admin", HTTP_GET, handleAdmin);
-  server.on("/deleteUser", HTTP_GET, handleDeleteUser);
+  // Статика отдаётся прямо из контекста сервера, остальное - через очередь
+  server.on("/", HTTP_GET, handleRoot);
+  webRequests.on(server, "/data", HTTP_ANY, handleData);
+  webRequests.on(server, "/setTime", HTTP_GET, handleSetTime);
+  webRequests.on(server, "/setAlarm", HTTP_GET, handleSetAlarm);
+  webRequests.on(server, "/clearAlarm", HTTP_GET, handleClearAlarm);
+  webRequests.on(server, "/login", HTTP_POST, handleLogin);
+  webRequests.on(server, "/register", HTTP_POST, handleRegister);
+  webRequests.on(server, "/logout", HTTP_GET, handleLogout);
+  webRequests.on(server, "/setSleep", HTTP_POST, handleSetSleep);
+  webRequests.on(server, "/admin", HTTP_GET, handleAdmin);
+  webRequests.on(server, "/deleteUser", HTTP_GET, handleDeleteUser);
+  webRequests.on(server, "/tasks", HTTP_GET, handleTasks);
+  webRequests.on(server, "/history", HTTP_GET, handleHistory);
+  webRequests.on(server, "/export", HTTP_GET, handleExport);
+  eventStream.begin(server);
   
   // Default handler для любых других запросов - редирект на главную
-  server.onNotFound([]() {
-    server.sendHeader("Location", "/");
-    server.send(302, "text/plain", "Переход на главную страницу...");
+  server.onNotFound([](AsyncWebServerRequest* request) {
+    request->redirect("/");
   });
   
   server.begin();
 
+  // Задачи основного цикла: имя, функция, период (мс), приоритет (0 - наивысший),
+  // допустимое опоздание (мс) и бюджет времени выполнения (мкс)
+  sensorTaskId = scheduler.addTask("sensor", sensorTask, fifoPollInterval, 0, 100, 5000);
+  scheduler.addTask("clock", clockTask, clockInterval, 1, 100, 1000);
+  displayTaskId = scheduler.addTask("display", updateDisplay, displayInterval, 1, 200, 30000);
+  scheduler.addTask("events", eventsTask, eventsInterval, 2, 100, 5000);
+  scheduler.addTask("network", networkTask, networkInterval, 2, 50, 20000);
+  exportTaskId = scheduler.addTask("export", exportTask, exportInterval, 3, 100, 20000);
+  scheduler.addTask("notifications", checkSleepNotifications, notificationInterval, 3, 1000, 5000);
+  scheduler.addTask("motivation", showMotivationalMessage, motivationCheckInterval, 4, 5000, 5000);
+  scheduler.addTask("persist", persistTask, persistInterval, 4, 1000, 100000);
+  scheduler.addTask("wifi", checkWiFi, wifiCheckInterval, 5, 5000, 50000);
+
   display.clearDisplay();
   display.setCursor(0,0);
   display.println("System ready");
@@ -243,23 +642,14 @@ void setupWiFi() {
     Serial.println("3. Логин: admin, пароль: admin");
     Serial.println("======================");
 
-    display.clearDisplay();
-    display.setCursor(0, 0);
-    display.println("WiFi AP:");
-    display.println(ssid);
-    display.print("IP: ");
-    display.println(ip);
-    display.println("Login: admin");
-    display.println("Pass: admin");
-    display.display();
-    delay(4000);
+    char title[TOAST_TEXT_LENGTH];
+    char text[TOAST_TEXT_LENGTH];
+    snprintf(title, sizeof(title), "WiFi AP: %s", ssid);
+    snprintf(text, sizeof(text), "IP: %s admin/admin", ip.toString().c_str());
+    showToast(title, text, TOAST_NOTICE, 4000, 1);
   } else {
     Serial.println("AP setup failed");
-    display.clearDisplay();
-    display.setCursor(0, 0);
-    display.println("WiFi AP failed!");
-    display.display();
-    delay(2000);
+    showToast("WiFi AP failed!", "", TOAST_NOTICE, 2000, 1);
   }
 }
 
@@ -273,211 +663,254 @@ void checkWiFi() {
 }
 
 void loop() {
-  // Добавляем yield() в начале цикла для улучшения отзывчивости
-  yield();
-  
-  unsigned long now = millis();
-  
-  // Наивысший приоритет - обновление времени
-  static unsigned long lastSecondCheck = 0;
-  if (now - lastSecondCheck >= 1000) {
-    lastSecondCheck = now;
-    seconds++;
-    if (seconds >= 60) {
-      seconds = 0;
-      minutes++;
-      if (minutes >= 60) {
-        minutes = 0;
-        hours++;
-        if (hours >= 24) {
-          hours = 0;
-        }
-      }
+  // Прерывание датчика делает задачу чтения FIFO готовой немедленно
+  if (sensor->pending()) {
+    scheduler.trigger(sensorTaskId);
+  }
+  
+  // За один проход выполняется одна самая срочная задача, затем управление
+  // возвращается системе (WiFi-стек обслуживается между проходами loop)
+  if (!scheduler.runNext()) {
+    // Готовых задач нет - ждём ближайшего срока, delay() отдаёт время системе
+    uint32_t idle = scheduler.timeUntilNextDue();
+    if (idle > 0) {
+      delay(idle);
     }
-    
-    // Сразу после обновления времени - проверка будильника
-    // это позволяет своевременно реагировать на наступление времени будильника
-    checkAlarmState();
-    
-    // Обеспечиваем минимальный интервал между проверками дисплея
-    static unsigned long lastDisplayRefresh = 0;
-    if (now - lastDisplayRefresh >= 200) {  // Обновляем дисплей не чаще 5 раз в секунду
-      updateDisplay();
-      lastDisplayRefresh = now;
+  }
+}
+
+// Часы, будильник и обновление дисплея
+void clockTask() {
+  seconds++;
+  if (seconds >= 60) {
+    seconds = 0;
+    minutes++;
+    if (minutes >= 60) {
+      minutes = 0;
+      hours++;
+      if (hours >= 24) {
+        hours = 0;
+      }
     }
   }
   
-  // Даём возможность системе обработать другие задачи после интенсивных операций
-  yield();
-  
-  // Следующий приоритет - обработка DNS и клиентских запросов
+  // Сразу после обновления времени - проверка будильника
+  // это позволяет своевременно реагировать на наступление времени будильника
+  checkAlarmState();
+  scheduler.trigger(displayTaskId);
+}
+
+// Обработка DNS и запросов, поставленных асинхронным сервером в очередь.
+// По одному запросу за запуск, чтобы между ними успевала задача датчика
+void networkTask() {
   dnsServer.processNextRequest();
-  server.handleClient();
-  
-  // Обязательно даем системе передохнуть после сетевых операций
-  yield();
-  
-  // Проверяем наличие пальца, но не отключаем сенсор
-  checkFingerPresence();
-  
-  // Еще один yield перед операциями с датчиком
-  yield();
-  
-  // Чтение датчика с ограничением частоты для улучшения стабильности
-  static unsigned long lastSensorReadTime = 0;
-  if (now - lastSensorReadTime >= 30) {  // Не чаще ~33 раз в секунду
-    lastSensorReadTime = now;
-    readSensorData();
+  webRequests.dispatch(1);
+  ChunkedResponse::pump();
+}
+
+// Чтение FIFO датчика и обработка всех накопленных отсчётов
+void sensorTask() {
+  // Забираем накопленные в FIFO датчика отсчёты одним пакетом
+  pollSensorFifo();
+  
+  // Обрабатываем каждый отсчёт, чтобы пульс и SpO2 считались на полной частоте 100 Гц
+  PpgSample block[DSP_MAX_BLOCK];
+  size_t blockSize;
+  while ((blockSize = popSampleBlock(block, DSP_MAX_BLOCK)) > 0) {
+    for (size_t i = 0; i < blockSize; i++) {
+      // Проверяем наличие пальца, но не отключаем сенсор
+      checkFingerPresence(block[i]);
+    }
+    readSensorData(block, blockSize);
     
     // Рассчитываем SpO2 только если палец на датчике
     if (fingerPresent) {
-      calculateSpO2();
-      
-      // Сохраняем измерения при наличии данных
-      if (beatDetected && currentUserIndex >= 0 && pulse > 0 && spo2 > 0) {
-        // Ограничиваем частоту сохранения данных
-        static unsigned long lastRecordTime = 0;
-        if (now - lastRecordTime >= 5000) { // Сохраняем не чаще раза в 5 секунд
-          addPulseRecord(pulse, spo2);
-          lastRecordTime = now;
-        }
-      }
-    } else {
-      // Если пальца нет, не сбрасываем показания полностью,
-      // а постепенно уменьшаем их, чтобы избежать резких перепадов на дисплее
-      static unsigned long lastValueDecayTime = 0;
-      if (now - lastValueDecayTime >= 2000) { // Обновляем значения каждые 2 секунды
-        lastValueDecayTime = now;
-        if (pulse > 0) pulse--;
-        if (spo2 > 0) spo2--;
-        beatDetected = false;
-      }
+      calculateSpO2(block, blockSize);
+    }
+    
+    // Волну копим, только когда её кто-то смотрит
+    if (eventStream.clientCount() > 0) {
+      collectWaveform(block, blockSize);
     }
   }
   
-  // Даем системе выполнить другие задачи после интенсивных вычислений
-  yield();
-  
-  // Периодические проверки с более низким приоритетом
-  static unsigned long lastWifiCheck = 0;
-  if (now - lastWifiCheck >= 10000) { // Проверка WiFi раз в 10 секунд
-    checkWiFi();
-    lastWifiCheck = now;
+  unsigned long now = nowMs();
+  if (fingerPresent) {
+    // Сохраняем измерения при наличии данных
+    if (beatDetected && currentUserIndex >= 0 && pulse > 0 && spo2 > 0 &&
+        signalQuality.index() >= SQI_MIN_PUBLISH) {
+      // Ограничиваем частоту сохранения данных
+      static unsigned long lastRecordTime = 0;
+      if (now - lastRecordTime >= recordInterval) {
+        addPulseRecord(pulse, spo2, signalQuality.index() >= SQI_GOOD);
+        lastRecordTime = now;
+      }
+    }
+  } else {
+    // Если пальца нет, не сбрасываем показания полностью,
+    // а постепенно уменьшаем их, чтобы избежать резких перепадов на дисплее
+    static unsigned long lastValueDecayTime = 0;
+    if (now - lastValueDecayTime >= 2000) { // Обновляем значения каждые 2 секунды
+      lastValueDecayTime = now;
+      if (pulse > 0) pulse--;
+      if (spo2 > 0) spo2--;
+      beatDetected = false;
+    }
   }
+}
+
+// Переменная составляющая ИК-канала, усреднённая по WAVE_DECIMATION отсчётам
+void collectWaveform(const PpgSample* samples, size_t count) {
+  uint32_t ir[DSP_MAX_BLOCK] = {};
+  q15_t ac[DSP_MAX_BLOCK];
+  for (size_t i = 0; i < count; i++) {
+    ir[i] = samples[i].ir;
+  }
+  dspDcRemove(&waveDc, ir, ac, count);
   
-  // Проверяем состояния уведомлений
-  static unsigned long lastNotificationCheck = 0;
-  if (now - lastNotificationCheck >= 3000) { // Проверка раз в 3 секунды
-    lastNotificationCheck = now;
-    
-    // Проверки всех типов уведомлений
-    checkSleepNotifications();
-    
-    // Мотивационные сообщения показываем с большим интервалом
-    static unsigned long lastMotivationalCheck = 0;
-    if (now - lastMotivationalCheck >= 60000) { // Проверка раз в минуту
-      showMotivationalMessage();
-      lastMotivationalCheck = now;
+  for (size_t i = 0; i < count; i++) {
+    waveSum += ac[i];
+    if (++wavePhase < WAVE_DECIMATION) {
+      continue;
+    }
+    // Если кадр давно не уходил, новые отсчёты отбрасываем
+    if (waveCount < EVENT_WAVE_MAX) {
+      waveSamples[waveCount++] = (int16_t)(waveSum / WAVE_DECIMATION);
     }
+    waveSum = 0;
+    wavePhase = 0;
   }
-  
-  // Финальный yield в конце цикла
-  yield();
 }
 
-void readSensorData() {
-  // Добавляем yield() в начале функции
-  yield();
-  
-  if (checkForBeat(irValue)) {
-    unsigned long delta = millis() - lastBeat;
-    lastBeat = millis();
-    if (delta > 300 && delta < 2000) {
-      pulse = 60000 / delta;
-      beatDetected = true;
-      Serial.print("BPM: "); Serial.println(pulse);
-    }
+// Рассылка показателей и волны подписчикам /events
+void eventsTask() {
+  if (eventStream.clientCount() == 0) {
+    waveCount = 0;
+    return;
   }
   
-  // Добавляем дополнительный yield() в конце
-  yield();
+  LiveVitals vitals;
+  vitals.pulse = pulse;
+  vitals.spo2 = spo2;
+  vitals.hours = hours;
+  vitals.minutes = minutes;
+  vitals.seconds = seconds;
+  vitals.fingerPresent = fingerPresent;
+  vitals.sensorActive = activeSensorReading;
+  vitals.alarmEnabled = alarmHour >= 0;
+  vitals.alarmTriggered = alarmTriggered;
+  
+  // Без пальца волна - шум, её не отправляем
+  eventStream.publish(vitals, waveSamples, fingerPresent ? waveCount : 0, nowMs());
+  waveCount = 0;
 }
 
-void calculateSpO2() {
-  // Добавляем yield() в начале функции для улучшения отзывчивости
-  yield();
+// Удары ищутся на каждом отсчёте по его метке времени; пульс - медиана интервалов RR.
+// По тем же ударам считается качество сигнала
+void readSensorData(const PpgSample* samples, size_t count) {
+  uint32_t red[DSP_MAX_BLOCK];
+  uint32_t ir[DSP_MAX_BLOCK];
+  uint32_t timestamps[DSP_MAX_BLOCK];
+  for (size_t i = 0; i < count; i++) {
+    // Палец убрали - ритм потерян, копим интервалы и шаблон удара заново
+    if (samples[i].ir < FINGER_THRESHOLD) {
+      beatDetector.reset();
+      signalQuality.reset();
+      pulseConfidence = 0;
+      pulse = 0;
+      spo2 = 0;
+      return;
+    }
+    red[i] = samples[i].red;
+    ir[i] = samples[i].ir;
+    timestamps[i] = samples[i].timestamp;
+  }
   
-  // Если палец не на датчике, сбрасываем буфер
-  if (irValue < FINGER_THRESHOLD) {
-    collectingData = false;
-    spo2BufferIndex = 0;
+  size_t beats = beatDetector.addBlock(ir, timestamps, count);
+  // Окно с движением или засветкой гасит пульс и SpO2 до следующего хорошего
+  // окна: прежние значения в /data и /events выглядели бы как текущие
+  if (signalQuality.addBlock(red, ir, count, beatDetector.beatPositions(), beats) &&
+      signalQuality.index() < SQI_MIN_PUBLISH) {
+    beatDetected = false;
+    pulse = 0;
     spo2 = 0;
+  }
+  if (beats == 0) {
     return;
   }
+  pulseConfidence = beatDetector.confidence();
+  if (pulseConfidence >= PULSE_MIN_CONFIDENCE && signalQuality.index() >= SQI_MIN_PUBLISH) {
+    int bpm = beatDetector.bpm();
+    if (bpm != pulse) {
+      Serial.print("BPM: "); Serial.println(bpm);
+    }
+    pulse = bpm;
+    beatDetected = true;
+  }
+}
+
+void calculateSpO2(const PpgSample* samples, size_t count) {
+  uint32_t red[DSP_MAX_BLOCK];
+  uint32_t ir[DSP_MAX_BLOCK];
+  for (size_t i = 0; i < count; i++) {
+    // Если палец убрали хотя бы на одном отсчёте, сбрасываем окно
+    if (samples[i].ir < FINGER_THRESHOLD) {
+      spo2Engine.reset();
+      spo2 = 0;
+      return;
+    }
+    red[i] = samples[i].red;
+    ir[i] = samples[i].ir;
+  }
   
-  // Неблокирующий сбор данных
-  unsigned long currentMillis = millis();
-  if (currentMillis - lastSampleTime >= sampleInterval) {
-    lastSampleTime = currentMillis;
-    
-    // Добавляем yield() для предотвращения блокировки во время сбора данных
-    yield();
-    
-    if (spo2BufferIndex < SPO2_BUFFER_SIZE) {
-      // Добавляем данные в буфер
-      redBuffer[spo2BufferIndex] = particleSensor.getRed();
-      irBuffer[spo2BufferIndex] = irValue;
-      spo2BufferIndex++;
-      
-      // Добавляем yield() после каждой 10-й записи в буфер
-      if (spo2BufferIndex % 10 == 0) {
-        yield();
-      }
-    } else {
-      // Буфер заполнен, выполняем расчет
-      // Выполняем немедленный yield() перед интенсивным вычислением
-      yield();
-      
-      int32_t spo2Value;
-      int8_t validSPO2;
-      int32_t heartRateValue;
-      int8_t validHeartRate;
-      
-      maxim_heart_rate_and_oxygen_saturation(
-        irBuffer, SPO2_BUFFER_SIZE,
-        redBuffer,
-        &spo2Value, &validSPO2,
-        &heartRateValue, &validHeartRate
-      );
-      
-      yield();
-      
-      // Обновляем значение SpO2
-      if (validSPO2 == 1 && spo2Value > 0 && spo2Value <= 100) {
-        spo2 = spo2Value;
-        Serial.print("SpO2: ");
-        Serial.print(spo2);
-        Serial.println("%");
-      }
-      
-      // Сбрасываем буфер для следующего измерения
-      spo2BufferIndex = 0;
+  // Блок обновляет скользящее окно, новое значение - каждые SPO2_UPDATE_SAMPLES отсчётов;
+  // при плохом сигнале остаётся прежнее
+  if (spo2Engine.addBlock(red, ir, count) && spo2Engine.isValid() &&
+      signalQuality.index() >= SQI_MIN_PUBLISH) {
+    if (spo2 != spo2Engine.value()) {
+      Serial.print("SpO2: ");
+      Serial.print(spo2Engine.value());
+      Serial.println("%");
     }
+    spo2 = spo2Engine.value();
+  }
+}
+
+// Ставит уведомление в очередь и сразу возвращается; false - очередь занята
+// более важными уведомлениями
+bool showToast(const char* title, const char* text, uint8_t priority, unsigned long duration, uint8_t textSize) {
+  if (!toasts.push(title, text, priority, duration, textSize)) {
+    return false;
+  }
+  // Показываем без ожидания очередного периода дисплея
+  scheduler.trigger(displayTaskId);
+  return true;
+}
+
+// Рисует активное уведомление рамкой поверх уже подготовленного кадра
+void drawToastOverlay() {
+  Toast* toast = toasts.current(nowMs());
+  if (toast == nullptr) {
+    return;
   }
   
-  // Финальный yield() в конце функции
-  yield();
+  display.fillRect(0, 14, SCREEN_WIDTH, SCREEN_HEIGHT - 14, BLACK);
+  display.drawRect(0, 14, SCREEN_WIDTH, SCREEN_HEIGHT - 14, WHITE);
+  display.setTextSize(1);
+  display.setCursor(3, 17);
+  display.println(toast->title);
+  display.setTextSize(toast->textSize);
+  display.setCursor(3, 28);
+  display.println(toast->text);
+  display.setTextSize(1);
 }
 
 void checkAlarmState() {
-  // Добавляем yield для предотвращения зависания
-  yield();
-  
   // Если будильник уже сработал, обрабатываем мигание
   if (alarmTriggered) {
-    if (millis() - lastBlink > 500) {
+    if (nowMs() - lastBlink > 500) {
       blinkState = !blinkState;
-      lastBlink = millis();
+      lastBlink = nowMs();
     }
     
     // Добавляем звуковой сигнал, если есть пищалка
@@ -496,24 +929,15 @@ void checkAlarmState() {
     // Получаем текущее время
     if (hours == alarmHour && minutes == alarmMinute && seconds < 2) {
       alarmTriggered = true;
-      lastBlink = millis();
+      lastBlink = nowMs();
       
       // Выводим сообщение о срабатывании будильника
       Serial.println("ALARM TRIGGERED!");
       
-      // Очищаем экран и показываем уведомление о будильнике
-      display.clearDisplay();
-      display.setTextSize(2);
-      display.setCursor(0, 0);
-      display.println("ALARM!");
-      display.setTextSize(1);
-      display.setCursor(0, 20);
-      display.println("Time to wake up!");
-      display.display();
+      // Уведомление о будильнике вытесняет все остальные
+      showToast("Time to wake up!", "ALARM!", TOAST_ALARM, 5000, 2);
     }
   }
-  
-  yield();
 }
 
 const char* menuTitles[] = {
@@ -525,15 +949,6 @@ const char* menuTitles[] = {
 };
 
 void updateDisplay() {
-  unsigned long now = millis();
-  if (now - lastDisplayUpdate < displayUpdateInterval) {
-    return;
-  }
-  lastDisplayUpdate = now;
-  
-  // Предотвращаем зависание
-  yield();
-  
   display.clearDisplay();
   display.setTextSize(1);
   display.setCursor(0, 0);
@@ -548,660 +963,500 @@ void updateDisplay() {
       display.println("Press Reset");
       display.println("to dismiss");
     }
-    display.display();
+    drawToastOverlay();
+    frameSink->flush(display.getBuffer());
     return;
   }
 
+  // Основной экран рисуется прямо в буфер кадра готовыми глифами, строки по страницам
+  uint8_t* frame = display.getBuffer();
+  
   // Заголовок системы
-  display.setTextSize(1);
-  display.println(menuTitles[0]); 
-  display.drawLine(0, 9, display.width(), 9, WHITE);
-  display.setCursor(0, 12);
+  oledDrawText(frame, 0, 0, menuTitles[0]);
+  oledDrawHLine(frame, 9);
 
   // Всегда показываем время и статус будильника
-  display.printf("Time: %02d:%02d:%02d", hours, minutes, seconds);
+  uint8_t column = oledDrawText_P(frame, 2, 0, PSTR("Time: "));
+  column = oledDrawNumber(frame, 2, column, hours, 2);
+  column = oledDrawText_P(frame, 2, column, PSTR(":"));
+  column = oledDrawNumber(frame, 2, column, minutes, 2);
+  column = oledDrawText_P(frame, 2, column, PSTR(":"));
+  oledDrawNumber(frame, 2, column, seconds, 2);
   
   // Показываем статус будильника
   if (alarmHour >= 0) {
-    display.setCursor(95, 12);
-    display.print("[A]");
+    oledDrawText_P(frame, 2, 95, PSTR("[A]"));
   }
   
-  display.setCursor(0, 22);
-  
   // Показываем статус пальца и значения, если они доступны
   if (!fingerPresent) {
-    display.println("Place finger");
+    oledDrawText_P(frame, 3, 0, PSTR("Place finger"));
   } else {
-    display.printf("Pulse: %d bpm\n", beatDetected ? pulse : 0);
-    display.printf("SpO2: %d%%\n", spo2);
+    column = oledDrawText_P(frame, 3, 0, PSTR("Pulse: "));
+    column = oledDrawNumber(frame, 3, column, beatDetected ? pulse : 0, 1);
+    oledDrawText_P(frame, 3, column, PSTR(" bpm"));
+    column = oledDrawText_P(frame, 4, 0, PSTR("SpO2: "));
+    column = oledDrawNumber(frame, 4, column, spo2, 1);
+    oledDrawText_P(frame, 4, column, PSTR("%"));
   }
   
   if (currentUserIndex >= 0) {
-    display.print("User: ");
-    display.println(users[currentUserIndex].username);
+    column = oledDrawText_P(frame, 5, 0, PSTR("User: "));
+    oledDrawText(frame, 5, column, users.name(currentUserIndex));
     
     // Показываем иконку будильника, если он установлен
     if (alarmHour >= 0) {
-      display.setCursor(0, 55);
-      display.printf("Alarm: %02d:%02d", alarmHour, alarmMinute);
+      column = oledDrawText_P(frame, 7, 0, PSTR("Alarm: "));
+      column = oledDrawNumber(frame, 7, column, alarmHour, 2);
+      column = oledDrawText_P(frame, 7, column, PSTR(":"));
+      oledDrawNumber(frame, 7, column, alarmMinute, 2);
     }
   } else {
-    display.println("Not logged in");
+    oledDrawText_P(frame, 5, 0, PSTR("Not logged in"));
   }
 
-  display.display();
-  yield();
+  drawToastOverlay();
+  frameSink->flush(display.getBuffer());
 }
 
-void handleRoot() {
-  server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  server.sendHeader("Pragma", "no-cache");
-  server.sendHeader("Expires", "-1");
-  
-  String html = F(R"=====(
-<!DOCTYPE html><html><head>
-<meta charset='UTF-8'>
-<meta name='viewport' content='width=device-width,initial-scale=1'>
-<title>Умный монитор здоровья</title>
-<style>
-:root {
-  --primary: #ff9aa2;
-  --primary-light: #ffb7b2;
-  --bg: #fff5f5;
-  --text: #5e5e5e;
-  --text-light: #888;
-  --card-bg: #fff;
-  --accent: #ff6b6b;
-  --success: #7ac142;
+// FNV-1a от содержимого файла: тот же хеш печатает tools/build_assets.py
+uint32_t hashFile(File& file) {
+  uint32_t hash = 2166136261UL;
+  uint8_t buffer[128];
+  size_t length;
+  while ((length = file.read(buffer, sizeof(buffer))) > 0) {
+    for (size_t i = 0; i < length; i++) {
+      hash = (hash ^ buffer[i]) * 16777619UL;
+    }
+  }
+  return hash;
 }
-body{font-family:'Arial Rounded MT Bold',Arial,sans-serif;margin:0;padding:0;background:var(--bg);color:var(--text)}
-header{background:linear-gradient(to right,var(--primary),var(--primary-light));color:#fff;padding:15px;border-radius:0 0 15px 15px;box-shadow:0 4px 10px rgba(255,170,170,0.3)}
-h1{margin:0;font-size:22px;text-align:center;text-shadow:1px 1px 2px rgba(150,150,150,0.3)}
-.container{max-width:800px;margin:0 auto;padding:15px}
-.card{background:var(--card-bg);border-radius:15px;box-shadow:0 4px 15px rgba(0,0,0,0.05);padding:15px;margin-bottom:15px;transition:all 0.3s ease}
-.card:hover{transform:translateY(-3px);box-shadow:0 7px 20px rgba(0,0,0,0.1)}
-.tabs{display:flex;margin-bottom:15px;border-radius:12px;overflow:hidden;box-shadow:0 3px 10px rgba(0,0,0,0.1)}
-.tab{flex:1;text-align:center;padding:10px;cursor:pointer;background:#ffeaea;color:#ff9aa2;font-weight:bold;transition:all 0.3s}
-.tab:hover{background:#ffe0e0}
-.tab.active{background:#ff9aa2;color:white}
-.tab-content{display:none;padding:15px 5px}
-.tab-content.active{display:block}
-.metric{text-align:center;padding:15px;border:1px solid #ffe0e0;border-radius:15px;margin:8px;flex:1;min-width:100px;transition:all 0.3s}
-.metric:hover{background:#fff8f8;transform:scale(1.03)}
-.metric h3{color:#ff9aa2;margin-top:0}
-.value{font-size:32px;font-weight:bold;margin:10px 0}
-.form-group{margin-bottom:15px}
-label{display:block;margin-bottom:5px;color:#ff9aa2;font-weight:bold}
-input{width:100%;padding:10px;border:2px solid #ffe0e0;border-radius:12px;box-sizing:border-box;transition:all 0.3s}
-input:focus{border-color:#ff9aa2;outline:none}
-input[type="checkbox"]{width:auto}
-button{background:#ff9aa2;color:white;border:none;padding:10px 15px;border-radius:12px;cursor:pointer;font-weight:bold;transition:all 0.3s;box-shadow:0 3px 8px rgba(255,154,162,0.3)}
-button:hover{background:#ff8a94;transform:translateY(-2px);box-shadow:0 5px 12px rgba(255,154,162,0.4)}
-button:active{transform:translateY(0)}
-.warning{background:#fff0f0;color:#ff6b6b;padding:10px;border-radius:12px;margin-bottom:15px;border-left:4px solid #ff9aa2}
-.health-metrics{display:flex;flex-wrap:wrap;justify-content:space-between}
-.normal{color:#7ac142}
-.warning-value{color:#ff6b6b}
-#loginStatus{text-align:center;font-weight:bold;margin-top:5px}
-.time-inputs{display:flex;gap:10px;align-items:center}
-.time-inputs input{width:70px}
-.time-inputs span{font-size:18px;color:var(--primary)}
-.toggle-form{text-align:center;margin-top:10px;color:var(--primary);cursor:pointer;text-decoration:underline}
-.toggle-form:hover{color:var(--accent)}
-.admin-link {
-  position: fixed;
-  bottom: 15px;
-  right: 15px;
-  background: var(--primary);
-  color: white;
-  padding: 10px 15px;
-  border-radius: 50px;
-  text-decoration: none;
-  display: flex;
-  align-items: center;
-  box-shadow: 0 4px 10px rgba(255,154,162,0.4);
-  transition: all 0.3s;
-  font-weight: bold;
-  z-index: 100;
+
+// Считает ETag для всех статических файлов; вызывается после монтирования LittleFS
+void loadStaticAssets() {
+  for (int i = 0; i < ASSET_COUNT; i++) {
+    StaticAsset& asset = staticAssets[i];
+    asset.etag[0] = '\0';
+    asset.size = 0;
+    File file = LittleFS.open(asset.path, "r");
+    if (!file) {
+      Serial.print("Static asset missing: ");
+      Serial.println(asset.path);
+      continue;
+    }
+    asset.size = file.size();
+    snprintf(asset.etag, sizeof(asset.etag), "\"%08lx\"", (unsigned long)hashFile(file));
+    file.close();
+  }
 }
-.admin-link:hover {
-  background: var(--accent);
-  transform: translateY(-3px);
-  box-shadow: 0 6px 15px rgba(255,154,162,0.6);
+
+// Отдаёт сжатый файл с ETag; при совпадении If-None-Match - 304 без тела.
+// Таблица staticAssets после загрузки не меняется, поэтому очередь не нужна
+void serveStaticAsset(AsyncWebServerRequest* request, int assetId) {
+  const StaticAsset& asset = staticAssets[assetId];
+  if (asset.etag[0] == '\0') {
+    request->send(503, "text/plain", "UI files are missing: upload the LittleFS image built by tools/build_assets.py");
+    return;
+  }
+  
+  AsyncWebServerResponse* response;
+  if (request->hasHeader("If-None-Match") && request->header("If-None-Match") == asset.etag) {
+    response = request->beginResponse(304);
+  } else {
+    response = request->beginResponse(LittleFS, asset.path, asset.contentType);
+    response->addHeader("Content-Encoding", "gzip");
+  }
+  // no-cache: браузер хранит копию, но каждый раз сверяет ETag
+  response->addHeader("Cache-Control", "no-cache");
+  response->addHeader("ETag", asset.etag);
+  request->send(response);
 }
-</style>
-</head>
-<body>
-    <header>
-        <div class="container">
-            <h1>❤️ Умный монитор здоровья ❤️</h1>
-            <div id="loginStatus">Не авторизован</div>
-        </div>
-    </header>
-    
-    <div class="container">
-        <div class="tabs">
-            <div class="tab active" onclick="switchTab('dashboard')">Главная</div>
-            <div class="tab" onclick="switchTab('settings')">Настройки</div>
-            <div class="tab" onclick="switchTab('profile')">Профиль</div>
-            <div class="tab" id="adminTab" style="display:none" onclick="window.location.href='/admin'">Админ</div>
-        </div>
-        
-        <div id="dashboard" class="tab-content active">
-            <div id="sensorWarning" class="warning" style="display:none">
-                📌 Приложите палец к датчику для измерений
-            </div>
-            
-            <div class="card">
-                <h2 style="text-align:center;color:#ff9aa2">Текущее время: <span id="currentTime">--:--:--</span></h2>
-            </div>
-            
-            <div class="card">
-                <h2 style="text-align:center;color:#ff9aa2">Показатели здоровья</h2>
-                <div class="health-metrics">
-                    <div class="metric">
-                        <h3>Пульс</h3>
-                        <div id="pulseValue" class="value">--</div>
-                        <div>уд/мин</div>
-                    </div>
-                    <div class="metric">
-                        <h3>Кислород</h3>
-                        <div id="spo2Value" class="value">--</div>
-                        <div>%</div>
-                    </div>
-                    <div class="metric">
-                        <h3>Будильник</h3>
-                        <div id="alarmStatus" class="value">--</div>
-                        <div id="alarmTime">--:--</div>
-                    </div>
-                </div>
-            </div>
-
-            <!-- Добавляем карточку для отключения сработавшего будильника -->
-            <div id="alarmAlertCard" class="card" style="display:none; background-color:#ffebeb; border:2px solid #ff6b6b;">
-                <h2 style="text-align:center;color:#ff3333">⏰ БУДИЛЬНИК! ⏰</h2>
-                <p style="text-align:center;font-size:18px;">Время вставать! Будильник сработал!</p>
-                <div style="text-align:center;margin-top:10px;">
-                    <button onclick="clearAlarm()" style="background:#ff3333; font-size:18px; padding:15px 30px;">
-                        Отключить будильник
-                    </button>
-                </div>
-            </div>
-        </div>
-        
-        <div id="settings" class="tab-content">
-            <div class="card">
-                <h2 style="text-align:center;color:#ff9aa2">Установка времени</h2>
-                <div class="form-group">
-                    <label for="timeHours">Часы:</label>
-                    <input type="number" id="timeHours" min="0" max="23" placeholder="0-23">
-                </div>
-                <div class="form-group">
-                    <label for="timeMinutes">Минуты:</label>
-                    <input type="number" id="timeMinutes" min="0" max="59" placeholder="0-59">
-                </div>
-                <button onclick="setTime()">Установить время</button>
-            </div>
-            
-            <div class="card">
-                <h2 style="text-align:center;color:#ff9aa2">Настройка будильника</h2>
-                <div class="form-group">
-                    <label for="alarmEnabled">Включить будильник:</label>
-                    <input type="checkbox" id="alarmEnabled">
-                </div>
-                <div class="form-group">
-                    <label for="alarmHours">Часы:</label>
-                    <input type="number" id="alarmHours" min="0" max="23" placeholder="0-23">
-                </div>
-                <div class="form-group">
-                    <label for="alarmMinutes">Минуты:</label>
-                    <input type="number" id="alarmMinutes" min="0" max="59" placeholder="0-59">
-                </div>
-                <button onclick="setAlarm()">Установить</button>
-                <button onclick="clearAlarm()" style="background:#ff6b6b">Отключить</button>
-            </div>
-            
-            <div class="card" id="sleepSettingsCard" style="display:none">
-                <h2 style="text-align:center;color:#ff9aa2">Режим сна</h2>
-                <div class="form-group">
-                    <label>Время отхода ко сну:</label>
-                    <div class="time-inputs">
-                        <input type="number" id="bedHour" min="0" max="23" placeholder="Часы">
-                        <span>:</span>
-                        <input type="number" id="bedMinute" min="0" max="59" placeholder="Минуты">
-                    </div>
-                </div>
-                <div class="form-group">
-                    <label>Время пробуждения:</label>
-                    <div class="time-inputs">
-                        <input type="number" id="wakeHour" min="0" max="23" placeholder="Часы">
-                        <span>:</span>
-                        <input type="number" id="wakeMinute" min="0" max="59" placeholder="Минуты">
-                    </div>
-                </div>
-                <button onclick="setSleepTime()">Сохранить</button>
-            </div>
-        </div>
-        
-        <div id="profile" class="tab-content">
-            <div id="loginForm" class="card">
-                <h2 style="text-align:center;color:#ff9aa2">Авторизация</h2>
-                <div class="form-group">
-                    <label for="username">Имя пользователя:</label>
-                    <input type="text" id="username" placeholder="Введите логин">
-                </div>
-                <div class="form-group">
-                    <label for="password">Пароль:</label>
-                    <input type="password" id="password" placeholder="Введите пароль">
-                </div>
-                <button onclick="login()">Войти</button>
-                <div class="toggle-form" onclick="toggleRegisterForm()">Нет аккаунта? Зарегистрироваться</div>
-                <div style="text-align:center;margin-top:20px;color:#888;font-size:12px">
-                    Администратор: admin / admin
-                </div>
-            </div>
-
-            <div id="registerForm" class="card" style="display:none">
-                <h2 style="text-align:center;color:#ff9aa2">Регистрация</h2>
-                <div class="form-group">
-                    <label for="newUsername">Имя пользователя:</label>
-                    <input type="text" id="newUsername" placeholder="Придумайте логин">
-                </div>
-                <div class="form-group">
-                    <label for="newPassword">Пароль:</label>
-                    <input type="password" id="newPassword" placeholder="Придумайте пароль">
-                </div>
-                <button onclick="register()">Зарегистрироваться</button>
-                <div class="toggle-form" onclick="toggleRegisterForm()">Уже есть аккаунт? Войти</div>
-            </div>
-            
-            <div id="userProfile" style="display:none" class="card">
-                <h2 style="text-align:center;color:#ff9aa2">Профиль пользователя</h2>
-                <p style="text-align:center;font-size:18px;">Вы вошли как: <span id="profileUsername">--</span></p>
-                <div id="adminNotice" style="display:none; margin:15px 0; padding:10px; background:#fff8f8; border-left:4px solid #ff9aa2; border-radius:5px;">
-                    <p><strong>Вы администратор!</strong> У вас есть доступ к:</p>
-                    <ul style="margin-left:20px;">
-                        <li>Панели администратора (вкладка "Админ")</li>
-                        <li>Управлению пользователями</li>
-                        <li>Удалению пользователей</li>
-                    </ul>
-                </div>
-                <button onclick="logout()">Выйти</button>
-            </div>
-        </div>
-    </div>
-    
-    <!-- Кнопка быстрого доступа к админке -->
-    <a href="/admin" class="admin-link" id="quickAdminLink" style="display:none">
-        ⚙️ Панель администратора
-    </a>
-
-    <script>
-        // Переключение вкладок
-        function switchTab(tabId) {
-            document.querySelectorAll('.tab-content').forEach(tab => tab.classList.remove('active'));
-            document.querySelectorAll('.tab').forEach(btn => btn.classList.remove('active'));
-            document.getElementById(tabId).classList.add('active');
-            document.querySelector(`.tab[onclick="switchTab('${tabId}')"]`).classList.add('active');
-        }
-        
-        // Обновление данных с сервера
-        function updateData() {
-            fetch('/data')
-                .then(response => response.json())
-                .then(data => {
-                    // Обновляем время
-                    document.getElementById('currentTime').textContent = data.time;
-                    
-                    // Обновляем показатели здоровья
-                    document.getElementById('pulseValue').textContent = data.pulse;
-                    document.getElementById('spo2Value').textContent = data.spo2;
-                    
-                    // Показываем предупреждение о датчике
-                    if (data.finger_present === "0") {
-                        document.getElementById('sensorWarning').style.display = 'block';
-                    } else {
-                        document.getElementById('sensorWarning').style.display = 'none';
-                    }
-                    
-                    // Обновляем статус будильника
-                    const alarmAlertCard = document.getElementById('alarmAlertCard');
-                    if (data.alarmTriggered === "1") {
-                        // Показываем карточку срабатывания будильника
-                        alarmAlertCard.style.display = 'block';
-                        
-                        // Меняем статус будильника в метрике
-                        document.getElementById('alarmStatus').textContent = 'АКТИВЕН!';
-                        document.getElementById('alarmStatus').className = 'value warning-value';
-                        document.getElementById('alarmTime').textContent = data.alarmTime || '--:--';
-                        document.getElementById('alarmTime').style.fontWeight = 'bold';
-                        document.getElementById('alarmTime').style.color = '#ff3333';
-                    } else if (data.alarmEnabled === "1") {
-                        // Будильник установлен, но еще не сработал
-                        alarmAlertCard.style.display = 'none';
-                        document.getElementById('alarmStatus').textContent = 'Включен';
-                        document.getElementById('alarmStatus').className = 'value normal';
-                        document.getElementById('alarmTime').textContent = data.alarmTime || '--:--';
-                        document.getElementById('alarmTime').style.fontWeight = 'normal';
-                        document.getElementById('alarmTime').style.color = '';
-                        document.getElementById('alarmEnabled').checked = true;
-                    } else {
-                        // Будильник отключен
-                        alarmAlertCard.style.display = 'none';
-                        document.getElementById('alarmStatus').textContent = 'Выключен';
-                        document.getElementById('alarmStatus').className = 'value';
-                        document.getElementById('alarmTime').textContent = '--:--';
-                        document.getElementById('alarmTime').style.fontWeight = 'normal';
-                        document.getElementById('alarmTime').style.color = '';
-                        document.getElementById('alarmEnabled').checked = false;
-                    }
-                    
-                    // Обновляем информацию о пользователе
-                    if (data.username) {
-                        document.getElementById('loginStatus').textContent = `Пользователь: ${data.username}`;
-                        document.getElementById('loginStatus').style.color = '#fff';
-                        document.getElementById('loginStatus').style.fontWeight = 'bold';
-                        
-                        document.getElementById('loginForm').style.display = 'none';
-                        document.getElementById('registerForm').style.display = 'none';
-                        document.getElementById('userProfile').style.display = 'block';
-                        document.getElementById('profileUsername').textContent = data.username;
-                        document.getElementById('sleepSettingsCard').style.display = 'block';
-                        
-                        // Заполняем данные о режиме сна
-                        if (data.bedtime && data.bedtime !== "Not set") {
-                            const [bedHour, bedMin] = data.bedtime.split(':');
-                            document.getElementById('bedHour').value = bedHour;
-                            document.getElementById('bedMinute').value = bedMin;
-                        }
-                        
-                        if (data.wakeup && data.wakeup !== "Not set") {
-                            const [wakeHour, wakeMin] = data.wakeup.split(':');
-                            document.getElementById('wakeHour').value = wakeHour;
-                            document.getElementById('wakeMinute').value = wakeMin;
-                        }
-                        
-                        // Показываем вкладку админа и кнопку быстрого доступа если пользователь админ
-                        const isAdmin = data.isAdmin === "1";
-                        document.getElementById('adminTab').style.display = isAdmin ? 'block' : 'none';
-                        document.getElementById('quickAdminLink').style.display = isAdmin ? 'flex' : 'none';
-                        document.getElementById('adminNotice').style.display = isAdmin ? 'block' : 'none';
-                        
-                        // Добавляем индикатор администратора в статус
-                        if (isAdmin) {
-                            document.getElementById('loginStatus').innerHTML = `<span style="background:#ff9aa2;color:white;padding:2px 6px;border-radius:10px;">Админ</span> ${data.username}`;
-                        }
-                    } else {
-                        document.getElementById('loginStatus').textContent = 'Не авторизован';
-                        document.getElementById('loginStatus').style.color = '#fff';
-                        document.getElementById('loginStatus').style.fontWeight = 'normal';
-                        
-                        document.getElementById('loginForm').style.display = 'block';
-                        document.getElementById('userProfile').style.display = 'none';
-                        document.getElementById('sleepSettingsCard').style.display = 'none';
-                        document.getElementById('adminTab').style.display = 'none';
-                        document.getElementById('quickAdminLink').style.display = 'none';
-                    }
-                    
-                    // Применяем цвета предупреждений
-                    if (data.pulse > 0) {
-                        if (data.pulse < 60 || data.pulse > 100) {
-                            document.getElementById('pulseValue').className = 'value warning-value';
-                        } else {
-                            document.getElementById('pulseValue').className = 'value normal';
-                        }
-                    } else {
-                        document.getElementById('pulseValue').className = 'value';
-                    }
-                    
-                    if (data.spo2 > 0) {
-                        if (data.spo2 < 95) {
-                            document.getElementById('spo2Value').className = 'value warning-value';
-                        } else {
-                            document.getElementById('spo2Value').className = 'value normal';
-                        }
-                    } else {
-                        document.getElementById('spo2Value').className = 'value';
-                    }
-                })
-                .catch(error => console.error('Ошибка:', error));
-        }
-        
-        // Переключение между формами входа и регистрации
-        function toggleRegisterForm() {
-            const loginForm = document.getElementById('loginForm');
-            const registerForm = document.getElementById('registerForm');
-            
-            if (loginForm.style.display === 'none') {
-                loginForm.style.display = 'block';
-                registerForm.style.display = 'none';
-            } else {
-                loginForm.style.display = 'none';
-                registerForm.style.display = 'block';
-            }
-        }
-        
-        // Установка времени
-        function setTime() {
-            const hours = document.getElementById('timeHours').value;
-            const minutes = document.getElementById('timeMinutes').value;
-            
-            if (!hours || !minutes) {
-                alert('Пожалуйста, заполните часы и минуты');
-                return;
-            }
-            
-            fetch(`/setTime?h=${hours}&m=${minutes}`)
-                .then(response => {
-                    if (response.ok) {
-                        alert('Время успешно установлено!');
-                        updateData();
-                    } else {
-                        alert('Ошибка при установке времени');
-                    }
-                })
-                .catch(error => {
-                    console.error('Ошибка:', error);
-                });
-        }
-        
-        // Установка будильника
-        function setAlarm() {
-            const hours = document.getElementById('alarmHours').value;
-            const minutes = document.getElementById('alarmMinutes').value;
-            
-            if (!hours || !minutes) {
-                alert('Пожалуйста, заполните часы и минуты');
-                return;
-            }
-            
-            fetch(`/setAlarm?h=${hours}&m=${minutes}`)
-                .then(response => {
-                    if (response.ok) {
-                        alert('Будильник успешно установлен!');
-                        updateData();
-                    } else {
-                        alert('Ошибка при установке будильника');
-                    }
-                })
-                .catch(error => {
-                    console.error('Ошибка:', error);
-                });
-        }
-        
-        // Отключение будильника
-        function clearAlarm() {
-            fetch('/clearAlarm')
-                .then(response => {
-                    if (response.ok) {
-                        // Закрываем карточку срабатывания будильника
-                        document.getElementById('alarmAlertCard').style.display = 'none';
-                        updateData();
-                    } else {
-                        alert('Ошибка при отключении будильника');
-                    }
-                })
-                .catch(error => {
-                    console.error('Ошибка:', error);
-                });
-        }
-        
-        // Установка времени сна
-        function setSleepTime() {
-            const bedHour = document.getElementById('bedHour').value;
-            const bedMinute = document.getElementById('bedMinute').value;
-            const wakeHour = document.getElementById('wakeHour').value;
-            const wakeMinute = document.getElementById('wakeMinute').value;
-            
-            fetch('/setSleep', {
-                method: 'POST',
-                headers: {
-                    'Content-Type': 'application/x-www-form-urlencoded',
-                },
-                body: `bedH=${bedHour}&bedM=${bedMinute}&wakeH=${wakeHour}&wakeM=${wakeMinute}`
-            })
-            .then(response => {
-                alert('Настройки сна сохранены');
-                updateData();
-            })
-            .catch(error => {
-                console.error('Ошибка:', error);
-            });
-        }
-        
-        // Регистрация нового пользователя
-        function register() {
-            const username = document.getElementById('newUsername').value;
-            const password = document.getElementById('newPassword').value;
-            
-            if (!username || !password) {
-                alert('Пожалуйста, заполните все поля');
-                return;
-            }
-            
-            const formData = new FormData();
-            formData.append('username', username);
-            formData.append('password', password);
-            
-            fetch('/register', {
-                method: 'POST',
-                body: formData
-            })
-            .then(response => {
-                if (response.ok) {
-                    alert('Регистрация успешна!');
-                    updateData();
-                } else {
-                    alert('Ошибка регистрации. Возможно, имя пользователя уже занято.');
-                }
-            })
-            .catch(error => {
-                alert('Ошибка регистрации: ' + error);
-            });
-        }
-        
-        // Вход в систему
-        function login() {
-            const username = document.getElementById('username').value;
-            const password = document.getElementById('password').value;
-            
-            const formData = new FormData();
-            formData.append('username', username);
-            formData.append('password', password);
-            
-            fetch('/login', {
-                method: 'POST',
-                body: formData
-            })
-            .then(response => {
-                if (response.ok) {
-                    document.getElementById('username').value = '';
-                    document.getElementById('password').value = '';
-                    updateData();
-                } else {
-                    alert('Неверное имя пользователя или пароль');
-                }
-            })
-            .catch(error => {
-                alert('Ошибка входа: ' + error);
-            });
-        }
-        
-        // Выход из системы
-        function logout() {
-            fetch('/logout')
-                .then(() => {
-                    updateData();
-                });
-        }
-        
-        // Обновление данных каждую секунду
-        setInterval(updateData, 1000);
-        updateData();
-    </script>
-</body>
-</html>
-)=====");
-  server.send(200, "text/html", html);
+
+void handleRoot(AsyncWebServerRequest* request) {
+  serveStaticAsset(request, ASSET_INDEX);
 }
 
+// Схема ответа /data: порядок ключей задаётся перечислением
+enum DataField {
+  DATA_TIME,
+  DATA_PULSE,
+  DATA_PULSE_CONFIDENCE,
+  DATA_SPO2,
+  DATA_SQI,
+  DATA_FINGER_PRESENT,
+  DATA_SENSOR_ACTIVE,
+  DATA_ALARM_ENABLED,
+  DATA_ALARM_TRIGGERED,
+  DATA_ALARM_TIME,
+  DATA_USERNAME,
+  DATA_IS_ADMIN,
+  DATA_BEDTIME,
+  DATA_WAKEUP,
+  DATA_FIELD_COUNT
+};
+
+constexpr const char* dataFieldNames[] = {
+  "time", "pulse", "pulse_confidence", "spo2", "sqi", "finger_present", "sensor_active",
+  "alarmEnabled", "alarmTriggered", "alarmTime", "username", "isAdmin", "bedtime", "wakeup"
+};
+
+#define DATA_JSON_BUFFER 448
+
+static_assert(sizeof(dataFieldNames) / sizeof(dataFieldNames[0]) == DATA_FIELD_COUNT,
+              "dataFieldNames must list every DataField");
+// Ключи + самые длинные значения: 4 времени, 4 числа, 4 флага, имя с экранированием \uXXXX
+static_assert(jsonSchemaKeyBytes(dataFieldNames, DATA_FIELD_COUNT) + 2 +
+              4 * 10 + 4 * 11 + 4 * 5 + USER_NAME_MAX * 6 + 2 < DATA_JSON_BUFFER,
+              "DATA_JSON_BUFFER is too small for the /data schema");
+
+static_assert(DATA_JSON_BUFFER <= RESPONSE_BUFFER_SIZE, "/data must fit a request queue response buffer");
+
+// Ответ пишется в буфер очереди и уходит серверу оттуда же, без String и копии
+// в куче. Если все буферы ещё отдаются медленным клиентам - 503: панель
+// опрашивает /data каждую секунду и просто возьмёт следующий ответ
 void handleData() {
-  // Добавляем yield для улучшения отзывчивости
-  yield();
-  
-  String json = "{";
-  json += "\"time\":\"" + String(hours) + ":" + (minutes < 10 ? "0" : "") + String(minutes) + ":" + (seconds < 10 ? "0" : "") + String(seconds) + "\",";
-  json += "\"pulse\":\"" + String(pulse) + "\",";
-  json += "\"spo2\":\"" + String(spo2) + "\",";
-  json += "\"finger_present\":\"" + String(fingerPresent ? "1" : "0") + "\",";
-  json += "\"sensor_active\":\"" + String(activeSensorReading ? "1" : "0") + "\",";
-  json += "\"alarmEnabled\":\"" + String(alarmHour >= 0 ? "1" : "0") + "\",";
-  json += "\"alarmTriggered\":\"" + String(alarmTriggered ? "1" : "0") + "\",";
-  json += "\"alarmTime\":\"" + (alarmHour >= 0 ? String(alarmHour) + ":" + (alarmMinute < 10 ? "0" : "") + String(alarmMinute) : "") + "\"";
-  
-  // Добавляем информацию о пользователе, если авторизован
-  if (currentUserIndex >= 0) {
-    User* user = &users[currentUserIndex];
-    json += ",\"username\":\"" + user->username + "\",";
-    json += "\"isAdmin\":\"" + String(user->isAdmin ? "1" : "0") + "\"";
-    
-    // Добавляем информацию о времени сна/пробуждения
-    if (user->bedtimeHour >= 0) {
-      String bedTime = String(user->bedtimeHour) + ":";
-      if (user->bedtimeMinute < 10) bedTime += "0";
-      bedTime += String(user->bedtimeMinute);
-      json += ",\"bedtime\":\"" + bedTime + "\"";
-    } else {
-      json += ",\"bedtime\":\"Not set\"";
+  char* buffer = webRequests.responseBuffer();
+  if (buffer == nullptr) {
+    webRequests.sendHeader("Retry-After", "1");
+    webRequests.send(503, "text/plain", "Server busy");
+    return;
+  }
+  JsonWriter json(buffer, DATA_JSON_BUFFER);
+  int userIndex = requestUser();
+
+  json.beginObject();
+  json.key(dataFieldNames[DATA_TIME]);
+  json.time(hours, minutes, seconds);
+  json.key(dataFieldNames[DATA_PULSE]);
+  json.value((int32_t)pulse);
+  json.key(dataFieldNames[DATA_PULSE_CONFIDENCE]);
+  json.value((int32_t)pulseConfidence);
+  json.key(dataFieldNames[DATA_SPO2]);
+  json.value((int32_t)spo2);
+  json.key(dataFieldNames[DATA_SQI]);
+  json.value((int32_t)signalQuality.index());
+  json.key(dataFieldNames[DATA_FINGER_PRESENT]);
+  json.value(fingerPresent);
+  json.key(dataFieldNames[DATA_SENSOR_ACTIVE]);
+  json.value(activeSensorReading);
+  json.key(dataFieldNames[DATA_ALARM_ENABLED]);
+  json.value(alarmHour >= 0);
+  json.key(dataFieldNames[DATA_ALARM_TRIGGERED]);
+  json.value((bool)alarmTriggered);
+  json.key(dataFieldNames[DATA_ALARM_TIME]);
+  if (alarmHour >= 0) {
+    json.time(alarmHour, alarmMinute, -1);
+  } else {
+    json.null();
+  }
+
+  // Информация о пользователе, если авторизован; иначе null
+  static const UserSchedule noSchedule;
+  const UserSchedule& schedule = userIndex >= 0 ? users.schedule(userIndex) : noSchedule;
+  json.key(dataFieldNames[DATA_USERNAME]);
+  if (userIndex >= 0) {
+    json.value(users.name(userIndex));
+  } else {
+    json.null();
+  }
+  json.key(dataFieldNames[DATA_IS_ADMIN]);
+  json.value(userIndex >= 0 && users.isAdmin(userIndex));
+  json.key(dataFieldNames[DATA_BEDTIME]);
+  if (schedule.bedtimeHour != USER_TIME_UNSET) {
+    json.time(schedule.bedtimeHour, schedule.bedtimeMinute, -1);
+  } else {
+    json.null();
+  }
+  json.key(dataFieldNames[DATA_WAKEUP]);
+  if (schedule.wakeupHour != USER_TIME_UNSET) {
+    json.time(schedule.wakeupHour, schedule.wakeupMinute, -1);
+  } else {
+    json.null();
+  }
+  json.endObject();
+
+  if (json.overflow()) {
+    webRequests.releaseBuffer(buffer);
+    webRequests.send(500, "text/plain", "Response buffer overflow");
+    return;
+  }
+  webRequests.send(200, "application/json", buffer, json.length());
+}
+
+// Статистика задач планировщика и счётчики датчика
+void handleTasks() {
+  String json = "{\"tasks\":[";
+  for (uint8_t i = 0; i < scheduler.taskCount(); i++) {
+    const Task& task = scheduler.task(i);
+    uint32_t avg = task.stats.runs > 0 ? (uint32_t)(task.stats.totalRuntime / task.stats.runs) : 0;
+    if (i > 0) json += ",";
+    json += "{\"name\":\"" + String(task.name) + "\",";
+    json += "\"period\":" + String(task.period) + ",";
+    json += "\"priority\":" + String(task.priority) + ",";
+    json += "\"runs\":" + String(task.stats.runs) + ",";
+    json += "\"avg_us\":" + String(avg) + ",";
+    json += "\"max_us\":" + String(task.stats.maxRuntime) + ",";
+    json += "\"missed\":" + String(task.stats.missedDeadlines) + ",";
+    json += "\"overruns\":" + String(task.stats.budgetOverruns) + "}";
+  }
+  json += "],\"sensor\":{";
+  json += "\"samples\":" + String(samplesAcquired) + ",";
+  json += "\"fifo_overflow\":" + String(sensor->lostSamples()) + ",";
+  json += "\"ring_dropped\":" + String(ringDroppedSamples) + "},";
+  const SignalQualityScores& quality = signalQuality.scores();
+  json += "\"signal\":{";
+  json += "\"index\":" + String(quality.index) + ",";
+  json += "\"perfusion\":" + String(quality.perfusion) + ",";
+  json += "\"correlation\":" + String(quality.correlation) + ",";
+  json += "\"clipped\":" + String(quality.clipped) + ",";
+  json += "\"ratio_change\":" + String(quality.ratioChange) + "},";
+  json += "\"events\":{";
+  json += "\"clients\":" + String(eventStream.clientCount()) + ",";
+  json += "\"frames\":" + String(eventStream.framesSent()) + ",";
+  json += "\"dropped\":" + String(eventStream.droppedFrames()) + "},";
+  const RequestQueueStats& http = webRequests.stats();
+  json += "\"http\":{";
+  json += "\"handled\":" + String(http.handled) + ",";
+  json += "\"rejected\":" + String(http.rejected) + ",";
+  json += "\"cancelled\":" + String(http.cancelled) + ",";
+  json += "\"max_depth\":" + String(http.maxDepth) + ",";
+  json += "\"avg_wait_us\":" + String(http.handled > 0 ? (uint32_t)(http.totalWait / http.handled) : 0) + ",";
+  json += "\"max_wait_us\":" + String(http.maxWait) + "},";
+  json += "\"display\":{";
+  json += "\"last_frame_bytes\":" + String(displayFlusher.lastFrameBytes()) + ",";
+  json += "\"total_bytes\":" + String(displayFlusher.totalBytes()) + "},";
+  json += "\"users\":{\"count\":" + String(users.count()) + ",\"capacity\":" + String(MAX_USERS) + ",";
+  json += "\"bytes_per_user\":" + String(UserTable::bytesPerUser()) + ",\"table_bytes\":" + String(sizeof(users)) + ",";
+  json += "\"file_bytes\":" + String(usersFileBytes) + "},";
+  json += "\"heap\":{\"free\":" + String(ESP.getFreeHeap()) + ",";
+  json += "\"max_block\":" + String(ESP.getMaxFreeBlockSize()) + ",";
+  json += "\"fragmentation\":" + String(ESP.getHeapFragmentation()) + ",\"routes\":[";
+  for (int i = 0; i < ROUTE_COUNT; i++) {
+    if (i > 0) json += ",";
+    json += "{\"route\":\"" + String(routeHeapStats[i].route) + "\",";
+    json += "\"requests\":" + String(routeHeapStats[i].requests) + ",";
+    json += "\"peak_bytes\":" + String(routeHeapStats[i].peakBytes) + ",";
+    json += "\"last_peak_bytes\":" + String(routeHeapStats[i].lastPeakBytes) + "}";
+  }
+  json += "]}}";
+  
+  if (webRequests.hasArg("reset")) {
+    scheduler.resetStats();
+    webRequests.resetStats();
+  }
+  webRequests.send(200, "application/json", json);
+}
+
+// Следующая сырая запись пользователя на датчике из кольца в ОЗУ
+bool nextRecentSample(HistoryRows& history, PulseSample& sample) {
+  // Пользователь ушёл с датчика - в кольце уже чужие записи, продолжит журнал
+  if (currentUserIndex < 0 || users.id(currentUserIndex) != history.userId) {
+    if (history.recentStarted) {
+      history.next = history.recentTime + 1;
     }
-    
-    if (user->wakeupHour >= 0) {
-      String wakeTime = String(user->wakeupHour) + ":";
-      if (user->wakeupMinute < 10) wakeTime += "0";
-      wakeTime += String(user->wakeupMinute);
-      json += ",\"wakeup\":\"" + wakeTime + "\"";
-    } else {
-      json += ",\"wakeup\":\"Not set\"";
+    return false;
+  }
+  uint32_t first = recentPushed - recentRecords.size();
+  uint16_t i = 0;
+  sample.time = recentOldestTime;
+  bool resumed = history.recentStarted && history.recentSequence >= first;
+  if (resumed) {
+    // Запись ещё в кольце: следующая за ней, время - по разности
+    i = history.recentSequence - first + 1;
+    sample.time = history.recentTime;
+  }
+  for (; i < recentRecords.size(); i++) {
+    const PulseRecord& record = recentRecords[i];
+    if (i > 0) {
+      sample.time += record.delta;
+    }
+    // Отданная запись уже вытеснена - продолжаем по времени
+    if (sample.time < history.from || sample.time > history.to ||
+        (history.recentStarted && !resumed && sample.time <= history.recentTime)) {
+      continue;
+    }
+    history.recentStarted = true;
+    history.recentSequence = first + i;
+    history.recentTime = sample.time;
+    sample.pulse = record.pulse;
+    sample.spo2 = record.spo2 & ~LOG_QUALITY_FLAG;
+    sample.quality = (record.spo2 & LOG_QUALITY_FLAG) != 0;
+    return true;
+  }
+  return false;
+}
+
+// Строка сырой истории: [time,pulse,spo2,quality]
+bool nextSampleRow(HistoryRows& history, JsonWriter& json) {
+  PulseSample sample;
+  if (!(history.recent ? nextRecentSample(history, sample) : history.reader->next(sample))) {
+    return false;
+  }
+  if (history.rows == HISTORY_MAX_ROWS) {
+    history.next = sample.time;
+    return false;
+  }
+  json.beginArray();
+  json.value(sample.time);
+  json.value((int32_t)sample.pulse);
+  json.value((int32_t)sample.spo2);
+  json.value(sample.quality);
+  json.endArray();
+  return true;
+}
+
+// Строка сводки: сумма и число измерений вместо среднего, клиент делит сам без потери точности
+bool nextRollupRow(HistoryRows& history, JsonWriter& json) {
+  if (history.bucketIndex == history.bucketCount) {
+    if ((history.queried && history.next == 0) || history.rows == HISTORY_MAX_ROWS) {
+      return false;
+    }
+    size_t page = HISTORY_MAX_ROWS - history.rows < HISTORY_PAGE ? HISTORY_MAX_ROWS - history.rows : HISTORY_PAGE;
+    uint32_t cursor = history.queried ? history.next : history.from;
+    history.bucketCount = pulseRollup.query(history.userId, (RollupLevel)history.level, cursor, history.to,
+                                            history.buckets, page, history.next);
+    history.bucketIndex = 0;
+    history.queried = true;
+    if (history.bucketCount == 0) {
+      return false;
+    }
+  }
+  const RollupBucket& bucket = history.buckets[history.bucketIndex++];
+  json.beginArray();
+  json.value(bucket.start);
+  json.value((uint32_t)bucket.count);
+  json.value((uint32_t)bucket.pulseMin);
+  json.value((uint32_t)bucket.pulseMax);
+  json.value(bucket.pulseSum);
+  json.value((uint32_t)bucket.spo2Min);
+  json.value((uint32_t)bucket.spo2Max);
+  json.value(bucket.spo2Sum);
+  json.endArray();
+  return true;
+}
+
+// Печатает следующую строку /history, а после последней - хвост ответа
+bool printHistoryRow(ChunkedResponse& response, HistoryRows& history) {
+  char row[96];
+  JsonWriter json(row, sizeof(row));
+  if (history.level >= 0 ? nextRollupRow(history, json) : nextSampleRow(history, json)) {
+    response.print(history.rows++ > 0 ? "," : "");
+    response.print(json.data());
+    return true;
+  }
+  response.print("],\"next\":");
+  if (history.next > 0) {
+    response.print((long)history.next);
+  } else {
+    response.print("null");
+  }
+  response.print("}");
+  return false;
+}
+
+// История пользователя сессии: /history?from=&to=&res=raw|minute|hour|day.
+// Время - секунды журнала (logSeconds()); строки - массивы значений по списку columns
+void handleHistory() {
+  int userIndex = requestUser();
+  if (userIndex < 0) {
+    webRequests.send(401, "text/plain", "Not logged in");
+    return;
+  }
+  
+  String res = webRequests.hasArg("res") ? webRequests.arg("res") : String("minute");
+  std::shared_ptr<HistoryRows> history = std::make_shared<HistoryRows>();
+  history->userId = users.id(userIndex);
+  history->from = webRequests.hasArg("from") ? webRequests.arg("from").toInt() : 0;
+  history->to = webRequests.hasArg("to") ? webRequests.arg("to").toInt() : logSeconds();
+  
+  history->level = -1;
+  for (int i = 0; i < ROLLUP_LEVELS; i++) {
+    if (res == rollupLevels[i].name) {
+      history->level = i;
+    }
+  }
+  if (history->level < 0 && res != "raw") {
+    webRequests.send(400, "text/plain", "res must be raw, minute, hour or day");
+    return;
+  }
+  
+  ChunkedResponse response(webRequests, &routeHeapStats[ROUTE_HISTORY]);
+  response.begin(200, "application/json");
+  response.print("{\"res\":\"");
+  response.print(res);
+  response.print("\",\"period\":");
+  response.print(history->level >= 0 ? (long)rollupLevels[history->level].period : (long)(recordInterval / 1000));
+  
+  if (history->level < 0) {
+    response.print_P(PSTR(",\"columns\":[\"time\",\"pulse\",\"spo2\",\"quality\"],\"rows\":["));
+    // Пользователь на датчике: записи из кольца в ОЗУ, время восстанавливается по разностям.
+    // Остальные - из журнала
+    history->recent = userIndex == currentUserIndex;
+    if (!history->recent) {
+      history->reader.reset(new PulseLogReader(pulseLog, history->userId, history->from, history->to));
     }
   } else {
-    json += ",\"username\":\"\",";
-    json += "\"isAdmin\":\"0\",";
-    json += "\"bedtime\":\"Not set\",";
-    json += "\"wakeup\":\"Not set\"";
+    response.print_P(PSTR(",\"columns\":[\"start\",\"count\",\"pulse_min\",\"pulse_max\",\"pulse_sum\","
+                          "\"spo2_min\",\"spo2_max\",\"spo2_sum\"],\"rows\":["));
+  }
+  response.end([history](ChunkedResponse& rows) {
+    return printHistoryRow(rows, *history);
+  });
+}
+
+// Выгрузка журнала пользователя сессии в двоичном формате (см. export_stream.h):
+// /export?from=&to=&offset=. offset - сколько байт уже получено при прерванной
+// выгрузке с теми же from и to; по пустому последнему блоку можно продолжить с нового from.
+// Без to выгрузка идёт до текущего времени, поэтому докачка без to не совпала бы
+// с первым ответом: при offset > 0 to обязателен (его значение - в заголовке выгрузки)
+void handleExport() {
+  int userIndex = requestUser();
+  if (userIndex < 0) {
+    webRequests.send(401, "text/plain", "Not logged in");
+    return;
+  }
+  if (!activeExport.expired()) {
+    webRequests.sendHeader("Retry-After", "5");
+    webRequests.send(503, "text/plain", "Export already running");
+    return;
+  }
+  AsyncWebServerRequest* request = webRequests.current();
+  if (request == nullptr) {
+    return;
   }
   
-  json += "}";
-  server.send(200, "application/json", json);
+  uint16_t userId = users.id(userIndex);
+  uint32_t from = webRequests.hasArg("from") ? webRequests.arg("from").toInt() : 0;
+  uint32_t to = webRequests.hasArg("to") ? webRequests.arg("to").toInt() : logSeconds();
+  uint32_t offset = webRequests.hasArg("offset") ? webRequests.arg("offset").toInt() : 0;
+  if (offset > 0 && !webRequests.hasArg("to")) {
+    webRequests.send(400, "text/plain", "to is required with offset");
+    return;
+  }
   
-  // Добавляем yield в конце функции
-  yield();
+  std::shared_ptr<ExportSession> session = std::make_shared<ExportSession>(pulseLog, userId, from, to, offset);
+  activeExport = session;
+  AsyncWebServerResponse* response = request->beginChunkedResponse("application/octet-stream",
+    [session](uint8_t* buffer, size_t maxLength, size_t) -> size_t {
+      return session->read(buffer, maxLength);
+    });
+  webRequests.sendHeader("Content-Disposition", "attachment; filename=\"pulse.ppgx\"");
+  webRequests.send(response);
+  scheduler.trigger(exportTaskId);
+}
+
+// Кодирование выгрузки, пока клиент её забирает
+void exportTask() {
+  std::shared_ptr<ExportSession> session = activeExport.lock();
+  if (session) {
+    session->pump();
+  }
 }
 
 void handleSetTime() {
-  if (server.hasArg("h") && server.hasArg("m")) {
-    int h = server.arg("h").toInt();
-    int m = server.arg("m").toInt();
+  if (webRequests.hasArg("h") && webRequests.hasArg("m")) {
+    int h = webRequests.arg("h").toInt();
+    int m = webRequests.arg("m").toInt();
     
     if (h >= 0 && h < 24 && m >= 0 && m < 60) {
       // Устанавливаем глобальные переменные времени
@@ -1210,25 +1465,25 @@ void handleSetTime() {
       seconds = 0; // Сбрасываем секунды
       
       // Устанавливаем базу времени для корректной работы всех функций
-      timeBase = millis() - (h * 3600000UL + m * 60000UL);
+      timeBase = nowMs() - (h * 3600000UL + m * 60000UL);
       
       Serial.print("Время установлено: ");
       Serial.print(h);
       Serial.print(":");
       Serial.println(m);
       
-      server.send(200, "text/plain", "Time set successfully");
+      webRequests.send(200, "text/plain", "Time set successfully");
       return;
     }
   }
   
-  server.send(400, "text/plain", "Invalid time parameters");
+  webRequests.send(400, "text/plain", "Invalid time parameters");
 }
 
 void handleSetAlarm() {
-  if (server.hasArg("h") && server.hasArg("m")) {
-    int h = server.arg("h").toInt();
-    int m = server.arg("m").toInt();
+  if (webRequests.hasArg("h") && webRequests.hasArg("m")) {
+    int h = webRequests.arg("h").toInt();
+    int m = webRequests.arg("m").toInt();
     
     // Проверяем корректность введенных данных
     if (h >= 0 && h < 24 && m >= 0 && m < 60) {
@@ -1242,22 +1497,16 @@ void handleSetAlarm() {
       Serial.println(m);
       
       // Показываем уведомление на дисплее
-      display.clearDisplay();
-      display.setTextSize(1);
-      display.setCursor(0, 0);
-      display.println("Alarm set to:");
-      display.setTextSize(2);
-      display.setCursor(30, 20);
-      display.printf("%02d:%02d", h, m);
-      display.display();
-      delay(2000);
+      char text[6];
+      snprintf(text, sizeof(text), "%02d:%02d", h, m);
+      showToast("Alarm set to:", text, TOAST_NOTICE, 2000, 2);
       
-      server.send(200, "text/plain", "Alarm set successfully");
+      webRequests.send(200, "text/plain", "Alarm set successfully");
       return;
     }
   }
   
-  server.send(400, "text/plain", "Invalid alarm parameters");
+  webRequests.send(400, "text/plain", "Invalid alarm parameters");
 }
 
 void handleClearAlarm() {
@@ -1266,143 +1515,347 @@ void handleClearAlarm() {
   alarmTriggered = false;
   
   // Показываем уведомление на дисплее
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setCursor(0, 0);
-  display.println("Alarm cleared!");
-  display.display();
-  delay(1000);
+  showToast("Alarm cleared!", "", TOAST_NOTICE, 1000, 1);
   
-  server.send(200, "text/plain", "Alarm cleared successfully");
+  webRequests.send(200, "text/plain", "Alarm cleared successfully");
 }
 
 // Функции для работы с пользователями
-void loadUsers() {
-  if (LittleFS.exists("/users.json")) {
-    File file = LittleFS.open("/users.json", "r");
-    if (file) {
-      DynamicJsonDocument doc(4096);
+// users.json читается и пишется по одному пользователю: в памяти всегда один
+// документ на USER_JSON_DOCUMENT байт, сколько бы пользователей ни было в файле.
+// Хватает и на пользователя старого формата с 20 записями истории
+#define USER_JSON_DOCUMENT 2048
+#define USER_JSON_BUFFER 384
+
+enum UserField {
+  USER_FIELD_ID,
+  USER_FIELD_USERNAME,
+  USER_FIELD_SALT,
+  USER_FIELD_HASH,
+  USER_FIELD_BEDTIME_HOUR,
+  USER_FIELD_BEDTIME_MINUTE,
+  USER_FIELD_WAKEUP_HOUR,
+  USER_FIELD_WAKEUP_MINUTE,
+  USER_FIELD_IS_ADMIN,
+  USER_FIELD_COUNT
+};
+
+constexpr const char* userFieldNames[] = {
+  "id", "username", "salt", "hash", "bedtimeHour", "bedtimeMinute",
+  "wakeupHour", "wakeupMinute", "isAdmin"
+};
+
+static_assert(sizeof(userFieldNames) / sizeof(userFieldNames[0]) == USER_FIELD_COUNT,
+              "userFieldNames must match UserField");
+// Ключи, скобки, номер, экранированное имя, соль и хеш в hex, четыре времени и флаг
+static_assert(jsonSchemaKeyBytes(userFieldNames, USER_FIELD_COUNT) + 2 + 5 + USER_NAME_MAX * 6 + 2 +
+              USER_SALT_BYTES * 2 + 2 + USER_HASH_BYTES * 2 + 2 + 4 * 2 + 5 < USER_JSON_BUFFER,
+              "USER_JSON_BUFFER is too small for a users.json entry");
+
+// Один элемент массива users; migrated - файл нужно переписать в новом формате
+void loadUser(JsonObject entry, bool& migrated) {
+  String username = entry[userFieldNames[USER_FIELD_USERNAME]].as<String>();
+  if (users.full() || findUser(username) >= 0) {
+    Serial.println("Пропущен пользователь: " + username);
+    return;
+  }
+  
+  // У файлов старого формата номеров нет ни у кого - выдаём по порядку
+  uint16_t id = entry[userFieldNames[USER_FIELD_ID]] | 0;
+  if (id == 0) {
+    id = nextUserId;
+    migrated = true;
+  }
+  int16_t slot = users.add(id, username.c_str());
+  if (slot < 0) {
+    Serial.println("Пропущен пользователь: " + username);
+    return;
+  }
+  if (id >= nextUserId) {
+    nextUserId = id + 1;
+  }
+  
+  UserSchedule& schedule = users.schedule(slot);
+  schedule.bedtimeHour = entry[userFieldNames[USER_FIELD_BEDTIME_HOUR]] | -1;
+  schedule.bedtimeMinute = entry[userFieldNames[USER_FIELD_BEDTIME_MINUTE]] | -1;
+  schedule.wakeupHour = entry[userFieldNames[USER_FIELD_WAKEUP_HOUR]] | -1;
+  schedule.wakeupMinute = entry[userFieldNames[USER_FIELD_WAKEUP_MINUTE]] | -1;
+  // Старый формат флаг не сохранял: администратором был только "admin"
+  JsonVariant isAdmin = entry[userFieldNames[USER_FIELD_IS_ADMIN]];
+  if (isAdmin.isNull()) {
+    users.setAdmin(slot, username == "admin");
+    migrated = true;
+  } else {
+    users.setAdmin(slot, isAdmin.as<bool>());
+  }
+  
+  // Старый формат хранил пароль открытым текстом - заменяем хешем
+  UserCredentials& credentials = users.credentials(slot);
+  String salt = entry[userFieldNames[USER_FIELD_SALT]] | "";
+  String hash = entry[userFieldNames[USER_FIELD_HASH]] | "";
+  if (!userHexDecode(salt.c_str(), credentials.salt, USER_SALT_BYTES) ||
+      !userHexDecode(hash.c_str(), credentials.hash, USER_HASH_BYTES)) {
+    String password = entry["password"] | "";
+    users.setPassword(slot, password.c_str());
+    migrated = true;
+  }
+  userNameIndex.insert(users.name(slot), slot);
+  
+  // Старый формат хранил историю в файле - переносим её в журнал
+  JsonArray records = entry["records"];
+  for (JsonObject record : records) {
+    pulseLog.append(id, record["timestamp"].as<unsigned long>() / 1000,
+                    record["pulse"].as<int>(), record["spo2"].as<int>(), true);
+    migrated = true;
+  }
+}
+
+// Разбирает users.json по одному пользователю и передаёт каждого в visit;
+// возвращает размер прочитанной копии без подписи
+size_t readUsersFile(void (*visit)(JsonObject, bool&), bool& migrated) {
+  size_t length = 0;
+  File file = safeFileOpen(LittleFS, USERS_FILE, usersGeneration, length);
+  if (!file) {
+    return 0;
+  }
+  // На конце файла Stream::find() не должен ждать новых данных
+  file.setTimeout(0);
+  DynamicJsonDocument doc(USER_JSON_DOCUMENT);
+  // Элементы массива users разбираются по одному; "count" не нужен
+  if (file.find("\"users\":[")) {
+    while (file.peek() != ']') {
       DeserializationError error = deserializeJson(doc, file);
-      if (!error) {
-        userCount = min((int)doc["count"].as<int>(), MAX_USERS);
-        for (int i = 0; i < userCount; i++) {
-          users[i].username = doc["users"][i]["username"].as<String>();
-          users[i].password = doc["users"][i]["password"].as<String>();
-          users[i].bedtimeHour = doc["users"][i]["bedtimeHour"] | -1;
-          users[i].bedtimeMinute = doc["users"][i]["bedtimeMinute"] | -1;
-          users[i].wakeupHour = doc["users"][i]["wakeupHour"] | -1;
-          users[i].wakeupMinute = doc["users"][i]["wakeupMinute"] | -1;
-          users[i].recordCount = min((int)doc["users"][i]["recordCount"].as<int>(), 20);
-          users[i].isAdmin = doc["users"][i]["isAdmin"] | false;
-          
-          for (int j = 0; j < users[i].recordCount; j++) {
-            users[i].records[j].timestamp = doc["users"][i]["records"][j]["timestamp"].as<unsigned long>();
-            users[i].records[j].pulseValue = doc["users"][i]["records"][j]["pulse"].as<int>();
-            users[i].records[j].spo2Value = doc["users"][i]["records"][j]["spo2"].as<int>();
-          }
-        }
+      if (error) {
+        Serial.print("users.json: ");
+        Serial.println(error.c_str());
+        break;
+      }
+      visit(doc.as<JsonObject>(), migrated);
+      // За элементом - запятая или конец массива
+      if (!file.findUntil(",", "]")) {
+        break;
       }
-      file.close();
     }
   }
+  file.close();
+  return length;
+}
+
+void loadUsers() {
+  bool migrated = false;
+  usersFileBytes = readUsersFile(loadUser, migrated);
+  
+  // Записи уже перенесены в журнал - сохраняем сразу, иначе после сбоя
+  // они перенеслись бы повторно
+  if (migrated) {
+    markUsersDirty();
+    saveUsers();
+  }
   
   // Создаем админа, если его нет
   createAdminIfNeeded();
 }
 
+// Пользователь одним объектом JSON в буфере; false - не поместился
+bool writeUserJson(int slot, char* buffer, size_t capacity) {
+  const UserSchedule& schedule = users.schedule(slot);
+  UserCredentials& credentials = users.credentials(slot);
+  char salt[USER_SALT_BYTES * 2 + 1];
+  char hash[USER_HASH_BYTES * 2 + 1];
+  userHexEncode(credentials.salt, USER_SALT_BYTES, salt);
+  userHexEncode(credentials.hash, USER_HASH_BYTES, hash);
+  
+  JsonWriter json(buffer, capacity);
+  json.beginObject();
+  json.key(userFieldNames[USER_FIELD_ID]);
+  json.value((uint32_t)users.id(slot));
+  json.key(userFieldNames[USER_FIELD_USERNAME]);
+  json.value(users.name(slot));
+  json.key(userFieldNames[USER_FIELD_SALT]);
+  json.value(salt);
+  json.key(userFieldNames[USER_FIELD_HASH]);
+  json.value(hash);
+  // В файле незаданное время по-прежнему -1
+  json.key(userFieldNames[USER_FIELD_BEDTIME_HOUR]);
+  json.value(schedule.bedtimeHour != USER_TIME_UNSET ? (int32_t)schedule.bedtimeHour : -1);
+  json.key(userFieldNames[USER_FIELD_BEDTIME_MINUTE]);
+  json.value(schedule.bedtimeMinute != USER_TIME_UNSET ? (int32_t)schedule.bedtimeMinute : -1);
+  json.key(userFieldNames[USER_FIELD_WAKEUP_HOUR]);
+  json.value(schedule.wakeupHour != USER_TIME_UNSET ? (int32_t)schedule.wakeupHour : -1);
+  json.key(userFieldNames[USER_FIELD_WAKEUP_MINUTE]);
+  json.value(schedule.wakeupMinute != USER_TIME_UNSET ? (int32_t)schedule.wakeupMinute : -1);
+  json.key(userFieldNames[USER_FIELD_IS_ADMIN]);
+  json.value(users.isAdmin(slot));
+  json.endObject();
+  return !json.overflow();
+}
+
 void saveUsers() {
-  DynamicJsonDocument doc(4096);
-  doc["count"] = userCount;
-  
-  JsonArray usersArray = doc.createNestedArray("users");
-  for (int i = 0; i < userCount; i++) {
-    JsonObject userObj = usersArray.createNestedObject();
-    userObj["username"] = users[i].username;
-    userObj["password"] = users[i].password;
-    userObj["bedtimeHour"] = users[i].bedtimeHour;
-    userObj["bedtimeMinute"] = users[i].bedtimeMinute;
-    userObj["wakeupHour"] = users[i].wakeupHour;
-    userObj["wakeupMinute"] = users[i].wakeupMinute;
-    userObj["recordCount"] = users[i].recordCount;
-    
-    JsonArray recordsArray = userObj.createNestedArray("records");
-    for (int j = 0; j < users[i].recordCount; j++) {
-      JsonObject recordObj = recordsArray.createNestedObject();
-      recordObj["timestamp"] = users[i].records[j].timestamp;
-      recordObj["pulse"] = users[i].records[j].pulseValue;
-      recordObj["spo2"] = users[i].records[j].spo2Value;
+  // Новая копия во временном файле с контрольной суммой, затем rename
+  SafeFileWriter writer(LittleFS, USERS_FILE, usersGeneration + 1);
+  bool complete = writer.begin();
+  if (complete) {
+    char buffer[USER_JSON_BUFFER];
+    writer.print("{\"count\":");
+    writer.print(users.count());
+    writer.print(",\"users\":[");
+    for (int i = 0; i < users.count() && complete; i++) {
+      if (i > 0) {
+        writer.print(',');
+      }
+      complete = writeUserJson(i, buffer, sizeof(buffer));
+      writer.print(buffer);
     }
+    writer.print("]}");
   }
-  
-  File file = LittleFS.open("/users.json", "w");
-  if (file) {
-    serializeJson(doc, file);
-    file.close();
+  if (!complete) {
+    writer.abort(); // неполную копию не подставляем
+  } else if (writer.commit()) {
+    usersGeneration++;
+    usersFileBytes = writer.length();
+    usersDirty = false;
+    return;
   }
+  Serial.println("users.json write failed");
 }
 
-int findUser(String username) {
-  for (int i = 0; i < userCount; i++) {
-    if (users[i].username == username) {
-      return i;
+// Учётные записи изменились; запись - в persistTask()
+void markUsersDirty() {
+  unsigned long now = nowMs();
+  if (!usersDirty) {
+    usersDirty = true;
+    usersFirstChange = now;
+  }
+  usersLastChange = now;
+}
+
+void persistTask() {
+  // Дописанные в журнал записи фиксируются не позже LOG_SYNC_SECONDS
+  pulseLog.sync(logSeconds());
+  logClock.persist(nowMs());
+  if (!usersDirty) {
+    return;
+  }
+  unsigned long now = nowMs();
+  if (now - usersLastChange >= usersSaveDelay || now - usersFirstChange >= usersSaveMaxLatency) {
+    saveUsers();
+    if (usersDirty) {
+      // Не получилось - следующая попытка не раньше чем через usersSaveDelay
+      usersFirstChange = now;
+      usersLastChange = now;
     }
   }
-  return -1;
 }
 
-bool addUser(String username, String password) {
-  if (userCount >= MAX_USERS) {
-    return false;
+int findUser(const String& username) {
+  return userNameIndex.find(username.c_str());
+}
+
+// Пользователь текущего веб-запроса по cookie сессии или -1
+int requestUser() {
+  char token[SESSION_TOKEN_LENGTH + 1];
+  if (!sessionTokenFromCookie(webRequests.header("Cookie"), token)) {
+    return -1;
   }
-  
+  int user = sessions.resolve(token, nowMs());
+  return user < users.count() ? user : -1;
+}
+
+// Открывает сессию и отдаёт её cookie в ответе
+void startSession(int userIndex) {
+  char token[SESSION_TOKEN_LENGTH + 1];
+  sessions.create(userIndex, nowMs(), token);
+  webRequests.sendHeader("Set-Cookie", String(SESSION_COOKIE "=") + token +
+                         "; Path=/; HttpOnly; SameSite=Strict; Max-Age=" + String(SESSION_IDLE_TIMEOUT / 1000));
+}
+
+bool addUser(String username, String password) {
   if (findUser(username) >= 0) {
     return false; // Пользователь уже существует
   }
   
-  users[userCount].username = username;
-  users[userCount].password = password;
-  users[userCount].bedtimeHour = -1;
-  users[userCount].bedtimeMinute = -1;
-  users[userCount].wakeupHour = -1;
-  users[userCount].wakeupMinute = -1;
-  users[userCount].recordCount = 0;
-  userCount++;
-  saveUsers();
+  // Таблица полна или имя не помещается
+  int slot = users.add(nextUserId, username.c_str());
+  if (slot < 0) {
+    return false;
+  }
+  nextUserId++;
+  users.setPassword(slot, password.c_str());
+  userNameIndex.insert(users.name(slot), slot);
+  markUsersDirty();
   return true;
 }
 
-void addPulseRecord(int pulseVal, int spo2Val) {
-  if (currentUserIndex < 0 || currentUserIndex >= userCount) {
+// Время журнала в секундах (log_clock.h): не идёт назад между загрузками
+// и при установке часов, в отличие от времени на экране
+uint32_t logSeconds() {
+  return logClock.now(nowMs());
+}
+
+void addPulseRecord(int pulseVal, int spo2Val, bool quality) {
+  if (currentUserIndex < 0 || currentUserIndex >= users.count()) {
     return; // Никто не авторизован
   }
   
-  User* user = &users[currentUserIndex];
-  
-  // Если достигли максимума записей, сдвинем все записи на одну позицию назад
-  if (user->recordCount >= 20) {
-    for (int i = 0; i < 19; i++) {
-      user->records[i] = user->records[i+1];
-    }
-    user->recordCount = 19;
+  // Одна запись в 4 байта дописывается в конец журнала; users.json не трогаем
+  uint32_t time = logSeconds();
+  if (!pulseLog.append(users.id(currentUserIndex), time, pulseVal, spo2Val, quality)) {
+    Serial.println("Pulse log write failed");
+  }
+  pushRecentRecord(time, pulseVal, spo2Val, quality);
+  pulseRollup.add(time, pulseVal, spo2Val);
+}
+
+void pushRecentRecord(uint32_t time, uint8_t pulseVal, uint8_t spo2Val, bool quality) {
+  // Часы пошли назад или разрыв не помещается в разность - начинаем кольцо заново
+  if (!recentRecords.empty() && (time < recentNewestTime || time - recentNewestTime > UINT16_MAX)) {
+    recentRecords.clear();
+  }
+  if (recentRecords.empty()) {
+    recentOldestTime = time;
+    recentNewestTime = time;
   }
   
-  // Добавляем новую запись
-  user->records[user->recordCount].timestamp = millis() - timeBase;
-  user->records[user->recordCount].pulseValue = pulseVal;
-  user->records[user->recordCount].spo2Value = spo2Val;
-  user->recordCount++;
-  
-  saveUsers();
+  PulseRecord record;
+  record.delta = time - recentNewestTime;
+  record.pulse = pulseVal;
+  record.spo2 = (spo2Val & ~LOG_QUALITY_FLAG) | (quality ? LOG_QUALITY_FLAG : 0);
+  recentPushed++;
+  if (recentRecords.push(record)) {
+    // Вытеснена самая старая запись: разность новой самой старой отсчитана от неё
+    recentOldestTime += recentRecords.oldest().delta;
+  }
+  recentNewestTime = time;
+}
+
+// Готовит историю текущего пользователя: кольцо последних записей из журнала
+// и открытые корзины сводок
+void openUserHistory() {
+  recentRecords.clear();
+  if (currentUserIndex < 0) {
+    pulseRollup.deselect();
+    return;
+  }
+  uint16_t userId = users.id(currentUserIndex);
+  pulseRollup.select(userId, logSeconds());
+  uint32_t last = pulseLog.lastTime(userId);
+  uint32_t window = RECENT_RECORDS * (recordInterval / 1000);
+  
+  PulseLogReader reader(pulseLog, userId, last > window ? last - window : 0, last);
+  PulseSample sample;
+  while (reader.next(sample)) {
+    pushRecentRecord(sample.time, sample.pulse, sample.spo2, sample.quality);
+  }
 }
 
 // Проверка для сообщений о сне
 void checkSleepNotifications() {
-  if (currentUserIndex < 0 || currentUserIndex >= userCount) {
+  if (currentUserIndex < 0 || currentUserIndex >= users.count()) {
     return; // Никто не авторизован
   }
   
-  User* user = &users[currentUserIndex];
-  unsigned long t = millis() - timeBase;
+  const UserSchedule& schedule = users.schedule(currentUserIndex);
+  unsigned long t = nowMs() - timeBase;
   int h = (t / 3600000) % 24;
   int m = (t / 60000) % 60;
   
@@ -1410,54 +1863,37 @@ void checkSleepNotifications() {
   static bool wakeupNotificationShown = false;
   
   // Проверка времени отхода ко сну
-  if (user->bedtimeHour >= 0 && !sleepNotificationShown && 
-      h == user->bedtimeHour && m == user->bedtimeMinute) {
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setCursor(0, 0);
-    display.println("TIME TO SLEEP!");
-    display.println("Good night!");
-    display.display();
-    delay(3000);
+  if (schedule.bedtimeHour != USER_TIME_UNSET && !sleepNotificationShown && 
+      h == schedule.bedtimeHour && m == schedule.bedtimeMinute) {
+    showToast("TIME TO SLEEP!", "Good night!", TOAST_REMINDER, 3000, 1);
     sleepNotificationShown = true;
   }
   
   // Сброс флага уведомления о сне через час после уведомления
   if (sleepNotificationShown && 
-      ((h != user->bedtimeHour) || (m != user->bedtimeMinute))) {
+      ((h != schedule.bedtimeHour) || (m != schedule.bedtimeMinute))) {
     sleepNotificationShown = false;
   }
   
   // Проверка времени пробуждения
-  if (user->wakeupHour >= 0 && !wakeupNotificationShown && 
-      h == user->wakeupHour && m == user->wakeupMinute) {
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setCursor(0, 0);
-    display.println("GOOD MORNING!");
-    display.println("TIME TO WAKE UP!");
-    display.display();
-    delay(3000);
+  if (schedule.wakeupHour != USER_TIME_UNSET && !wakeupNotificationShown && 
+      h == schedule.wakeupHour && m == schedule.wakeupMinute) {
+    showToast("GOOD MORNING!", "TIME TO WAKE UP!", TOAST_REMINDER, 3000, 1);
     wakeupNotificationShown = true;
   }
   
   // Сброс флага уведомления о пробуждении через час после уведомления
   if (wakeupNotificationShown && 
-      ((h != user->wakeupHour) || (m != user->wakeupMinute))) {
+      ((h != schedule.wakeupHour) || (m != schedule.wakeupMinute))) {
     wakeupNotificationShown = false;
   }
 }
 
 // Показ мотивирующих сообщений
 void showMotivationalMessage() {
-  unsigned long now = millis();
+  unsigned long now = nowMs();
   if (now - lastMessageTime >= messageInterval) {
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setCursor(0, 0);
-    display.println(motivationalMessages[currentMessageIndex]);
-    display.display();
-    delay(3000); // Показываем на 3 секунды
+    showToast("Tip:", motivationalMessages[currentMessageIndex], TOAST_INFO, 3000, 1); // Показываем 3 секунды
     
     currentMessageIndex = (currentMessageIndex + 1) % MESSAGE_COUNT;
     lastMessageTime = now;
@@ -1465,109 +1901,120 @@ void showMotivationalMessage() {
 }
 
 void handleLogin() {
-  if (server.hasArg("username") && server.hasArg("password")) {
-    String username = server.arg("username");
-    String password = server.arg("password");
+  if (webRequests.hasArg("username") && webRequests.hasArg("password")) {
+    String username = webRequests.arg("username");
+    String password = webRequests.arg("password");
     
     int userIndex = findUser(username);
-    if (userIndex >= 0 && users[userIndex].password == password) {
+    if (userIndex >= 0 && users.checkPassword(userIndex, password.c_str())) {
       // Сначала сбрасываем значения предыдущего пользователя
       pulse = 0;
       spo2 = 0;
       beatDetected = false;
       
-      // Затем устанавливаем нового пользователя
+      // Затем устанавливаем нового пользователя: теперь измеряют его
       currentUserIndex = userIndex;
+      openUserHistory();
+      startSession(userIndex);
       
       // Показываем приветственное сообщение
-      display.clearDisplay();
-      display.setTextSize(1);
-      display.setCursor(0, 0);
-      display.println("Приветствую!");
-      display.println(username);
-      display.display();
-      delay(1000);
+      showToast("Приветствую!", username.c_str(), TOAST_NOTICE, 1000, 1);
       
       // Логируем вход
       Serial.println("Пользователь вошел: " + username);
       
-      server.sendHeader("Location", "/");
-      server.send(303);
+      webRequests.sendHeader("Location", "/");
+      webRequests.send(303);
       return;
     }
   }
   
   // Ошибка аутентификации
-  server.send(401, "text/html", "Invalid credentials");
+  webRequests.send(401, "text/html", "Invalid credentials");
 }
 
 void handleRegister() {
-  if (server.hasArg("username") && server.hasArg("password")) {
-    String username = server.arg("username");
-    String password = server.arg("password");
+  if (webRequests.hasArg("username") && webRequests.hasArg("password")) {
+    String username = webRequests.arg("username");
+    String password = webRequests.arg("password");
     
     if (addUser(username, password)) {
       // Автоматически авторизуем пользователя после регистрации
       currentUserIndex = findUser(username);
-      server.sendHeader("Location", "/");
-      server.send(303);
+      openUserHistory();
+      startSession(currentUserIndex);
+      webRequests.sendHeader("Location", "/");
+      webRequests.send(303);
       return;
     }
   }
   
   // Ошибка регистрации
-  server.send(400, "text/html", "Registration failed");
+  webRequests.send(400, "text/html", "Registration failed");
 }
 
 void handleLogout() {
-  // Выход из аккаунта
-  currentUserIndex = -1;
-  
-  // Сбрасываем все личные данные
-  pulse = 0;
-  spo2 = 0;
-  beatDetected = false;
-  alarmHour = -1;
-  alarmMinute = -1;
-  alarmTriggered = false;
+  // Выход из аккаунта: закрываем только сессию этого клиента
+  int userIndex = requestUser();
+  char token[SESSION_TOKEN_LENGTH + 1];
+  if (sessionTokenFromCookie(webRequests.header("Cookie"), token)) {
+    sessions.close(token);
+  }
+  webRequests.sendHeader("Set-Cookie", SESSION_COOKIE "=; Path=/; Max-Age=0");
   
-  // Очищаем дисплей для следующего пользователя
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setCursor(0, 0);
-  display.println("Выход из аккаунта");
-  display.println("Успешно!");
-  display.display();
-  delay(1000);
+  // Датчик освобождается, когда его пользователь вышел со всех клиентов
+  if (userIndex >= 0 && userIndex == currentUserIndex && !sessions.hasUser(userIndex, nowMs())) {
+    currentUserIndex = -1;
+    openUserHistory();
+    
+    // Сбрасываем все личные данные
+    pulse = 0;
+    spo2 = 0;
+    beatDetected = false;
+    alarmHour = -1;
+    alarmMinute = -1;
+    alarmTriggered = false;
+    
+    // Очищаем дисплей для следующего пользователя
+    showToast("Выход из аккаунта", "Успешно!", TOAST_NOTICE, 1000, 1);
+  }
   
   // Перенаправляем на главную страницу
-  server.sendHeader("Location", "/");
-  server.send(303);
+  webRequests.sendHeader("Location", "/");
+  webRequests.send(303);
   
   Serial.println("Пользователь вышел из аккаунта");
 }
 
 void handleSetSleep() {
-  if (currentUserIndex < 0) {
-    server.send(401, "text/html", "Not logged in");
+  int userIndex = requestUser();
+  if (userIndex < 0) {
+    webRequests.send(401, "text/html", "Not logged in");
     return;
   }
   
-  User* user = &users[currentUserIndex];
+  UserSchedule& schedule = users.schedule(userIndex);
   
-  if (server.hasArg("bedH") && server.hasArg("bedM")) {
-    user->bedtimeHour = server.arg("bedH").toInt();
-    user->bedtimeMinute = server.arg("bedM").toInt();
+  // Время вне суток (например, -1) снимает напоминание
+  if (webRequests.hasArg("bedH") && webRequests.hasArg("bedM")) {
+    int h = webRequests.arg("bedH").toInt();
+    int m = webRequests.arg("bedM").toInt();
+    bool valid = h >= 0 && h < 24 && m >= 0 && m < 60;
+    schedule.bedtimeHour = valid ? h : USER_TIME_UNSET;
+    schedule.bedtimeMinute = valid ? m : USER_TIME_UNSET;
   }
   
-  if (server.hasArg("wakeH") && server.hasArg("wakeM")) {
-    user->wakeupHour = server.arg("wakeH").toInt();
-    user->wakeupMinute = server.arg("wakeM").toInt();
+  if (webRequests.hasArg("wakeH") && webRequests.hasArg("wakeM")) {
+    int h = webRequests.arg("wakeH").toInt();
+    int m = webRequests.arg("wakeM").toInt();
+    bool valid = h >= 0 && h < 24 && m >= 0 && m < 60;
+    schedule.wakeupHour = valid ? h : USER_TIME_UNSET;
+    schedule.wakeupMinute = valid ? m : USER_TIME_UNSET;
   }
   
-  saveUsers();
-  server.sendHeader("Location", "/");
-  server.send(303);
+  markUsersDirty();
+  webRequests.sendHeader("Location", "/");
+  webRequests.send(303);
 }
 
 // Функция для проверки показателей здоровья и выдачи предупреждений
@@ -1591,34 +2038,32 @@ String checkHealthStatus(int pulseValue, int spo2Value) {
   return warning;
 }
 
-// Создаем административный аккаунт, если он не существует
+// Создаем административный аккаунт, если он не существует, и возвращаем ему права
 void createAdminIfNeeded() {
-  if (findUser("admin") < 0) {
+  int existing = findUser("admin");
+  if (existing >= 0 && !users.isAdmin(existing)) {
+    // Права потеряны (файл без флага) - без них панель администратора недоступна
+    users.setAdmin(existing, true);
+    markUsersDirty();
+  }
+  if (existing < 0) {
     // Добавляем администратора с паролем admin
-    users[userCount].username = "admin";
-    users[userCount].password = "admin";
-    users[userCount].bedtimeHour = -1;
-    users[userCount].bedtimeMinute = -1;
-    users[userCount].wakeupHour = -1;
-    users[userCount].wakeupMinute = -1;
-    users[userCount].recordCount = 0;
-    users[userCount].isAdmin = true;
-    userCount++;
-    saveUsers();
+    int slot = users.add(nextUserId, "admin");
+    if (slot < 0) {
+      Serial.println("Нет места для админа");
+      return;
+    }
+    nextUserId++;
+    users.setPassword(slot, "admin");
+    users.setAdmin(slot, true);
+    userNameIndex.insert(users.name(slot), slot);
+    markUsersDirty();
     Serial.println("Админ создан");
   }
 }
 
-// Обрабатываем запрос на административную страницу
-void handleAdmin() {
-  // Проверяем, что пользователь авторизован и является администратором
-  if (currentUserIndex < 0 || !users[currentUserIndex].isAdmin) {
-    server.sendHeader("Location", "/");
-    server.send(303);
-    return;
-  }
-
-  String html = F(R"=====(<!DOCTYPE html><html><head>
+// Неизменяемые части страницы администратора во флеш-памяти
+static const char adminPageHead[] PROGMEM = R"=====(<!DOCTYPE html><html><head>
 <meta charset='UTF-8'>
 <meta name='viewport' content='width=device-width,initial-scale=1'>
 <title>Панель администратора</title>
@@ -1676,45 +2121,9 @@ tr:hover td{background:#fff8f8}
         <th>Режим пробуждения</th>
         <th>Действия</th>
       </tr>
-)=====");
-
-  // Проверяем, есть ли пользователи
-  if (userCount == 0) {
-    html += "<tr><td colspan='5' class='no-users'>Нет зарегистрированных пользователей</td></tr>";
-  } else {
-    // Добавляем каждого пользователя в таблицу
-    for (int i = 0; i < userCount; i++) {
-      html += "<tr><td>" + users[i].username + "</td><td>";
-      html += users[i].isAdmin ? "<span class='admin-badge'>Админ</span>" : "<span class='user-badge'>Пользователь</span>";
-      html += "</td><td>";
-      
-      // Добавляем время отхода ко сну
-      if (users[i].bedtimeHour >= 0) {
-        html += String(users[i].bedtimeHour) + ":" + (users[i].bedtimeMinute < 10 ? "0" : "") + String(users[i].bedtimeMinute);
-      } else {
-        html += "<i>Не задано</i>";
-      }
-      
-      html += "</td><td>";
-      
-      // Добавляем время пробуждения
-      if (users[i].wakeupHour >= 0) {
-        html += String(users[i].wakeupHour) + ":" + (users[i].wakeupMinute < 10 ? "0" : "") + String(users[i].wakeupMinute);
-      } else {
-        html += "<i>Не задано</i>";
-      }
-      
-      html += "</td><td class='actions'>";
-      if (i != currentUserIndex) {
-        html += "<button onclick='confirmDelete(" + String(i) + ", \"" + users[i].username + "\")' class='button'>Удалить</button>";
-      } else {
-        html += "<i>Текущий аккаунт</i>";
-      }
-      html += "</td></tr>";
-    }
-  }
+)=====";
 
-  html += F(R"=====(
+static const char adminPageTail[] PROGMEM = R"=====(
     </table>
   </div>
   <div class="logout-section">
@@ -1737,12 +2146,12 @@ tr:hover td{background:#fff8f8}
 
 <script>
   // Функция для подтверждения удаления пользователя
-  function confirmDelete(userId, username) {
+  function confirmDelete(username) {
     document.getElementById('deleteMessage').innerText = `Вы уверены, что хотите удалить пользователя "${username}"?`;
     
     const confirmBtn = document.getElementById('confirmDeleteBtn');
     confirmBtn.onclick = function() {
-      window.location.href = `/deleteUser?id=${userId}`;
+      window.location.href = `/deleteUser?name=${encodeURIComponent(username)}`;
     };
     
     document.getElementById('deleteModal').style.display = 'flex';
@@ -1763,46 +2172,123 @@ tr:hover td{background:#fff8f8}
 </script>
 </body>
 </html>
-)=====");
+)=====";
+
+// Обрабатываем запрос на административную страницу
+void handleAdmin() {
+  // Проверяем, что пользователь авторизован и является администратором
+  int adminIndex = requestUser();
+  if (adminIndex < 0 || !users.isAdmin(adminIndex)) {
+    webRequests.sendHeader("Location", "/");
+    webRequests.send(303);
+    return;
+  }
+
+  ChunkedResponse response(webRequests, &routeHeapStats[ROUTE_ADMIN]);
+  response.begin(200, "text/html");
+  response.print_P(adminPageHead);
+  response.end([row = 0, adminIndex](ChunkedResponse& rows) mutable {
+    return printAdminRow(rows, row++, adminIndex);
+  });
+}
+
+// Строка таблицы пользователей на странице администратора; после последней - конец страницы
+bool printAdminRow(ChunkedResponse& response, int i, int adminIndex) {
+  if (i >= users.count()) {
+    // Проверяем, есть ли пользователи
+    if (i == 0) {
+      response.print_P(PSTR("<tr><td colspan='5' class='no-users'>Нет зарегистрированных пользователей</td></tr>"));
+    }
+    response.print_P(adminPageTail);
+    return false;
+  }
 
-  server.send(200, "text/html", html);
+  response.print("<tr><td>");
+  response.print(users.name(i));
+  response.print("</td><td>");
+  response.print(users.isAdmin(i) ? "<span class='admin-badge'>Админ</span>" : "<span class='user-badge'>Пользователь</span>");
+  response.print("</td><td>");
+  
+  // Добавляем время отхода ко сну
+  if (users.schedule(i).bedtimeHour != USER_TIME_UNSET) {
+    response.print(users.schedule(i).bedtimeHour);
+    response.print(":");
+    response.printPadded(users.schedule(i).bedtimeMinute, 2);
+  } else {
+    response.print("<i>Не задано</i>");
+  }
+  
+  response.print("</td><td>");
+  
+  // Добавляем время пробуждения
+  if (users.schedule(i).wakeupHour != USER_TIME_UNSET) {
+    response.print(users.schedule(i).wakeupHour);
+    response.print(":");
+    response.printPadded(users.schedule(i).wakeupMinute, 2);
+  } else {
+    response.print("<i>Не задано</i>");
+  }
+  
+  response.print("</td><td class='actions'>");
+  if (i == adminIndex) {
+    response.print("<i>Текущий аккаунт</i>");
+  } else if (i == currentUserIndex) {
+    response.print("<i>Идут измерения</i>");
+  } else {
+    response.print("<button onclick='confirmDelete(\"");
+    response.print(users.name(i));
+    response.print("\")' class='button'>Удалить</button>");
+  }
+  response.print("</td></tr>");
+  return true;
 }
 
 // Обрабатываем запрос на удаление пользователя
 void handleDeleteUser() {
   // Проверяем, что администратор авторизован
-  if (currentUserIndex < 0 || !users[currentUserIndex].isAdmin) {
-    server.sendHeader("Location", "/");
-    server.send(303);
+  int adminIndex = requestUser();
+  if (adminIndex < 0 || !users.isAdmin(adminIndex)) {
+    webRequests.sendHeader("Location", "/");
+    webRequests.send(303);
     return;
   }
 
-  // Проверяем, что передан ID пользователя
-  if (server.hasArg("id")) {
-    int userId = server.arg("id").toInt();
+  // Пользователь задаётся именем, а не номером ячейки: удаление переставляет
+  // ячейки, и номер со страницы, открытой до этого, указал бы на другого
+  if (webRequests.hasArg("name")) {
+    String username = webRequests.arg("name");
+    int userId = findUser(username);
     
-    // Проверяем что ID валидный и не пытаемся удалить текущего пользователя
-    if (userId >= 0 && userId < userCount && userId != currentUserIndex) {
+    // Проверяем что пользователь есть и не пытаемся удалить себя или того, кого сейчас измеряют
+    if (userId >= 0 && userId != adminIndex && userId != currentUserIndex) {
       // Запоминаем имя пользователя для вывода сообщения
-      String deletedUsername = users[userId].username;
+      String deletedUsername = users.name(userId);
+      pulseLog.remove(users.id(userId));
+      userNameIndex.remove(users.name(userId));
+      sessions.removeUser(userId);
       
-      // Сдвигаем всех пользователей в массиве
-      for (int i = userId; i < userCount - 1; i++) {
-        users[i] = users[i+1];
+      // На место удалённого ставим последнего: порядок в таблице не важен,
+      // а копировать весь хвост массива не нужно
+      int moved = users.remove(userId);
+      if (moved >= 0) {
+        userNameIndex.update(users.name(userId), userId);
+        sessions.moveUser(moved, userId);
+        if (currentUserIndex == moved) {
+          currentUserIndex = userId;
+        }
       }
-      userCount--;
-      saveUsers(); // Сохраняем обновленный список
+      markUsersDirty(); // Сохраняем обновленный список
       
       // Выводим сообщение об успешном удалении
       Serial.println("Пользователь удален: " + deletedUsername);
-    } else if (userId == currentUserIndex) {
+    } else if (userId >= 0) {
       Serial.println("Попытка удаления текущего пользователя");
     } else {
-      Serial.println("Неверный ID пользователя для удаления: " + String(userId));
+      Serial.println("Нет пользователя для удаления: " + username);
     }
   }
   
   // Перенаправляем обратно на административную панель
-  server.sendHeader("Location", "/admin");
-  server.send(303);
-}
\ No newline at end of file
+  webRequests.sendHeader("Location", "/admin");
+  webRequests.send(303);
+}
@@ -0,0 +1,78 @@
+// Кольцевой буфер фиксированной ёмкости для истории значений.
+//
+// push() за O(1) записывает новый элемент поверх самого старого, когда
+// буфер полон. Доступ по индексу считается от самого старого элемента:
+// ring[0] - самый старый, ring[size() - 1] - самый новый.
+// Ёмкость задаётся при компиляции, динамической памяти нет.
+#pragma once
+
+#include <stdint.h>
+
+template <typename T, uint16_t N>
+class FixedRing {
+  static_assert(N > 0, "FixedRing capacity must be positive");
+
+public:
+  // Возвращает true, если при этом был вытеснен самый старый элемент
+  bool push(const T& item) {
+    _items[_head] = item;
+    _head = next(_head);
+    if (_count < N) {
+      _count++;
+      return false;
+    }
+    return true;
+  }
+
+  const T& operator[](uint16_t index) const {
+    return _items[position(index)];
+  }
+
+  T& operator[](uint16_t index) {
+    return _items[position(index)];
+  }
+
+  const T& oldest() const {
+    return (*this)[0];
+  }
+
+  const T& newest() const {
+    return (*this)[_count - 1];
+  }
+
+  uint16_t size() const {
+    return _count;
+  }
+
+  bool empty() const {
+    return _count == 0;
+  }
+
+  bool full() const {
+    return _count == N;
+  }
+
+  static constexpr uint16_t capacity() {
+    return N;
+  }
+
+  void clear() {
+    _head = 0;
+    _count = 0;
+  }
+
+private:
+  static uint16_t next(uint16_t index) {
+    return index + 1 == N ? 0 : index + 1;
+  }
+
+  // Самый старый элемент лежит на _head - _count (по модулю N)
+  uint16_t position(uint16_t index) const {
+    uint32_t slot = (uint32_t)_head + N - _count + index;
+    return slot >= N ? slot - N : slot;
+  }
+
+  T _items[N];
+  uint16_t _head = 0;  // куда пойдёт следующий элемент
+  uint16_t _count = 0;
+};
@@ -0,0 +1,62 @@
+// Тонкие интерфейсы между логикой прошивки и оборудованием.
+//
+// На устройстве их реализуют SystemClock, Max30102Sensor и OledFlusher;
+// вместо них можно подставить поддельные или записанные источники и гонять
+// ту же обработку без платы. Файловая система уже передаётся модулям как
+// fs::FS (LittleFS на устройстве), HTTP - через RequestQueue.
+#pragma once
+
+#include <Arduino.h>
+
+// Отсчёт датчика: пара каналов АЦП и время его получения
+struct PpgSample {
+  uint32_t timestamp; // мс, время получения отсчёта датчиком
+  uint32_t red;
+  uint32_t ir;
+};
+
+class Clock {
+public:
+  virtual ~Clock() {}
+  virtual uint32_t millis() = 0;
+  virtual uint32_t micros() = 0;
+};
+
+// Часы платы
+class SystemClock : public Clock {
+public:
+  uint32_t millis() override {
+    return ::millis();
+  }
+
+  uint32_t micros() override {
+    return ::micros();
+  }
+};
+
+class PpgSensor {
+public:
+  virtual ~PpgSensor() {}
+
+  virtual bool begin() = 0;
+
+  // Датчик сам сообщил о новых отсчётах (например, прерыванием)
+  virtual bool pending() {
+    return false;
+  }
+
+  // Забирает накопленные отсчёты, не больше maxCount, в порядке получения
+  virtual size_t read(PpgSample* samples, size_t maxCount) = 0;
+
+  // Отсчёты, потерянные до read() (переполнение буфера датчика)
+  virtual uint32_t lostSamples() const = 0;
+};
+
+// Приёмник готовых кадров дисплея (1 бит на пиксель, страницы SSD1306)
+class FrameSink {
+public:
+  virtual ~FrameSink() {}
+
+  // Возвращает число переданных байт
+  virtual size_t flush(const uint8_t* frame) = 0;
+};
@@ -0,0 +1,66 @@
+// Adafruit_GFX для сборки на Linux: примитивы и текст поверх drawPixel().
+// Шрифт условный (узор от кода символа) - тесты сравнивают кадры между
+// собой, а не с картинкой библиотеки; шаг и перенос строк как у 5x7.
+#pragma once
+
+#include "Arduino.h"
+
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t width, int16_t height) : _width(width), _height(height) {}
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+  virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  virtual void fillScreen(uint16_t color) {
+    fillRect(0, 0, _width, _height, color);
+  }
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t background, uint8_t size);
+
+  void setCursor(int16_t x, int16_t y) {
+    _cursorX = x;
+    _cursorY = y;
+  }
+  void setTextSize(uint8_t size) {
+    _textSize = size > 0 ? size : 1;
+  }
+  void setTextColor(uint16_t color) {
+    _textColor = color;
+    _textBackground = color;
+  }
+  void setTextColor(uint16_t color, uint16_t background) {
+    _textColor = color;
+    _textBackground = background;
+  }
+  void setTextWrap(bool wrap) {
+    _wrap = wrap;
+  }
+  int16_t getCursorX() const {
+    return _cursorX;
+  }
+  int16_t getCursorY() const {
+    return _cursorY;
+  }
+  int16_t width() const {
+    return _width;
+  }
+  int16_t height() const {
+    return _height;
+  }
+
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+protected:
+  int16_t _width;
+  int16_t _height;
+  int16_t _cursorX = 0;
+  int16_t _cursorY = 0;
+  uint8_t _textSize = 1;
+  uint16_t _textColor = 1;
+  uint16_t _textBackground = 1;  // совпадает с цветом: фон не закрашивается
+  bool _wrap = true;
+};
@@ -0,0 +1,44 @@
+// Adafruit_SSD1306 для сборки на Linux: тот же буфер кадра (страницы по
+// 8 строк) и та же отправка целого кадра по Wire в display().
+#pragma once
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define BLACK SSD1306_BLACK
+#define WHITE SSD1306_WHITE
+#define INVERSE SSD1306_INVERSE
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_EXTERNALVCC 0x01
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+  Adafruit_SSD1306(uint8_t width, uint8_t height, TwoWire* wire, int8_t resetPin = -1);
+  ~Adafruit_SSD1306();
+
+  bool begin(uint8_t vccState = SSD1306_SWITCHCAPVCC, uint8_t address = 0, bool reset = true,
+             bool periphBegin = true);
+  void display();
+  void clearDisplay();
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  bool getPixel(int16_t x, int16_t y) const;
+  uint8_t* getBuffer() {
+    return _buffer;
+  }
+  void dim(bool dim) {
+    (void)dim;
+  }
+  void invertDisplay(bool invert) {
+    (void)invert;
+  }
+
+private:
+  void sendCommand(uint8_t command);
+
+  TwoWire* _wire;
+  uint8_t _address = 0x3C;
+  uint8_t* _buffer = nullptr;
+};
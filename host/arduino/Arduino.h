@@ -0,0 +1,148 @@
+// Ядро Arduino ESP8266 для сборки прошивки на Linux (раздел README о host/).
+//
+// Только то, чем пользуются прошивка и её библиотеки. Время виртуальное:
+// millis()/micros() читают часы хоста, delay() их сдвигает, поэтому loop()
+// никогда не ждёт, а сутки работы проходят за секунды. Управление часами,
+// кучей и выводом Serial из тестов - в host_core.h.
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+
+#define PROGMEM
+#define PGM_P const char*
+#define PGM_VOID_P const void*
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(PSTR(s)))
+#define FPSTR(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+inline uint8_t pgm_read_byte(const void* address) {
+  return *(const uint8_t*)address;
+}
+inline uint16_t pgm_read_word(const void* address) {
+  uint16_t value;
+  memcpy(&value, address, sizeof(value));
+  return value;
+}
+inline uint32_t pgm_read_dword(const void* address) {
+  uint32_t value;
+  memcpy(&value, address, sizeof(value));
+  return value;
+}
+inline void* memcpy_P(void* destination, const void* source, size_t length) {
+  return memcpy(destination, source, length);
+}
+inline size_t strlen_P(const char* text) {
+  return strlen(text);
+}
+inline int strcmp_P(const char* left, const char* right) {
+  return strcmp(left, right);
+}
+inline int strncmp_P(const char* left, const char* right, size_t length) {
+  return strncmp(left, right, length);
+}
+inline char* strncpy_P(char* destination, const char* source, size_t length) {
+  return strncpy(destination, source, length);
+}
+#define snprintf_P snprintf
+#define sprintf_P sprintf
+
+// Время: unsigned long на ESP8266 32-битный, здесь переполняется так же
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int interrupt, void (*handler)(), int mode);
+void detachInterrupt(int interrupt);
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud);
+  size_t write(uint8_t byte) override;
+  size_t write(const uint8_t* data, size_t length) override;
+  int available() override {
+    return 0;
+  }
+  int read() override {
+    return -1;
+  }
+  int peek() override {
+    return -1;
+  }
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  uint32_t getFreeHeap();
+  uint32_t getMaxFreeBlockSize();
+  uint8_t getHeapFragmentation();
+  uint32_t getCycleCount();
+  uint8_t getCpuFreqMHz() {
+    return 80;
+  }
+  uint32_t getChipId() {
+    return 0x00E5A1;
+  }
+  uint32_t random();
+  void restart();
+};
+
+extern EspClass ESP;
+
+class IPAddress : public Printable {
+public:
+  IPAddress() : IPAddress(0, 0, 0, 0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _bytes{a, b, c, d} {}
+
+  String toString() const;
+  size_t printTo(Print& output) const override;
+  uint8_t operator[](int index) const {
+    return _bytes[index];
+  }
+  bool operator==(const IPAddress& other) const {
+    return memcmp(_bytes, other._bytes, sizeof(_bytes)) == 0;
+  }
+
+private:
+  uint8_t _bytes[4];
+};
+
+#include "host_core.h"
@@ -0,0 +1,362 @@
+// ArduinoJson 6 для сборки на Linux: разбор в документ с фиксированной
+// ёмкостью и чтение через JsonVariant/JsonObject/JsonArray.
+//
+// Документ, как в библиотеке, берёт память одним блоком при создании и
+// раскладывает в нём узлы и строки. Ёмкость считается в размерах ESP8266
+// (16 байт на узел, строка с нулём в конце), поэтому NoMemory наступает там
+// же, где на плате. Запись (doc["x"] = ...) прошивке не нужна и не сделана.
+#pragma once
+
+#include <limits>
+#include <type_traits>
+#include "Arduino.h"
+
+#define ARDUINOJSON_DEFAULT_NESTING_LIMIT 10
+#define ARDUINOJSON_SLOT_SIZE 16
+
+class JsonVariant;
+class JsonObject;
+class JsonArray;
+
+namespace ArduinoJson {
+namespace detail {
+
+enum class NodeType : uint8_t {
+  Null,
+  Bool,
+  Integer,
+  Float,
+  String,
+  Array,
+  Object
+};
+
+struct Node {
+  NodeType type;
+  bool boolean;
+  int64_t integer;
+  double real;
+  const char* text;   // строка-значение
+  const char* key;    // ключ, если узел - член объекта
+  Node* child;        // первый элемент массива или член объекта
+  Node* next;
+};
+
+}  // namespace detail
+}  // namespace ArduinoJson
+
+class DeserializationError {
+public:
+  enum Code {
+    Ok,
+    EmptyInput,
+    IncompleteInput,
+    InvalidInput,
+    NoMemory,
+    TooDeep
+  };
+
+  DeserializationError(Code code = Ok) : _code(code) {}
+
+  Code code() const {
+    return _code;
+  }
+  const char* c_str() const;
+  explicit operator bool() const {
+    return _code != Ok;
+  }
+  bool operator==(Code code) const {
+    return _code == code;
+  }
+  bool operator!=(Code code) const {
+    return _code != code;
+  }
+
+private:
+  Code _code;
+};
+
+class JsonVariant {
+public:
+  JsonVariant(const ArduinoJson::detail::Node* node = nullptr) : _node(node) {}
+
+  bool isNull() const {
+    return _node == nullptr || _node->type == ArduinoJson::detail::NodeType::Null;
+  }
+  template <typename T>
+  bool is() const;
+  template <typename T>
+  T as() const;
+  template <typename T>
+  operator T() const {
+    return as<T>();
+  }
+
+  JsonVariant operator[](const char* key) const;
+  JsonVariant operator[](const String& key) const {
+    return (*this)[key.c_str()];
+  }
+  JsonVariant operator[](size_t index) const;
+  JsonVariant operator[](int index) const {
+    return (*this)[(size_t)index];
+  }
+  bool containsKey(const char* key) const;
+  size_t size() const;
+
+  // Значение по умолчанию, если тип не подходит (как в ArduinoJson)
+  const char* operator|(const char* fallback) const;
+  template <typename T>
+  T operator|(const T& fallback) const {
+    return is<T>() ? as<T>() : fallback;
+  }
+
+  const ArduinoJson::detail::Node* node() const {
+    return _node;
+  }
+
+private:
+  const ArduinoJson::detail::Node* _node;
+};
+
+class JsonPair {
+public:
+  explicit JsonPair(const ArduinoJson::detail::Node* node) : _node(node) {}
+  const char* key() const {
+    return _node->key;
+  }
+  JsonVariant value() const {
+    return JsonVariant(_node);
+  }
+
+private:
+  const ArduinoJson::detail::Node* _node;
+};
+
+// Итератор по детям узла; T - что отдаёт разыменование
+template <typename T>
+class JsonIterator {
+public:
+  explicit JsonIterator(const ArduinoJson::detail::Node* node) : _node(node) {}
+  T operator*() const {
+    return T(_node);
+  }
+  JsonIterator& operator++() {
+    _node = _node->next;
+    return *this;
+  }
+  bool operator!=(const JsonIterator& other) const {
+    return _node != other._node;
+  }
+
+private:
+  const ArduinoJson::detail::Node* _node;
+};
+
+class JsonObject {
+public:
+  JsonObject(const ArduinoJson::detail::Node* node = nullptr)
+      : _node(node != nullptr && node->type == ArduinoJson::detail::NodeType::Object ? node : nullptr) {}
+
+  bool isNull() const {
+    return _node == nullptr;
+  }
+  JsonVariant operator[](const char* key) const {
+    return JsonVariant(_node)[key];
+  }
+  JsonVariant operator[](const String& key) const {
+    return JsonVariant(_node)[key.c_str()];
+  }
+  bool containsKey(const char* key) const {
+    return JsonVariant(_node).containsKey(key);
+  }
+  size_t size() const {
+    return JsonVariant(_node).size();
+  }
+  JsonIterator<JsonPair> begin() const {
+    return JsonIterator<JsonPair>(_node != nullptr ? _node->child : nullptr);
+  }
+  JsonIterator<JsonPair> end() const {
+    return JsonIterator<JsonPair>(nullptr);
+  }
+  const ArduinoJson::detail::Node* node() const {
+    return _node;
+  }
+
+private:
+  const ArduinoJson::detail::Node* _node;
+};
+
+class JsonArray {
+public:
+  JsonArray(const ArduinoJson::detail::Node* node = nullptr)
+      : _node(node != nullptr && node->type == ArduinoJson::detail::NodeType::Array ? node : nullptr) {}
+
+  bool isNull() const {
+    return _node == nullptr;
+  }
+  JsonVariant operator[](size_t index) const {
+    return JsonVariant(_node)[index];
+  }
+  size_t size() const {
+    return JsonVariant(_node).size();
+  }
+  JsonIterator<JsonVariant> begin() const {
+    return JsonIterator<JsonVariant>(_node != nullptr ? _node->child : nullptr);
+  }
+  JsonIterator<JsonVariant> end() const {
+    return JsonIterator<JsonVariant>(nullptr);
+  }
+  const ArduinoJson::detail::Node* node() const {
+    return _node;
+  }
+
+private:
+  const ArduinoJson::detail::Node* _node;
+};
+
+class DynamicJsonDocument {
+public:
+  explicit DynamicJsonDocument(size_t capacity);
+  DynamicJsonDocument(const DynamicJsonDocument&) = delete;
+  DynamicJsonDocument& operator=(const DynamicJsonDocument&) = delete;
+  ~DynamicJsonDocument();
+
+  void clear();
+  size_t capacity() const {
+    return _capacity;
+  }
+  size_t memoryUsage() const {
+    return _used;
+  }
+  bool overflowed() const {
+    return _overflowed;
+  }
+
+  bool isNull() const {
+    return JsonVariant(_root).isNull();
+  }
+  template <typename T>
+  T as() const {
+    return JsonVariant(_root).as<T>();
+  }
+  template <typename T>
+  bool is() const {
+    return JsonVariant(_root).is<T>();
+  }
+  JsonVariant operator[](const char* key) const {
+    return JsonVariant(_root)[key];
+  }
+  JsonVariant operator[](size_t index) const {
+    return JsonVariant(_root)[index];
+  }
+  bool containsKey(const char* key) const {
+    return JsonVariant(_root).containsKey(key);
+  }
+  size_t size() const {
+    return JsonVariant(_root).size();
+  }
+
+  // Для разбора: место под узел и копию строки в блоке документа
+  ArduinoJson::detail::Node* newNode();
+  char* newString(const char* text, size_t length);
+  void setRoot(ArduinoJson::detail::Node* root) {
+    _root = root;
+  }
+
+private:
+  void* take(size_t hostBytes, size_t deviceBytes);
+
+  size_t _capacity;
+  size_t _used = 0;       // в байтах ESP8266
+  uint8_t* _pool;
+  size_t _poolSize;
+  size_t _poolUsed = 0;   // в байтах хоста
+  bool _overflowed = false;
+  ArduinoJson::detail::Node* _root = nullptr;
+};
+
+DeserializationError deserializeJson(DynamicJsonDocument& doc, Stream& input);
+DeserializationError deserializeJson(DynamicJsonDocument& doc, const char* input);
+DeserializationError deserializeJson(DynamicJsonDocument& doc, const char* input, size_t length);
+inline DeserializationError deserializeJson(DynamicJsonDocument& doc, const String& input) {
+  return deserializeJson(doc, input.c_str(), input.length());
+}
+
+size_t serializeJson(JsonVariant value, Print& output);
+size_t serializeJson(JsonVariant value, String& output);
+inline size_t serializeJson(const DynamicJsonDocument& doc, Print& output) {
+  return serializeJson(doc.as<JsonVariant>(), output);
+}
+inline size_t serializeJson(const DynamicJsonDocument& doc, String& output) {
+  return serializeJson(doc.as<JsonVariant>(), output);
+}
+
+template <>
+bool JsonVariant::is<bool>() const;
+template <>
+bool JsonVariant::is<float>() const;
+template <>
+bool JsonVariant::is<double>() const;
+template <>
+bool JsonVariant::is<const char*>() const;
+template <>
+bool JsonVariant::is<String>() const;
+template <>
+bool JsonVariant::is<JsonObject>() const;
+template <>
+bool JsonVariant::is<JsonArray>() const;
+template <>
+bool JsonVariant::is<JsonVariant>() const;
+
+template <typename T>
+bool JsonVariant::is() const {
+  // Целые: только целое значение, влезающее в тип
+  static_assert(std::is_integral<T>::value, "unsupported JsonVariant::is<T>()");
+  if (_node == nullptr || _node->type != ArduinoJson::detail::NodeType::Integer) {
+    return false;
+  }
+  int64_t value = _node->integer;
+  if (std::is_signed<T>::value) {
+    return value >= (int64_t)std::numeric_limits<T>::min() && value <= (int64_t)std::numeric_limits<T>::max();
+  }
+  return value >= 0 && (uint64_t)value <= (uint64_t)std::numeric_limits<T>::max();
+}
+
+template <>
+bool JsonVariant::as<bool>() const;
+template <>
+double JsonVariant::as<double>() const;
+template <>
+float JsonVariant::as<float>() const;
+template <>
+const char* JsonVariant::as<const char*>() const;
+template <>
+String JsonVariant::as<String>() const;
+template <>
+JsonObject JsonVariant::as<JsonObject>() const;
+template <>
+JsonArray JsonVariant::as<JsonArray>() const;
+template <>
+JsonVariant JsonVariant::as<JsonVariant>() const;
+
+template <typename T>
+T JsonVariant::as() const {
+  static_assert(std::is_integral<T>::value, "unsupported JsonVariant::as<T>()");
+  if (_node == nullptr) {
+    return 0;
+  }
+  switch (_node->type) {
+    case ArduinoJson::detail::NodeType::Integer:
+      return (T)_node->integer;
+    case ArduinoJson::detail::NodeType::Float:
+      return (T)_node->real;
+    case ArduinoJson::detail::NodeType::Bool:
+      return (T)_node->boolean;
+    default:
+      return 0;
+  }
+}
+
+inline const char* JsonVariant::operator|(const char* fallback) const {
+  return is<const char*>() ? as<const char*>() : fallback;
+}
@@ -0,0 +1,26 @@
+// DNSServer для сборки на Linux: на хосте запросов DNS нет.
+#pragma once
+
+#include "Arduino.h"
+
+enum class DNSReplyCode {
+  NoError = 0,
+  FormError = 1,
+  ServerFailure = 2,
+  NonExistentDomain = 3
+};
+
+class DNSServer {
+public:
+  void setErrorReplyCode(DNSReplyCode code) {
+    (void)code;
+  }
+  bool start(uint16_t port, const String& domain, const IPAddress& ip) {
+    (void)port;
+    (void)domain;
+    (void)ip;
+    return true;
+  }
+  void processNextRequest() {}
+  void stop() {}
+};
@@ -0,0 +1,66 @@
+// ESP8266WiFi для сборки на Linux: точка доступа всегда поднимается.
+#pragma once
+
+#include "Arduino.h"
+
+enum WiFiMode_t {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3
+};
+
+enum wl_status_t {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_DISCONNECTED = 6
+};
+
+class ESP8266WiFiClass {
+public:
+  bool mode(WiFiMode_t mode) {
+    _mode = mode;
+    return true;
+  }
+  bool disconnect(bool wifiOff = false) {
+    (void)wifiOff;
+    return true;
+  }
+  bool softAPConfig(IPAddress localIp, IPAddress gateway, IPAddress subnet) {
+    (void)gateway;
+    (void)subnet;
+    _ip = localIp;
+    return true;
+  }
+  bool softAP(const char* ssid, const char* password = nullptr) {
+    (void)password;
+    _ssid = ssid;
+    return true;
+  }
+  IPAddress softAPIP() const {
+    return _ip;
+  }
+  String softAPSSID() const {
+    return _ssid;
+  }
+  uint8_t softAPgetStationNum() const {
+    return _stations;
+  }
+  wl_status_t status() const {
+    return WL_DISCONNECTED;
+  }
+
+  // Для кода хоста: сколько клиентов подключено к точке доступа
+  void setStationCount(uint8_t stations) {
+    _stations = stations;
+  }
+
+private:
+  WiFiMode_t _mode = WIFI_OFF;
+  IPAddress _ip = IPAddress(192, 168, 4, 1);
+  String _ssid;
+  uint8_t _stations = 1;
+};
+
+extern ESP8266WiFiClass WiFi;
@@ -0,0 +1,4 @@
+// ESPAsyncTCP для сборки на Linux: соединения моделирует ESPAsyncWebServer.h.
+#pragma once
+
+#include "Arduino.h"
@@ -0,0 +1,381 @@
+// ESPAsyncWebServer для сборки на Linux.
+//
+// Сокетов нет: запрос создаёт код хоста (host/http_client.h) и отдаёт
+// серверу через handleRequest(), а тело ответа забирает порциями, как
+// сделал бы AsyncTCP по мере подтверждений клиента. Поэтому отложенные
+// ответы (RequestQueue), заполнение по кускам и отключение клиента до
+// ответа проверяются так же, как на плате. AsyncEventSource - по API
+// ветки 3.x (onDisconnect, packetsWaiting() клиента).
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Arduino.h"
+#include "FS.h"
+
+enum WebRequestMethod : uint8_t {
+  HTTP_GET = 0b00000001,
+  HTTP_POST = 0b00000010,
+  HTTP_DELETE = 0b00000100,
+  HTTP_PUT = 0b00001000,
+  HTTP_PATCH = 0b00010000,
+  HTTP_HEAD = 0b00100000,
+  HTTP_OPTIONS = 0b01000000,
+  HTTP_ANY = 0b01111111
+};
+
+typedef uint8_t WebRequestMethodComposite;
+
+#define RESPONSE_TRY_AGAIN 0xFFFFFFFF
+#define SSE_MAX_QUEUED_MESSAGES 32
+
+class AsyncWebServerRequest;
+class AsyncWebServerResponse;
+class AsyncEventSourceClient;
+
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+typedef std::function<void()> ArDisconnectHandler;
+typedef std::function<size_t(uint8_t*, size_t, size_t)> AwsResponseFiller;
+typedef std::function<String(const String&)> AwsTemplateProcessor;
+typedef std::function<void(AsyncEventSourceClient*)> ArEventHandlerFunction;
+
+class AsyncWebHeader {
+public:
+  AsyncWebHeader(const String& name, const String& value) : _name(name), _value(value) {}
+  const String& name() const {
+    return _name;
+  }
+  const String& value() const {
+    return _value;
+  }
+
+private:
+  String _name;
+  String _value;
+};
+
+class AsyncWebParameter {
+public:
+  AsyncWebParameter(const String& name, const String& value, bool post) : _name(name), _value(value), _post(post) {}
+  const String& name() const {
+    return _name;
+  }
+  const String& value() const {
+    return _value;
+  }
+  bool isPost() const {
+    return _post;
+  }
+
+private:
+  String _name;
+  String _value;
+  bool _post;
+};
+
+class AsyncWebServerResponse {
+public:
+  AsyncWebServerResponse(int code, const String& contentType) : _code(code), _contentType(contentType) {}
+  virtual ~AsyncWebServerResponse() {}
+
+  void setCode(int code) {
+    _code = code;
+  }
+  void setContentLength(size_t length) {
+    _contentLength = length;
+  }
+  void setContentType(const String& type) {
+    _contentType = type;
+  }
+  void addHeader(const String& name, const String& value) {
+    _headers.emplace_back(name, value);
+  }
+
+  // Для кода хоста
+  int code() const {
+    return _code;
+  }
+  const String& contentType() const {
+    return _contentType;
+  }
+  const std::vector<AsyncWebHeader>& headers() const {
+    return _headers;
+  }
+  bool chunked() const {
+    return _chunked;
+  }
+  // Строка состояния и заголовки в том виде, в каком они уйдут клиенту
+  String head() const;
+  // Следующий кусок тела не длиннее maxLength; RESPONSE_TRY_AGAIN - данных
+  // пока нет, 0 - тело закончилось
+  virtual size_t fillBody(uint8_t* buffer, size_t maxLength) = 0;
+  virtual bool sourceValid() const {
+    return true;
+  }
+
+protected:
+  int _code;
+  String _contentType;
+  size_t _contentLength = 0;
+  bool _chunked = false;
+  std::vector<AsyncWebHeader> _headers;
+};
+
+class AsyncBasicResponse : public AsyncWebServerResponse {
+public:
+  AsyncBasicResponse(int code, const String& contentType, const String& content);
+  size_t fillBody(uint8_t* buffer, size_t maxLength) override;
+
+private:
+  String _content;
+  size_t _sent = 0;
+};
+
+class AsyncProgmemResponse : public AsyncWebServerResponse {
+public:
+  AsyncProgmemResponse(int code, const String& contentType, const uint8_t* content, size_t length);
+  size_t fillBody(uint8_t* buffer, size_t maxLength) override;
+
+private:
+  const uint8_t* _content;
+  size_t _sent = 0;
+};
+
+class AsyncFileResponse : public AsyncWebServerResponse {
+public:
+  AsyncFileResponse(FS& fs, const String& path, const String& contentType);
+  size_t fillBody(uint8_t* buffer, size_t maxLength) override;
+  bool sourceValid() const override {
+    return (bool)_file;
+  }
+
+private:
+  File _file;
+};
+
+class AsyncChunkedResponse : public AsyncWebServerResponse {
+public:
+  AsyncChunkedResponse(const String& contentType, AwsResponseFiller filler);
+  size_t fillBody(uint8_t* buffer, size_t maxLength) override;
+
+private:
+  AwsResponseFiller _filler;
+  size_t _index = 0;
+};
+
+class AsyncWebServerRequest {
+public:
+  // Для кода хоста: запрос от клиента; query - "a=1&b=2", form - тело POST
+  AsyncWebServerRequest(WebRequestMethod method, const String& url, const String& query = String(),
+                        const String& form = String());
+  ~AsyncWebServerRequest();
+
+  WebRequestMethodComposite method() const {
+    return _method;
+  }
+  const String& url() const {
+    return _url;
+  }
+
+  bool hasArg(const char* name) const;
+  bool hasArg(const String& name) const {
+    return hasArg(name.c_str());
+  }
+  const String& arg(const char* name) const;
+  const String& arg(const String& name) const {
+    return arg(name.c_str());
+  }
+  size_t args() const {
+    return _params.size();
+  }
+  bool hasParam(const String& name, bool post = false) const;
+  AsyncWebParameter* getParam(const String& name, bool post = false);
+
+  bool hasHeader(const char* name) const;
+  bool hasHeader(const String& name) const {
+    return hasHeader(name.c_str());
+  }
+  AsyncWebHeader* getHeader(const char* name);
+  AsyncWebHeader* getHeader(const String& name) {
+    return getHeader(name.c_str());
+  }
+  const String& header(const char* name) const;
+
+  void onDisconnect(ArDisconnectHandler handler);
+
+  void send(AsyncWebServerResponse* response);
+  void send(int code, const String& contentType = String(), const String& content = String());
+  void redirect(const String& url);
+  AsyncWebServerResponse* beginResponse(int code, const String& contentType = String(),
+                                        const String& content = String());
+  AsyncWebServerResponse* beginResponse(FS& fs, const String& path, const String& contentType = String(),
+                                        bool download = false);
+  AsyncWebServerResponse* beginResponse_P(int code, const String& contentType, const uint8_t* content,
+                                          size_t length, AwsTemplateProcessor callback = nullptr);
+  AsyncWebServerResponse* beginResponse_P(int code, const String& contentType, PGM_P content,
+                                          AwsTemplateProcessor callback = nullptr);
+  AsyncWebServerResponse* beginChunkedResponse(const String& contentType, AwsResponseFiller filler,
+                                               AwsTemplateProcessor callback = nullptr);
+
+  // Для кода хоста
+  void addHeader(const String& name, const String& value) {
+    _headers.emplace_back(name, value);
+  }
+  AsyncWebServerResponse* response() const {
+    return _response.get();
+  }
+  // Клиент закрыл соединение; повторный вызов ничего не делает
+  void disconnect();
+  bool disconnected() const {
+    return _disconnected;
+  }
+  AsyncEventSourceClient* eventClient() const {
+    return _eventClient;
+  }
+  void setEventClient(AsyncEventSourceClient* client) {
+    _eventClient = client;
+  }
+
+private:
+  void parseParams(const String& text, bool post);
+
+  WebRequestMethodComposite _method;
+  String _url;
+  std::vector<AsyncWebParameter> _params;
+  std::vector<AsyncWebHeader> _headers;
+  std::vector<ArDisconnectHandler> _disconnectHandlers;
+  std::unique_ptr<AsyncWebServerResponse> _response;
+  AsyncEventSourceClient* _eventClient = nullptr;
+  bool _disconnected = false;
+};
+
+class AsyncWebHandler {
+public:
+  virtual ~AsyncWebHandler() {}
+  virtual bool canHandle(AsyncWebServerRequest* request) = 0;
+  virtual void handleRequest(AsyncWebServerRequest* request) = 0;
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+public:
+  AsyncCallbackWebHandler(const String& uri, WebRequestMethodComposite method, ArRequestHandlerFunction handler)
+      : _uri(uri), _method(method), _handler(std::move(handler)) {}
+  bool canHandle(AsyncWebServerRequest* request) override;
+  void handleRequest(AsyncWebServerRequest* request) override;
+
+private:
+  String _uri;
+  WebRequestMethodComposite _method;
+  ArRequestHandlerFunction _handler;
+};
+
+class AsyncWebServer {
+public:
+  explicit AsyncWebServer(uint16_t port) : _port(port) {}
+  ~AsyncWebServer();
+
+  void begin() {
+    _started = true;
+  }
+  void end() {
+    _started = false;
+  }
+  AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction handler);
+  AsyncCallbackWebHandler& on(const char* uri, ArRequestHandlerFunction handler) {
+    return on(uri, HTTP_ANY, std::move(handler));
+  }
+  AsyncWebHandler& addHandler(AsyncWebHandler* handler);
+  void onNotFound(ArRequestHandlerFunction handler) {
+    _notFound = std::move(handler);
+  }
+
+  // Для кода хоста: разбор запроса сервером, как по приходу заголовков
+  void handleRequest(AsyncWebServerRequest* request);
+  bool started() const {
+    return _started;
+  }
+
+private:
+  uint16_t _port;
+  bool _started = false;
+  std::vector<AsyncWebHandler*> _handlers;
+  std::vector<std::unique_ptr<AsyncCallbackWebHandler>> _ownedHandlers;
+  ArRequestHandlerFunction _notFound;
+};
+
+class AsyncEventSource;
+
+class AsyncEventSourceClient {
+public:
+  AsyncEventSourceClient(AsyncWebServerRequest* request, AsyncEventSource* source);
+  ~AsyncEventSourceClient();
+
+  void send(const char* message, const char* event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+  void close();
+  bool connected() const {
+    return _request != nullptr;
+  }
+  size_t packetsWaiting() const {
+    return _queue.size();
+  }
+  uint32_t lastId() const {
+    return _lastId;
+  }
+
+  // Для кода хоста: клиент подтвердил до maxMessages сообщений очереди.
+  // Возвращает их текст
+  String drain(size_t maxMessages = SIZE_MAX);
+  // Всё полученное с подключения
+  const String& received() const {
+    return _received;
+  }
+  uint32_t dropped() const {
+    return _dropped;
+  }
+
+private:
+  friend class AsyncEventSource;
+  void detach();
+
+  AsyncWebServerRequest* _request;
+  AsyncEventSource* _source;
+  std::vector<String> _queue;
+  String _received;
+  uint32_t _lastId = 0;
+  uint32_t _dropped = 0;
+};
+
+class AsyncEventSource : public AsyncWebHandler {
+public:
+  explicit AsyncEventSource(const String& url) : _url(url) {}
+  ~AsyncEventSource();
+
+  const char* url() const {
+    return _url.c_str();
+  }
+  void onConnect(ArEventHandlerFunction handler) {
+    _connect = std::move(handler);
+  }
+  void onDisconnect(ArEventHandlerFunction handler) {
+    _disconnect = std::move(handler);
+  }
+  void send(const char* message, const char* event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+  size_t count() const;
+  size_t avgPacketsWaiting() const;
+
+  bool canHandle(AsyncWebServerRequest* request) override;
+  void handleRequest(AsyncWebServerRequest* request) override;
+
+private:
+  friend class AsyncEventSourceClient;
+  void removeClient(AsyncEventSourceClient* client);
+
+  String _url;
+  std::vector<AsyncEventSourceClient*> _clients;
+  ArEventHandlerFunction _connect;
+  ArEventHandlerFunction _disconnect;
+};
+
+// Текст ответа по коду, как в заголовке HTTP
+const char* asyncResponseCodeText(int code);
@@ -0,0 +1,161 @@
+// Файловая система ядра ESP8266 для сборки на Linux: fs::FS поверх каталога
+// хоста (hostFsMount). Ведёт счётчики операций для тестов и умеет
+// "выключать питание" после заданного числа записанных байтов.
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+namespace fs {
+
+enum SeekMode {
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+class FileImpl;
+
+class File : public Stream {
+public:
+  File() = default;
+  explicit File(std::shared_ptr<FileImpl> impl) : _impl(std::move(impl)) {}
+
+  size_t write(uint8_t byte) override;
+  size_t write(const uint8_t* data, size_t length) override;
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush() override;
+  size_t read(uint8_t* buffer, size_t length);
+  size_t readBytes(char* buffer, size_t length) {
+    return read((uint8_t*)buffer, length);
+  }
+  bool seek(uint32_t position, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  bool truncate(uint32_t size);
+  void close();
+  operator bool() const;
+  const char* name() const;
+  const char* fullName() const;
+  bool isFile() const;
+  bool isDirectory() const;
+
+  using Print::write;
+
+private:
+  std::shared_ptr<FileImpl> _impl;
+};
+
+class Dir {
+public:
+  Dir() = default;
+  Dir(std::string root, std::string path, std::vector<std::string> names)
+      : _root(std::move(root)), _path(std::move(path)), _names(std::move(names)) {}
+
+  bool next();
+  String fileName() const;
+  size_t fileSize() const;
+  bool isFile() const;
+  bool isDirectory() const;
+  File openFile(const char* mode) const;
+  bool rewind();
+
+private:
+  std::string _root;
+  std::string _path;
+  std::vector<std::string> _names;
+  size_t _position = 0;  // номер следующей записи; текущая - _position - 1
+};
+
+struct FSInfo {
+  size_t totalBytes;
+  size_t usedBytes;
+  size_t blockSize;
+  size_t pageSize;
+  size_t maxOpenFiles;
+  size_t maxPathLength;
+};
+
+class FS {
+public:
+  bool begin();
+  void end() {}
+  bool format();
+  bool info(FSInfo& info);
+
+  File open(const char* path, const char* mode);
+  File open(const String& path, const char* mode) {
+    return open(path.c_str(), mode);
+  }
+  bool exists(const char* path);
+  bool exists(const String& path) {
+    return exists(path.c_str());
+  }
+  Dir openDir(const char* path);
+  Dir openDir(const String& path) {
+    return openDir(path.c_str());
+  }
+  bool remove(const char* path);
+  bool remove(const String& path) {
+    return remove(path.c_str());
+  }
+  bool rename(const char* from, const char* to);
+  bool rename(const String& from, const String& to) {
+    return rename(from.c_str(), to.c_str());
+  }
+  bool mkdir(const char* path);
+  bool mkdir(const String& path) {
+    return mkdir(path.c_str());
+  }
+  bool rmdir(const char* path);
+  bool rmdir(const String& path) {
+    return rmdir(path.c_str());
+  }
+};
+
+}  // namespace fs
+
+using fs::Dir;
+using fs::File;
+using fs::FS;
+using fs::FSInfo;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
+
+// Счётчики операций с момента монтирования или hostFsResetStats()
+struct HostFsStats {
+  uint32_t opensRead;
+  uint32_t opensWrite;   // "w"
+  uint32_t opensAppend;  // "a"
+  uint32_t opensUpdate;  // "r+", "w+", "a+"
+  uint32_t closes;
+  uint32_t mkdirs;
+  uint32_t removes;
+  uint32_t renames;
+  uint32_t readCalls;
+  uint32_t writeCalls;
+  uint64_t bytesRead;
+  uint64_t bytesWritten;
+  int32_t openHandles;
+};
+
+// Корень файловой системы в каталоге хоста; сбрасывает счётчики и питание
+void hostFsMount(const std::string& root);
+const std::string& hostFsRoot();
+HostFsStats hostFsStats();
+void hostFsResetStats();
+// Объём, который отчитывает info(); занятое считается по файлам каталога
+void hostFsSetCapacity(size_t totalBytes);
+
+// Питание пропадает после budget записанных байтов: каждая операция с
+// метаданными (создание, rename, remove, mkdir, truncate) стоит один байт.
+// После этого любые изменения молча не выполняются, как на обесточенной флеш
+void hostFsCutPowerAfter(uint64_t budget);
+bool hostFsPowerLost();
+void hostFsRestorePower();
@@ -0,0 +1,6 @@
+// LittleFS ядра ESP8266 для сборки на Linux: один экземпляр fs::FS.
+#pragma once
+
+#include "FS.h"
+
+extern fs::FS LittleFS;
@@ -0,0 +1,39 @@
+// Библиотека SparkFun MAX3010x для сборки на Linux: та часть, которой
+// пользуется Max30102Sensor. Настройка идёт теми же записями регистров по
+// Wire, поэтому с моделью датчика на шине (FakeMax30102) код проверяется
+// вместе с разбором FIFO.
+#pragma once
+
+#include "Wire.h"
+
+#define I2C_SPEED_STANDARD 100000
+#define I2C_SPEED_FAST 400000
+#define MAX30105_ADDRESS 0x57
+
+class MAX30105 {
+public:
+  bool begin(TwoWire& wirePort = Wire, uint32_t i2cSpeed = I2C_SPEED_STANDARD, uint8_t address = MAX30105_ADDRESS);
+  void setup(uint8_t powerLevel = 0x1F, uint8_t sampleAverage = 4, uint8_t ledMode = 3, int sampleRate = 400,
+             int pulseWidth = 411, int adcRange = 4096);
+
+  void softReset();
+  void setPulseAmplitudeRed(uint8_t value);
+  void setPulseAmplitudeIR(uint8_t value);
+  void setPulseAmplitudeGreen(uint8_t value);
+  void setFIFOAlmostFull(uint8_t samples);
+  void enableAFULL();
+  void disableAFULL();
+  void enableFIFORollover();
+  void clearFIFO();
+  uint8_t getINT1();
+  uint8_t readPartID();
+
+  uint8_t readRegister8(uint8_t reg);
+  void writeRegister8(uint8_t reg, uint8_t value);
+
+private:
+  void bitMask(uint8_t reg, uint8_t mask, uint8_t value);
+
+  TwoWire* _wire = nullptr;
+  uint8_t _address = MAX30105_ADDRESS;
+};
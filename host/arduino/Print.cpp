@@ -0,0 +1,107 @@
+#include "Print.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+size_t Print::write(const uint8_t* data, size_t length) {
+  size_t written = 0;
+  while (written < length && write(data[written]) == 1) {
+    written++;
+  }
+  return written;
+}
+
+size_t Print::write(const char* text) {
+  return text != nullptr ? write((const uint8_t*)text, strlen(text)) : 0;
+}
+
+size_t Print::print(const __FlashStringHelper* text) {
+  return write(reinterpret_cast<const char*>(text));
+}
+
+size_t Print::print(const String& text) {
+  return write((const uint8_t*)text.c_str(), text.length());
+}
+
+size_t Print::print(const char* text) {
+  return write(text);
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char value, int base) {
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(int value, int base) {
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned int value, int base) {
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(long value, int base) {
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long value, int base) {
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(long long value, int base) {
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long long value, int base) {
+  return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(double value, int decimals) {
+  return print(String(value, (unsigned char)decimals));
+}
+
+size_t Print::print(const Printable& value) {
+  return value.printTo(*this);
+}
+
+size_t Print::println() {
+  return write((const uint8_t*)"\r\n", 2);
+}
+
+static size_t printFormatted(Print& output, const char* format, va_list args) {
+  char small[128];
+  va_list copy;
+  va_copy(copy, args);
+  int length = vsnprintf(small, sizeof(small), format, copy);
+  va_end(copy);
+  if (length < 0) {
+    return 0;
+  }
+  if ((size_t)length < sizeof(small)) {
+    return output.write((const uint8_t*)small, length);
+  }
+  std::vector<char> large(length + 1);
+  vsnprintf(large.data(), large.size(), format, args);
+  return output.write((const uint8_t*)large.data(), length);
+}
+
+size_t Print::printf(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  size_t length = printFormatted(*this, format, args);
+  va_end(args);
+  return length;
+}
+
+size_t Print::printf_P(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  size_t length = printFormatted(*this, format, args);
+  va_end(args);
+  return length;
+}
@@ -0,0 +1,61 @@
+// Print и Printable ядра Arduino для сборки на Linux.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print;
+
+class Printable {
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print& output) const = 0;
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+
+  virtual size_t write(uint8_t byte) = 0;
+  virtual size_t write(const uint8_t* data, size_t length);
+  size_t write(const char* text);
+  size_t write(const char* data, size_t length) {
+    return write((const uint8_t*)data, length);
+  }
+  virtual void flush() {}
+
+  size_t print(const __FlashStringHelper* text);
+  size_t print(const String& text);
+  size_t print(const char* text);
+  size_t print(char c);
+  size_t print(unsigned char value, int base = DEC);
+  size_t print(int value, int base = DEC);
+  size_t print(unsigned int value, int base = DEC);
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(long long value, int base = DEC);
+  size_t print(unsigned long long value, int base = DEC);
+  size_t print(double value, int decimals = 2);
+  size_t print(const Printable& value);
+
+  template <typename T>
+  size_t println(const T& value) {
+    size_t length = print(value);
+    return length + println();
+  }
+  template <typename T>
+  size_t println(const T& value, int format) {
+    size_t length = print(value, format);
+    return length + println();
+  }
+  size_t println();
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  size_t printf_P(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
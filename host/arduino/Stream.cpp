@@ -0,0 +1,105 @@
+#include "Stream.h"
+
+#include <string.h>
+
+// Продвигает совпадение с образцом на символ c; true - образец найден целиком
+static bool advanceMatch(const char* pattern, size_t length, size_t& matched, char c) {
+  if (length == 0) {
+    return false;
+  }
+  if (c == pattern[matched]) {
+    return ++matched == length;
+  }
+  // Упрощённый откат, как в ядре Arduino: символ может начать новое совпадение
+  matched = c == pattern[0] ? 1 : 0;
+  return matched == length;
+}
+
+bool Stream::find(const char* target) {
+  return findUntil(target, nullptr);
+}
+
+bool Stream::find(const char* target, size_t length) {
+  size_t matched = 0;
+  int c;
+  while ((c = read()) >= 0) {
+    if (advanceMatch(target, length, matched, (char)c)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Stream::findUntil(const char* target, const char* terminator) {
+  size_t targetLength = strlen(target);
+  size_t terminatorLength = terminator != nullptr ? strlen(terminator) : 0;
+  if (targetLength == 0) {
+    return true;
+  }
+  size_t targetMatched = 0;
+  size_t terminatorMatched = 0;
+  int c;
+  while ((c = read()) >= 0) {
+    if (advanceMatch(target, targetLength, targetMatched, (char)c)) {
+      return true;
+    }
+    if (advanceMatch(terminator, terminatorLength, terminatorMatched, (char)c)) {
+      return false;
+    }
+  }
+  return false;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  int c;
+  while (count < length && (c = read()) >= 0) {
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+  size_t count = 0;
+  int c;
+  while (count < length && (c = read()) >= 0 && c != terminator) {
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+String Stream::readString() {
+  String text;
+  int c;
+  while ((c = read()) >= 0) {
+    text += (char)c;
+  }
+  return text;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String text;
+  int c;
+  while ((c = read()) >= 0 && c != terminator) {
+    text += (char)c;
+  }
+  return text;
+}
+
+long Stream::parseInt() {
+  int c;
+  while ((c = peek()) >= 0 && c != '-' && (c < '0' || c > '9')) {
+    read();
+  }
+  bool negative = false;
+  long value = 0;
+  if (peek() == '-') {
+    negative = true;
+    read();
+  }
+  while ((c = peek()) >= '0' && c <= '9') {
+    value = value * 10 + (c - '0');
+    read();
+  }
+  return negative ? -value : value;
+}
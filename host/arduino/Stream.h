@@ -0,0 +1,36 @@
+// Stream ядра Arduino для сборки на Linux. Таймаут не ждёт: на хосте
+// все данные потока уже на месте, поэтому пустой поток - это конец данных.
+#pragma once
+
+#include "Print.h"
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) {
+    _timeout = timeout;
+  }
+  unsigned long getTimeout() const {
+    return _timeout;
+  }
+
+  bool find(const char* target);
+  bool find(const char* target, size_t length);
+  bool findUntil(const char* target, const char* terminator);
+  size_t readBytes(char* buffer, size_t length);
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    return readBytes((char*)buffer, length);
+  }
+  size_t readBytesUntil(char terminator, char* buffer, size_t length);
+  String readString();
+  String readStringUntil(char terminator);
+  long parseInt();
+
+  using Print::write;
+
+protected:
+  unsigned long _timeout = 1000;
+};
@@ -0,0 +1,31 @@
+// StreamString ядра ESP8266 для сборки на Linux: запись в конец, чтение с начала.
+#pragma once
+
+#include "Arduino.h"
+
+class StreamString : public String, public Stream {
+public:
+  size_t write(uint8_t byte) override {
+    concat((char)byte);
+    return 1;
+  }
+  size_t write(const uint8_t* data, size_t length) override {
+    concat((const char*)data, (unsigned int)length);
+    return length;
+  }
+  int available() override {
+    return (int)length();
+  }
+  int read() override {
+    if (length() == 0) {
+      return -1;
+    }
+    char c = charAt(0);
+    remove(0, 1);
+    return (uint8_t)c;
+  }
+  int peek() override {
+    return length() > 0 ? (uint8_t)charAt(0) : -1;
+  }
+  using Print::write;
+};
@@ -0,0 +1,364 @@
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static std::string formatUnsigned(unsigned long long value, unsigned char base) {
+  if (base < 2 || base > 36) {
+    base = 10;
+  }
+  std::string digits;
+  do {
+    unsigned digit = value % base;
+    digits.insert(digits.begin(), digit < 10 ? '0' + digit : 'a' + digit - 10);
+    value /= base;
+  } while (value > 0);
+  return digits;
+}
+
+static std::string formatSigned(long long value, unsigned char base) {
+  if (value < 0 && base == 10) {
+    return "-" + formatUnsigned(0ULL - (unsigned long long)value, base);
+  }
+  // Как в ядре ESP8266: отрицательные в других системах - дополнительный код
+  return formatUnsigned((unsigned long long)value, base);
+}
+
+static std::string formatDouble(double value, unsigned char decimals) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+  return buffer;
+}
+
+String::String(const char* text) : _text(text != nullptr ? text : "") {
+}
+
+String::String(const char* text, size_t length) : _text(text, length) {
+}
+
+String::String(const __FlashStringHelper* text) : String(reinterpret_cast<const char*>(text)) {
+}
+
+String::String(char c) : _text(1, c) {
+}
+
+String::String(unsigned char value, unsigned char base) : _text(formatUnsigned(value, base)) {
+}
+
+String::String(int value, unsigned char base) : _text(formatSigned(value, base)) {
+}
+
+String::String(unsigned int value, unsigned char base) : _text(formatUnsigned(value, base)) {
+}
+
+String::String(long value, unsigned char base) : _text(formatSigned(value, base)) {
+}
+
+String::String(unsigned long value, unsigned char base) : _text(formatUnsigned(value, base)) {
+}
+
+String::String(long long value, unsigned char base) : _text(formatSigned(value, base)) {
+}
+
+String::String(unsigned long long value, unsigned char base) : _text(formatUnsigned(value, base)) {
+}
+
+String::String(float value, unsigned char decimals) : _text(formatDouble(value, decimals)) {
+}
+
+String::String(double value, unsigned char decimals) : _text(formatDouble(value, decimals)) {
+}
+
+String& String::operator=(const char* text) {
+  _text = text != nullptr ? text : "";
+  return *this;
+}
+
+bool String::reserve(unsigned int size) {
+  _text.reserve(size);
+  return true;
+}
+
+bool String::concat(const String& text) {
+  _text += text._text;
+  return true;
+}
+
+bool String::concat(const char* text) {
+  if (text == nullptr) {
+    return false;
+  }
+  _text += text;
+  return true;
+}
+
+bool String::concat(const char* text, unsigned int length) {
+  if (text == nullptr) {
+    return false;
+  }
+  _text.append(text, length);
+  return true;
+}
+
+bool String::concat(char c) {
+  _text += c;
+  return true;
+}
+
+bool String::concat(int value) {
+  return concat(String(value));
+}
+
+bool String::concat(unsigned int value) {
+  return concat(String(value));
+}
+
+bool String::concat(long value) {
+  return concat(String(value));
+}
+
+bool String::concat(unsigned long value) {
+  return concat(String(value));
+}
+
+bool String::concat(long long value) {
+  return concat(String(value));
+}
+
+bool String::concat(unsigned long long value) {
+  return concat(String(value));
+}
+
+bool String::concat(double value) {
+  return concat(String(value));
+}
+
+bool String::equals(const String& other) const {
+  return _text == other._text;
+}
+
+bool String::equals(const char* text) const {
+  return _text == (text != nullptr ? text : "");
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+  if (_text.size() != other._text.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < _text.size(); i++) {
+    if (tolower((unsigned char)_text[i]) != tolower((unsigned char)other._text[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool String::startsWith(const String& prefix) const {
+  return _text.compare(0, prefix._text.size(), prefix._text) == 0;
+}
+
+bool String::startsWith(const char* prefix) const {
+  return startsWith(String(prefix));
+}
+
+bool String::endsWith(const String& suffix) const {
+  return _text.size() >= suffix._text.size() &&
+         _text.compare(_text.size() - suffix._text.size(), suffix._text.size(), suffix._text) == 0;
+}
+
+bool String::endsWith(const char* suffix) const {
+  return endsWith(String(suffix));
+}
+
+char String::charAt(unsigned int index) const {
+  return index < _text.size() ? _text[index] : '\0';
+}
+
+void String::setCharAt(unsigned int index, char c) {
+  if (index < _text.size()) {
+    _text[index] = c;
+  }
+}
+
+char String::operator[](unsigned int index) const {
+  return charAt(index);
+}
+
+char& String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= _text.size()) {
+    dummy = '\0';
+    return dummy;
+  }
+  return _text[index];
+}
+
+void String::toCharArray(char* buffer, unsigned int size, unsigned int index) const {
+  getBytes((unsigned char*)buffer, size, index);
+}
+
+void String::getBytes(unsigned char* buffer, unsigned int size, unsigned int index) const {
+  if (size == 0 || buffer == nullptr) {
+    return;
+  }
+  if (index >= _text.size()) {
+    buffer[0] = '\0';
+    return;
+  }
+  size_t count = _text.size() - index;
+  if (count > size - 1) {
+    count = size - 1;
+  }
+  memcpy(buffer, _text.data() + index, count);
+  buffer[count] = '\0';
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  size_t position = _text.find(c, from);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::indexOf(const char* text, unsigned int from) const {
+  size_t position = _text.find(text, from);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::indexOf(const String& text, unsigned int from) const {
+  return indexOf(text.c_str(), from);
+}
+
+int String::lastIndexOf(char c) const {
+  size_t position = _text.rfind(c);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(const char* text) const {
+  size_t position = _text.rfind(text);
+  return position == std::string::npos ? -1 : (int)position;
+}
+
+String String::substring(unsigned int from) const {
+  return substring(from, length());
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) {
+    unsigned int swap = from;
+    from = to;
+    to = swap;
+  }
+  if (from >= _text.size()) {
+    return String();
+  }
+  if (to > _text.size()) {
+    to = _text.size();
+  }
+  return String(_text.data() + from, to - from);
+}
+
+void String::replace(const String& find, const String& replacement) {
+  if (find._text.empty()) {
+    return;
+  }
+  size_t position = 0;
+  while ((position = _text.find(find._text, position)) != std::string::npos) {
+    _text.replace(position, find._text.size(), replacement._text);
+    position += replacement._text.size();
+  }
+}
+
+void String::remove(unsigned int index) {
+  if (index < _text.size()) {
+    _text.erase(index);
+  }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index < _text.size()) {
+    _text.erase(index, count);
+  }
+}
+
+void String::toLowerCase() {
+  for (char& c : _text) {
+    c = tolower((unsigned char)c);
+  }
+}
+
+void String::toUpperCase() {
+  for (char& c : _text) {
+    c = toupper((unsigned char)c);
+  }
+}
+
+void String::trim() {
+  size_t first = _text.find_first_not_of(" \t\r\n\f\v");
+  if (first == std::string::npos) {
+    _text.clear();
+    return;
+  }
+  size_t last = _text.find_last_not_of(" \t\r\n\f\v");
+  _text = _text.substr(first, last - first + 1);
+}
+
+long String::toInt() const {
+  return atol(_text.c_str());
+}
+
+float String::toFloat() const {
+  return (float)atof(_text.c_str());
+}
+
+double String::toDouble() const {
+  return atof(_text.c_str());
+}
+
+String operator+(const String& left, const String& right) {
+  String result(left);
+  result.concat(right);
+  return result;
+}
+
+String operator+(const String& left, const char* right) {
+  String result(left);
+  result.concat(right);
+  return result;
+}
+
+String operator+(const char* left, const String& right) {
+  String result(left);
+  result.concat(right);
+  return result;
+}
+
+String operator+(const String& left, char right) {
+  String result(left);
+  result.concat(right);
+  return result;
+}
+
+String operator+(const String& left, int right) {
+  String result(left);
+  result.concat(right);
+  return result;
+}
+
+String operator+(const String& left, unsigned int right) {
+  String result(left);
+  result.concat(right);
+  return result;
+}
+
+String operator+(const String& left, long right) {
+  String result(left);
+  result.concat(right);
+  return result;
+}
+
+String operator+(const String& left, unsigned long right) {
+  String result(left);
+  result.concat(right);
+  return result;
+}
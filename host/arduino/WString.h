@@ -0,0 +1,133 @@
+// String из ядра ESP8266 для сборки на Linux: те же методы поверх std::string.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class __FlashStringHelper;
+
+class String {
+public:
+  String(const char* text = "");
+  String(const char* text, size_t length);
+  String(const String& other) = default;
+  String(String&& other) = default;
+  String(const __FlashStringHelper* text);
+  explicit String(char c);
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(long long value, unsigned char base = 10);
+  explicit String(unsigned long long value, unsigned char base = 10);
+  explicit String(float value, unsigned char decimals = 2);
+  explicit String(double value, unsigned char decimals = 2);
+
+  String& operator=(const String& other) = default;
+  String& operator=(String&& other) = default;
+  String& operator=(const char* text);
+
+  bool reserve(unsigned int size);
+  unsigned int length() const {
+    return (unsigned int)_text.size();
+  }
+  bool isEmpty() const {
+    return _text.empty();
+  }
+  const char* c_str() const {
+    return _text.c_str();
+  }
+  char* begin() {
+    return &_text[0];
+  }
+  char* end() {
+    return &_text[0] + _text.size();
+  }
+
+  bool concat(const String& text);
+  bool concat(const char* text);
+  bool concat(const char* text, unsigned int length);
+  bool concat(char c);
+  bool concat(int value);
+  bool concat(unsigned int value);
+  bool concat(long value);
+  bool concat(unsigned long value);
+  bool concat(long long value);
+  bool concat(unsigned long long value);
+  bool concat(double value);
+
+  template <typename T>
+  String& operator+=(const T& value) {
+    concat(value);
+    return *this;
+  }
+
+  bool equals(const String& other) const;
+  bool equals(const char* text) const;
+  bool equalsIgnoreCase(const String& other) const;
+  bool operator==(const String& other) const {
+    return equals(other);
+  }
+  bool operator==(const char* text) const {
+    return equals(text);
+  }
+  bool operator!=(const String& other) const {
+    return !equals(other);
+  }
+  bool operator!=(const char* text) const {
+    return !equals(text);
+  }
+  bool operator<(const String& other) const {
+    return _text < other._text;
+  }
+
+  bool startsWith(const String& prefix) const;
+  bool startsWith(const char* prefix) const;
+  bool endsWith(const String& suffix) const;
+  bool endsWith(const char* suffix) const;
+
+  char charAt(unsigned int index) const;
+  void setCharAt(unsigned int index, char c);
+  char operator[](unsigned int index) const;
+  char& operator[](unsigned int index);
+  void toCharArray(char* buffer, unsigned int size, unsigned int index = 0) const;
+  void getBytes(unsigned char* buffer, unsigned int size, unsigned int index = 0) const;
+
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const char* text, unsigned int from = 0) const;
+  int indexOf(const String& text, unsigned int from = 0) const;
+  int lastIndexOf(char c) const;
+  int lastIndexOf(const char* text) const;
+  String substring(unsigned int from) const;
+  String substring(unsigned int from, unsigned int to) const;
+
+  void replace(const String& find, const String& replacement);
+  void remove(unsigned int index);
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long toInt() const;
+  float toFloat() const;
+  double toDouble() const;
+
+  // Для кода хоста (тесты, симуляция)
+  const std::string& str() const {
+    return _text;
+  }
+
+private:
+  std::string _text;
+};
+
+String operator+(const String& left, const String& right);
+String operator+(const String& left, const char* right);
+String operator+(const char* left, const String& right);
+String operator+(const String& left, char right);
+String operator+(const String& left, int right);
+String operator+(const String& left, unsigned int right);
+String operator+(const String& left, long right);
+String operator+(const String& left, unsigned long right);
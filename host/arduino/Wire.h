@@ -0,0 +1,79 @@
+// TwoWire ядра ESP8266 для сборки на Linux. Вместо шины - реестр моделей
+// устройств (I2cDevice) по адресам; без устройства транзакция получает NACK.
+#pragma once
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 128
+
+class I2cDevice {
+public:
+  virtual ~I2cDevice() {}
+  // Запись ведущего: байты после адреса одной транзакции
+  virtual void i2cWrite(const uint8_t* data, size_t length) = 0;
+  // Чтение ведущего: устройство заполняет до length байт
+  virtual size_t i2cRead(uint8_t* data, size_t length) = 0;
+};
+
+// Трафик по адресу с момента hostWireResetStats()
+struct HostWireStats {
+  uint32_t writeTransactions;
+  uint32_t readTransactions;
+  uint64_t bytesWritten;
+  uint64_t bytesRead;
+};
+
+class TwoWire : public Stream {
+public:
+  void begin() {}
+  void begin(int sda, int scl) {
+    (void)sda;
+    (void)scl;
+  }
+  void setClock(uint32_t frequency) {
+    _clock = frequency;
+  }
+
+  void beginTransmission(uint8_t address);
+  void beginTransmission(int address) {
+    beginTransmission((uint8_t)address);
+  }
+  uint8_t endTransmission(bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, size_t length, bool sendStop = true);
+  uint8_t requestFrom(int address, int length) {
+    return requestFrom((uint8_t)address, (size_t)length);
+  }
+
+  size_t write(uint8_t byte) override;
+  size_t write(const uint8_t* data, size_t length) override;
+  size_t write(int value) {
+    return write((uint8_t)value);
+  }
+  size_t write(unsigned int value) {
+    return write((uint8_t)value);
+  }
+  int available() override;
+  int read() override;
+  int peek() override;
+  using Print::write;
+
+  // Для кода хоста
+  void attach(uint8_t address, I2cDevice* device);
+  void detach(uint8_t address);
+  HostWireStats stats(uint8_t address) const;
+  void resetStats();
+
+private:
+  I2cDevice* _devices[128] = {};
+  HostWireStats _stats[128] = {};
+  uint8_t _address = 0;
+  uint8_t _txBuffer[BUFFER_LENGTH];
+  size_t _txLength = 0;
+  bool _txOverflow = false;
+  uint8_t _rxBuffer[BUFFER_LENGTH];
+  size_t _rxLength = 0;
+  size_t _rxIndex = 0;
+  uint32_t _clock = 100000;
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,577 @@
+#include "ArduinoJson.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <string>
+
+using ArduinoJson::detail::Node;
+using ArduinoJson::detail::NodeType;
+
+namespace {
+
+// Узел хоста крупнее слота ESP8266; блок документа берётся с запасом
+const size_t HOST_POOL_FACTOR = (sizeof(Node) + ARDUINOJSON_SLOT_SIZE - 1) / ARDUINOJSON_SLOT_SIZE + 1;
+
+// Источник символов с заглядыванием на один вперёд без лишнего чтения:
+// поток после разбора стоит ровно за значением
+class Reader {
+public:
+  explicit Reader(Stream* stream) : _stream(stream) {}
+  Reader(const char* text, size_t length) : _text(text), _end(text + length) {}
+
+  int peek() {
+    if (_stream != nullptr) {
+      return _stream->peek();
+    }
+    return _text < _end ? (uint8_t)*_text : -1;
+  }
+
+  int read() {
+    if (_stream != nullptr) {
+      return _stream->read();
+    }
+    return _text < _end ? (uint8_t)*_text++ : -1;
+  }
+
+private:
+  Stream* _stream = nullptr;
+  const char* _text = nullptr;
+  const char* _end = nullptr;
+};
+
+class Parser {
+public:
+  Parser(DynamicJsonDocument& doc, Reader& reader) : _doc(doc), _reader(reader) {}
+
+  DeserializationError parse() {
+    skipSpace();
+    if (_reader.peek() < 0) {
+      return DeserializationError::EmptyInput;
+    }
+    Node* root = nullptr;
+    DeserializationError error = parseValue(root, 0);
+    if (!error) {
+      _doc.setRoot(root);
+    }
+    return error;
+  }
+
+private:
+  void skipSpace() {
+    int c;
+    while ((c = _reader.peek()) == ' ' || c == '\n' || c == '\r' || c == '\t') {
+      _reader.read();
+    }
+  }
+
+  DeserializationError parseValue(Node*& node, int depth) {
+    node = _doc.newNode();
+    if (node == nullptr) {
+      return DeserializationError::NoMemory;
+    }
+    int c = _reader.peek();
+    if (c < 0) {
+      return DeserializationError::IncompleteInput;
+    }
+    if (c == '{' || c == '[') {
+      if (depth >= ARDUINOJSON_DEFAULT_NESTING_LIMIT) {
+        return DeserializationError::TooDeep;
+      }
+      return c == '{' ? parseObject(node, depth + 1) : parseArray(node, depth + 1);
+    }
+    if (c == '"' || c == '\'') {
+      node->type = NodeType::String;
+      return parseString(node->text);
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      return parseNumber(node);
+    }
+    return parseLiteral(node);
+  }
+
+  DeserializationError parseObject(Node* node, int depth) {
+    node->type = NodeType::Object;
+    _reader.read();
+    skipSpace();
+    if (_reader.peek() == '}') {
+      _reader.read();
+      return DeserializationError::Ok;
+    }
+    Node** tail = &node->child;
+    while (true) {
+      skipSpace();
+      int c = _reader.peek();
+      if (c < 0) {
+        return DeserializationError::IncompleteInput;
+      }
+      if (c != '"' && c != '\'') {
+        return DeserializationError::InvalidInput;
+      }
+      const char* key = nullptr;
+      DeserializationError error = parseString(key);
+      if (error) {
+        return error;
+      }
+      skipSpace();
+      c = _reader.read();
+      if (c != ':') {
+        return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+      }
+      skipSpace();
+      Node* member = nullptr;
+      error = parseValue(member, depth);
+      if (error) {
+        return error;
+      }
+      member->key = key;
+      *tail = member;
+      tail = &member->next;
+      skipSpace();
+      c = _reader.read();
+      if (c == '}') {
+        return DeserializationError::Ok;
+      }
+      if (c != ',') {
+        return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+      }
+    }
+  }
+
+  DeserializationError parseArray(Node* node, int depth) {
+    node->type = NodeType::Array;
+    _reader.read();
+    skipSpace();
+    if (_reader.peek() == ']') {
+      _reader.read();
+      return DeserializationError::Ok;
+    }
+    Node** tail = &node->child;
+    while (true) {
+      skipSpace();
+      Node* element = nullptr;
+      DeserializationError error = parseValue(element, depth);
+      if (error) {
+        return error;
+      }
+      *tail = element;
+      tail = &element->next;
+      skipSpace();
+      int c = _reader.read();
+      if (c == ']') {
+        return DeserializationError::Ok;
+      }
+      if (c != ',') {
+        return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+      }
+    }
+  }
+
+  static void appendUtf8(std::string& text, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+      text += (char)codepoint;
+    } else if (codepoint < 0x800) {
+      text += (char)(0xC0 | (codepoint >> 6));
+      text += (char)(0x80 | (codepoint & 0x3F));
+    } else {
+      text += (char)(0xE0 | (codepoint >> 12));
+      text += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+      text += (char)(0x80 | (codepoint & 0x3F));
+    }
+  }
+
+  DeserializationError parseString(const char*& result) {
+    int quote = _reader.read();
+    _scratch.clear();
+    while (true) {
+      int c = _reader.read();
+      if (c < 0) {
+        return DeserializationError::IncompleteInput;
+      }
+      if (c == quote) {
+        break;
+      }
+      if (c != '\\') {
+        _scratch += (char)c;
+        continue;
+      }
+      c = _reader.read();
+      switch (c) {
+        case 'b': _scratch += '\b'; break;
+        case 'f': _scratch += '\f'; break;
+        case 'n': _scratch += '\n'; break;
+        case 'r': _scratch += '\r'; break;
+        case 't': _scratch += '\t'; break;
+        case 'u': {
+          uint32_t codepoint = 0;
+          for (int i = 0; i < 4; i++) {
+            int digit = _reader.read();
+            if (digit < 0) {
+              return DeserializationError::IncompleteInput;
+            }
+            if (!isxdigit(digit)) {
+              return DeserializationError::InvalidInput;
+            }
+            codepoint = codepoint * 16 + (isdigit(digit) ? digit - '0' : (tolower(digit) - 'a' + 10));
+          }
+          appendUtf8(_scratch, codepoint);
+          break;
+        }
+        case -1:
+          return DeserializationError::IncompleteInput;
+        default:
+          _scratch += (char)c;
+          break;
+      }
+    }
+    result = _doc.newString(_scratch.data(), _scratch.size());
+    return result != nullptr ? DeserializationError::Ok : DeserializationError::NoMemory;
+  }
+
+  DeserializationError parseNumber(Node* node) {
+    _scratch.clear();
+    int c;
+    while ((c = _reader.peek()) >= 0 && (isdigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+      _scratch += (char)_reader.read();
+    }
+    char* end = nullptr;
+    bool integer = _scratch.find_first_of(".eE") == std::string::npos;
+    if (integer) {
+      errno = 0;
+      long long value = strtoll(_scratch.c_str(), &end, 10);
+      if (errno == 0 && *end == '\0') {
+        node->type = NodeType::Integer;
+        node->integer = value;
+        return DeserializationError::Ok;
+      }
+    }
+    double value = strtod(_scratch.c_str(), &end);
+    if (end == _scratch.c_str() || *end != '\0') {
+      return DeserializationError::InvalidInput;
+    }
+    node->type = NodeType::Float;
+    node->real = value;
+    return DeserializationError::Ok;
+  }
+
+  DeserializationError parseLiteral(Node* node) {
+    static const char* const literals[] = {"true", "false", "null"};
+    int c = _reader.peek();
+    for (const char* literal : literals) {
+      if (c != literal[0]) {
+        continue;
+      }
+      for (const char* expected = literal; *expected != '\0'; expected++) {
+        int actual = _reader.read();
+        if (actual < 0) {
+          return DeserializationError::IncompleteInput;
+        }
+        if (actual != *expected) {
+          return DeserializationError::InvalidInput;
+        }
+      }
+      node->type = literal[0] == 'n' ? NodeType::Null : NodeType::Bool;
+      node->boolean = literal[0] == 't';
+      return DeserializationError::Ok;
+    }
+    return DeserializationError::InvalidInput;
+  }
+
+  DynamicJsonDocument& _doc;
+  Reader& _reader;
+  std::string _scratch;
+};
+
+size_t writeEscaped(Print& output, const char* text) {
+  size_t length = output.print('"');
+  for (const char* c = text; *c != '\0'; c++) {
+    switch (*c) {
+      case '"': length += output.print("\\\""); break;
+      case '\\': length += output.print("\\\\"); break;
+      case '\n': length += output.print("\\n"); break;
+      case '\r': length += output.print("\\r"); break;
+      case '\t': length += output.print("\\t"); break;
+      default: length += output.print(*c); break;
+    }
+  }
+  return length + output.print('"');
+}
+
+size_t writeNode(Print& output, const Node* node) {
+  if (node == nullptr) {
+    return output.print("null");
+  }
+  switch (node->type) {
+    case NodeType::Null:
+      return output.print("null");
+    case NodeType::Bool:
+      return output.print(node->boolean ? "true" : "false");
+    case NodeType::Integer:
+      return output.print((long long)node->integer);
+    case NodeType::Float: {
+      char text[32];
+      snprintf(text, sizeof(text), "%.9g", node->real);
+      return output.print(text);
+    }
+    case NodeType::String:
+      return writeEscaped(output, node->text);
+    case NodeType::Array:
+    case NodeType::Object: {
+      bool object = node->type == NodeType::Object;
+      size_t length = output.print(object ? '{' : '[');
+      for (const Node* child = node->child; child != nullptr; child = child->next) {
+        if (child != node->child) {
+          length += output.print(',');
+        }
+        if (object) {
+          length += writeEscaped(output, child->key);
+          length += output.print(':');
+        }
+        length += writeNode(output, child);
+      }
+      return length + output.print(object ? '}' : ']');
+    }
+  }
+  return 0;
+}
+
+class StringPrint : public Print {
+public:
+  explicit StringPrint(String& text) : _text(text) {}
+  size_t write(uint8_t c) override {
+    _text.concat((char)c);
+    return 1;
+  }
+  using Print::write;
+
+private:
+  String& _text;
+};
+
+}  // namespace
+
+const char* DeserializationError::c_str() const {
+  static const char* const names[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+  return names[_code];
+}
+
+JsonVariant JsonVariant::operator[](const char* key) const {
+  if (_node == nullptr || _node->type != NodeType::Object || key == nullptr) {
+    return JsonVariant();
+  }
+  for (const Node* child = _node->child; child != nullptr; child = child->next) {
+    if (strcmp(child->key, key) == 0) {
+      return JsonVariant(child);
+    }
+  }
+  return JsonVariant();
+}
+
+JsonVariant JsonVariant::operator[](size_t index) const {
+  if (_node == nullptr || _node->type != NodeType::Array) {
+    return JsonVariant();
+  }
+  const Node* child = _node->child;
+  while (child != nullptr && index-- > 0) {
+    child = child->next;
+  }
+  return JsonVariant(child);
+}
+
+bool JsonVariant::containsKey(const char* key) const {
+  return (*this)[key].node() != nullptr;
+}
+
+size_t JsonVariant::size() const {
+  if (_node == nullptr || (_node->type != NodeType::Array && _node->type != NodeType::Object)) {
+    return 0;
+  }
+  size_t count = 0;
+  for (const Node* child = _node->child; child != nullptr; child = child->next) {
+    count++;
+  }
+  return count;
+}
+
+template <>
+bool JsonVariant::is<bool>() const {
+  return _node != nullptr && _node->type == NodeType::Bool;
+}
+
+template <>
+bool JsonVariant::is<double>() const {
+  return _node != nullptr && (_node->type == NodeType::Float || _node->type == NodeType::Integer);
+}
+
+template <>
+bool JsonVariant::is<float>() const {
+  return is<double>();
+}
+
+template <>
+bool JsonVariant::is<const char*>() const {
+  return _node != nullptr && _node->type == NodeType::String;
+}
+
+template <>
+bool JsonVariant::is<String>() const {
+  return is<const char*>();
+}
+
+template <>
+bool JsonVariant::is<JsonObject>() const {
+  return _node != nullptr && _node->type == NodeType::Object;
+}
+
+template <>
+bool JsonVariant::is<JsonArray>() const {
+  return _node != nullptr && _node->type == NodeType::Array;
+}
+
+template <>
+bool JsonVariant::is<JsonVariant>() const {
+  return true;
+}
+
+template <>
+bool JsonVariant::as<bool>() const {
+  if (_node == nullptr) {
+    return false;
+  }
+  switch (_node->type) {
+    case NodeType::Bool:
+      return _node->boolean;
+    case NodeType::Integer:
+      return _node->integer != 0;
+    case NodeType::Float:
+      return _node->real != 0;
+    default:
+      return false;
+  }
+}
+
+template <>
+double JsonVariant::as<double>() const {
+  if (_node == nullptr) {
+    return 0;
+  }
+  switch (_node->type) {
+    case NodeType::Integer:
+      return (double)_node->integer;
+    case NodeType::Float:
+      return _node->real;
+    case NodeType::Bool:
+      return _node->boolean ? 1 : 0;
+    default:
+      return 0;
+  }
+}
+
+template <>
+float JsonVariant::as<float>() const {
+  return (float)as<double>();
+}
+
+template <>
+const char* JsonVariant::as<const char*>() const {
+  return is<const char*>() ? _node->text : nullptr;
+}
+
+template <>
+String JsonVariant::as<String>() const {
+  if (is<const char*>()) {
+    return String(_node->text);
+  }
+  // Не строка: как в ArduinoJson 6, значение в виде JSON
+  String text;
+  serializeJson(*this, text);
+  return text;
+}
+
+template <>
+JsonObject JsonVariant::as<JsonObject>() const {
+  return JsonObject(_node);
+}
+
+template <>
+JsonArray JsonVariant::as<JsonArray>() const {
+  return JsonArray(_node);
+}
+
+template <>
+JsonVariant JsonVariant::as<JsonVariant>() const {
+  return *this;
+}
+
+DynamicJsonDocument::DynamicJsonDocument(size_t capacity)
+    : _capacity(capacity), _poolSize(capacity * HOST_POOL_FACTOR) {
+  _pool = new uint8_t[_poolSize];
+}
+
+DynamicJsonDocument::~DynamicJsonDocument() {
+  delete[] _pool;
+}
+
+void DynamicJsonDocument::clear() {
+  _used = 0;
+  _poolUsed = 0;
+  _overflowed = false;
+  _root = nullptr;
+}
+
+void* DynamicJsonDocument::take(size_t hostBytes, size_t deviceBytes) {
+  hostBytes = (hostBytes + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+  if (_used + deviceBytes > _capacity || _poolUsed + hostBytes > _poolSize) {
+    _overflowed = true;
+    return nullptr;
+  }
+  void* block = _pool + _poolUsed;
+  _poolUsed += hostBytes;
+  _used += deviceBytes;
+  return block;
+}
+
+Node* DynamicJsonDocument::newNode() {
+  void* block = take(sizeof(Node), ARDUINOJSON_SLOT_SIZE);
+  if (block == nullptr) {
+    return nullptr;
+  }
+  Node* node = static_cast<Node*>(block);
+  *node = Node();
+  node->type = NodeType::Null;
+  return node;
+}
+
+char* DynamicJsonDocument::newString(const char* text, size_t length) {
+  char* copy = static_cast<char*>(take(length + 1, length + 1));
+  if (copy != nullptr) {
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+  }
+  return copy;
+}
+
+DeserializationError deserializeJson(DynamicJsonDocument& doc, Stream& input) {
+  doc.clear();
+  Reader reader(&input);
+  return Parser(doc, reader).parse();
+}
+
+DeserializationError deserializeJson(DynamicJsonDocument& doc, const char* input) {
+  return deserializeJson(doc, input, input != nullptr ? strlen(input) : 0);
+}
+
+DeserializationError deserializeJson(DynamicJsonDocument& doc, const char* input, size_t length) {
+  doc.clear();
+  Reader reader(input, length);
+  return Parser(doc, reader).parse();
+}
+
+size_t serializeJson(JsonVariant value, Print& output) {
+  return writeNode(output, value.node());
+}
+
+size_t serializeJson(JsonVariant value, String& output) {
+  output = "";
+  StringPrint print(output);
+  return writeNode(print, value.node());
+}
@@ -0,0 +1,457 @@
+#include "ESPAsyncWebServer.h"
+#include "ESP8266WiFi.h"
+
+#include <algorithm>
+
+ESP8266WiFiClass WiFi;
+
+namespace {
+
+String emptyString;
+
+String urlDecode(const char* begin, const char* end) {
+  String value;
+  for (const char* c = begin; c < end; c++) {
+    if (*c == '+') {
+      value += ' ';
+    } else if (*c == '%' && end - c > 2) {
+      char hex[3] = {c[1], c[2], '\0'};
+      value += (char)strtol(hex, nullptr, 16);
+      c += 2;
+    } else {
+      value += *c;
+    }
+  }
+  return value;
+}
+
+}  // namespace
+
+const char* asyncResponseCodeText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 303: return "See Other";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+String AsyncWebServerResponse::head() const {
+  String text = "HTTP/1.1 " + String(_code) + " " + asyncResponseCodeText(_code) + "\r\n";
+  text += "Connection: close\r\n";
+  if (_chunked) {
+    text += "Transfer-Encoding: chunked\r\n";
+  } else {
+    text += "Content-Length: " + String((unsigned long)_contentLength) + "\r\n";
+  }
+  if (_contentType.length() > 0) {
+    text += "Content-Type: " + _contentType + "\r\n";
+  }
+  for (const AsyncWebHeader& header : _headers) {
+    text += header.name() + ": " + header.value() + "\r\n";
+  }
+  text += "\r\n";
+  return text;
+}
+
+AsyncBasicResponse::AsyncBasicResponse(int code, const String& contentType, const String& content)
+    : AsyncWebServerResponse(code, contentType), _content(content) {
+  _contentLength = _content.length();
+  if (_contentLength > 0 && _contentType.length() == 0) {
+    _contentType = "text/plain";
+  }
+}
+
+size_t AsyncBasicResponse::fillBody(uint8_t* buffer, size_t maxLength) {
+  size_t length = std::min(maxLength, _contentLength - _sent);
+  memcpy(buffer, _content.c_str() + _sent, length);
+  _sent += length;
+  return length;
+}
+
+AsyncProgmemResponse::AsyncProgmemResponse(int code, const String& contentType, const uint8_t* content, size_t length)
+    : AsyncWebServerResponse(code, contentType), _content(content) {
+  _contentLength = length;
+}
+
+size_t AsyncProgmemResponse::fillBody(uint8_t* buffer, size_t maxLength) {
+  size_t length = std::min(maxLength, _contentLength - _sent);
+  memcpy_P(buffer, _content + _sent, length);
+  _sent += length;
+  return length;
+}
+
+AsyncFileResponse::AsyncFileResponse(FS& fs, const String& path, const String& contentType)
+    : AsyncWebServerResponse(200, contentType) {
+  _file = fs.open(path, "r");
+  _contentLength = _file ? _file.size() : 0;
+}
+
+size_t AsyncFileResponse::fillBody(uint8_t* buffer, size_t maxLength) {
+  return _file ? _file.read(buffer, maxLength) : 0;
+}
+
+AsyncChunkedResponse::AsyncChunkedResponse(const String& contentType, AwsResponseFiller filler)
+    : AsyncWebServerResponse(200, contentType), _filler(std::move(filler)) {
+  _chunked = true;
+}
+
+size_t AsyncChunkedResponse::fillBody(uint8_t* buffer, size_t maxLength) {
+  size_t length = _filler(buffer, maxLength, _index);
+  if (length != RESPONSE_TRY_AGAIN) {
+    _index += length;
+  }
+  return length;
+}
+
+AsyncWebServerRequest::AsyncWebServerRequest(WebRequestMethod method, const String& url, const String& query,
+                                             const String& form)
+    : _method(method), _url(url) {
+  parseParams(query, false);
+  parseParams(form, true);
+}
+
+AsyncWebServerRequest::~AsyncWebServerRequest() {
+  disconnect();
+}
+
+void AsyncWebServerRequest::parseParams(const String& text, bool post) {
+  const char* p = text.c_str();
+  while (*p != '\0') {
+    const char* end = strchr(p, '&');
+    if (end == nullptr) {
+      end = p + strlen(p);
+    }
+    const char* equals = (const char*)memchr(p, '=', end - p);
+    if (equals == nullptr) {
+      _params.emplace_back(urlDecode(p, end), String(), post);
+    } else {
+      _params.emplace_back(urlDecode(p, equals), urlDecode(equals + 1, end), post);
+    }
+    p = *end == '&' ? end + 1 : end;
+  }
+}
+
+bool AsyncWebServerRequest::hasArg(const char* name) const {
+  for (const AsyncWebParameter& param : _params) {
+    if (param.name() == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const String& AsyncWebServerRequest::arg(const char* name) const {
+  for (const AsyncWebParameter& param : _params) {
+    if (param.name() == name) {
+      return param.value();
+    }
+  }
+  return emptyString;
+}
+
+bool AsyncWebServerRequest::hasParam(const String& name, bool post) const {
+  for (const AsyncWebParameter& param : _params) {
+    if (param.name() == name && param.isPost() == post) {
+      return true;
+    }
+  }
+  return false;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::getParam(const String& name, bool post) {
+  for (AsyncWebParameter& param : _params) {
+    if (param.name() == name && param.isPost() == post) {
+      return &param;
+    }
+  }
+  return nullptr;
+}
+
+bool AsyncWebServerRequest::hasHeader(const char* name) const {
+  for (const AsyncWebHeader& header : _headers) {
+    if (header.name().equalsIgnoreCase(name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+AsyncWebHeader* AsyncWebServerRequest::getHeader(const char* name) {
+  for (AsyncWebHeader& header : _headers) {
+    if (header.name().equalsIgnoreCase(name)) {
+      return &header;
+    }
+  }
+  return nullptr;
+}
+
+const String& AsyncWebServerRequest::header(const char* name) const {
+  for (const AsyncWebHeader& header : _headers) {
+    if (header.name().equalsIgnoreCase(name)) {
+      return header.value();
+    }
+  }
+  return emptyString;
+}
+
+void AsyncWebServerRequest::onDisconnect(ArDisconnectHandler handler) {
+  _disconnectHandlers.push_back(std::move(handler));
+}
+
+void AsyncWebServerRequest::disconnect() {
+  if (_disconnected) {
+    return;
+  }
+  _disconnected = true;
+  // Обработчик может добавить новый; проходим по копии
+  std::vector<ArDisconnectHandler> handlers;
+  handlers.swap(_disconnectHandlers);
+  for (ArDisconnectHandler& handler : handlers) {
+    handler();
+  }
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response) {
+  if (_disconnected || _response) {
+    // Как в библиотеке: второй ответ и ответ ушедшему клиенту удаляются
+    delete response;
+    return;
+  }
+  if (!response->sourceValid()) {
+    delete response;
+    response = new AsyncBasicResponse(500, String(), String());
+  }
+  _response.reset(response);
+}
+
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content) {
+  send(beginResponse(code, contentType, content));
+}
+
+void AsyncWebServerRequest::redirect(const String& url) {
+  AsyncWebServerResponse* response = beginResponse(302);
+  response->addHeader("Location", url);
+  send(response);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType,
+                                                             const String& content) {
+  return new AsyncBasicResponse(code, contentType, content);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(FS& fs, const String& path, const String& contentType,
+                                                             bool download) {
+  AsyncWebServerResponse* response = new AsyncFileResponse(fs, path, contentType);
+  if (download) {
+    response->addHeader("Content-Disposition", "attachment");
+  }
+  return response;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse_P(int code, const String& contentType,
+                                                               const uint8_t* content, size_t length,
+                                                               AwsTemplateProcessor callback) {
+  (void)callback;
+  return new AsyncProgmemResponse(code, contentType, content, length);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse_P(int code, const String& contentType, PGM_P content,
+                                                               AwsTemplateProcessor callback) {
+  return beginResponse_P(code, contentType, (const uint8_t*)content, strlen_P(content), callback);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginChunkedResponse(const String& contentType,
+                                                                    AwsResponseFiller filler,
+                                                                    AwsTemplateProcessor callback) {
+  (void)callback;
+  return new AsyncChunkedResponse(contentType, std::move(filler));
+}
+
+bool AsyncCallbackWebHandler::canHandle(AsyncWebServerRequest* request) {
+  if (!(_method & request->method())) {
+    return false;
+  }
+  // Как в библиотеке: точное совпадение или подкаталог "uri/..."
+  const String& url = request->url();
+  return url == _uri || url.startsWith(_uri + "/");
+}
+
+void AsyncCallbackWebHandler::handleRequest(AsyncWebServerRequest* request) {
+  if (_handler) {
+    _handler(request);
+  } else {
+    request->send(500);
+  }
+}
+
+AsyncWebServer::~AsyncWebServer() {}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction handler) {
+  _ownedHandlers.emplace_back(new AsyncCallbackWebHandler(uri, method, std::move(handler)));
+  _handlers.push_back(_ownedHandlers.back().get());
+  return *_ownedHandlers.back();
+}
+
+AsyncWebHandler& AsyncWebServer::addHandler(AsyncWebHandler* handler) {
+  _handlers.push_back(handler);
+  return *handler;
+}
+
+void AsyncWebServer::handleRequest(AsyncWebServerRequest* request) {
+  for (AsyncWebHandler* handler : _handlers) {
+    if (handler->canHandle(request)) {
+      handler->handleRequest(request);
+      return;
+    }
+  }
+  if (_notFound) {
+    _notFound(request);
+  } else {
+    request->send(404);
+  }
+}
+
+AsyncEventSourceClient::AsyncEventSourceClient(AsyncWebServerRequest* request, AsyncEventSource* source)
+    : _request(request), _source(source) {}
+
+AsyncEventSourceClient::~AsyncEventSourceClient() {}
+
+void AsyncEventSourceClient::send(const char* message, const char* event, uint32_t id, uint32_t reconnect) {
+  if (!connected()) {
+    return;
+  }
+  String text;
+  if (reconnect > 0) {
+    text += "retry: " + String((unsigned long)reconnect) + "\r\n";
+  }
+  if (id > 0) {
+    text += "id: " + String((unsigned long)id) + "\r\n";
+    _lastId = id;
+  }
+  if (event != nullptr) {
+    text += "event: " + String(event) + "\r\n";
+  }
+  if (message != nullptr) {
+    for (const char* line = message; ; ) {
+      const char* end = strchr(line, '\n');
+      text += "data: ";
+      text.concat(line, end != nullptr ? (unsigned int)(end - line) : (unsigned int)strlen(line));
+      text += "\r\n";
+      if (end == nullptr) {
+        break;
+      }
+      line = end + 1;
+    }
+  }
+  text += "\r\n";
+  // Как в библиотеке: переполненная очередь клиента теряет новое сообщение
+  if (_queue.size() >= SSE_MAX_QUEUED_MESSAGES) {
+    _dropped++;
+    return;
+  }
+  _queue.push_back(text);
+}
+
+void AsyncEventSourceClient::close() {
+  if (_request != nullptr) {
+    // Отключение удаляет клиента из источника и сам объект
+    _request->disconnect();
+  }
+}
+
+String AsyncEventSourceClient::drain(size_t maxMessages) {
+  String text;
+  size_t count = std::min(maxMessages, _queue.size());
+  for (size_t i = 0; i < count; i++) {
+    text += _queue[i];
+  }
+  _queue.erase(_queue.begin(), _queue.begin() + count);
+  _received += text;
+  return text;
+}
+
+void AsyncEventSourceClient::detach() {
+  if (_request != nullptr) {
+    _request->setEventClient(nullptr);
+    _request = nullptr;
+  }
+}
+
+AsyncEventSource::~AsyncEventSource() {
+  for (AsyncEventSourceClient* client : _clients) {
+    client->detach();
+    delete client;
+  }
+}
+
+void AsyncEventSource::send(const char* message, const char* event, uint32_t id, uint32_t reconnect) {
+  for (AsyncEventSourceClient* client : _clients) {
+    client->send(message, event, id, reconnect);
+  }
+}
+
+size_t AsyncEventSource::count() const {
+  size_t connected = 0;
+  for (AsyncEventSourceClient* client : _clients) {
+    if (client->connected()) {
+      connected++;
+    }
+  }
+  return connected;
+}
+
+size_t AsyncEventSource::avgPacketsWaiting() const {
+  size_t waiting = 0;
+  size_t connected = 0;
+  for (AsyncEventSourceClient* client : _clients) {
+    if (client->connected()) {
+      waiting += client->packetsWaiting();
+      connected++;
+    }
+  }
+  // Как в библиотеке: среднее с округлением
+  return connected > 0 ? (waiting + connected / 2) / connected : 0;
+}
+
+bool AsyncEventSource::canHandle(AsyncWebServerRequest* request) {
+  return request->method() == HTTP_GET && request->url() == _url;
+}
+
+void AsyncEventSource::handleRequest(AsyncWebServerRequest* request) {
+  AsyncEventSourceClient* client = new AsyncEventSourceClient(request, this);
+  request->setEventClient(client);
+  request->onDisconnect([this, client]() {
+    removeClient(client);
+  });
+  _clients.push_back(client);
+  if (_connect) {
+    _connect(client);
+  }
+}
+
+void AsyncEventSource::removeClient(AsyncEventSourceClient* client) {
+  auto position = std::find(_clients.begin(), _clients.end(), client);
+  if (position == _clients.end()) {
+    return;
+  }
+  _clients.erase(position);
+  client->detach();
+  if (_disconnect) {
+    _disconnect(client);
+  }
+  delete client;
+}
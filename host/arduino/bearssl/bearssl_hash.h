@@ -0,0 +1,17 @@
+// SHA-256 из BearSSL для сборки на Linux: те же функции контекста.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define br_sha256_SIZE 32
+
+typedef struct {
+  uint8_t buffer[64];
+  uint64_t count;
+  uint32_t state[8];
+} br_sha256_context;
+
+void br_sha256_init(br_sha256_context* context);
+void br_sha256_update(br_sha256_context* context, const void* data, size_t length);
+void br_sha256_out(const br_sha256_context* context, void* out);
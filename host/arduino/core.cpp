@@ -0,0 +1,149 @@
+#include "Arduino.h"
+
+namespace {
+
+uint64_t nowMicros = 0;
+void (*yieldHook)() = nullptr;
+bool serialEcho = false;
+uint32_t randomState = 0x2545F491;
+
+uint32_t nextRandom() {
+  // xorshift32: достаточно для идентификаторов сессий и повторяемо
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+}  // namespace
+
+HardwareSerial Serial;
+EspClass ESP;
+
+uint64_t hostMicros() {
+  return nowMicros;
+}
+
+void hostAdvanceMicros(uint64_t us) {
+  nowMicros += us;
+}
+
+void hostAdvanceMillis(uint64_t ms) {
+  nowMicros += ms * 1000;
+}
+
+void hostSetYieldHook(void (*hook)()) {
+  yieldHook = hook;
+}
+
+void hostSetSerialEcho(bool echo) {
+  serialEcho = echo;
+}
+
+void hostSeedRandom(uint32_t seed) {
+  randomState = seed != 0 ? seed : 0x2545F491;
+}
+
+unsigned long millis() {
+  return (uint32_t)(nowMicros / 1000);
+}
+
+unsigned long micros() {
+  return (uint32_t)nowMicros;
+}
+
+void delay(unsigned long ms) {
+  hostAdvanceMillis(ms);
+  yield();
+}
+
+void delayMicroseconds(unsigned int us) {
+  hostAdvanceMicros(us);
+}
+
+void yield() {
+  if (yieldHook != nullptr) {
+    yieldHook();
+  }
+}
+
+void pinMode(uint8_t, uint8_t) {}
+
+int digitalRead(uint8_t) {
+  return HIGH;
+}
+
+void digitalWrite(uint8_t, uint8_t) {}
+
+int digitalPinToInterrupt(int pin) {
+  return pin;
+}
+
+void attachInterrupt(int, void (*)(), int) {}
+
+void detachInterrupt(int) {}
+
+long random(long max) {
+  return max > 0 ? (long)(nextRandom() % (uint32_t)max) : 0;
+}
+
+long random(long min, long max) {
+  return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+  hostSeedRandom((uint32_t)seed);
+}
+
+void HardwareSerial::begin(unsigned long) {}
+
+size_t HardwareSerial::write(uint8_t byte) {
+  if (serialEcho) {
+    fputc(byte, stderr);
+  }
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t length) {
+  if (serialEcho) {
+    fwrite(data, 1, length, stderr);
+  }
+  return length;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  int64_t used = hostHeapUsedSinceBoot();
+  return used < HOST_HEAP_SIZE ? (uint32_t)(HOST_HEAP_SIZE - used) : 0;
+}
+
+uint32_t EspClass::getMaxFreeBlockSize() {
+  return getFreeHeap();
+}
+
+uint8_t EspClass::getHeapFragmentation() {
+  return 0;
+}
+
+uint32_t EspClass::getCycleCount() {
+  // 80 МГц: такты считаются от виртуального времени
+  return (uint32_t)(nowMicros * 80);
+}
+
+uint32_t EspClass::random() {
+  return nextRandom();
+}
+
+void EspClass::restart() {
+  fprintf(stderr, "ESP.restart()\n");
+  exit(0);
+}
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+  return String(text);
+}
+
+size_t IPAddress::printTo(Print& output) const {
+  return output.print(toString());
+}
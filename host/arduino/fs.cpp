@@ -0,0 +1,458 @@
+#include "FS.h"
+#include "LittleFS.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+
+fs::FS LittleFS;
+
+namespace {
+
+std::string mountRoot = "./littlefs";
+HostFsStats stats = {};
+size_t capacity = 1024 * 1024;
+bool powerCutArmed = false;
+uint64_t powerBudget = 0;
+
+std::string hostPath(const char* path) {
+  std::string full = mountRoot;
+  if (path == nullptr || path[0] != '/') {
+    full += '/';
+  }
+  if (path != nullptr) {
+    full += path;
+  }
+  while (full.size() > 1 && full.back() == '/') {
+    full.pop_back();
+  }
+  return full;
+}
+
+bool isDirectoryPath(const std::string& path) {
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+bool isFilePath(const std::string& path) {
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+// Списывает length байтов с запаса питания; возвращает, сколько успело записаться
+size_t spendPower(size_t length) {
+  if (!powerCutArmed) {
+    return length;
+  }
+  size_t allowed = (size_t)std::min<uint64_t>(powerBudget, length);
+  powerBudget -= allowed;
+  return allowed;
+}
+
+bool spendMetadata() {
+  return spendPower(1) == 1;
+}
+
+// Создаёт недостающие каталоги пути, как LittleFS ядра при открытии на запись
+void createParents(const std::string& path) {
+  for (size_t slash = mountRoot.size() + 1; (slash = path.find('/', slash)) != std::string::npos; slash++) {
+    ::mkdir(path.substr(0, slash).c_str(), 0755);
+  }
+}
+
+uint64_t usedBytes(const std::string& path) {
+  DIR* dir = opendir(path.c_str());
+  if (dir == nullptr) {
+    return 0;
+  }
+  uint64_t used = 4096;  // блок метаданных каталога
+  while (dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    std::string child = path + "/" + name;
+    struct stat info;
+    if (stat(child.c_str(), &info) != 0) {
+      continue;
+    }
+    if (S_ISDIR(info.st_mode)) {
+      used += usedBytes(child);
+    } else {
+      used += ((uint64_t)info.st_size + 4095) / 4096 * 4096;
+    }
+  }
+  closedir(dir);
+  return used;
+}
+
+const char* baseName(const std::string& path) {
+  size_t slash = path.rfind('/');
+  return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+}  // namespace
+
+namespace fs {
+
+class FileImpl {
+public:
+  FileImpl(FILE* handle, std::string path, std::string fullName, bool writable, bool directory)
+      : handle(handle), path(std::move(path)), fullName(std::move(fullName)), writable(writable),
+        directory(directory) {
+    stats.openHandles++;
+  }
+  ~FileImpl() {
+    close();
+  }
+
+  void close() {
+    if (open) {
+      if (handle != nullptr) {
+        fclose(handle);
+      }
+      handle = nullptr;
+      open = false;
+      stats.closes++;
+      stats.openHandles--;
+    }
+  }
+
+  FILE* handle;
+  std::string path;
+  std::string fullName;
+  bool writable;
+  bool directory;
+  bool open = true;
+};
+
+size_t File::write(uint8_t byte) {
+  return write(&byte, 1);
+}
+
+size_t File::write(const uint8_t* data, size_t length) {
+  if (!_impl || _impl->handle == nullptr || !_impl->writable) {
+    return 0;
+  }
+  stats.writeCalls++;
+  size_t allowed = spendPower(length);
+  size_t written = allowed > 0 ? fwrite(data, 1, allowed, _impl->handle) : 0;
+  // Без буфера stdio: байты на "флеш" сразу, чтобы обрыв питания был честным
+  fflush(_impl->handle);
+  stats.bytesWritten += written;
+  return written;
+}
+
+int File::available() {
+  if (!_impl || _impl->handle == nullptr) {
+    return 0;
+  }
+  return (int)(size() - position());
+}
+
+int File::read() {
+  uint8_t byte;
+  return read(&byte, 1) == 1 ? byte : -1;
+}
+
+int File::peek() {
+  if (!_impl || _impl->handle == nullptr) {
+    return -1;
+  }
+  int c = fgetc(_impl->handle);
+  if (c != EOF) {
+    ungetc(c, _impl->handle);
+  }
+  return c == EOF ? -1 : c;
+}
+
+void File::flush() {
+  if (_impl && _impl->handle != nullptr) {
+    fflush(_impl->handle);
+  }
+}
+
+size_t File::read(uint8_t* buffer, size_t length) {
+  if (!_impl || _impl->handle == nullptr) {
+    return 0;
+  }
+  stats.readCalls++;
+  size_t count = fread(buffer, 1, length, _impl->handle);
+  stats.bytesRead += count;
+  return count;
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+  if (!_impl || _impl->handle == nullptr) {
+    return false;
+  }
+  int whence = mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END;
+  return fseek(_impl->handle, (long)position, whence) == 0;
+}
+
+size_t File::position() const {
+  if (!_impl || _impl->handle == nullptr) {
+    return 0;
+  }
+  long position = ftell(_impl->handle);
+  return position < 0 ? 0 : (size_t)position;
+}
+
+size_t File::size() const {
+  if (!_impl || _impl->handle == nullptr) {
+    return 0;
+  }
+  struct stat info;
+  return fstat(fileno(_impl->handle), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+bool File::truncate(uint32_t size) {
+  if (!_impl || _impl->handle == nullptr || !_impl->writable || !spendMetadata()) {
+    return false;
+  }
+  fflush(_impl->handle);
+  return ftruncate(fileno(_impl->handle), size) == 0;
+}
+
+void File::close() {
+  if (_impl) {
+    _impl->close();
+    _impl.reset();
+  }
+}
+
+File::operator bool() const {
+  return _impl && _impl->open;
+}
+
+const char* File::name() const {
+  return _impl ? baseName(_impl->fullName) : "";
+}
+
+const char* File::fullName() const {
+  return _impl ? _impl->fullName.c_str() : "";
+}
+
+bool File::isFile() const {
+  return _impl && !_impl->directory;
+}
+
+bool File::isDirectory() const {
+  return _impl && _impl->directory;
+}
+
+bool Dir::next() {
+  if (_position >= _names.size()) {
+    return false;
+  }
+  _position++;
+  return true;
+}
+
+String Dir::fileName() const {
+  return _position > 0 ? String(_names[_position - 1].c_str()) : String();
+}
+
+size_t Dir::fileSize() const {
+  struct stat info;
+  if (_position == 0 || stat((_root + "/" + _names[_position - 1]).c_str(), &info) != 0) {
+    return 0;
+  }
+  return S_ISREG(info.st_mode) ? (size_t)info.st_size : 0;
+}
+
+bool Dir::isFile() const {
+  return _position > 0 && isFilePath(_root + "/" + _names[_position - 1]);
+}
+
+bool Dir::isDirectory() const {
+  return _position > 0 && isDirectoryPath(_root + "/" + _names[_position - 1]);
+}
+
+File Dir::openFile(const char* mode) const {
+  if (_position == 0) {
+    return File();
+  }
+  std::string path = _path + "/" + _names[_position - 1];
+  return LittleFS.open(path.c_str(), mode);
+}
+
+bool Dir::rewind() {
+  _position = 0;
+  return true;
+}
+
+bool FS::begin() {
+  ::mkdir(mountRoot.c_str(), 0755);
+  return isDirectoryPath(mountRoot);
+}
+
+bool FS::format() {
+  std::string command = "rm -rf '" + mountRoot + "'";
+  if (system(command.c_str()) != 0) {
+    return false;
+  }
+  return begin();
+}
+
+bool FS::info(FSInfo& info) {
+  info.totalBytes = capacity;
+  info.usedBytes = (size_t)std::min<uint64_t>(usedBytes(mountRoot), capacity);
+  info.blockSize = 4096;
+  info.pageSize = 256;
+  info.maxOpenFiles = 5;
+  info.maxPathLength = 32;
+  return true;
+}
+
+File FS::open(const char* path, const char* mode) {
+  std::string full = hostPath(path);
+  std::string requested = mode != nullptr ? mode : "r";
+  bool update = requested.find('+') != std::string::npos;
+  bool writable = requested[0] != 'r' || update;
+  if (isDirectoryPath(full)) {
+    if (writable) {
+      return File();
+    }
+    stats.opensRead++;
+    return File(std::make_shared<FileImpl>(nullptr, full, path, false, true));
+  }
+  if (writable && !isFilePath(full)) {
+    if (requested[0] == 'r' || !spendMetadata()) {
+      return File();
+    }
+    createParents(full);
+  } else if (requested[0] == 'w' && !spendMetadata()) {
+    // Обесточенная флеш не обнуляет существующий файл
+    return File();
+  }
+  std::string hostMode = requested.substr(0, 1) + (update ? "+b" : "b");
+  FILE* handle = fopen(full.c_str(), hostMode.c_str());
+  if (handle == nullptr) {
+    return File();
+  }
+  if (update) {
+    stats.opensUpdate++;
+  } else if (requested[0] == 'w') {
+    stats.opensWrite++;
+  } else if (requested[0] == 'a') {
+    stats.opensAppend++;
+  } else {
+    stats.opensRead++;
+  }
+  return File(std::make_shared<FileImpl>(handle, full, path, writable, false));
+}
+
+bool FS::exists(const char* path) {
+  struct stat info;
+  return stat(hostPath(path).c_str(), &info) == 0;
+}
+
+Dir FS::openDir(const char* path) {
+  std::string full = hostPath(path);
+  std::vector<std::string> names;
+  if (DIR* dir = opendir(full.c_str())) {
+    while (dirent* entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name != "." && name != "..") {
+        names.push_back(name);
+      }
+    }
+    closedir(dir);
+  }
+  // Порядок readdir на хосте случаен; LittleFS отдаёт записи отсортированными
+  std::sort(names.begin(), names.end());
+  std::string logical = path != nullptr ? path : "/";
+  while (logical.size() > 1 && logical.back() == '/') {
+    logical.pop_back();
+  }
+  return Dir(full, logical, std::move(names));
+}
+
+bool FS::remove(const char* path) {
+  std::string full = hostPath(path);
+  if (!isFilePath(full) || !spendMetadata()) {
+    return false;
+  }
+  stats.removes++;
+  return unlink(full.c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+  std::string source = hostPath(from);
+  std::string target = hostPath(to);
+  if (!isFilePath(source) || !spendMetadata()) {
+    return false;
+  }
+  createParents(target);
+  stats.renames++;
+  return ::rename(source.c_str(), target.c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+  std::string full = hostPath(path);
+  stats.mkdirs++;
+  if (isDirectoryPath(full)) {
+    return true;
+  }
+  if (!spendMetadata()) {
+    return false;
+  }
+  createParents(full);
+  return ::mkdir(full.c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char* path) {
+  std::string full = hostPath(path);
+  if (!isDirectoryPath(full) || !spendMetadata()) {
+    return false;
+  }
+  return ::rmdir(full.c_str()) == 0;
+}
+
+}  // namespace fs
+
+void hostFsMount(const std::string& root) {
+  mountRoot = root;
+  while (mountRoot.size() > 1 && mountRoot.back() == '/') {
+    mountRoot.pop_back();
+  }
+  ::mkdir(mountRoot.c_str(), 0755);
+  int32_t openHandles = stats.openHandles;
+  stats = {};
+  stats.openHandles = openHandles;
+  powerCutArmed = false;
+}
+
+const std::string& hostFsRoot() {
+  return mountRoot;
+}
+
+HostFsStats hostFsStats() {
+  return stats;
+}
+
+void hostFsResetStats() {
+  int32_t openHandles = stats.openHandles;
+  stats = {};
+  stats.openHandles = openHandles;
+}
+
+void hostFsSetCapacity(size_t totalBytes) {
+  capacity = totalBytes;
+}
+
+void hostFsCutPowerAfter(uint64_t budget) {
+  powerCutArmed = true;
+  powerBudget = budget;
+}
+
+bool hostFsPowerLost() {
+  return powerCutArmed && powerBudget == 0;
+}
+
+void hostFsRestorePower() {
+  powerCutArmed = false;
+}
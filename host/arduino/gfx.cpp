@@ -0,0 +1,167 @@
+#include "Adafruit_SSD1306.h"
+
+#include <stdlib.h>
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  for (int16_t i = 0; i < w; i++) {
+    drawPixel(x + i, y, color);
+  }
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  for (int16_t i = 0; i < h; i++) {
+    drawPixel(x, y + i, color);
+  }
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t i = 0; i < h; i++) {
+    drawFastHLine(x, y + i, w, color);
+  }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  // Брезенхем
+  int16_t dx = abs(x1 - x0);
+  int16_t dy = -abs(y1 - y0);
+  int16_t sx = x0 < x1 ? 1 : -1;
+  int16_t sy = y0 < y1 ? 1 : -1;
+  int16_t error = dx + dy;
+  while (true) {
+    drawPixel(x0, y0, color);
+    if (x0 == x1 && y0 == y1) {
+      break;
+    }
+    int16_t doubled = 2 * error;
+    if (doubled >= dy) {
+      error += dy;
+      x0 += sx;
+    }
+    if (doubled <= dx) {
+      error += dx;
+      y0 += sy;
+    }
+  }
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t background,
+                            uint8_t size) {
+  for (int8_t column = 0; column < 5; column++) {
+    // Условный глиф: столбцы - перемешанные биты кода символа, пробел пустой
+    uint8_t bits = c == ' ' ? 0 : (uint8_t)((c * 37u + column * 73u) ^ (c >> 1)) & 0x7F;
+    for (int8_t row = 0; row < 8; row++, bits >>= 1) {
+      if (bits & 1) {
+        fillRect(x + column * size, y + row * size, size, size, color);
+      } else if (background != color) {
+        fillRect(x + column * size, y + row * size, size, size, background);
+      }
+    }
+  }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (c == '\n') {
+    _cursorX = 0;
+    _cursorY += _textSize * 8;
+  } else if (c != '\r') {
+    if (_wrap && _cursorX + _textSize * 6 > _width) {
+      _cursorX = 0;
+      _cursorY += _textSize * 8;
+    }
+    drawChar(_cursorX, _cursorY, c, _textColor, _textBackground, _textSize);
+    _cursorX += _textSize * 6;
+  }
+  return 1;
+}
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t width, uint8_t height, TwoWire* wire, int8_t resetPin)
+    : Adafruit_GFX(width, height), _wire(wire) {
+  (void)resetPin;
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+  free(_buffer);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t vccState, uint8_t address, bool reset, bool periphBegin) {
+  (void)vccState;
+  (void)reset;
+  (void)periphBegin;
+  // Как в библиотеке: буфер кадра берётся из кучи при begin()
+  if (_buffer == nullptr) {
+    _buffer = (uint8_t*)malloc(_width * ((_height + 7) / 8));
+    if (_buffer == nullptr) {
+      return false;
+    }
+  }
+  if (address != 0) {
+    _address = address;
+  }
+  clearDisplay();
+  sendCommand(0xAE);  // дисплей выключен на время настройки
+  sendCommand(0x20);  // горизонтальная адресация
+  sendCommand(0x00);
+  sendCommand(0xAF);
+  return true;
+}
+
+void Adafruit_SSD1306::display() {
+  sendCommand(0x22);  // окно страниц 0..7
+  sendCommand(0x00);
+  sendCommand(0xFF);
+  sendCommand(0x21);  // окно столбцов 0..127
+  sendCommand(0x00);
+  sendCommand(_width - 1);
+  size_t length = _width * ((_height + 7) / 8);
+  // Библиотека делит кадр на посылки по размеру буфера Wire
+  for (size_t offset = 0; offset < length;) {
+    _wire->beginTransmission(_address);
+    _wire->write((uint8_t)0x40);
+    size_t chunk = length - offset < BUFFER_LENGTH - 1 ? length - offset : BUFFER_LENGTH - 1;
+    _wire->write(_buffer + offset, chunk);
+    _wire->endTransmission();
+    offset += chunk;
+  }
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+  if (_buffer != nullptr) {
+    memset(_buffer, 0, _width * ((_height + 7) / 8));
+  }
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (_buffer == nullptr || x < 0 || y < 0 || x >= _width || y >= _height) {
+    return;
+  }
+  uint8_t& cell = _buffer[x + (y / 8) * _width];
+  uint8_t bit = 1 << (y & 7);
+  if (color == SSD1306_WHITE) {
+    cell |= bit;
+  } else if (color == SSD1306_BLACK) {
+    cell &= ~bit;
+  } else {
+    cell ^= bit;
+  }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) const {
+  if (_buffer == nullptr || x < 0 || y < 0 || x >= _width || y >= _height) {
+    return false;
+  }
+  return _buffer[x + (y / 8) * _width] & (1 << (y & 7));
+}
+
+void Adafruit_SSD1306::sendCommand(uint8_t command) {
+  _wire->beginTransmission(_address);
+  _wire->write((uint8_t)0x00);
+  _wire->write(command);
+  _wire->endTransmission();
+}
@@ -0,0 +1,48 @@
+// Управление поддельным ядром из тестов, замеров и симуляции.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Виртуальное время: начинается с нуля при запуске процесса, как у платы
+uint64_t hostMicros();
+void hostAdvanceMicros(uint64_t us);
+void hostAdvanceMillis(uint64_t ms);
+
+// Вызывается из yield() и delay(): сюда симуляция вешает сетевые события
+void hostSetYieldHook(void (*hook)());
+
+// Вывод Serial в stderr; по умолчанию молчит
+void hostSetSerialEcho(bool echo);
+
+// Начальное состояние генератора ESP.random(): прогоны повторяются
+void hostSeedRandom(uint32_t seed);
+
+// Куча: все operator new/delete процесса проходят через счётчики
+struct HostHeapStats {
+  uint64_t allocations;  // вызовов operator new
+  uint64_t frees;
+  uint64_t allocatedBytes;
+  int64_t liveBytes;
+  int64_t peakLiveBytes;
+  size_t largestAllocation;
+};
+
+HostHeapStats hostHeapStats();
+// Сбрасывает счётчики вызовов и пик; живые байты остаются
+void hostHeapResetCounters();
+
+// Память, выделенная внутри области, - не устройства, а его окружения на
+// хосте (например, тело ответа у клиента HTTP): её нет ни в счётчиках, ни в
+// ESP.getFreeHeap(). Области могут вкладываться
+class HostHeapExclude {
+public:
+  HostHeapExclude();
+  ~HostHeapExclude();
+};
+
+// Размер кучи, которую видит ESP.getFreeHeap(): как у ESP8266 после запуска
+// Wi-Fi. Занятое считается от момента hostHeapMarkBoot()
+#define HOST_HEAP_SIZE 45000
+void hostHeapMarkBoot();
+int64_t hostHeapUsedSinceBoot();
@@ -0,0 +1,129 @@
+// Счётчики кучи: замена глобальных operator new/delete. Размер блока
+// хранится в заголовке перед ним, чтобы delete знал, сколько освобождено.
+#include "host_core.h"
+
+#include <stdlib.h>
+#include <new>
+
+namespace {
+
+struct alignas(16) BlockHeader {
+  size_t size;
+  bool counted;  // выделено устройством, а не вне его (HostHeapExclude)
+};
+
+HostHeapStats heap = {};
+int64_t bootLiveBytes = 0;
+int excludeDepth = 0;
+
+void* allocate(size_t size) {
+  void* block = malloc(sizeof(BlockHeader) + size);
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  static_cast<BlockHeader*>(block)->size = size;
+  static_cast<BlockHeader*>(block)->counted = excludeDepth == 0;
+  if (excludeDepth > 0) {
+    return static_cast<BlockHeader*>(block) + 1;
+  }
+  heap.allocations++;
+  heap.allocatedBytes += size;
+  heap.liveBytes += (int64_t)size;
+  if (heap.liveBytes > heap.peakLiveBytes) {
+    heap.peakLiveBytes = heap.liveBytes;
+  }
+  if (size > heap.largestAllocation) {
+    heap.largestAllocation = size;
+  }
+  return static_cast<BlockHeader*>(block) + 1;
+}
+
+void release(void* pointer) {
+  if (pointer == nullptr) {
+    return;
+  }
+  BlockHeader* block = static_cast<BlockHeader*>(pointer) - 1;
+  if (block->counted) {
+    heap.frees++;
+    heap.liveBytes -= (int64_t)block->size;
+  }
+  free(block);
+}
+
+}  // namespace
+
+HostHeapExclude::HostHeapExclude() {
+  excludeDepth++;
+}
+
+HostHeapExclude::~HostHeapExclude() {
+  excludeDepth--;
+}
+
+HostHeapStats hostHeapStats() {
+  return heap;
+}
+
+void hostHeapResetCounters() {
+  heap.allocations = 0;
+  heap.frees = 0;
+  heap.allocatedBytes = 0;
+  heap.peakLiveBytes = heap.liveBytes;
+  heap.largestAllocation = 0;
+}
+
+void hostHeapMarkBoot() {
+  bootLiveBytes = heap.liveBytes;
+}
+
+int64_t hostHeapUsedSinceBoot() {
+  return heap.liveBytes - bootLiveBytes;
+}
+
+void* operator new(size_t size) {
+  return allocate(size);
+}
+
+void* operator new[](size_t size) {
+  return allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void* pointer) noexcept {
+  release(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  release(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  release(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+  release(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  release(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  release(pointer);
+}
@@ -0,0 +1,123 @@
+#include "MAX30105.h"
+
+namespace {
+
+const uint8_t REG_INT_STAT1 = 0x00;
+const uint8_t REG_INT_ENABLE1 = 0x02;
+const uint8_t REG_FIFO_WR_PTR = 0x04;
+const uint8_t REG_FIFO_OVF = 0x05;
+const uint8_t REG_FIFO_RD_PTR = 0x06;
+const uint8_t REG_FIFO_CONFIG = 0x08;
+const uint8_t REG_MODE_CONFIG = 0x09;
+const uint8_t REG_SPO2_CONFIG = 0x0A;
+const uint8_t REG_LED1_PA = 0x0C;
+const uint8_t REG_LED2_PA = 0x0D;
+const uint8_t REG_LED3_PA = 0x0E;
+const uint8_t REG_MULTI_LED1 = 0x11;
+const uint8_t REG_PART_ID = 0xFF;
+const uint8_t EXPECTED_PART_ID = 0x15;
+
+}  // namespace
+
+bool MAX30105::begin(TwoWire& wirePort, uint32_t i2cSpeed, uint8_t address) {
+  _wire = &wirePort;
+  _address = address;
+  _wire->begin();
+  _wire->setClock(i2cSpeed);
+  return readPartID() == EXPECTED_PART_ID;
+}
+
+void MAX30105::setup(uint8_t powerLevel, uint8_t sampleAverage, uint8_t ledMode, int sampleRate, int pulseWidth,
+                     int adcRange) {
+  softReset();
+
+  uint8_t average = 0;
+  for (uint8_t value = sampleAverage; value > 1 && average < 5; value >>= 1) {
+    average++;
+  }
+  bitMask(REG_FIFO_CONFIG, 0x1F, average << 5);
+  enableFIFORollover();
+
+  bitMask(REG_MODE_CONFIG, 0xF8, ledMode == 3 ? 0x07 : ledMode == 2 ? 0x03 : 0x02);
+
+  uint8_t range = adcRange < 4096 ? 0x00 : adcRange < 8192 ? 0x20 : adcRange < 16384 ? 0x40 : 0x60;
+  uint8_t rate = sampleRate < 100 ? 0 : sampleRate < 200 ? 1 : sampleRate < 400 ? 2 : sampleRate < 800 ? 3 : 4;
+  uint8_t width = pulseWidth < 118 ? 0 : pulseWidth < 215 ? 1 : pulseWidth < 411 ? 2 : 3;
+  writeRegister8(REG_SPO2_CONFIG, range | (rate << 2) | width);
+
+  setPulseAmplitudeRed(powerLevel);
+  setPulseAmplitudeIR(powerLevel);
+  setPulseAmplitudeGreen(powerLevel);
+  writeRegister8(REG_MULTI_LED1, 0x21);  // слот 1 - красный, слот 2 - ИК
+
+  clearFIFO();
+}
+
+void MAX30105::softReset() {
+  bitMask(REG_MODE_CONFIG, 0xBF, 0x40);
+  // Бит сброса опускается сам; модель датчика делает это сразу
+  for (int attempt = 0; attempt < 100 && (readRegister8(REG_MODE_CONFIG) & 0x40); attempt++) {
+    delay(1);
+  }
+}
+
+void MAX30105::setPulseAmplitudeRed(uint8_t value) {
+  writeRegister8(REG_LED1_PA, value);
+}
+
+void MAX30105::setPulseAmplitudeIR(uint8_t value) {
+  writeRegister8(REG_LED2_PA, value);
+}
+
+void MAX30105::setPulseAmplitudeGreen(uint8_t value) {
+  writeRegister8(REG_LED3_PA, value);
+}
+
+void MAX30105::setFIFOAlmostFull(uint8_t samples) {
+  bitMask(REG_FIFO_CONFIG, 0xF0, samples & 0x0F);
+}
+
+void MAX30105::enableAFULL() {
+  bitMask(REG_INT_ENABLE1, 0x7F, 0x80);
+}
+
+void MAX30105::disableAFULL() {
+  bitMask(REG_INT_ENABLE1, 0x7F, 0x00);
+}
+
+void MAX30105::enableFIFORollover() {
+  bitMask(REG_FIFO_CONFIG, 0xEF, 0x10);
+}
+
+void MAX30105::clearFIFO() {
+  writeRegister8(REG_FIFO_WR_PTR, 0);
+  writeRegister8(REG_FIFO_OVF, 0);
+  writeRegister8(REG_FIFO_RD_PTR, 0);
+}
+
+uint8_t MAX30105::getINT1() {
+  return readRegister8(REG_INT_STAT1);
+}
+
+uint8_t MAX30105::readPartID() {
+  return readRegister8(REG_PART_ID);
+}
+
+uint8_t MAX30105::readRegister8(uint8_t reg) {
+  _wire->beginTransmission(_address);
+  _wire->write(reg);
+  _wire->endTransmission(false);
+  _wire->requestFrom(_address, (size_t)1);
+  return _wire->available() ? (uint8_t)_wire->read() : 0;
+}
+
+void MAX30105::writeRegister8(uint8_t reg, uint8_t value) {
+  _wire->beginTransmission(_address);
+  _wire->write(reg);
+  _wire->write(value);
+  _wire->endTransmission();
+}
+
+void MAX30105::bitMask(uint8_t reg, uint8_t mask, uint8_t value) {
+  writeRegister8(reg, (readRegister8(reg) & mask) | value);
+}
@@ -0,0 +1,91 @@
+#include "Wire.h"
+
+TwoWire Wire;
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _address = address & 0x7F;
+  _txLength = 0;
+  _txOverflow = false;
+}
+
+// Коды возврата как у ядра: 0 - успех, 1 - данные не влезли в буфер, 2 - NACK адреса
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  I2cDevice* device = _devices[_address];
+  if (device == nullptr) {
+    return 2;
+  }
+  if (_txOverflow) {
+    return 1;
+  }
+  device->i2cWrite(_txBuffer, _txLength);
+  _stats[_address].writeTransactions++;
+  _stats[_address].bytesWritten += _txLength;
+  _txLength = 0;
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, size_t length, bool sendStop) {
+  (void)sendStop;
+  address &= 0x7F;
+  _rxLength = 0;
+  _rxIndex = 0;
+  I2cDevice* device = _devices[address];
+  if (device == nullptr) {
+    return 0;
+  }
+  if (length > BUFFER_LENGTH) {
+    length = BUFFER_LENGTH;
+  }
+  _rxLength = device->i2cRead(_rxBuffer, length);
+  _stats[address].readTransactions++;
+  _stats[address].bytesRead += _rxLength;
+  return (uint8_t)_rxLength;
+}
+
+size_t TwoWire::write(uint8_t byte) {
+  if (_txLength >= BUFFER_LENGTH) {
+    _txOverflow = true;
+    return 0;
+  }
+  _txBuffer[_txLength++] = byte;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t length) {
+  size_t written = 0;
+  while (written < length && write(data[written]) == 1) {
+    written++;
+  }
+  return written;
+}
+
+int TwoWire::available() {
+  return (int)(_rxLength - _rxIndex);
+}
+
+int TwoWire::read() {
+  return _rxIndex < _rxLength ? _rxBuffer[_rxIndex++] : -1;
+}
+
+int TwoWire::peek() {
+  return _rxIndex < _rxLength ? _rxBuffer[_rxIndex] : -1;
+}
+
+void TwoWire::attach(uint8_t address, I2cDevice* device) {
+  _devices[address & 0x7F] = device;
+}
+
+void TwoWire::detach(uint8_t address) {
+  _devices[address & 0x7F] = nullptr;
+}
+
+HostWireStats TwoWire::stats(uint8_t address) const {
+  return _stats[address & 0x7F];
+}
+
+void TwoWire::resetStats() {
+  for (HostWireStats& entry : _stats) {
+    entry = {};
+  }
+}
@@ -0,0 +1,584 @@
+// Замеры горячих путей прошивки на хосте (Google Benchmark).
+//
+// Прошивка загружается один раз на процесс на файловой системе-образце во
+// временном каталоге: сжатый интерфейс, 10 пользователей с расписанием сна и
+// журналом пульса, заполненным до ротации. Живые файлы устройства замеры не видят.
+// Сигнал - запись из FIRMWARE_BENCH_TRACE (trace_sensor.h) или синтетическая
+// запись с вариабельностью ритма, шумом и участками движения.
+//
+// Кроме времени каждый случай сообщает на операцию:
+//   allocs, alloc_bytes - вызовы operator new и их байты (host_heap.cpp);
+//   io_bytes            - байты шины I2C, файлов или тела ответа.
+// Сравнение с сохранённой базой: tools/bench_compare.py.
+#include <Adafruit_SSD1306.h>
+#include <benchmark/benchmark.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <random>
+#include <spo2_algorithm.h>
+#include "beat_detector.h"
+#include "export_stream.h"
+#include "firmware_host.h"
+#include "ppg_dsp.h"
+#include "trace_sensor.h"
+
+#define BENCH_USERS MAX_USERS
+#define BENCH_TRACE_MS 600000
+#define BENCH_EXPORT_USER 9999     // журнал выгрузки в отдельном каталоге, не пользователь устройства
+#define BENCH_EXPORT_INTERVAL 5    // с между записями, как при addPulseRecord
+#define OLED_ADDRESS 0x3C
+#define GLYPH_BENCH_ADDRESS 0x3D  // отдельный экран без устройства на шине
+
+namespace {
+
+struct Device {
+  TempDir dir;
+  std::unique_ptr<FirmwareHost> host;
+  std::vector<PpgSample> trace;
+  size_t tracePosition = 0;
+};
+
+// Архив интерфейса из tools/build_assets.py, как в образе LittleFS
+void installAssets(const std::string& root) {
+  mkdir((root + "/www").c_str(), 0755);
+  std::ifstream source(WEB_ASSETS_DIR "/index.html.gz", std::ios::binary);
+  std::ofstream target(root + "/www/index.html.gz", std::ios::binary);
+  target << source.rdbuf();
+}
+
+void buildUsers(FirmwareHost& host) {
+  for (int i = 1; i < BENCH_USERS; i++) {
+    String name = "user" + String(i);
+    host.cookie = String();
+    host.post("/register", "username=" + name + "&password=secret" + String(i));
+    host.post("/setSleep", "bedH=" + String(21 + i % 3) + "&bedM=" + String(i * 5) + "&wakeH=" + String(6 + i % 2) +
+                           "&wakeM=" + String(i * 3));
+  }
+  host.cookie = String();
+  host.login("admin", "admin");
+  saveUsers();
+}
+
+// Журнал каждого пользователя заполняется до ротации, как после недель работы
+void buildHistories() {
+  int saved = currentUserIndex;
+  uint32_t records = (uint32_t)pulseLog.segmentBudget() * LOG_SEGMENT_RECORDS;
+  for (int slot = 0; slot < users.count(); slot++) {
+    currentUserIndex = slot;
+    openUserHistory();
+    for (uint32_t i = 0; i < records; i++) {
+      hostAdvanceMillis(5000);
+      addPulseRecord(60 + (i * 7 + slot) % 40, 92 + (i * 3 + slot) % 8, i % 5 != 0);
+    }
+  }
+  currentUserIndex = saved;
+  openUserHistory();
+}
+
+void buildTrace(Device& device) {
+  const char* path = getenv("FIRMWARE_BENCH_TRACE");
+  if (path != nullptr && readTrace(path, device.trace) && !device.trace.empty()) {
+    return;
+  }
+  PpgSynthConfig signal;
+  signal.bpm = 68;
+  signal.variability = 0.05f;
+  signal.noise = 40;
+  signal.seed = 7;
+  signal.motion.push_back({ 120000, 135000, 0.02f });
+  signal.motion.push_back({ 400000, 402000, 0.05f });
+  PpgSynth synth(signal);
+  for (uint32_t t = 0; t < BENCH_TRACE_MS; t += SAMPLE_PERIOD_MS) {
+    PpgSample sample;
+    sample.timestamp = t;
+    synth.sample(t, sample.red, sample.ir);
+    device.trace.push_back(sample);
+  }
+}
+
+Device& device() {
+  static Device* device = nullptr;
+  if (device == nullptr) {
+    device = new Device();
+    installAssets(device->dir.path());
+    device->host.reset(new FirmwareHost(device->dir.path()));
+    buildUsers(*device->host);
+    buildHistories();
+    buildTrace(*device);
+    device->host->run(5000);
+  }
+  return *device;
+}
+
+// Очередной блок записи с метками времени от текущего момента; часы
+// уходят вперёд на длину блока, поэтому время у обработки не идёт назад
+size_t nextBlock(Device& device, PpgSample* block, size_t count) {
+  uint32_t now = millis();
+  for (size_t i = 0; i < count; i++) {
+    block[i] = device.trace[device.tracePosition];
+    block[i].timestamp = now + i * SAMPLE_PERIOD_MS;
+    device.tracePosition = (device.tracePosition + 1) % device.trace.size();
+  }
+  hostAdvanceMillis(count * SAMPLE_PERIOD_MS);
+  return count;
+}
+
+// Счётчики кучи и ввода-вывода между start() и report()
+class OpCounters {
+public:
+  void start() {
+    hostHeapResetCounters();
+    _fs = hostFsStats();
+    _wire = Wire.stats(OLED_ADDRESS);
+  }
+
+  void report(benchmark::State& state, uint64_t bodyBytes = 0) {
+    HostHeapStats heap = hostHeapStats();
+    HostFsStats fs = hostFsStats();
+    HostWireStats wire = Wire.stats(OLED_ADDRESS);
+    uint64_t io = bodyBytes + (fs.bytesRead - _fs.bytesRead) + (fs.bytesWritten - _fs.bytesWritten) +
+                  (wire.bytesWritten - _wire.bytesWritten);
+    state.counters["allocs"] = benchmark::Counter(heap.allocations, benchmark::Counter::kAvgIterations);
+    state.counters["alloc_bytes"] = benchmark::Counter(heap.allocatedBytes, benchmark::Counter::kAvgIterations);
+    state.counters["io_bytes"] = benchmark::Counter(io, benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  HostFsStats _fs;
+  HostWireStats _wire;
+};
+
+// Ответ на запрос без остального основного цикла: постановка в очередь,
+// обработчик и отдача тела серверу
+uint64_t request(FirmwareHost& host, const String& target, const HttpHeaders& headers = HttpHeaders(),
+                 int expected = 200) {
+  HttpHeaders all = headers;
+  all.emplace_back("Cookie", host.cookie);
+  HttpExchange exchange(server, HTTP_GET, target, String(), all);
+  webRequests.dispatch(1);
+  if (!exchange.receive() || !exchange.complete()) {
+    host.finish(exchange);
+  }
+  return exchange.status() == expected ? exchange.wireBytes() : 0;
+}
+
+}  // namespace
+
+static void BM_ReadSensorData(benchmark::State& state) {
+  Device& dev = device();
+  OpCounters counters;
+  PpgSample block[DSP_MAX_BLOCK];
+  counters.start();
+  for (auto _ : state) {
+    size_t count = nextBlock(dev, block, DSP_MAX_BLOCK);
+    for (size_t i = 0; i < count; i++) {
+      checkFingerPresence(block[i]);
+    }
+    readSensorData(block, count);
+  }
+  counters.report(state);
+  state.SetItemsProcessed(state.iterations() * DSP_MAX_BLOCK);
+}
+BENCHMARK(BM_ReadSensorData);
+
+// Только детектор ударов на той же записи: его доля в BM_ReadSensorData
+static void BM_BeatDetector(benchmark::State& state) {
+  Device& dev = device();
+  BeatDetector detector;
+  uint32_t ir[DSP_MAX_BLOCK];
+  uint32_t timestamps[DSP_MAX_BLOCK];
+  uint32_t now = 0;
+  size_t position = 0;
+  size_t beats = 0;
+  OpCounters counters;
+  counters.start();
+  for (auto _ : state) {
+    for (size_t i = 0; i < DSP_MAX_BLOCK; i++) {
+      ir[i] = dev.trace[position].ir;
+      timestamps[i] = now;
+      now += SAMPLE_PERIOD_MS;
+      position = (position + 1) % dev.trace.size();
+    }
+    beats += detector.addBlock(ir, timestamps, DSP_MAX_BLOCK);
+  }
+  benchmark::DoNotOptimize(beats);
+  counters.report(state);
+  state.SetItemsProcessed(state.iterations() * DSP_MAX_BLOCK);
+}
+BENCHMARK(BM_BeatDetector);
+
+static void BM_CalculateSpO2(benchmark::State& state) {
+  Device& dev = device();
+  OpCounters counters;
+  PpgSample block[DSP_MAX_BLOCK];
+  counters.start();
+  for (auto _ : state) {
+    calculateSpO2(block, nextBlock(dev, block, DSP_MAX_BLOCK));
+  }
+  counters.report(state);
+  state.SetItemsProcessed(state.iterations() * DSP_MAX_BLOCK);
+}
+BENCHMARK(BM_CalculateSpO2);
+
+// Прежний пакетный расчёт Maxim на том же сигнале: буфер 4 с на 25 Гц
+// пересчитывается целиком раз в секунду. На отсчёт 100 Гц, чтобы сравнивать
+// items_per_second с BM_CalculateSpO2.
+static void BM_Spo2BatchReference(benchmark::State& state) {
+  Device& dev = device();
+  uint32_t red[BUFFER_SIZE];
+  uint32_t ir[BUFFER_SIZE];
+  for (size_t i = 0; i < BUFFER_SIZE; i++) {
+    const PpgSample& sample = dev.trace[(i * SENSOR_OUTPUT_RATE / FreqS) % dev.trace.size()];
+    red[i] = sample.red;
+    ir[i] = sample.ir;
+  }
+  OpCounters counters;
+  counters.start();
+  for (auto _ : state) {
+    int32_t spo2;
+    int8_t spo2Valid;
+    int32_t heartRate;
+    int8_t heartRateValid;
+    maxim_heart_rate_and_oxygen_saturation(ir, BUFFER_SIZE, red, &spo2, &spo2Valid, &heartRate, &heartRateValid);
+    benchmark::DoNotOptimize(spo2);
+  }
+  counters.report(state);
+  state.SetItemsProcessed(state.iterations() * SENSOR_OUTPUT_RATE);
+}
+BENCHMARK(BM_Spo2BatchReference);
+
+static void BM_UpdateDisplay(benchmark::State& state) {
+  device();
+  OpCounters counters;
+  counters.start();
+  for (auto _ : state) {
+    hostAdvanceMillis(500);
+    updateDisplay();
+  }
+  counters.report(state);
+}
+BENCHMARK(BM_UpdateDisplay);
+
+static void BM_UpdateDisplayFull(benchmark::State& state) {
+  device();
+  OpCounters counters;
+  counters.start();
+  for (auto _ : state) {
+    displayFlusher.invalidate();
+    updateDisplay();
+  }
+  counters.report(state);
+}
+BENCHMARK(BM_UpdateDisplayFull);
+
+// Главный экран без остальной updateDisplay(): готовые глифы в буфер кадра
+// против прежнего вывода через Adafruit_GFX (попиксельно, printf)
+static void BM_GlyphHomeScreen(benchmark::State& state) {
+  static uint8_t frame[OLED_FRAME_SIZE];
+  oledGlyphCacheInit();
+  uint32_t second = 0;
+  OpCounters counters;
+  counters.start();
+  for (auto _ : state) {
+    memset(frame, 0, sizeof(frame));
+    oledDrawText(frame, 0, 0, "Health Monitoring");
+    oledDrawHLine(frame, 9);
+    uint8_t column = oledDrawText_P(frame, 2, 0, PSTR("Time: "));
+    column = oledDrawNumber(frame, 2, column, 12, 2);
+    column = oledDrawText_P(frame, 2, column, PSTR(":"));
+    column = oledDrawNumber(frame, 2, column, 34, 2);
+    column = oledDrawText_P(frame, 2, column, PSTR(":"));
+    oledDrawNumber(frame, 2, column, second++ % 60, 2);
+    oledDrawText_P(frame, 2, 95, PSTR("[A]"));
+    column = oledDrawText_P(frame, 3, 0, PSTR("Pulse: "));
+    column = oledDrawNumber(frame, 3, column, 72, 1);
+    oledDrawText_P(frame, 3, column, PSTR(" bpm"));
+    column = oledDrawText_P(frame, 4, 0, PSTR("SpO2: "));
+    column = oledDrawNumber(frame, 4, column, 97, 1);
+    oledDrawText_P(frame, 4, column, PSTR("%"));
+    column = oledDrawText_P(frame, 5, 0, PSTR("User: "));
+    oledDrawText(frame, 5, column, "user1");
+    column = oledDrawText_P(frame, 7, 0, PSTR("Alarm: "));
+    column = oledDrawNumber(frame, 7, column, 7, 2);
+    column = oledDrawText_P(frame, 7, column, PSTR(":"));
+    oledDrawNumber(frame, 7, column, 30, 2);
+    benchmark::DoNotOptimize(frame);
+  }
+  counters.report(state);
+}
+BENCHMARK(BM_GlyphHomeScreen);
+
+static void BM_GfxHomeScreen(benchmark::State& state) {
+  static Adafruit_SSD1306 screen(OLED_WIDTH, OLED_PAGES * 8, &Wire);
+  screen.begin(SSD1306_SWITCHCAPVCC, GLYPH_BENCH_ADDRESS);
+  uint32_t second = 0;
+  OpCounters counters;
+  counters.start();
+  for (auto _ : state) {
+    screen.clearDisplay();
+    screen.setTextSize(1);
+    screen.setTextColor(SSD1306_WHITE);
+    screen.setCursor(0, 0);
+    screen.println("Health Monitoring");
+    screen.drawLine(0, 9, screen.width(), 9, SSD1306_WHITE);
+    screen.setCursor(0, 12);
+    screen.printf("Time: %02d:%02d:%02d", 12, 34, (int)(second++ % 60));
+    screen.setCursor(95, 12);
+    screen.print("[A]");
+    screen.setCursor(0, 22);
+    screen.printf("Pulse: %d bpm\n", 72);
+    screen.printf("SpO2: %d%%\n", 97);
+    screen.print("User: ");
+    screen.println("user1");
+    screen.setCursor(0, 55);
+    screen.printf("Alarm: %02d:%02d", 7, 30);
+    benchmark::DoNotOptimize(screen.getBuffer());
+  }
+  counters.report(state);
+}
+BENCHMARK(BM_GfxHomeScreen);
+
+static void BM_GlyphNumber(benchmark::State& state) {
+  static uint8_t frame[OLED_FRAME_SIZE];
+  oledGlyphCacheInit();
+  uint32_t value = 0;
+  OpCounters counters;
+  counters.start();
+  for (auto _ : state) {
+    oledDrawNumber(frame, 3, 0, value++ % 1000, 2);
+    benchmark::DoNotOptimize(frame);
+  }
+  counters.report(state);
+}
+BENCHMARK(BM_GlyphNumber);
+
+static void BM_HandleData(benchmark::State& state) {
+  Device& dev = device();
+  // Часы замеров уходят далеко вперёд, сессия к этому моменту могла истечь
+  dev.host->login("admin", "admin");
+  OpCounters counters;
+  uint64_t wire = 0;
+  counters.start();
+  for (auto _ : state) {
+    wire += request(*dev.host, "/data");
+  }
+  counters.report(state, wire);
+}
+BENCHMARK(BM_HandleData);
+
+// Только обработчик /data и передача ответа серверу, без клиента вокруг:
+// время на ответ и выделения памяти, самое крупное - меньше тела
+static void BM_DataResponse(benchmark::State& state) {
+  Device& dev = device();
+  dev.host->login("admin", "admin");
+  HttpHeaders headers = { { "Cookie", dev.host->cookie } };
+  uint64_t allocations = 0;
+  uint64_t allocatedBytes = 0;
+  size_t largest = 0;
+  size_t body = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::unique_ptr<HttpExchange> exchange(new HttpExchange(server, HTTP_GET, "/data", String(), headers));
+    hostHeapResetCounters();
+    state.ResumeTiming();
+    webRequests.dispatch(1);
+    state.PauseTiming();
+    HostHeapStats heap = hostHeapStats();
+    allocations += heap.allocations;
+    allocatedBytes += heap.allocatedBytes;
+    largest = heap.largestAllocation > largest ? heap.largestAllocation : largest;
+    exchange->receive();
+    body = exchange->body().size();
+    exchange.reset();
+    state.ResumeTiming();
+  }
+  state.counters["allocs"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+  state.counters["alloc_bytes"] = benchmark::Counter(allocatedBytes, benchmark::Counter::kAvgIterations);
+  state.counters["largest_alloc"] = largest;
+  state.counters["body_bytes"] = body;
+}
+BENCHMARK(BM_DataResponse);
+
+// Страница интерфейса: первый заход и повторный с ETag (304 без тела)
+static void BM_ServeIndex(benchmark::State& state) {
+  Device& dev = device();
+  OpCounters counters;
+  uint64_t wire = 0;
+  counters.start();
+  for (auto _ : state) {
+    wire += request(*dev.host, "/");
+  }
+  counters.report(state, wire);
+}
+BENCHMARK(BM_ServeIndex)->Unit(benchmark::kMicrosecond);
+
+static void BM_ServeIndexNotModified(benchmark::State& state) {
+  Device& dev = device();
+  HttpExchange first(server, HTTP_GET, "/");
+  dev.host->finish(first);
+  HttpHeaders revalidate = { { "If-None-Match", first.header("ETag") } };
+  OpCounters counters;
+  uint64_t wire = 0;
+  counters.start();
+  for (auto _ : state) {
+    wire += request(*dev.host, "/", revalidate, 304);
+  }
+  counters.report(state, wire);
+}
+BENCHMARK(BM_ServeIndexNotModified);
+
+static void BM_HistoryDay(benchmark::State& state) {
+  Device& dev = device();
+  dev.host->login("admin", "admin");
+  String target = "/history?res=minute&from=" + String(logSeconds() - 86400);
+  OpCounters counters;
+  uint64_t wire = 0;
+  counters.start();
+  for (auto _ : state) {
+    wire += request(*dev.host, target);
+  }
+  counters.report(state, wire);
+}
+BENCHMARK(BM_HistoryDay)->Unit(benchmark::kMicrosecond);
+
+// Сутки записей, как synthetic_night() в tools/ppg_export.py: медленный
+// дрейф пульса и SpO2, шум, снятый палец и сбои качества
+void buildExportDay(PulseLog& log) {
+  std::mt19937 random(1);
+  std::normal_distribution<float> pulseNoise(0, 2);
+  std::normal_distribution<float> spo2Noise(0, 0.7f);
+  std::uniform_real_distribution<float> chance(0, 1);
+  std::uniform_int_distribution<uint32_t> gap(60, 1800);
+  uint32_t start = 100000;
+  for (uint32_t t = start; t < start + 86400; t += BENCH_EXPORT_INTERVAL) {
+    float phase = 2 * M_PI * (t % 86400) / 86400;
+    int pulse = 62 + 8 * sinf(phase) + pulseNoise(random);
+    int spo2 = std::min(100.0f, 96 + cosf(phase * 3) + spo2Noise(random));
+    log.append(BENCH_EXPORT_USER, t, std::min(220, std::max(30, pulse)), std::max(70, spo2), chance(random) > 0.05f);
+    if (chance(random) < 0.002f) {
+      t += gap(random);  // палец снят
+    }
+  }
+  log.flush();
+}
+
+// Выгрузка суток через настоящий ExportSession: кодирование блоков основным
+// циклом и чтение сервером порциями сегмента TCP. bytes_per_record - сжатие
+// (в журнале запись - 4 байта), items_per_second - записи
+static void BM_ExportDay(benchmark::State& state) {
+  Device& dev = device();
+  TempDir dir;
+  hostFsMount(dir.path());
+  PulseLog log;
+  log.begin(LittleFS, 1, 0);
+  buildExportDay(log);
+  uint8_t chunk[HTTP_WINDOW];
+  uint64_t bytes = 0;
+  uint32_t records = 0;
+  OpCounters counters;
+  counters.start();
+  for (auto _ : state) {
+    ExportSession session(log, BENCH_EXPORT_USER, 0, UINT32_MAX, 0);
+    while (true) {
+      session.pump();
+      size_t length = session.read(chunk, sizeof(chunk));
+      if (length == 0) {
+        break;
+      }
+      if (length != RESPONSE_TRY_AGAIN) {
+        bytes += length;
+      }
+    }
+    records = session.records();
+  }
+  counters.report(state, bytes);
+  state.counters["records"] = records;
+  state.counters["bytes_per_record"] = (double)bytes / state.iterations() / records;
+  state.SetItemsProcessed(state.iterations() * records);
+  state.SetBytesProcessed(bytes);
+
+  hostFsMount(dev.dir.path());
+}
+BENCHMARK(BM_ExportDay)->Unit(benchmark::kMillisecond);
+
+static void BM_SaveUsers(benchmark::State& state) {
+  device();
+  OpCounters counters;
+  counters.start();
+  for (auto _ : state) {
+    saveUsers();
+  }
+  counters.report(state);
+}
+BENCHMARK(BM_SaveUsers)->Unit(benchmark::kMicrosecond);
+
+static void skipUser(JsonObject entry, bool& migrated) {
+  benchmark::DoNotOptimize(entry);
+  (void)migrated;
+}
+
+// Загрузка users.json на state.range(0) записей из отдельного каталога: в
+// таблицу попадает не больше MAX_USERS, но разбирается файл целиком
+static void BM_LoadUsers(benchmark::State& state) {
+  Device& dev = device();
+  int count = state.range(0);
+  TempDir dir;
+  {
+    std::ofstream file(dir.path() + "/users.json", std::ios::binary);
+    file << "{\"count\":" << count << ",\"users\":[";
+    for (int i = 0; i < count; i++) {
+      char entry[256];
+      snprintf(entry, sizeof(entry),
+               "%s{\"id\":%d,\"username\":\"user%d\",\"salt\":\"%016x\",\"hash\":\"%064x\",\"bedtimeHour\":22,"
+               "\"bedtimeMinute\":30,\"wakeupHour\":7,\"wakeupMinute\":0,\"isAdmin\":false}",
+               i > 0 ? "," : "", i + 1, i, i * 7919, i);
+      file << entry;
+    }
+    file << "]}";
+  }
+  hostFsMount(dir.path());
+  OpCounters counters;
+  counters.start();
+  size_t length = 0;
+  for (auto _ : state) {
+    bool migrated = false;
+    length = readUsersFile(skipUser, migrated);
+    benchmark::DoNotOptimize(length);
+  }
+  counters.report(state);
+  state.counters["file_bytes"] = length;
+  state.SetItemsProcessed(state.iterations() * count);
+
+  // Обратно на файлы устройства; поколение users.json - снова его
+  hostFsMount(dev.dir.path());
+  bool migrated = false;
+  readUsersFile(skipUser, migrated);
+}
+BENCHMARK(BM_LoadUsers)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+static void BM_AddPulseRecord(benchmark::State& state) {
+  device();
+  OpCounters counters;
+  counters.start();
+  for (auto _ : state) {
+    hostAdvanceMillis(5000);
+    addPulseRecord(72, 97, true);
+  }
+  counters.report(state);
+}
+BENCHMARK(BM_AddPulseRecord);
+
+// Секунда работы устройства целиком: датчик, дисплей, события, сеть
+static void BM_LoopSecond(benchmark::State& state) {
+  Device& dev = device();
+  OpCounters counters;
+  counters.start();
+  for (auto _ : state) {
+    dev.host->run(1000);
+  }
+  counters.report(state);
+}
+BENCHMARK(BM_LoopSecond)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
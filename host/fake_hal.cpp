@@ -0,0 +1,222 @@
+#include "fake_hal.h"
+#include "crc32.h"
+
+#define REG_INT_STAT1 0x00
+#define REG_FIFO_CONFIG 0x08
+#define REG_MODE_CONFIG 0x09
+#define REG_REV_ID 0xFE
+#define REG_PART_ID 0xFF
+#define INT_A_FULL 0x80
+#define FIFO_ROLLOVER 0x10
+#define SSD1306_COLUMN_ADDR 0x21
+#define SSD1306_PAGE_ADDR 0x22
+#define SSD1306_CONTROL_DATA 0x40
+
+FakePpgSensor::FakePpgSensor(Clock& clock, PpgGenerator generator)
+  : _clock(clock), _generator(std::move(generator)) {
+}
+
+bool FakePpgSensor::begin() {
+  _startTime = _clock.millis();
+  _nextSampleTime = _startTime;
+  _head = 0;
+  _count = 0;
+  return true;
+}
+
+// Досчитывает отсчёты АЦП, накопившиеся с прошлого чтения
+void FakePpgSensor::produce() {
+  uint32_t now = _clock.millis();
+  if ((int32_t)(now - _nextSampleTime) < 0) {
+    return;
+  }
+  // Из долгой паузы в FIFO доживают только последние отсчёты, остальные
+  // сразу считаются потерянными и не вычисляются
+  uint32_t backlog = (now - _nextSampleTime) / SAMPLE_PERIOD_MS + 1;
+  if (backlog > MAX30102_FIFO_DEPTH) {
+    uint32_t skipped = backlog - MAX30102_FIFO_DEPTH;
+    _lost += skipped;
+    _produced += skipped;
+    _nextSampleTime += skipped * SAMPLE_PERIOD_MS;
+  }
+  while ((int32_t)(now - _nextSampleTime) >= 0) {
+    PpgSample sample;
+    sample.timestamp = _nextSampleTime;
+    _generator(_nextSampleTime - _startTime, sample.red, sample.ir);
+    if (_count == MAX30102_FIFO_DEPTH) {
+      // Rollover: новый отсчёт затирает самый старый
+      _head = (_head + 1) % MAX30102_FIFO_DEPTH;
+      _count--;
+      _lost++;
+    }
+    _fifo[(_head + _count) % MAX30102_FIFO_DEPTH] = sample;
+    _count++;
+    _produced++;
+    _nextSampleTime += SAMPLE_PERIOD_MS;
+  }
+}
+
+size_t FakePpgSensor::read(PpgSample* samples, size_t maxCount) {
+  produce();
+  size_t count = 0;
+  while (count < maxCount && _count > 0) {
+    samples[count++] = _fifo[_head];
+    _head = (_head + 1) % MAX30102_FIFO_DEPTH;
+    _count--;
+  }
+  return count;
+}
+
+size_t CaptureFrameSink::flush(const uint8_t* frame) {
+  memcpy(_last, frame, OLED_FRAME_SIZE);
+  _frames++;
+  size_t bytes = _next != nullptr ? _next->flush(frame) : OLED_FRAME_SIZE;
+  _bytes += bytes;
+  return bytes;
+}
+
+uint32_t CaptureFrameSink::lastCrc() const {
+  return crc32Update(0, _last, OLED_FRAME_SIZE);
+}
+
+FakeMax30102::FakeMax30102() {
+  _registers[REG_PART_ID] = 0x15;
+  _registers[REG_REV_ID] = 0x03;
+}
+
+void FakeMax30102::i2cWrite(const uint8_t* data, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  _pointer = data[0];
+  _byteInSample = 0;
+  for (size_t i = 1; i < length; i++) {
+    uint8_t value = data[i];
+    if (_pointer == REG_MODE_CONFIG && (value & 0x40)) {
+      // Программный сброс: регистры по умолчанию, бит сброса опускается сразу
+      memset(_registers, 0, 0xFE);
+      _stored = 0;
+      value &= ~0x40;
+    }
+    if (_pointer == MAX30102_FIFO_WR_PTR || _pointer == MAX30102_FIFO_RD_PTR) {
+      value &= 0x1F;
+      _stored = 0;  // запись указателей - очистка FIFO драйвером
+    }
+    if (_pointer != REG_PART_ID && _pointer != REG_REV_ID) {
+      _registers[_pointer] = value;
+    }
+    if (_pointer != MAX30102_FIFO_DATA) {
+      _pointer++;
+    }
+  }
+}
+
+size_t FakeMax30102::i2cRead(uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    if (_pointer != MAX30102_FIFO_DATA) {
+      data[i] = _registers[_pointer];
+      if (_pointer == REG_INT_STAT1) {
+        _registers[REG_INT_STAT1] = 0;  // чтение статуса сбрасывает прерывания
+      }
+      _pointer++;
+      continue;
+    }
+    uint8_t readPtr = _registers[MAX30102_FIFO_RD_PTR];
+    data[i] = _stored > 0 ? _fifo[readPtr][_byteInSample] : 0;
+    if (++_byteInSample == MAX30102_BYTES_PER_SAMPLE) {
+      _byteInSample = 0;
+      if (_stored > 0) {
+        _registers[MAX30102_FIFO_RD_PTR] = (readPtr + 1) % MAX30102_FIFO_DEPTH;
+        _registers[MAX30102_OVF_COUNTER] = 0;
+        _stored--;
+        _fifoReads++;
+      }
+    }
+  }
+  return length;
+}
+
+void FakeMax30102::pushSample(uint32_t red, uint32_t ir) {
+  uint8_t writePtr = _registers[MAX30102_FIFO_WR_PTR];
+  if (_stored == MAX30102_FIFO_DEPTH) {
+    if (_registers[MAX30102_OVF_COUNTER] < 0x1F) {
+      _registers[MAX30102_OVF_COUNTER]++;
+    }
+    if (!(_registers[REG_FIFO_CONFIG] & FIFO_ROLLOVER)) {
+      return;  // без rollover новый отсчёт теряется
+    }
+    // Rollover: самый старый отсчёт затирается, указатель чтения уходит вперёд
+    _registers[MAX30102_FIFO_RD_PTR] = (_registers[MAX30102_FIFO_RD_PTR] + 1) % MAX30102_FIFO_DEPTH;
+    _stored--;
+  }
+  uint8_t* sample = _fifo[writePtr];
+  sample[0] = (red >> 16) & 0x03;
+  sample[1] = red >> 8;
+  sample[2] = red;
+  sample[3] = (ir >> 16) & 0x03;
+  sample[4] = ir >> 8;
+  sample[5] = ir;
+  _registers[MAX30102_FIFO_WR_PTR] = (writePtr + 1) % MAX30102_FIFO_DEPTH;
+  _stored++;
+  // Прерывание "почти полон": свободных ячеек не больше FIFO_A_FULL
+  if (MAX30102_FIFO_DEPTH - _stored <= (_registers[REG_FIFO_CONFIG] & 0x0F)) {
+    _registers[REG_INT_STAT1] |= INT_A_FULL;
+  }
+}
+
+void FakeSsd1306::i2cWrite(const uint8_t* data, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  bool isData = data[0] == SSD1306_CONTROL_DATA;
+  for (size_t i = 1; i < length; i++) {
+    if (!isData) {
+      command(data[i]);
+      continue;
+    }
+    _ram[_page * OLED_WIDTH + _column] = data[i];
+    _dataBytes++;
+    // Горизонтальная адресация: по столбцам окна, затем следующая страница
+    if (_column++ >= _columnEnd) {
+      _column = _columnStart;
+      _page = _page >= _pageEnd ? _pageStart : _page + 1;
+    }
+  }
+}
+
+void FakeSsd1306::command(uint8_t byte) {
+  if (_pendingArguments > 0) {
+    if (_pendingCommand == SSD1306_COLUMN_ADDR) {
+      if (_argumentIndex == 0) {
+        _columnStart = byte & 0x7F;
+      } else {
+        _columnEnd = byte & 0x7F;
+        _column = _columnStart;
+      }
+    } else if (_pendingCommand == SSD1306_PAGE_ADDR) {
+      if (_argumentIndex == 0) {
+        _pageStart = byte & 0x07;
+      } else {
+        _pageEnd = byte & 0x07;
+        _page = _pageStart;
+      }
+    }
+    _argumentIndex++;
+    _pendingArguments--;
+    return;
+  }
+  _pendingCommand = byte;
+  _argumentIndex = 0;
+  switch (byte) {
+    case SSD1306_COLUMN_ADDR:
+    case SSD1306_PAGE_ADDR:
+      _pendingArguments = 2;
+      break;
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+      _pendingArguments = 1;
+      break;
+    default:
+      _pendingArguments = 0;
+      break;
+  }
+}
@@ -0,0 +1,146 @@
+// Поддельное оборудование за интерфейсами hal.h для сборки на Linux.
+//
+// FakeClock, FakePpgSensor и CaptureFrameSink подставляются в прошивку
+// вместо SystemClock, Max30102Sensor и OledFlusher. FakeMax30102 и
+// FakeSsd1306 - модели микросхем на шине Wire: с ними настоящие
+// Max30102Sensor и OledFlusher проверяются вместе с разбором регистров.
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <Wire.h>
+#include "hal.h"
+#include "max30102_sensor.h"
+#include "oled_renderer.h"
+
+// Часы прошивки поверх виртуального времени хоста (millis()/delay())
+class FakeClock : public Clock {
+public:
+  uint32_t millis() override {
+    return ::millis();
+  }
+  uint32_t micros() override {
+    return ::micros();
+  }
+  void advance(uint32_t ms) {
+    hostAdvanceMillis(ms);
+  }
+};
+
+// Значение каналов в момент t (мс от начала записи)
+typedef std::function<void(uint32_t t, uint32_t& red, uint32_t& ir)> PpgGenerator;
+
+// Датчик с FIFO на 32 отсчёта, как у MAX30102: отсчёты копятся с частотой
+// SENSOR_OUTPUT_RATE по часам, при переполнении старые теряются
+class FakePpgSensor : public PpgSensor {
+public:
+  FakePpgSensor(Clock& clock, PpgGenerator generator);
+
+  bool begin() override;
+  size_t read(PpgSample* samples, size_t maxCount) override;
+  uint32_t lostSamples() const override {
+    return _lost;
+  }
+
+  void setGenerator(PpgGenerator generator) {
+    _generator = std::move(generator);
+  }
+  uint32_t produced() const {
+    return _produced;
+  }
+
+private:
+  void produce();
+
+  Clock& _clock;
+  PpgGenerator _generator;
+  PpgSample _fifo[MAX30102_FIFO_DEPTH];
+  size_t _head = 0;
+  size_t _count = 0;
+  uint32_t _nextSampleTime = 0;  // мс, время следующего отсчёта АЦП
+  uint32_t _startTime = 0;
+  uint32_t _produced = 0;
+  uint32_t _lost = 0;
+};
+
+// Принимает кадры вместо дисплея; может передавать их дальше (OledFlusher)
+class CaptureFrameSink : public FrameSink {
+public:
+  explicit CaptureFrameSink(FrameSink* next = nullptr) : _next(next) {}
+
+  size_t flush(const uint8_t* frame) override;
+
+  uint32_t frames() const {
+    return _frames;
+  }
+  const uint8_t* lastFrame() const {
+    return _last;
+  }
+  uint32_t lastCrc() const;
+  uint64_t bytesSent() const {
+    return _bytes;
+  }
+
+private:
+  FrameSink* _next;
+  uint8_t _last[OLED_FRAME_SIZE] = {};
+  uint32_t _frames = 0;
+  uint64_t _bytes = 0;
+};
+
+// Модель MAX30102 на шине: регистровый файл, FIFO на 32 отсчёта с
+// указателями записи и чтения, счётчиком переполнения и битом rollover
+class FakeMax30102 : public I2cDevice {
+public:
+  FakeMax30102();
+
+  void i2cWrite(const uint8_t* data, size_t length) override;
+  size_t i2cRead(uint8_t* data, size_t length) override;
+
+  // Датчик оцифровал очередной отсчёт (18 бит на канал)
+  void pushSample(uint32_t red, uint32_t ir);
+  uint8_t reg(uint8_t address) const {
+    return _registers[address];
+  }
+  uint32_t fifoReads() const {
+    return _fifoReads;
+  }
+
+private:
+  uint8_t _registers[256] = {};
+  uint8_t _pointer = 0;
+  uint8_t _fifo[MAX30102_FIFO_DEPTH][MAX30102_BYTES_PER_SAMPLE] = {};
+  uint8_t _byteInSample = 0;  // позиция чтения внутри отсчёта FIFO_DATA
+  uint8_t _stored = 0;        // отсчётов в FIFO: при WR_PTR == RD_PTR пуст или полон
+  uint32_t _fifoReads = 0;
+};
+
+// Модель SSD1306: разбирает команды окна адресации и пишет данные в ОЗУ экрана
+class FakeSsd1306 : public I2cDevice {
+public:
+  void i2cWrite(const uint8_t* data, size_t length) override;
+  size_t i2cRead(uint8_t* data, size_t length) override {
+    (void)data;
+    (void)length;
+    return 0;
+  }
+
+  const uint8_t* gddram() const {
+    return _ram;
+  }
+  uint64_t dataBytes() const {
+    return _dataBytes;
+  }
+
+private:
+  void command(uint8_t byte);
+
+  uint8_t _ram[OLED_FRAME_SIZE] = {};
+  uint8_t _columnStart = 0, _columnEnd = OLED_WIDTH - 1;
+  uint8_t _pageStart = 0, _pageEnd = OLED_PAGES - 1;
+  uint8_t _column = 0, _page = 0;
+  uint8_t _pendingCommand = 0;
+  uint8_t _pendingArguments = 0;
+  uint8_t _argumentIndex = 0;
+  uint64_t _dataBytes = 0;
+};
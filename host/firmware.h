@@ -0,0 +1,52 @@
+// Объявления из file.cpp, нужные коду хоста: точки входа скетча и
+// глобальные объекты прошивки. В самом скетче их объявляет компилятор
+// Arduino, поэтому отдельного заголовка у file.cpp нет.
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+#include "hal.h"
+#include "oled_renderer.h"
+#include "request_queue.h"
+#include "event_stream.h"
+#include "task_scheduler.h"
+#include "toast_queue.h"
+#include "pulse_log.h"
+#include "user_table.h"
+#include <ArduinoJson.h>
+
+void setup();
+void loop();
+
+// Горячие пути для замеров
+void checkFingerPresence(const PpgSample& sample);
+void readSensorData(const PpgSample* samples, size_t count);
+void calculateSpO2(const PpgSample* samples, size_t count);
+void updateDisplay();
+void saveUsers();
+size_t readUsersFile(void (*visit)(JsonObject, bool&), bool& migrated);
+void addPulseRecord(int pulseVal, int spo2Val, bool quality);
+void openUserHistory();
+uint32_t logSeconds();
+int findUser(const String& username);
+bool showToast(const char* title, const char* text, uint8_t priority, unsigned long duration, uint8_t textSize);
+
+extern Clock* deviceClock;
+extern PpgSensor* sensor;
+extern FrameSink* frameSink;
+extern OledFlusher displayFlusher;
+
+extern AsyncWebServer server;
+extern RequestQueue webRequests;
+extern EventStream eventStream;
+extern TaskScheduler scheduler;
+extern ToastQueue toasts;
+
+extern volatile int pulse;
+extern volatile int spo2;
+extern bool beatDetected;
+extern bool fingerPresent;
+extern uint32_t samplesAcquired;
+extern uint32_t ringDroppedSamples;
+extern int currentUserIndex;
+extern UserTable users;
+extern PulseLog pulseLog;
@@ -0,0 +1,110 @@
+#include "firmware_host.h"
+
+#include <ftw.h>
+#include <stdlib.h>
+#include <LittleFS.h>
+
+#define OLED_ADDRESS 0x3C
+
+FirmwareHost::FirmwareHost(const std::string& fsRoot, const PpgSynthConfig& signal)
+  : ppg(clock, nullptr), frames(&displayFlusher) {
+  hostFsMount(fsRoot);
+  setSignal(signal);
+  boot(ppg);
+}
+
+FirmwareHost::FirmwareHost(const std::string& fsRoot, PpgSensor& source)
+  : ppg(clock, nullptr), frames(&displayFlusher) {
+  hostFsMount(fsRoot);
+  boot(source);
+}
+
+void FirmwareHost::boot(PpgSensor& source) {
+  Wire.attach(OLED_ADDRESS, &oled);
+  deviceClock = &clock;
+  sensor = &source;
+  frameSink = &frames;
+  setup();
+  hostHeapMarkBoot();
+}
+
+void FirmwareHost::setSignal(const PpgSynthConfig& signal) {
+  _synth.reset(new PpgSynth(signal));
+  PpgSynth* synth = _synth.get();
+  ppg.setGenerator([synth](uint32_t t, uint32_t& red, uint32_t& ir) {
+    synth->sample(t, red, ir);
+  });
+}
+
+void FirmwareHost::run(uint32_t ms) {
+  uint32_t end = clock.millis() + ms;
+  while ((int32_t)(clock.millis() - end) < 0) {
+    loop();
+  }
+}
+
+std::unique_ptr<HttpExchange> FirmwareHost::open(WebRequestMethod method, const String& target, const String& form,
+                                                 const HttpHeaders& headers) {
+  HttpHeaders all = headers;
+  if (cookie.length() > 0) {
+    all.emplace_back("Cookie", cookie);
+  }
+  return std::unique_ptr<HttpExchange>(new HttpExchange(server, method, target, form, all));
+}
+
+bool FirmwareHost::finish(HttpExchange& exchange, uint32_t timeoutMs) {
+  uint32_t start = clock.millis();
+  while (!exchange.complete() && clock.millis() - start < timeoutMs) {
+    exchange.receive();
+    if (!exchange.complete()) {
+      loop();
+    }
+  }
+  rememberCookie(exchange);
+  return exchange.complete();
+}
+
+std::unique_ptr<HttpExchange> FirmwareHost::get(const String& target, uint32_t timeoutMs) {
+  std::unique_ptr<HttpExchange> exchange = open(HTTP_GET, target);
+  finish(*exchange, timeoutMs);
+  return exchange;
+}
+
+std::unique_ptr<HttpExchange> FirmwareHost::post(const String& target, const String& form, uint32_t timeoutMs) {
+  std::unique_ptr<HttpExchange> exchange = open(HTTP_POST, target, form);
+  finish(*exchange, timeoutMs);
+  return exchange;
+}
+
+bool FirmwareHost::login(const String& username, const String& password) {
+  std::unique_ptr<HttpExchange> exchange = post("/login", "username=" + username + "&password=" + password);
+  return exchange->complete() && cookie.length() > 0;
+}
+
+void FirmwareHost::rememberCookie(const HttpExchange& exchange) {
+  String value = exchange.header("Set-Cookie");
+  if (value.length() == 0) {
+    return;
+  }
+  int end = value.indexOf(';');
+  String pair = end < 0 ? value : value.substring(0, end);
+  // Пустое значение - сервер удалил сессию
+  cookie = pair.endsWith("=") ? String() : pair;
+}
+
+TempDir::TempDir() {
+  char name[] = "/tmp/firmware-XXXXXX";
+  if (mkdtemp(name) != nullptr) {
+    _path = name;
+  }
+}
+
+static int removeEntry(const char* path, const struct stat*, int, struct FTW*) {
+  return remove(path);
+}
+
+TempDir::~TempDir() {
+  if (!_path.empty()) {
+    nftw(_path.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+  }
+}
@@ -0,0 +1,70 @@
+// Прошивка целиком на Linux: setup()/loop() из file.cpp на виртуальном
+// времени, с поддельным датчиком и дисплеем и файловой системой в каталоге
+// хоста. Простой основного цикла (delay) не ждёт, а сразу переводит часы,
+// поэтому сутки работы проходят за секунды.
+//
+// Глобальные объекты скетча создаются один раз на процесс, поэтому каждая
+// загрузка прошивки в тестах идёт в отдельном дочернем процессе
+// (run_device.h). Несколько загрузок подряд на одном каталоге - перезагрузки
+// устройства с сохранённой файловой системой.
+#pragma once
+
+#include <memory>
+#include <string>
+#include "fake_hal.h"
+#include "firmware.h"
+#include "http_client.h"
+#include "ppg_synth.h"
+
+class FirmwareHost {
+public:
+  // Монтирует fsRoot как LittleFS и выполняет setup()
+  explicit FirmwareHost(const std::string& fsRoot, const PpgSynthConfig& signal = PpgSynthConfig());
+  // То же с другим источником отсчётов вместо синтетического сигнала
+  FirmwareHost(const std::string& fsRoot, PpgSensor& source);
+
+  // Крутит loop(), пока виртуальные часы не уйдут на ms вперёд
+  void run(uint32_t ms);
+
+  // Запрос, выполненный до конца: крутит loop(), пока ответ не отдан целиком
+  // или не прошло timeoutMs. Cookie сессии запоминается, как в браузере
+  std::unique_ptr<HttpExchange> get(const String& target, uint32_t timeoutMs = 10000);
+  std::unique_ptr<HttpExchange> post(const String& target, const String& form, uint32_t timeoutMs = 10000);
+  // Запрос без ожидания ответа; headers - заголовки сверх cookie
+  std::unique_ptr<HttpExchange> open(WebRequestMethod method, const String& target, const String& form = String(),
+                                     const HttpHeaders& headers = HttpHeaders());
+  bool finish(HttpExchange& exchange, uint32_t timeoutMs = 10000);
+
+  bool login(const String& username, const String& password);
+
+  // Новый сигнал с текущего момента
+  void setSignal(const PpgSynthConfig& signal);
+  PpgSynth& synth() {
+    return *_synth;
+  }
+
+  FakeClock clock;
+  FakePpgSensor ppg;
+  FakeSsd1306 oled;
+  CaptureFrameSink frames;
+  String cookie;
+
+private:
+  void boot(PpgSensor& source);
+  void rememberCookie(const HttpExchange& exchange);
+
+  std::unique_ptr<PpgSynth> _synth;
+};
+
+// Временный каталог, удаляется вместе с содержимым
+class TempDir {
+public:
+  TempDir();
+  ~TempDir();
+  const std::string& path() const {
+    return _path;
+  }
+
+private:
+  std::string _path;
+};
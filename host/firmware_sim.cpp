@@ -0,0 +1,56 @@
+// Прогон прошивки на записанном сигнале на компьютере (simulation.h)
+//
+//   firmware_sim --trace trace.csv [--script script.txt] --out DIR
+//   firmware_sim --synth-hours 24 [--script script.txt] --out DIR
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "simulation.h"
+
+static int usage() {
+  fprintf(stderr,
+          "usage: firmware_sim (--trace FILE | --synth-hours H) [--script FILE] --out DIR\n"
+          "  --trace FILE        recorded RED/IR samples, \"t_ms,red,ir\" lines or PPGT binary\n"
+          "  --synth-hours H     synthetic 72 bpm / 97%% signal instead of a trace\n"
+          "  --script FILE       HTTP requests, \"<ms> [GET|POST] <route>[?args]\" per line\n"
+          "  --out DIR           output.txt and the device filesystem (DIR/fs)\n");
+  return 2;
+}
+
+int main(int argc, char** argv) {
+  SimulationOptions options;
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      return usage();
+    }
+    if (strcmp(argv[i], "--trace") == 0) {
+      options.trace = argv[++i];
+    } else if (strcmp(argv[i], "--synth-hours") == 0) {
+      options.synthMs = (uint32_t)(atof(argv[++i]) * 3600000);
+    } else if (strcmp(argv[i], "--script") == 0) {
+      options.script = argv[++i];
+    } else if (strcmp(argv[i], "--out") == 0) {
+      options.out = argv[++i];
+    } else {
+      return usage();
+    }
+  }
+  if (options.out.empty() || options.trace.empty() == (options.synthMs == 0)) {
+    return usage();
+  }
+
+  timespec begin;
+  timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+  SimulationResult result = runSimulation(options);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  if (!result.ok) {
+    fprintf(stderr, "firmware_sim: %s\n", result.error.c_str());
+    return 1;
+  }
+  double seconds = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+  printf("simulated %.1f min in %.2f s: %lu samples, %lu dropped, %lu requests\n", result.durationMs / 60000.0,
+         seconds, (unsigned long)result.samples, (unsigned long)result.dropped, (unsigned long)result.requests);
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include "http_client.h"
+
+HttpExchange::HttpExchange(AsyncWebServer& server, WebRequestMethod method, const String& target,
+                           const String& form, const HttpHeaders& headers) {
+  int question = target.indexOf('?');
+  String path = question < 0 ? target : target.substring(0, question);
+  String query = question < 0 ? String() : target.substring(question + 1);
+  _request.reset(new AsyncWebServerRequest(method, path, query, form));
+  for (const auto& header : headers) {
+    _request->addHeader(header.first, header.second);
+  }
+  server.handleRequest(_request.get());
+}
+
+bool HttpExchange::receive(size_t maxBytes, size_t window) {
+  AsyncWebServerResponse* response = _request->response();
+  if (response == nullptr || _complete) {
+    return false;
+  }
+  if (!_headSent) {
+    _wireBytes += response->head().length();
+    _headSent = true;
+  }
+  bool received = false;
+  // Окно и полученное тело - память клиента, а не устройства
+  std::vector<uint8_t> buffer;
+  {
+    HostHeapExclude client;
+    buffer.resize(window);
+  }
+  size_t taken = 0;
+  while (taken < maxBytes) {
+    size_t length = response->fillBody(buffer.data(), std::min(window, maxBytes - taken));
+    _fills++;
+    if (length == RESPONSE_TRY_AGAIN) {
+      break;
+    }
+    if (length == 0) {
+      if (response->chunked()) {
+        _wireBytes += 5;  // "0\r\n\r\n"
+      }
+      _complete = true;
+      break;
+    }
+    if (response->chunked()) {
+      char size[12];
+      _wireBytes += snprintf(size, sizeof(size), "%zx\r\n", length) + 2;
+    }
+    {
+      HostHeapExclude client;
+      _body.append((const char*)buffer.data(), length);
+    }
+    _wireBytes += length;
+    taken += length;
+    received = true;
+  }
+  return received;
+}
+
+void HttpExchange::disconnect() {
+  _request->disconnect();
+}
+
+int HttpExchange::status() const {
+  AsyncWebServerResponse* response = _request->response();
+  return response != nullptr ? response->code() : 0;
+}
+
+String HttpExchange::header(const char* name) const {
+  AsyncWebServerResponse* response = _request->response();
+  if (response == nullptr) {
+    return String();
+  }
+  if (strcasecmp(name, "Content-Type") == 0) {
+    return response->contentType();
+  }
+  for (const AsyncWebHeader& header : response->headers()) {
+    if (header.name().equalsIgnoreCase(name)) {
+      return header.value();
+    }
+  }
+  return String();
+}
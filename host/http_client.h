@@ -0,0 +1,59 @@
+// Клиент HTTP для тестов без сокетов: запрос передаётся серверу прошивки
+// через AsyncWebServer::handleRequest(), тело ответа забирается порциями
+// через fillBody(), как это делает библиотека при освобождении окна TCP.
+// Байты на проводе считаются вместе со строкой состояния, заголовками и
+// разметкой chunked.
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ESPAsyncWebServer.h>
+
+typedef std::vector<std::pair<String, String>> HttpHeaders;
+
+#define HTTP_WINDOW 1460  // байт за одну отдачу, как у сегмента TCP
+
+class HttpExchange {
+public:
+  // target - путь со строкой запроса ("/history?range=day"), form - тело POST
+  HttpExchange(AsyncWebServer& server, WebRequestMethod method, const String& target,
+               const String& form = String(), const HttpHeaders& headers = HttpHeaders());
+
+  // Ответ назначен (send() уже вызван)
+  bool answered() const {
+    return _request->response() != nullptr;
+  }
+  // Забирает тело, пока оно есть, но не больше maxBytes; true - что-то пришло
+  bool receive(size_t maxBytes = SIZE_MAX, size_t window = HTTP_WINDOW);
+  bool complete() const {
+    return _complete;
+  }
+  // Клиент закрыл соединение
+  void disconnect();
+
+  int status() const;
+  String header(const char* name) const;
+  const std::string& body() const {
+    return _body;
+  }
+  // Всё, что ушло бы в сокет: заголовки и тело с разметкой chunked
+  size_t wireBytes() const {
+    return _wireBytes;
+  }
+  size_t fills() const {
+    return _fills;
+  }
+  AsyncWebServerRequest* request() const {
+    return _request.get();
+  }
+
+private:
+  std::unique_ptr<AsyncWebServerRequest> _request;
+  std::string _body;
+  size_t _wireBytes = 0;
+  size_t _fills = 0;
+  bool _headSent = false;
+  bool _complete = false;
+};
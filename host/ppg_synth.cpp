@@ -0,0 +1,87 @@
+#include "ppg_synth.h"
+
+#include <math.h>
+
+// Систолический пик приходится на эту долю интервала между ударами
+#define SYSTOLIC_PHASE 0.15f
+
+PpgSynth::PpgSynth(const PpgSynthConfig& config)
+  : _config(config), _ratio(ratioForSpo2(config.spo2)), _random(config.seed), _noise(0, 1) {
+  _beatLength = (uint32_t)(60000 / _config.bpm);
+}
+
+float PpgSynth::ratioForSpo2(float spo2) {
+  // Рабочая ветвь кривой убывает на [0.34, 1.8]: делим отрезок пополам
+  float low = 0.34f;
+  float high = 1.8f;
+  for (int i = 0; i < 40; i++) {
+    float middle = (low + high) / 2;
+    float value = -45.060f * middle * middle + 30.354f * middle + 94.845f;
+    if (value > spo2) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  return (low + high) / 2;
+}
+
+bool PpgSynth::inside(const std::vector<PpgSegment>& segments, uint32_t t, float* amplitude) {
+  for (const PpgSegment& segment : segments) {
+    if (t >= segment.start && t < segment.end) {
+      if (amplitude != nullptr) {
+        *amplitude = segment.amplitude;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+// Форма пульсовой волны, 0..1: систолический пик и дикротическая волна
+float PpgSynth::pulseShape(float phase) const {
+  float systolic = (phase - SYSTOLIC_PHASE) / 0.07f;
+  float dicrotic = (phase - 0.45f) / 0.09f;
+  return expf(-systolic * systolic / 2) + 0.3f * expf(-dicrotic * dicrotic / 2);
+}
+
+void PpgSynth::sample(uint32_t t, uint32_t& red, uint32_t& ir) {
+  while (t >= _beatStart + _beatLength) {
+    _beatStart += _beatLength;
+    float jitter = _config.variability * _noise(_random);
+    _beatLength = (uint32_t)(60000 / _config.bpm * (1 + jitter));
+  }
+  if (_beats.empty() || _beats.back() < _beatStart + (uint32_t)(SYSTOLIC_PHASE * _beatLength)) {
+    uint32_t peak = _beatStart + (uint32_t)(SYSTOLIC_PHASE * _beatLength);
+    if (peak <= t) {
+      _beats.push_back(peak);
+    }
+  }
+
+  if (inside(_config.noFinger, t)) {
+    // Без пальца до фотодиода доходит только рассеянный свет
+    red = 300 + (uint32_t)fabsf(_noise(_random) * 30);
+    ir = 400 + (uint32_t)fabsf(_noise(_random) * 30);
+    return;
+  }
+
+  float shape = pulseShape((float)(t - _beatStart) / _beatLength);
+  // Кровь в систолу поглощает больше света: сигнал проседает
+  float irLevel = _config.irDc * (1 - _config.perfusion * shape);
+  float redLevel = _config.redDc * (1 - _config.perfusion * _ratio * shape);
+
+  float amplitude = 0;
+  if (inside(_config.motion, t, &amplitude)) {
+    // Движение: медленный дрейф и рывки, одинаковые в обоих каналах
+    _motionPhase += 0.013f + 0.01f * fabsf(_noise(_random));
+    float artifact = amplitude * (sinf(_motionPhase * 6.28f) + 0.5f * _noise(_random));
+    irLevel += _config.irDc * artifact;
+    redLevel += _config.redDc * artifact;
+  }
+
+  irLevel += _config.noise * _noise(_random);
+  redLevel += _config.noise * _noise(_random);
+  const float adcMax = 262143;
+  ir = (uint32_t)fminf(fmaxf(irLevel, 0), adcMax);
+  red = (uint32_t)fminf(fmaxf(redLevel, 0), adcMax);
+}
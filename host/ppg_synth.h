@@ -0,0 +1,58 @@
+// Синтетический сигнал MAX30102 для тестов и замеров: пульсовая волна с
+// заданными частотой, вариабельностью и SpO2, шум, участки движения и
+// участки без пальца. Известны точные моменты ударов - с ними сверяются
+// детектор пульса и индекс качества.
+#pragma once
+
+#include <stdint.h>
+#include <random>
+#include <vector>
+
+struct PpgSegment {
+  uint32_t start;  // мс
+  uint32_t end;    // мс, не включая
+  float amplitude; // для движения: размах помехи относительно DC
+};
+
+struct PpgSynthConfig {
+  float bpm = 72;
+  float variability = 0.03f;   // разброс интервалов между ударами, доля
+  float spo2 = 97;
+  uint32_t irDc = 80000;
+  uint32_t redDc = 60000;
+  float perfusion = 0.015f;    // AC/DC канала IR
+  float noise = 20;            // СКО белого шума, единицы АЦП
+  uint32_t seed = 1;
+  std::vector<PpgSegment> motion;
+  std::vector<PpgSegment> noFinger;
+};
+
+class PpgSynth {
+public:
+  explicit PpgSynth(const PpgSynthConfig& config);
+
+  // Значения каналов в момент t (мс); t не должно убывать между вызовами
+  void sample(uint32_t t, uint32_t& red, uint32_t& ir);
+
+  // Моменты систолических пиков, пройденные к последнему вызову sample()
+  const std::vector<uint32_t>& beats() const {
+    return _beats;
+  }
+
+  // R = (AC/DC красного) / (AC/DC ИК), дающее spo2 по кривой Maxim
+  static float ratioForSpo2(float spo2);
+
+  static bool inside(const std::vector<PpgSegment>& segments, uint32_t t, float* amplitude = nullptr);
+
+private:
+  float pulseShape(float phase) const;
+
+  PpgSynthConfig _config;
+  float _ratio;
+  std::mt19937 _random;
+  std::normal_distribution<float> _noise;
+  uint32_t _beatStart = 0;
+  uint32_t _beatLength;
+  std::vector<uint32_t> _beats;
+  float _motionPhase = 0;
+};
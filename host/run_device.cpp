@@ -0,0 +1,79 @@
+#include "run_device.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+// Передаёт провалы проверок из дочернего процесса родителю записями
+// "файл\x1fстрока\x1fсообщение\x1e"
+class PipeReporter : public ::testing::EmptyTestEventListener {
+public:
+  explicit PipeReporter(int fd) : _fd(fd) {}
+
+  void OnTestPartResult(const ::testing::TestPartResult& result) override {
+    if (!result.failed()) {
+      return;
+    }
+    std::string record = result.file_name() != nullptr ? result.file_name() : "";
+    record += '\x1f';
+    record += std::to_string(result.line_number());
+    record += '\x1f';
+    record += result.message();
+    record += '\x1e';
+    ssize_t written = write(_fd, record.data(), record.size());
+    (void)written;
+  }
+
+private:
+  int _fd;
+};
+
+}  // namespace
+
+void runDevice(const std::function<void()>& body) {
+  fflush(stdout);
+  fflush(stderr);
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    close(fds[0]);
+    ::testing::UnitTest::GetInstance()->listeners().Append(new PipeReporter(fds[1]));
+    body();
+    fflush(stdout);
+    _exit(0);
+  }
+  close(fds[1]);
+  std::string reports;
+  char buffer[4096];
+  ssize_t length;
+  while ((length = read(fds[0], buffer, sizeof(buffer))) > 0) {
+    reports.append(buffer, length);
+  }
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+
+  size_t start = 0;
+  size_t end;
+  while ((end = reports.find('\x1e', start)) != std::string::npos) {
+    std::string record = reports.substr(start, end - start);
+    size_t first = record.find('\x1f');
+    size_t second = record.find('\x1f', first + 1);
+    std::string file = record.substr(0, first);
+    int line = atoi(record.substr(first + 1, second - first - 1).c_str());
+    ADD_FAILURE_AT(file.c_str(), line) << record.substr(second + 1);
+    start = end + 1;
+  }
+  if (WIFSIGNALED(status)) {
+    ADD_FAILURE() << "device process killed by signal " << strsignal(WTERMSIG(status));
+  } else if (WEXITSTATUS(status) != 0) {
+    ADD_FAILURE() << "device process exited with status " << WEXITSTATUS(status);
+  }
+}
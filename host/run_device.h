@@ -0,0 +1,8 @@
+// Загрузка прошивки в отдельном процессе для тестов gtest
+#pragma once
+
+#include <functional>
+
+// Выполняет body в дочернем процессе; провалы проверок gtest из него
+// переносятся в текущий тест, падение процесса тоже считается провалом
+void runDevice(const std::function<void()>& body);
@@ -0,0 +1,162 @@
+#include "simulation.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "crc32.h"
+#include "firmware_host.h"
+#include "trace_sensor.h"
+
+namespace {
+
+struct ScriptRequest {
+  uint32_t time;
+  WebRequestMethod method;
+  std::string target;
+};
+
+bool readScript(const std::string& path, std::vector<ScriptRequest>& requests, std::string& error) {
+  FILE* file = fopen(path.c_str(), "r");
+  if (file == nullptr) {
+    error = "cannot open script " + path;
+    return false;
+  }
+  char line[512];
+  int number = 0;
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    number++;
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] < '0' || line[0] > '9') {
+      continue;
+    }
+    char method[8] = "GET";
+    char target[sizeof(line)];
+    unsigned long time;
+    int fields = sscanf(line, "%lu %7s %511s", &time, method, target);
+    if (fields == 3 && strcmp(method, "GET") != 0 && strcmp(method, "POST") != 0) {
+      fields = 0;
+    }
+    if (fields != 3) {
+      strcpy(method, "GET");
+      if (sscanf(line, "%lu %511s", &time, target) != 2) {
+        error = path + ":" + std::to_string(number) + ": expected \"<ms> [GET|POST] <route>\"";
+        fclose(file);
+        return false;
+      }
+    }
+    ScriptRequest request;
+    request.time = time;
+    request.method = strcmp(method, "POST") == 0 ? HTTP_POST : HTTP_GET;
+    request.target = target;
+    if (!requests.empty() && request.time < requests.back().time) {
+      error = path + ":" + std::to_string(number) + ": requests must be in time order";
+      fclose(file);
+      return false;
+    }
+    requests.push_back(request);
+  }
+  fclose(file);
+  return true;
+}
+
+// Пишет CRC-32 каждого изменившегося кадра и передаёт кадр дальше
+class RecordingFrameSink : public FrameSink {
+public:
+  RecordingFrameSink(FrameSink& target, FILE* output) : _target(target), _output(output) {}
+
+  size_t flush(const uint8_t* frame) override {
+    uint32_t crc = crc32Update(0, frame, OLED_FRAME_SIZE);
+    if (crc != _lastCrc) {
+      fprintf(_output, "%lu frame %08lx\n", (unsigned long)millis(), (unsigned long)crc);
+    }
+    _lastCrc = crc;
+    return _target.flush(frame);
+  }
+
+private:
+  FrameSink& _target;
+  FILE* _output;
+  uint32_t _lastCrc = 0;
+};
+
+}  // namespace
+
+SimulationResult runSimulation(const SimulationOptions& options) {
+  SimulationResult result;
+  std::vector<ScriptRequest> requests;
+  if (!options.script.empty() && !readScript(options.script, requests, result.error)) {
+    return result;
+  }
+  if (mkdir(options.out.c_str(), 0755) != 0 && errno != EEXIST) {
+    result.error = "cannot create " + options.out;
+    return result;
+  }
+  std::string fsRoot = options.out + "/fs";
+  mkdir(fsRoot.c_str(), 0755);
+  FILE* output = fopen((options.out + "/output.txt").c_str(), "w");
+  if (output == nullptr) {
+    result.error = "cannot create " + options.out + "/output.txt";
+    return result;
+  }
+
+  // setup() ждёт вечно, если датчик не запустился, поэтому запись проверяется заранее
+  if (!options.trace.empty() && access(options.trace.c_str(), R_OK) != 0) {
+    result.error = "cannot read trace " + options.trace;
+    fclose(output);
+    return result;
+  }
+  FakeClock traceClock;
+  TraceSensor trace(options.trace, traceClock);
+  std::unique_ptr<FirmwareHost> host;
+  if (options.trace.empty()) {
+    host.reset(new FirmwareHost(fsRoot));
+  } else {
+    host.reset(new FirmwareHost(fsRoot, trace));
+  }
+  RecordingFrameSink recorder(host->frames, output);
+  frameSink = &recorder;
+
+  uint32_t start = host->clock.millis();
+  size_t next = 0;
+  while (true) {
+    uint32_t elapsed = host->clock.millis() - start;
+    while (next < requests.size() && requests[next].time <= elapsed) {
+      const ScriptRequest& request = requests[next++];
+      String target(request.target.c_str());
+      std::unique_ptr<HttpExchange> exchange;
+      if (request.method == HTTP_POST) {
+        int question = target.indexOf('?');
+        String form = question < 0 ? String() : target.substring(question + 1);
+        exchange = host->post(question < 0 ? target : target.substring(0, question), form);
+      } else {
+        exchange = host->get(target);
+      }
+      fprintf(output, "%lu %s %d %s\n", (unsigned long)elapsed, request.target.c_str(), exchange->status(),
+              exchange->body().c_str());
+      result.requests++;
+    }
+    bool signalDone = options.trace.empty() ? elapsed >= options.synthMs : trace.finished();
+    if (signalDone && next == requests.size()) {
+      break;
+    }
+    uint32_t step = 1000;
+    if (next < requests.size() && requests[next].time - elapsed < step) {
+      step = requests[next].time - elapsed;
+    }
+    host->run(step > 0 ? step : 1);
+  }
+
+  result.durationMs = host->clock.millis() - start;
+  result.samples = samplesAcquired;
+  result.dropped = ringDroppedSamples;
+  fprintf(output, "%lu end samples=%lu dropped=%lu\n", (unsigned long)result.durationMs,
+          (unsigned long)result.samples, (unsigned long)result.dropped);
+  frameSink = &host->frames;
+  result.ok = fclose(output) == 0;
+  if (!result.ok) {
+    result.error = "cannot write " + options.out + "/output.txt";
+  }
+  return result;
+}
@@ -0,0 +1,38 @@
+// Прогон прошивки на записанном или синтетическом сигнале на компьютере.
+//
+// Прошивка работает на виртуальных часах (firmware_host.h), поэтому сутки
+// записи проигрываются за секунды и каждый прогон даёт один и тот же
+// результат. Запись и все результаты лежат в файловой системе хоста:
+//   <out>/output.txt - ответы на запросы сценария и CRC-32 каждого нового
+//                      кадра дисплея, последней строкой итог прогона;
+//   <out>/fs/        - LittleFS устройства (users.json, журнал пульса).
+//
+// Сценарий - HTTP-запросы по времени записи, строками
+//   <мс> [GET|POST] <маршрут>[?a=1&b=2]
+// (например "60000 POST /login?username=admin&password=admin"). У POST
+// строка запроса уходит телом формы. Пустые строки и строки, не
+// начинающиеся с цифры, пропускаются.
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+struct SimulationOptions {
+  std::string trace;       // запись сигнала (trace_sensor.h); пусто - синтетический
+  uint32_t synthMs = 0;    // длительность синтетического сигнала
+  std::string script;      // пусто - без запросов
+  std::string out;
+};
+
+struct SimulationResult {
+  bool ok = false;
+  std::string error;
+  uint32_t durationMs = 0; // виртуального времени
+  uint32_t samples = 0;
+  uint32_t dropped = 0;
+  uint32_t requests = 0;
+};
+
+// Выполняет прогон в текущем процессе; прошивку можно загрузить в процессе
+// только один раз
+SimulationResult runSimulation(const SimulationOptions& options);
@@ -0,0 +1,203 @@
+// Выходы всех ядер ppg_dsp на фиксированных входах. Программа собирается
+// несколько раз: скалярный эталон (DSP_FORCE_SCALAR) записывает выходы в
+// файл, сборки SSE2 и AVX2 сверяют с ним свои побайтно.
+//
+// Входы нарочно доходят до границ: полный диапазон int16, коэффициенты КИХ
+// с суммой больше 2 (накопитель переполняется), скачки 18-битного АЦП, блоки
+// любой длины от 1 до DSP_MAX_BLOCK и все длины КИХ до DSP_MAX_FIR_TAPS.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "ppg_dsp.h"
+
+#define VECTOR_SAMPLES 1024
+#define SKIP_RETURN_CODE 77
+
+namespace {
+
+uint32_t randomState = 12345;
+std::vector<uint8_t> output;
+
+uint32_t nextRandom() {
+  randomState = randomState * 1664525u + 1013904223u;
+  return randomState >> 8;
+}
+
+q15_t randomQ15() {
+  switch (nextRandom() % 16) {
+    case 0: return 32767;
+    case 1: return -32768;
+    default: return (q15_t)(nextRandom() & 0xFFFF);
+  }
+}
+
+size_t randomBlock() {
+  return 1 + nextRandom() % DSP_MAX_BLOCK;
+}
+
+void write(const void* data, size_t bytes) {
+  const uint8_t* begin = (const uint8_t*)data;
+  output.insert(output.end(), begin, begin + bytes);
+}
+
+void writeQ15(const q15_t* values, size_t count) {
+  write(values, count * sizeof(q15_t));
+}
+
+void dcRemoveVectors() {
+  static uint32_t in[VECTOR_SAMPLES];
+  for (size_t i = 0; i < VECTOR_SAMPLES; i++) {
+    uint32_t level = (i / 200) % 2 ? 0x3FFFF : 80000;
+    in[i] = (level + nextRandom() % 4000) & 0x3FFFF;
+  }
+  for (uint8_t shift = 1; shift <= 12; shift += 3) {
+    DcRemoveState state;
+    dspDcRemoveInit(&state, shift);
+    q15_t result[DSP_MAX_BLOCK];
+    for (size_t i = 0; i < VECTOR_SAMPLES;) {
+      size_t block = randomBlock();
+      if (block > VECTOR_SAMPLES - i) block = VECTOR_SAMPLES - i;
+      dspDcRemove(&state, in + i, result, block);
+      writeQ15(result, block);
+      i += block;
+    }
+  }
+}
+
+void firVectors(const q15_t* in) {
+  static q15_t coeffs[DSP_MAX_FIR_TAPS];
+  static q15_t result[VECTOR_SAMPLES];
+  for (uint8_t taps = 1; taps <= DSP_MAX_FIR_TAPS; taps++) {
+    for (int extreme = 0; extreme < 2; extreme++) {
+      for (uint8_t k = 0; k < taps; k++) {
+        // Обычный фильтр (сумма |h| < 2) и предельный, где накопитель переполняется
+        coeffs[k] = extreme ? (k % 3 == 2 ? -32768 : 32767) : (q15_t)(nextRandom() % (65536 / taps) - 32768 / taps);
+      }
+      FirStateQ15 state;
+      dspFirInit(&state, coeffs, taps);
+      for (size_t i = 0; i < VECTOR_SAMPLES;) {
+        // Длинный вызов тоже проверяется: dspFir режет его на блоки сам
+        size_t block = nextRandom() % 8 == 0 ? 3 * DSP_MAX_BLOCK + 5 : randomBlock();
+        if (block > VECTOR_SAMPLES - i) block = VECTOR_SAMPLES - i;
+        dspFir(&state, in + i, result + i, block);
+        i += block;
+      }
+      writeQ15(result, VECTOR_SAMPLES);
+    }
+  }
+}
+
+void biquadVectors(const q15_t* in) {
+  static const q15_t sections[][5] = {
+    { Q14(0.0675), Q14(0.0), Q14(-0.0675), Q14(-1.8620), Q14(0.8650) },
+    { Q14(1.0), Q14(-1.99), Q14(1.0), Q14(-1.99), Q14(0.999) },
+    { Q14(1.999), Q14(1.999), Q14(1.999), Q14(1.999), Q14(-1.999) },
+  };
+  for (const q15_t* coeffs : sections) {
+    BiquadStateQ15 state;
+    dspBiquadInit(&state, coeffs);
+    q15_t result[DSP_MAX_BLOCK];
+    for (size_t i = 0; i < VECTOR_SAMPLES;) {
+      size_t block = randomBlock();
+      if (block > VECTOR_SAMPLES - i) block = VECTOR_SAMPLES - i;
+      dspBiquad(&state, in + i, result, block);
+      writeQ15(result, block);
+      i += block;
+    }
+  }
+}
+
+void averageAndDerivativeVectors(const q15_t* in) {
+  static const uint8_t lengths[] = { 1, 3, 4, 25, DSP_MAX_AVERAGE_WINDOW };
+  for (uint8_t length : lengths) {
+    MovingAverageStateQ15 state;
+    dspMovingAverageInit(&state, length);
+    q15_t result[DSP_MAX_BLOCK];
+    for (size_t i = 0; i < VECTOR_SAMPLES;) {
+      size_t block = randomBlock();
+      if (block > VECTOR_SAMPLES - i) block = VECTOR_SAMPLES - i;
+      dspMovingAverage(&state, in + i, result, block);
+      writeQ15(result, block);
+      i += block;
+    }
+  }
+
+  DerivativeStateQ15 derivative = { 0 };
+  q15_t buffer[DSP_MAX_BLOCK];
+  for (size_t i = 0; i < VECTOR_SAMPLES;) {
+    size_t block = randomBlock();
+    if (block > VECTOR_SAMPLES - i) block = VECTOR_SAMPLES - i;
+    for (size_t k = 0; k < block; k++) {
+      buffer[k] = in[i + k];
+    }
+    dspDerivative(&derivative, buffer, buffer, block);  // на месте
+    writeQ15(buffer, block);
+    i += block;
+  }
+}
+
+void peakVectors(const q15_t* in) {
+  PeakDetectStateQ15 state;
+  dspPeakDetectInit(&state);
+  uint32_t peaks[DSP_MAX_BLOCK];
+  for (size_t i = 0; i < VECTOR_SAMPLES;) {
+    size_t block = randomBlock();
+    if (block > VECTOR_SAMPLES - i) block = VECTOR_SAMPLES - i;
+    size_t found = dspFindPeaks(&state, in + i, block, 1000, 7, peaks, DSP_MAX_BLOCK);
+    write(peaks, found * sizeof(uint32_t));
+    i += block;
+  }
+}
+
+}  // namespace
+
+// dsp_vectors <file>         - записать выходы (эталон)
+// dsp_vectors <file> --check - сверить выходы с файлом
+int main(int argc, char** argv) {
+  bool check = argc == 3 && strcmp(argv[2], "--check") == 0;
+  if (argc != 2 && !check) {
+    fprintf(stderr, "usage: %s <file> [--check]\n", argv[0]);
+    return 2;
+  }
+#if defined(__AVX2__) && !defined(DSP_FORCE_SCALAR)
+  if (!__builtin_cpu_supports("avx2")) {
+    printf("AVX2 is not supported by this CPU\n");
+    return SKIP_RETURN_CODE;
+  }
+#endif
+  static q15_t in[VECTOR_SAMPLES];
+  for (size_t i = 0; i < VECTOR_SAMPLES; i++) {
+    in[i] = randomQ15();
+  }
+  dcRemoveVectors();
+  firVectors(in);
+  biquadVectors(in);
+  averageAndDerivativeVectors(in);
+  peakVectors(in);
+
+  FILE* file = fopen(argv[1], check ? "rb" : "wb");
+  if (file == nullptr) {
+    perror(argv[1]);
+    return 1;
+  }
+  if (!check) {
+    bool written = fwrite(output.data(), 1, output.size(), file) == output.size();
+    return fclose(file) == 0 && written ? 0 : 1;
+  }
+  std::vector<uint8_t> reference(output.size() + 1);
+  size_t length = fread(reference.data(), 1, reference.size(), file);
+  fclose(file);
+  if (length != output.size()) {
+    printf("size differs: reference %zu bytes, this build %zu bytes\n", length, output.size());
+    return 1;
+  }
+  for (size_t i = 0; i < length; i++) {
+    if (reference[i] != output[i]) {
+      printf("first difference at byte %zu: reference %02x, this build %02x\n", i, reference[i], output[i]);
+      return 1;
+    }
+  }
+  printf("%zu bytes match the scalar reference\n", length);
+  return 0;
+}
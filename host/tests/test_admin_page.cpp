@@ -0,0 +1,148 @@
+// Страница /admin через клиента, который забирает ответ окнами TCP: ответ
+// идёт чанками, в куче устройства не бывает всей страницы, пик кучи
+// маршрута виден в /tasks
+#include <gtest/gtest.h>
+#include <ArduinoJson.h>
+#include "firmware_host.h"
+#include "http_response.h"
+#include "run_device.h"
+
+#define CLIENT_WINDOW 256
+
+namespace {
+
+size_t countOf(const std::string& text, const std::string& part) {
+  size_t count = 0;
+  for (size_t at = text.find(part); at != std::string::npos; at = text.find(part, at + 1)) {
+    count++;
+  }
+  return count;
+}
+
+// Заполняет таблицу пользователей и входит администратором
+void addUsers(FirmwareHost& host) {
+  for (int i = 1; i < MAX_USERS; i++) {
+    char form[64];
+    snprintf(form, sizeof(form), "username=sleeper%02d&password=secret%02d", i, i);
+    ASSERT_EQ(host.post("/register", form)->status(), 303) << i;
+  }
+  ASSERT_EQ(users.count(), MAX_USERS);
+  ASSERT_TRUE(host.login("admin", "admin"));
+}
+
+// Медленный клиент: окно за проход основного цикла
+std::unique_ptr<HttpExchange> slowGet(FirmwareHost& host, const String& target) {
+  std::unique_ptr<HttpExchange> exchange = host.open(HTTP_GET, target);
+  for (int step = 0; step < 10000 && !exchange->complete(); step++) {
+    host.run(5);
+    exchange->receive(CLIENT_WINDOW, CLIENT_WINDOW);
+  }
+  return exchange;
+}
+
+TEST(AdminPage, ListsEveryUserInChunks) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    addUsers(host);
+
+    std::unique_ptr<HttpExchange> page = slowGet(host, "/admin");
+    ASSERT_TRUE(page->complete());
+    EXPECT_EQ(page->status(), 200);
+    const std::string& body = page->body();
+    EXPECT_EQ(body.rfind("<!DOCTYPE html>", 0), 0u);
+    EXPECT_NE(body.find("</html>"), std::string::npos);
+    EXPECT_EQ(countOf(body, "<tr><td>"), (size_t)MAX_USERS);
+    for (int i = 1; i < MAX_USERS; i++) {
+      char name[16];
+      snprintf(name, sizeof(name), "sleeper%02d<", i);
+      EXPECT_EQ(countOf(body, name), 1u) << name;
+    }
+    // Разметка chunked на проводе, тело - много окон клиента
+    EXPECT_GT(page->wireBytes(), body.size() + 5);
+    EXPECT_GT(page->fills(), body.size() / CLIENT_WINDOW);
+  });
+}
+
+TEST(AdminPage, DeviceNeverHoldsWholePage) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    addUsers(host);
+    size_t pageBytes = host.get("/admin")->body().size();
+
+    hostHeapResetCounters();
+    int64_t before = hostHeapStats().liveBytes;
+    std::unique_ptr<HttpExchange> page = slowGet(host, "/admin");
+    ASSERT_TRUE(page->complete());
+    ASSERT_EQ(page->body().size(), pageBytes);
+    HostHeapStats heap = hostHeapStats();
+    // Тело клиента - не память устройства; у устройства не больше пакета строк и служебного
+    EXPECT_LT(heap.peakLiveBytes - before, (int64_t)pageBytes / 2) << pageBytes << " bytes page";
+    EXPECT_LE(heap.largestAllocation, (size_t)2 * HTTP_BATCH_BYTES + 1);  // буфер пакета с нулём в конце
+
+    // Тот же пик видит прошивка и отдаёт в /tasks
+    std::unique_ptr<HttpExchange> tasks = host.get("/tasks");
+    DynamicJsonDocument json(8192);
+    ASSERT_FALSE(deserializeJson(json, tasks->body().c_str()));
+    JsonObject route = json["heap"]["routes"][0];
+    EXPECT_STREQ(route["route"].as<const char*>(), "/admin");
+    EXPECT_EQ(route["requests"].as<int>(), 2);
+    EXPECT_GT(route["last_peak_bytes"].as<int>(), 0);
+    EXPECT_LT(route["last_peak_bytes"].as<int64_t>(), (int64_t)pageBytes / 2);
+    EXPECT_GE(route["peak_bytes"].as<int>(), route["last_peak_bytes"].as<int>());
+  });
+}
+
+// Кнопки страницы удаляют по имени: после удаления, которое переставило
+// ячейки, ссылка со старой страницы удаляет того же пользователя
+TEST(AdminPage, StalePageDeletesNamedUser) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    addUsers(host);
+    std::string page = host.get("/admin")->body();
+    EXPECT_NE(page.find("confirmDelete(\"sleeper02\")"), std::string::npos);
+
+    // Последний пользователь переезжает в ячейку удалённого
+    int last = users.count() - 1;
+    String lastName = users.name(last);
+    int firstSlot = findUser("sleeper01");
+    ASSERT_EQ(host.get("/deleteUser?name=sleeper01")->status(), 303);
+    EXPECT_LT(findUser("sleeper01"), 0);
+    EXPECT_EQ(findUser(lastName), firstSlot);
+
+    // Та же старая страница: удаление пользователя из середины таблицы
+    ASSERT_EQ(host.get("/deleteUser?name=sleeper05")->status(), 303);
+    EXPECT_LT(findUser("sleeper05"), 0);
+    EXPECT_GE(findUser(lastName), 0);
+    EXPECT_EQ(users.count(), MAX_USERS - 2);
+
+    // Повтор и несуществующее имя ничего не удаляют, себя удалить нельзя
+    EXPECT_EQ(host.get("/deleteUser?name=sleeper05")->status(), 303);
+    EXPECT_EQ(host.get("/deleteUser?name=nobody")->status(), 303);
+    EXPECT_EQ(host.get("/deleteUser?name=admin")->status(), 303);
+    EXPECT_EQ(host.get("/deleteUser?id=1")->status(), 303);
+    EXPECT_EQ(users.count(), MAX_USERS - 2);
+    EXPECT_GE(findUser("admin"), 0);
+    for (int i = 1; i < MAX_USERS; i++) {
+      char name[16];
+      snprintf(name, sizeof(name), "sleeper%02d", i);
+      EXPECT_EQ(findUser(name) >= 0, i != 1 && i != 5) << name;
+    }
+  });
+}
+
+TEST(AdminPage, OrdinaryUserIsRedirected) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    ASSERT_EQ(host.post("/register", "username=guest&password=guest")->status(), 303);
+    std::unique_ptr<HttpExchange> page = host.get("/admin");
+    EXPECT_EQ(page->status(), 303);
+    EXPECT_EQ(page->header("Location"), "/");
+    EXPECT_TRUE(page->body().empty());
+  });
+}
+
+}  // namespace
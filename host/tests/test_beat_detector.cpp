@@ -0,0 +1,215 @@
+// Детектор ударов на синтетическом сигнале с известными моментами пиков:
+// найденные удары сверяются с настоящими по одному, пульс - с медианой
+// настоящих интервалов. Скорость обработки - BM_BeatDetector в firmware_bench
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "beat_detector.h"
+#include "max30102_sensor.h"
+#include "ppg_synth.h"
+#include "host_core.h"
+
+#define BEAT_TEST_MS 120000
+// Пока огибающая не выучила амплитуду, при 40 уд/мин за удар принимается и
+// дикротическая волна; к 25 с порог её отсекает, а кольцо RR обновляется
+#define BEAT_SETTLE_MS 25000
+#define BEAT_MATCH_MS 60       // удар найден, если он не дальше 60 мс от типичной задержки
+#define BEAT_BPM_TOLERANCE 2   // уд/мин или 3%, что больше: отсчёт 10 мс при 180 уд/мин - это 5 уд/мин
+
+namespace {
+
+struct Detection {
+  std::vector<uint32_t> truth;      // пики сигнала
+  std::vector<uint32_t> beats;      // принятые детектором удары
+  std::vector<uint32_t> seconds;    // раз в секунду, на границе блока
+  std::vector<uint16_t> bpm;        // показание детектора в этот момент
+  std::vector<uint32_t> lastBeat;   // последний принятый удар к концу секунды
+};
+
+Detection detect(const PpgSynthConfig& signal, size_t block = DSP_MAX_BLOCK) {
+  PpgSynth synth(signal);
+  BeatDetector detector;
+  Detection result;
+  uint32_t ir[DSP_MAX_BLOCK];
+  uint32_t red;
+  uint32_t timestamps[DSP_MAX_BLOCK];
+  uint32_t previous = 0;
+  uint32_t t = 0;
+  while (t < BEAT_TEST_MS) {
+    for (size_t i = 0; i < block; i++, t += SAMPLE_PERIOD_MS) {
+      timestamps[i] = t;
+      synth.sample(t, red, ir[i]);
+    }
+    size_t accepted = detector.addBlock(ir, timestamps, block);
+    for (size_t i = 0; i < accepted; i++) {
+      int8_t position = detector.beatPositions()[i];
+      result.beats.push_back(position < 0 ? previous : timestamps[position]);
+    }
+    previous = timestamps[block - 1];
+    if (result.seconds.empty() || t >= result.seconds.back() + 1000) {
+      result.seconds.push_back(t);
+      result.bpm.push_back(detector.bpm());
+      result.lastBeat.push_back(detector.lastBeatTime());
+    }
+  }
+  result.truth = synth.beats();
+  return result;
+}
+
+// Типичная задержка удара относительно пика: детектор отмечает крутой фронт
+// после фильтра, а не сам пик
+int32_t typicalDelay(const Detection& d) {
+  std::vector<int32_t> delays;
+  for (uint32_t beat : d.beats) {
+    auto next = std::lower_bound(d.truth.begin(), d.truth.end(), beat);
+    int32_t best = INT32_MAX;
+    if (next != d.truth.end()) {
+      best = (int32_t)(beat - *next);
+    }
+    if (next != d.truth.begin() && abs((int32_t)(beat - *(next - 1))) < abs(best)) {
+      best = (int32_t)(beat - *(next - 1));
+    }
+    delays.push_back(best);
+  }
+  std::sort(delays.begin(), delays.end());
+  return delays.empty() ? 0 : delays[delays.size() / 2];
+}
+
+// Пары "пик - удар" не дальше BEAT_MATCH_MS от типичной задержки, каждый не больше одного раза
+size_t matched(const Detection& d, int32_t delay, uint32_t from) {
+  size_t count = 0;
+  size_t j = 0;
+  for (uint32_t peak : d.truth) {
+    if (peak < from) {
+      continue;
+    }
+    while (j < d.beats.size() && (int32_t)(d.beats[j] - peak) - delay < -BEAT_MATCH_MS) {
+      j++;
+    }
+    if (j < d.beats.size() && abs((int32_t)(d.beats[j] - peak) - delay) <= BEAT_MATCH_MS) {
+      count++;
+      j++;
+    }
+  }
+  return count;
+}
+
+size_t countFrom(const std::vector<uint32_t>& times, uint32_t from) {
+  return times.end() - std::lower_bound(times.begin(), times.end(), from);
+}
+
+// Пульс по медиане последних BEAT_RR_HISTORY настоящих интервалов до пика
+// не позже last, так же, как его считает детектор
+uint16_t trueBpm(const std::vector<uint32_t>& truth, uint32_t last) {
+  size_t end = std::upper_bound(truth.begin(), truth.end(), last) - truth.begin();
+  std::vector<uint32_t> intervals;
+  for (size_t i = end - 1; i > 0 && intervals.size() < BEAT_RR_HISTORY; i--) {
+    intervals.push_back(truth[i] - truth[i - 1]);
+  }
+  std::sort(intervals.begin(), intervals.end());
+  size_t count = intervals.size();
+  uint32_t median = count % 2 ? intervals[count / 2] : (intervals[count / 2 - 1] + intervals[count / 2]) / 2;
+  return (60000 + median / 2) / median;
+}
+
+void expectAccurate(const PpgSynthConfig& signal) {
+  Detection d = detect(signal);
+  int32_t delay = typicalDelay(d);
+  size_t truth = countFrom(d.truth, BEAT_SETTLE_MS);
+  size_t beats = countFrom(d.beats, BEAT_SETTLE_MS + delay);
+  size_t hits = matched(d, delay, BEAT_SETTLE_MS);
+  printf("[ beats ] %3.0f bpm noise %3.0f: delay %d ms, %zu/%zu found, %zu extra\n", signal.bpm, signal.noise,
+         delay, hits, truth, beats - hits);
+  // Чувствительность и доля верных ударов - не меньше 98%
+  EXPECT_GE(hits * 100, truth * 98);
+  EXPECT_GE(hits * 100, beats * 98);
+  EXPECT_LE(abs(delay), 150);
+
+  size_t close = 0;
+  size_t total = 0;
+  for (size_t i = 0; i < d.seconds.size(); i++) {
+    if (d.seconds[i] < BEAT_SETTLE_MS) {
+      continue;
+    }
+    total++;
+    uint16_t expected = trueBpm(d.truth, d.lastBeat[i] - delay + BEAT_MATCH_MS);
+    int error = abs((int)d.bpm[i] - (int)expected);
+    if (error <= std::max(BEAT_BPM_TOLERANCE, expected * 3 / 100)) {
+      close++;
+    }
+    // Пропущенный удар - один длинный интервал в кольце: медиана сдвигается
+    // на соседний, но не уходит дальше разброса ритма
+    EXPECT_LE(error * 100, expected * 10) << "at " << d.seconds[i] << " ms: " << d.bpm[i] << " bpm";
+  }
+  EXPECT_GE(close * 100, total * 97);
+}
+
+class BeatAccuracy : public ::testing::TestWithParam<int> {};
+
+TEST_P(BeatAccuracy, FindsEveryBeatAtRate) {
+  PpgSynthConfig signal;
+  signal.bpm = GetParam();
+  signal.variability = 0.05f;
+  signal.seed = 3 + GetParam();
+  expectAccurate(signal);
+}
+
+INSTANTIATE_TEST_SUITE_P(Rates, BeatAccuracy, ::testing::Values(40, 55, 72, 100, 130, 160, 180));
+
+class BeatNoise : public ::testing::TestWithParam<int> {};
+
+TEST_P(BeatNoise, FindsEveryBeatInNoise) {
+  PpgSynthConfig signal;
+  signal.bpm = 66;
+  signal.variability = 0.05f;
+  signal.noise = GetParam();
+  signal.seed = 5;
+  expectAccurate(signal);
+}
+
+// Втрое больше шума по умолчанию. Дальше (СКО 80 и выше при размахе пульса
+// около 1200) удары теряются - такие окна отбраковывает индекс качества
+INSTANTIATE_TEST_SUITE_P(Levels, BeatNoise, ::testing::Values(0, 20, 40, 60));
+
+TEST(BeatDetector, WeakPerfusion) {
+  PpgSynthConfig signal;
+  signal.bpm = 80;
+  signal.perfusion = 0.003f;
+  signal.seed = 9;
+  expectAccurate(signal);
+}
+
+// Размер блока (сколько отсчётов было в FIFO) на результат не влияет
+TEST(BeatDetector, BlockSizeDoesNotMatter) {
+  PpgSynthConfig signal;
+  signal.bpm = 75;
+  signal.variability = 0.05f;
+  Detection whole = detect(signal, DSP_MAX_BLOCK);
+  for (size_t block : { 1, 4, 25 }) {
+    Detection split = detect(signal, block);
+    EXPECT_EQ(split.beats, whole.beats) << block;
+  }
+}
+
+// Обработка блока без кучи: на устройстве addBlock идёт на каждом чтении FIFO
+TEST(BeatDetector, AddBlockDoesNotAllocate) {
+  PpgSynthConfig signal;
+  PpgSynth synth(signal);
+  std::vector<uint32_t> ir;
+  std::vector<uint32_t> timestamps;
+  for (uint32_t t = 0; t < 20000; t += SAMPLE_PERIOD_MS) {
+    uint32_t red;
+    uint32_t value;
+    synth.sample(t, red, value);
+    ir.push_back(value);
+    timestamps.push_back(t);
+  }
+  BeatDetector detector;
+  hostHeapResetCounters();
+  for (size_t i = 0; i + DSP_MAX_BLOCK <= ir.size(); i += DSP_MAX_BLOCK) {
+    detector.addBlock(&ir[i], &timestamps[i], DSP_MAX_BLOCK);
+  }
+  EXPECT_EQ(hostHeapStats().allocations, 0u);
+  EXPECT_GT(detector.bpm(), 0);
+}
+
+}  // namespace
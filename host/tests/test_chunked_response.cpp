@@ -0,0 +1,214 @@
+// ChunkedResponse со строками, которые дописывает основной цикл: в ОЗУ один
+// пакет, медленный клиент получает то же тело, число таких ответов ограничено
+#include <gtest/gtest.h>
+#include <ArduinoJson.h>
+#include "firmware_host.h"
+#include "http_client.h"
+#include "http_response.h"
+#include "request_queue.h"
+#include "run_device.h"
+
+#define ROW_BYTES 40  // не длиннее
+#define HEAD "{\"rows\":["
+
+namespace {
+
+RequestQueue* testQueue = nullptr;
+RouteHeapStats testStats = { "/rows", 0, 0, 0 };
+int rowCount = 0;
+size_t producedBytes = 0;  // напечатано строками с начала ответа
+
+size_t formatRow(char* text, int row) {
+  return snprintf(text, ROW_BYTES + 1, "%s\"row %05d .....................\"", row > 0 ? "," : "", row);
+}
+
+std::string rowText(int row) {
+  char text[ROW_BYTES + 1];
+  formatRow(text, row);
+  return text;
+}
+
+std::string expectedBody(int rows) {
+  std::string body = HEAD;
+  for (int i = 0; i < rows; i++) {
+    body += rowText(i);
+  }
+  return body + "]}";
+}
+
+void handleRows() {
+  ChunkedResponse response(*testQueue, &testStats);
+  response.begin(200, "application/json");
+  response.print_P(PSTR(HEAD));
+  response.end([row = 0](ChunkedResponse& rows) mutable {
+    if (row == rowCount) {
+      rows.print("]}");
+      return false;
+    }
+    char text[ROW_BYTES + 1];
+    producedBytes += formatRow(text, row++);
+    rows.print(text);
+    return true;
+  });
+}
+
+class ChunkedResponseTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    testQueue = &queue;
+    queue.on(web, "/rows", HTTP_GET, handleRows);
+    producedBytes = 0;
+    testStats = { "/rows", 0, 0, 0 };
+  }
+
+  void TearDown() override {
+    exchanges.clear();
+    ChunkedResponse::pump();  // освобождает слоты отключившихся ответов
+  }
+
+  HttpExchange& open() {
+    exchanges.emplace_back(new HttpExchange(web, HTTP_GET, "/rows"));
+    queue.dispatch(1);
+    return *exchanges.back();
+  }
+
+  // Клиент забирает по window байт, основной цикл дописывает строки между чтениями
+  void receiveAll(HttpExchange& exchange, size_t window) {
+    for (int step = 0; step < 100000 && !exchange.complete(); step++) {
+      exchange.receive(window, window);
+      // Вперёд отданного напечатано не больше пакета и одной строки
+      if (exchanges.size() == 1) {
+        EXPECT_LE(producedBytes, exchange.body().size() + HTTP_BATCH_BYTES + ROW_BYTES);
+      }
+      ChunkedResponse::pump();
+    }
+  }
+
+  AsyncWebServer web{ 80 };
+  RequestQueue queue;
+  std::vector<std::unique_ptr<HttpExchange>> exchanges;
+};
+
+TEST_F(ChunkedResponseTest, ShortResponseIsCompleteRightAway) {
+  rowCount = 3;
+  HttpExchange& exchange = open();
+  ASSERT_TRUE(exchange.receive());
+  EXPECT_TRUE(exchange.complete());
+  EXPECT_EQ(exchange.body(), expectedBody(3));
+  EXPECT_EQ(testStats.requests, 1u);
+}
+
+TEST_F(ChunkedResponseTest, LargeBodyIsPrintedInBatches) {
+  rowCount = 2000;  // 80 КБ
+  hostHeapResetCounters();
+  HttpExchange& exchange = open();
+  // Обработчик напечатал только первый пакет
+  EXPECT_LE(producedBytes, (size_t)HTTP_BATCH_BYTES + ROW_BYTES);
+  EXPECT_LE(hostHeapStats().largestAllocation, (size_t)2 * HTTP_BATCH_BYTES + 1);  // буфер пакета с нулём в конце
+
+  // Следующие пакеты печатаются в тот же буфер: куча не растёт с телом
+  uint64_t allocations = 0;
+  int batches = 0;
+  while (!exchange.complete()) {
+    ASSERT_LT(batches, 1000);
+    exchange.receive();
+    hostHeapResetCounters();
+    int64_t live = hostHeapStats().liveBytes;
+    ChunkedResponse::pump();
+    HostHeapStats heap = hostHeapStats();
+    EXPECT_LE(heap.peakLiveBytes, live + HTTP_BATCH_BYTES);
+    EXPECT_LT(heap.largestAllocation, (size_t)HTTP_BATCH_BYTES);
+    allocations += heap.allocations;
+    batches++;
+  }
+  EXPECT_TRUE(exchange.body() == expectedBody(rowCount));
+  EXPECT_GE(batches, (int)(exchange.body().size() / (HTTP_BATCH_BYTES + ROW_BYTES)));
+  EXPECT_LT(allocations, 8u);
+}
+
+TEST_F(ChunkedResponseTest, SlowClientGetsSameBody) {
+  rowCount = 300;
+  HttpExchange& fast = open();
+  receiveAll(fast, HTTP_WINDOW);
+  exchanges.clear();
+  producedBytes = 0;
+  HttpExchange& slow = open();
+  receiveAll(slow, 7);
+  ASSERT_TRUE(slow.complete());
+  EXPECT_TRUE(slow.body() == expectedBody(rowCount));
+}
+
+TEST_F(ChunkedResponseTest, ServerWaitsForNextBatch) {
+  rowCount = 300;
+  HttpExchange& exchange = open();
+  // Без основного цикла сервер отдаёт только первый пакет и ждёт
+  exchange.receive();
+  size_t first = exchange.body().size();
+  EXPECT_LE(first, strlen(HEAD) + HTTP_BATCH_BYTES + ROW_BYTES);
+  EXPECT_FALSE(exchange.receive());
+  EXPECT_FALSE(exchange.complete());
+  ChunkedResponse::pump();
+  EXPECT_TRUE(exchange.receive());
+  EXPECT_GT(exchange.body().size(), first);
+}
+
+TEST_F(ChunkedResponseTest, StreamsAreLimited) {
+  rowCount = 300;
+  for (int i = 0; i < HTTP_MAX_STREAMS; i++) {
+    EXPECT_EQ(open().status(), 200);
+  }
+  HttpExchange& extra = open();
+  EXPECT_EQ(extra.status(), 503);
+  EXPECT_EQ(extra.header("Retry-After"), "1");
+
+  // Короткому ответу слот не нужен
+  rowCount = 2;
+  EXPECT_EQ(open().status(), 200);
+
+  // Клиент ушёл - его слот свободен
+  exchanges[0]->disconnect();
+  exchanges[0].reset();
+  ChunkedResponse::pump();
+  rowCount = 300;
+  HttpExchange& next = open();
+  EXPECT_EQ(next.status(), 200);
+}
+
+// Строки сырой истории пользователя на датчике: кольцо в ОЗУ сдвигается,
+// пока медленный клиент забирает ответ
+TEST(ChunkedHistory, RecentRowsSurviveNewRecords) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    ASSERT_TRUE(host.login("admin", "admin"));
+    host.run(20 * 60000);
+
+    std::unique_ptr<HttpExchange> slow = host.open(HTTP_GET, "/history?res=raw&from=0");
+    for (int step = 0; step < 10000 && !slow->complete(); step++) {
+      slow->receive(64, 64);
+      host.run(50);  // новые записи, основной цикл дописывает строки
+    }
+    ASSERT_TRUE(slow->complete());
+    DynamicJsonDocument page(32768);
+    ASSERT_FALSE(deserializeJson(page, slow->body().c_str()));
+    JsonArray rows = page["rows"];
+    ASSERT_EQ(rows.size(), 120u);
+    for (size_t i = 1; i < rows.size(); i++) {
+      EXPECT_GT(rows[i][0].as<uint32_t>(), rows[i - 1][0].as<uint32_t>()) << i;
+    }
+    uint32_t last = rows[rows.size() - 1][0].as<uint32_t>();
+    EXPECT_GT(page["next"].as<uint32_t>(), last);
+
+    // Тот же диапазон одним быстрым чтением
+    std::unique_ptr<HttpExchange> fast = host.get("/history?res=raw&from=0&to=" + String(last));
+    DynamicJsonDocument reference(32768);
+    ASSERT_FALSE(deserializeJson(reference, fast->body().c_str()));
+    String slowRows;
+    String fastRows;
+    serializeJson(page["rows"], slowRows);
+    serializeJson(reference["rows"], fastRows);
+    EXPECT_EQ(slowRows, fastRows);
+  });
+}
+
+}  // namespace
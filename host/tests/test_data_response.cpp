@@ -0,0 +1,145 @@
+// /data отдаётся серверу прямо из буфера очереди запросов: тело не копируется
+// в кучу, а буфер не переиспользуется, пока медленный клиент его не дочитал.
+// Когда все буферы заняты, ответ - 503 с Retry-After, тоже без выделений
+#include <gtest/gtest.h>
+#include <ArduinoJson.h>
+#include "firmware_host.h"
+#include "http_client.h"
+#include "run_device.h"
+
+namespace {
+
+// Запрос /data с выделениями памяти только за время обработчика и send()
+struct DataRequest {
+  std::unique_ptr<HttpExchange> exchange;
+  HostHeapStats heap;
+};
+
+DataRequest requestData(FirmwareHost& host) {
+  DataRequest result;
+  result.exchange = host.open(HTTP_GET, "/data");
+  hostHeapResetCounters();
+  webRequests.dispatch(1);
+  result.heap = hostHeapStats();
+  return result;
+}
+
+// Те же ответы от обработчиков, которые больше ничего не делают. Объект ответа
+// и копию Content-Type выделяет сама библиотека, этого не избежать
+RequestQueue* bareQueue = nullptr;
+
+void handleBareData() {
+  char* buffer = bareQueue->responseBuffer();
+  strcpy(buffer, "{}");
+  bareQueue->send(200, "application/json", buffer, 2);
+}
+
+void handleBareBusy() {
+  bareQueue->sendHeader("Retry-After", "1");
+  bareQueue->send(503, "text/plain", "Server busy");
+}
+
+HostHeapStats libraryResponse(RequestHandler handler) {
+  AsyncWebServer web(80);
+  RequestQueue queue;
+  bareQueue = &queue;
+  queue.on(web, "/bare", HTTP_GET, handler);
+  HttpExchange exchange(web, HTTP_GET, "/bare");
+  hostHeapResetCounters();
+  queue.dispatch(1);
+  HostHeapStats heap = hostHeapStats();
+  EXPECT_TRUE(exchange.answered());
+  return heap;
+}
+
+// Обработчик /data не выделил ничего сверх библиотеки
+void expectNoHandlerAllocations(const DataRequest& data, RequestHandler bare) {
+  HostHeapStats library = libraryResponse(bare);
+  EXPECT_EQ(data.heap.allocations, library.allocations);
+  EXPECT_EQ(data.heap.allocatedBytes, library.allocatedBytes);
+}
+
+bool validData(const std::string& body) {
+  DynamicJsonDocument json(512);
+  return !deserializeJson(json, body.c_str()) && json.containsKey("pulse") && json.containsKey("wakeup");
+}
+
+TEST(DataResponse, BodyIsNotCopiedToHeap) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    host.run(2000);
+    ASSERT_TRUE(host.login("admin", "admin"));
+
+    DataRequest data = requestData(host);
+    ASSERT_TRUE(host.finish(*data.exchange));
+    EXPECT_EQ(data.exchange->status(), 200);
+    ASSERT_TRUE(validData(data.exchange->body()));
+    expectNoHandlerAllocations(data, handleBareData);
+  });
+}
+
+TEST(DataResponse, SlowClientsKeepTheirBuffers) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    host.run(2000);
+
+    // Клиенты, которые ещё не забрали ни байта тела, держат все буферы
+    std::vector<DataRequest> slow;
+    for (int i = 0; i < RESPONSE_BUFFERS; i++) {
+      slow.push_back(requestData(host));
+      ASSERT_TRUE(slow.back().exchange->answered());
+      expectNoHandlerAllocations(slow.back(), handleBareData);
+    }
+    host.run(3000);  // время на экране другое, тела новых ответов отличаются
+
+    // Следующему клиенту - 503, буферы медленных клиентов не тронуты
+    DataRequest busy = requestData(host);
+    ASSERT_TRUE(host.finish(*busy.exchange));
+    EXPECT_EQ(busy.exchange->status(), 503);
+    EXPECT_EQ(busy.exchange->header("Retry-After"), "1");
+    expectNoHandlerAllocations(busy, handleBareBusy);
+
+    for (DataRequest& request : slow) {
+      ASSERT_TRUE(host.finish(*request.exchange));
+      EXPECT_TRUE(validData(request.exchange->body()));
+      EXPECT_EQ(request.exchange->status(), 200);
+    }
+
+    // Клиенты отключились - буферы снова свободны
+    std::string old = slow.front().exchange->body();
+    slow.clear();
+    DataRequest again = requestData(host);
+    ASSERT_TRUE(host.finish(*again.exchange));
+    EXPECT_EQ(again.exchange->status(), 200);
+    EXPECT_TRUE(validData(again.exchange->body()));
+    EXPECT_NE(again.exchange->body(), old);
+    expectNoHandlerAllocations(again, handleBareData);
+  });
+}
+
+TEST(DataResponse, DisconnectReleasesBuffer) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    host.run(1000);
+    // Клиенты уходят, не дочитав тело или не дождавшись ответа
+    for (int i = 0; i < 3 * RESPONSE_BUFFERS; i++) {
+      DataRequest gone = requestData(host);
+      EXPECT_EQ(gone.exchange->status(), 200);
+      gone.exchange->disconnect();
+    }
+    for (int i = 0; i < RESPONSE_BUFFERS; i++) {
+      std::unique_ptr<HttpExchange> early = host.open(HTTP_GET, "/data");
+      early->disconnect();
+      host.run(100);
+    }
+    DataRequest data = requestData(host);
+    ASSERT_TRUE(host.finish(*data.exchange));
+    EXPECT_EQ(data.exchange->status(), 200);
+    expectNoHandlerAllocations(data, handleBareData);
+  });
+}
+
+}  // namespace
@@ -0,0 +1,222 @@
+// EventStream с несколькими подписчиками: медленный клиент теряет кадры
+// только сам, а после пропуска получает полный снимок вместо дельты
+#include <gtest/gtest.h>
+#include <ArduinoJson.h>
+#include <map>
+#include <random>
+#include <vector>
+#include "event_stream.h"
+#include "http_client.h"
+
+namespace {
+
+struct EventMessage {
+  std::string event;
+  std::string data;
+};
+
+// Разбирает текст потока на сообщения "event: ...\r\ndata: ...\r\n\r\n"
+std::vector<EventMessage> parseEvents(const String& text) {
+  std::vector<EventMessage> messages;
+  std::string rest(text.c_str());
+  size_t end;
+  while ((end = rest.find("\r\n\r\n")) != std::string::npos) {
+    EventMessage message;
+    std::string block = rest.substr(0, end + 2);
+    rest.erase(0, end + 4);
+    for (size_t line = 0, next; (next = block.find("\r\n", line)) != std::string::npos; line = next + 2) {
+      std::string field = block.substr(line, next - line);
+      if (field.rfind("event: ", 0) == 0) {
+        message.event = field.substr(7);
+      } else if (field.rfind("data: ", 0) == 0) {
+        message.data = field.substr(6);
+      }
+    }
+    messages.push_back(message);
+  }
+  return messages;
+}
+
+// Показатели, собранные клиентом из полных снимков и дельт
+struct ClientView {
+  AsyncEventSourceClient* client = nullptr;
+  std::unique_ptr<HttpExchange> exchange;
+  std::map<std::string, std::string> fields;
+  int vitalsFrames = 0;
+  int fullFrames = 0;
+  int waveFrames = 0;
+
+  void receive(size_t maxMessages = SIZE_MAX) {
+    for (const EventMessage& message : parseEvents(client->drain(maxMessages))) {
+      if (message.event == "wave") {
+        waveFrames++;
+      }
+      if (message.event != "vitals") {
+        continue;
+      }
+      DynamicJsonDocument json(512);
+      ASSERT_FALSE(deserializeJson(json, message.data.c_str()));
+      JsonObject object = json.as<JsonObject>();
+      for (JsonPair pair : object) {
+        String value;
+        serializeJson(pair.value(), value);
+        fields[pair.key()] = value.c_str();
+      }
+      vitalsFrames++;
+      fullFrames += object.size() == 7 ? 1 : 0;
+    }
+  }
+};
+
+class EventStreamTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    stream.begin(web);
+    vitals = LiveVitals();
+    vitals.pulse = 60;
+    vitals.spo2 = 97;
+    vitals.hours = 7;
+    vitals.fingerPresent = true;
+    vitals.sensorActive = true;
+  }
+
+  ClientView& connect() {
+    clients.emplace_back(new ClientView());
+    ClientView& view = *clients.back();
+    view.exchange.reset(new HttpExchange(web, HTTP_GET, "/events"));
+    view.client = view.exchange->request()->eventClient();
+    return view;
+  }
+
+  void publish() {
+    int16_t wave[5] = { 1, 2, 3, 4, 5 };
+    now += 200;
+    stream.publish(vitals, wave, 5, now);
+  }
+
+  // Что клиент должен видеть сейчас
+  std::map<std::string, std::string> expected() const {
+    char time[12];
+    snprintf(time, sizeof(time), "%d:%02d:%02d", vitals.hours, vitals.minutes, vitals.seconds);
+    return {
+      { "time", std::string("\"") + time + "\"" },
+      { "pulse", std::to_string(vitals.pulse) },
+      { "spo2", std::to_string(vitals.spo2) },
+      { "finger_present", vitals.fingerPresent ? "true" : "false" },
+      { "sensor_active", vitals.sensorActive ? "true" : "false" },
+      { "alarmEnabled", vitals.alarmEnabled ? "true" : "false" },
+      { "alarmTriggered", vitals.alarmTriggered ? "true" : "false" },
+    };
+  }
+
+  AsyncWebServer web{ 80 };
+  EventStream stream{ "/events" };
+  LiveVitals vitals;
+  unsigned long now = 0;
+  std::vector<std::unique_ptr<ClientView>> clients;
+};
+
+TEST_F(EventStreamTest, SlowClientDoesNotStallOthers) {
+  ClientView& fast1 = connect();
+  ClientView& slow = connect();
+  ClientView& fast2 = connect();
+  ASSERT_EQ(stream.clientCount(), 3u);
+
+  for (int i = 0; i < 100; i++) {
+    vitals.pulse = 60 + i % 30;
+    vitals.seconds = i % 60;
+    publish();
+    fast1.receive();
+    fast2.receive();
+    // Быстрые клиенты видят каждое изменение
+    ASSERT_EQ(fast1.fields, expected()) << i;
+    ASSERT_EQ(fast2.fields, expected()) << i;
+  }
+  EXPECT_EQ(fast1.vitalsFrames, 100);
+  EXPECT_EQ(fast1.waveFrames, 100);
+  EXPECT_EQ(fast2.waveFrames, 100);
+
+  // Очередь медленного не растёт дальше порога, пропуски - только его
+  EXPECT_LE(slow.client->packetsWaiting(), (size_t)EVENT_MAX_PENDING + 1);
+  EXPECT_EQ(slow.client->dropped(), 0u);
+  EXPECT_GE(stream.droppedFrames(), 97u);
+  EXPECT_LE(stream.droppedFrames(), 100u);
+}
+
+TEST_F(EventStreamTest, SlowClientCatchesUpWithFullSnapshot) {
+  ClientView& fast = connect();
+  ClientView& slow = connect();
+  publish();
+  fast.receive();
+  slow.receive();
+  int fullBefore = slow.fullFrames;
+
+  // Медленный клиент не забирает кадры, пока всё меняется
+  for (int i = 0; i < 20; i++) {
+    vitals.pulse = 70 + i;
+    vitals.spo2 = 90 + i % 5;
+    vitals.alarmTriggered = i % 2;
+    publish();
+    fast.receive();
+  }
+  vitals.seconds = 30;
+  slow.receive();
+  publish();
+  slow.receive();
+  fast.receive();
+  EXPECT_EQ(slow.fullFrames, fullBefore + 1);
+  EXPECT_EQ(slow.fields, expected());
+  EXPECT_EQ(fast.fields, expected());
+  // Быстрому полный снимок не нужен: он получил все дельты
+  EXPECT_EQ(fast.fullFrames, 1);
+}
+
+TEST_F(EventStreamTest, RandomReadersStayConsistent) {
+  std::mt19937 random(11);
+  for (int i = 0; i < 3; i++) {
+    connect();
+  }
+  for (int step = 0; step < 2000; step++) {
+    switch (random() % 4) {
+      case 0: vitals.pulse = 50 + random() % 60; break;
+      case 1: vitals.spo2 = 88 + random() % 12; break;
+      case 2: vitals.seconds = random() % 60; break;
+      default: vitals.fingerPresent = random() % 2; break;
+    }
+    publish();
+    for (std::unique_ptr<ClientView>& view : clients) {
+      // Читатели разной скорости: забирают от нуля до нескольких сообщений
+      view->receive(random() % 4);
+    }
+  }
+  EXPECT_GT(stream.droppedFrames(), 0u);
+  for (std::unique_ptr<ClientView>& view : clients) {
+    view->receive();
+  }
+  publish();
+  for (std::unique_ptr<ClientView>& view : clients) {
+    view->receive();
+    EXPECT_EQ(view->fields, expected());
+    EXPECT_EQ(view->client->dropped(), 0u);
+  }
+}
+
+TEST_F(EventStreamTest, ClientsBeyondLimitAreClosed) {
+  for (int i = 0; i < EVENT_MAX_CLIENTS; i++) {
+    connect();
+  }
+  ClientView& extra = connect();
+  EXPECT_TRUE(extra.exchange->request()->disconnected());
+  EXPECT_EQ(stream.clientCount(), (uint8_t)EVENT_MAX_CLIENTS);
+
+  // Отключение освобождает место: новый клиент получает полный снимок
+  clients[0]->exchange->disconnect();
+  ClientView& late = connect();
+  EXPECT_FALSE(late.exchange->request()->disconnected());
+  publish();
+  late.receive();
+  EXPECT_EQ(late.fullFrames, 1);
+  EXPECT_EQ(late.fields, expected());
+}
+
+}  // namespace
@@ -0,0 +1,70 @@
+// Загрузка прошивки на хосте: setup(), основной цикл на синтетическом
+// сигнале и ответы веб-сервера
+#include <gtest/gtest.h>
+#include <ArduinoJson.h>
+#include "firmware_host.h"
+#include "run_device.h"
+
+TEST(FirmwareBoot, MeasuresSyntheticFinger) {
+  TempDir dir;
+  runDevice([&]() {
+    PpgSynthConfig signal;
+    signal.bpm = 72;
+    signal.spo2 = 97;
+    FirmwareHost host(dir.path(), signal);
+    host.run(30000);
+
+    EXPECT_TRUE(fingerPresent);
+    EXPECT_EQ(ringDroppedSamples, 0u);
+    EXPECT_GE(samplesAcquired, 2990u);
+    EXPECT_GT(host.frames.frames(), 0u);
+
+    std::unique_ptr<HttpExchange> data = host.get("/data");
+    ASSERT_TRUE(data->complete());
+    EXPECT_EQ(data->status(), 200);
+    DynamicJsonDocument json(512);
+    ASSERT_FALSE(deserializeJson(json, data->body().c_str()));
+    EXPECT_NEAR(json["pulse"].as<int>(), 72, 3);
+    EXPECT_NEAR(json["spo2"].as<int>(), 97, 2);
+    EXPECT_TRUE(json["finger_present"].as<bool>());
+  });
+}
+
+TEST(FirmwareBoot, NoFingerReportsNothing) {
+  TempDir dir;
+  runDevice([&]() {
+    PpgSynthConfig signal;
+    signal.noFinger.push_back({ 0, UINT32_MAX, 0 });
+    FirmwareHost host(dir.path(), signal);
+    host.run(10000);
+
+    EXPECT_FALSE(fingerPresent);
+    EXPECT_EQ(pulse, 0);
+    EXPECT_EQ(spo2, 0);
+  });
+}
+
+TEST(FirmwareBoot, DefaultAdminCanLogIn) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    host.run(1000);
+    ASSERT_TRUE(host.login("admin", "admin"));
+
+    std::unique_ptr<HttpExchange> data = host.get("/data");
+    DynamicJsonDocument json(512);
+    ASSERT_FALSE(deserializeJson(json, data->body().c_str()));
+    EXPECT_STREQ(json["username"].as<const char*>(), "admin");
+    EXPECT_TRUE(json["isAdmin"].as<bool>());
+  });
+}
+
+TEST(FirmwareBoot, UnknownPathRedirectsHome) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    std::unique_ptr<HttpExchange> page = host.get("/generate_204");
+    EXPECT_EQ(page->status(), 302);
+    EXPECT_EQ(page->header("Location"), "/");
+  });
+}
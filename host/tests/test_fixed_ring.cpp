@@ -0,0 +1,160 @@
+// FixedRing против std::deque, размер упакованной записи и кольцо последних
+// записей прошивки: в нём последние RECENT_RECORDS записей журнала по порядку
+#include <gtest/gtest.h>
+#include <ArduinoJson.h>
+#include <deque>
+#include <random>
+#include "firmware_host.h"
+#include "fixed_ring.h"
+#include "run_device.h"
+
+#define OLD_RECORDS_PER_USER 20
+#define OLD_RECORD_BYTES 12  // unsigned long и два int
+#define OLD_USERS 10
+#define RING_RECORDS 600     // RECENT_RECORDS в file.cpp
+
+namespace {
+
+template <typename T, uint16_t N>
+void expectSame(const FixedRing<T, N>& ring, const std::deque<T>& reference) {
+  ASSERT_EQ(ring.size(), reference.size());
+  EXPECT_EQ(ring.empty(), reference.empty());
+  EXPECT_EQ(ring.full(), reference.size() == N);
+  for (uint16_t i = 0; i < ring.size(); i++) {
+    ASSERT_EQ(ring[i], reference[i]) << i;
+  }
+  if (!ring.empty()) {
+    EXPECT_EQ(ring.oldest(), reference.front());
+    EXPECT_EQ(ring.newest(), reference.back());
+  }
+}
+
+TEST(FixedRing, IndexCountsFromOldestAcrossWrap) {
+  FixedRing<int, 4> ring;
+  for (int i = 1; i <= 4; i++) {
+    EXPECT_FALSE(ring.push(i));
+  }
+  EXPECT_TRUE(ring.full());
+  EXPECT_TRUE(ring.push(5));
+  EXPECT_TRUE(ring.push(6));
+  EXPECT_EQ(ring[0], 3);
+  EXPECT_EQ(ring[1], 4);
+  EXPECT_EQ(ring[2], 5);
+  EXPECT_EQ(ring[3], 6);
+  ring[0] = 30;
+  EXPECT_EQ(ring.oldest(), 30);
+  EXPECT_EQ(ring.newest(), 6);
+
+  ring.clear();
+  EXPECT_TRUE(ring.empty());
+  EXPECT_FALSE(ring.push(7));
+  EXPECT_EQ(ring.oldest(), 7);
+  EXPECT_EQ(ring.newest(), 7);
+}
+
+TEST(FixedRing, MatchesDequeUnderRandomPushes) {
+  std::mt19937 random(14);
+  FixedRing<uint32_t, 37> ring;
+  std::deque<uint32_t> reference;
+  for (int step = 0; step < 20000; step++) {
+    if (random() % 500 == 0) {
+      ring.clear();
+      reference.clear();
+    } else {
+      uint32_t value = random();
+      reference.push_back(value);
+      bool evicted = reference.size() > ring.capacity();
+      if (evicted) {
+        reference.pop_front();
+      }
+      ASSERT_EQ(ring.push(value), evicted) << step;
+    }
+    expectSame(ring, reference);
+  }
+}
+
+TEST(FixedRing, SingleSlot) {
+  FixedRing<int, 1> ring;
+  EXPECT_FALSE(ring.push(1));
+  EXPECT_TRUE(ring.push(2));
+  EXPECT_EQ(ring.size(), 1u);
+  EXPECT_EQ(ring[0], 2);
+}
+
+// Отчёт о памяти: кольцо последних записей одного пользователя не больше,
+// чем прежние records[20] у всех пользователей
+TEST(FixedRing, Footprint) {
+  static_assert(sizeof(PulseRecord) == 4, "PulseRecord must stay packed");
+  size_t oldBytes = OLD_USERS * OLD_RECORDS_PER_USER * OLD_RECORD_BYTES;
+  size_t ringBytes = sizeof(FixedRing<PulseRecord, RING_RECORDS>);
+  EXPECT_EQ(ringBytes, RING_RECORDS * sizeof(PulseRecord) + 2 * sizeof(uint16_t));
+  EXPECT_LE(ringBytes, oldBytes + 2 * sizeof(uint16_t));
+  RecordProperty("old_record_bytes", OLD_RECORD_BYTES);
+  RecordProperty("record_bytes", (int)sizeof(PulseRecord));
+  RecordProperty("old_history_bytes", (int)oldBytes);
+  RecordProperty("ring_bytes", (int)ringBytes);
+  printf("record %u -> %u bytes; %d users x %d records = %u bytes, ring of %d = %u bytes\n",
+         OLD_RECORD_BYTES, (unsigned)sizeof(PulseRecord), OLD_USERS, OLD_RECORDS_PER_USER,
+         (unsigned)oldBytes, RING_RECORDS, (unsigned)ringBytes);
+}
+
+// Сырая история пользователя на датчике по страницам /history
+std::vector<std::string> recentRows(FirmwareHost& host, uint32_t& first) {
+  std::vector<std::string> rows;
+  uint32_t from = 0;
+  first = 0;
+  for (int page = 0; page < 20; page++) {
+    std::unique_ptr<HttpExchange> history = host.get("/history?res=raw&from=" + String(from));
+    DynamicJsonDocument json(32768);
+    EXPECT_FALSE(deserializeJson(json, history->body().c_str()));
+    for (JsonVariant row : json["rows"].as<JsonArray>()) {
+      String text;
+      serializeJson(row, text);
+      rows.push_back(text.c_str());
+      if (rows.size() == 1) {
+        first = row[0];
+      }
+    }
+    if (json["next"].isNull()) {
+      break;
+    }
+    from = json["next"];
+  }
+  return rows;
+}
+
+TEST(RecentRing, HoldsNewestLogRecordsInOrder) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    ASSERT_TRUE(host.login("admin", "admin"));
+    host.run(70 * 60000);  // записей больше, чем вмещает кольцо
+    uint16_t userId = users.id(currentUserIndex);
+    ASSERT_GT(pulseLog.recordCount(userId), (uint32_t)RING_RECORDS);
+
+    uint32_t first;
+    std::vector<std::string> rows = recentRows(host, first);
+    ASSERT_EQ(rows.size(), (size_t)RING_RECORDS);
+
+    // Те же записи - хвост журнала
+    std::vector<std::string> tail;
+    PulseLogReader reader(pulseLog, userId, 0, UINT32_MAX);
+    PulseSample sample;
+    while (reader.next(sample)) {
+      char row[48];
+      snprintf(row, sizeof(row), "[%u,%u,%u,%s]", sample.time, sample.pulse, sample.spo2,
+               sample.quality ? "true" : "false");
+      tail.push_back(row);
+    }
+    tail.erase(tail.begin(), tail.end() - RING_RECORDS);
+    EXPECT_EQ(rows, tail);
+
+    // После повторного входа кольцо собирается из журнала таким же
+    ASSERT_TRUE(host.login("admin", "admin"));
+    uint32_t reloadedFirst;
+    EXPECT_EQ(recentRows(host, reloadedFirst), tail);
+    EXPECT_EQ(reloadedFirst, first);
+  });
+}
+
+}  // namespace
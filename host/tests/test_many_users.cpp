@@ -0,0 +1,70 @@
+// Модули прошивки, собранные с MAX_USERS больше 255 (firmware_modules_many_users):
+// таблица вмещает всех, а флеш-память журнала делится на всех, а не на
+// остаток от усечения числа пользователей до 8 бит
+#include <gtest/gtest.h>
+#include <LittleFS.h>
+#include <stdlib.h>
+#include <filesystem>
+#include "pulse_log.h"
+#include "pulse_rollup.h"
+#include "user_table.h"
+
+#define MANY_USERS_CAPACITY (64UL * 1024 * 1024)
+#define DEFAULT_CAPACITY (1024UL * 1024)  // как в fs.cpp
+
+static_assert(MAX_USERS > 255, "many_users_tests must be built with MAX_USERS above 255");
+
+namespace {
+
+class ManyUsersTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    char path[] = "/tmp/many_users_XXXXXX";
+    ASSERT_NE(mkdtemp(path), nullptr);
+    root = path;
+    hostFsMount(root);
+    hostFsSetCapacity(MANY_USERS_CAPACITY);
+    LittleFS.begin();
+  }
+
+  void TearDown() override {
+    hostFsSetCapacity(DEFAULT_CAPACITY);
+    std::filesystem::remove_all(root);
+  }
+
+  std::string root;
+};
+
+TEST_F(ManyUsersTest, TableHoldsEveryUser) {
+  static UserTable table;
+  char name[USER_NAME_SIZE];
+  for (int i = 0; i < MAX_USERS; i++) {
+    snprintf(name, sizeof(name), "user%d", i);
+    ASSERT_EQ(table.add(i + 1, name), i);
+  }
+  EXPECT_TRUE(table.full());
+  EXPECT_EQ(table.add(MAX_USERS + 1, "extra"), -1);
+  EXPECT_EQ(table.id(MAX_USERS - 1), MAX_USERS);
+}
+
+TEST_F(ManyUsersTest, SegmentBudgetIsSharedByAllUsers) {
+  PulseLog log;
+  log.begin(LittleFS, MAX_USERS, PulseRollup::bytesPerUser());
+  FSInfo info;
+  ASSERT_TRUE(LittleFS.info(info));
+  uint32_t share = (info.totalBytes - info.usedBytes - LOG_FS_RESERVE) / MAX_USERS;
+  uint32_t expected = (share - PulseRollup::bytesPerUser()) / LOG_SEGMENT_BYTES;
+  ASSERT_GT(expected, (uint32_t)LOG_MIN_SEGMENTS);
+  EXPECT_EQ(log.segmentBudget(), expected);
+  // Доли всех пользователей вместе со сводками помещаются в файловую систему
+  uint64_t total = (uint64_t)MAX_USERS * (log.segmentBudget() * LOG_SEGMENT_BYTES + PulseRollup::bytesPerUser());
+  EXPECT_LE(total, info.totalBytes - LOG_FS_RESERVE);
+
+  // Последний пользователь пишет в свою долю, как и первый
+  for (uint32_t i = 0; i < 2 * LOG_SEGMENT_RECORDS; i++) {
+    ASSERT_TRUE(log.append(MAX_USERS, 1000 + 5 * i, 70, 97, true)) << i;
+  }
+  EXPECT_EQ(log.recordCount(MAX_USERS), 2 * LOG_SEGMENT_RECORDS);
+}
+
+}  // namespace
@@ -0,0 +1,118 @@
+// Max30102Sensor против модели FIFO датчика на поддельной шине I2C
+#include <gtest/gtest.h>
+#include "fake_hal.h"
+#include "max30102_sensor.h"
+
+namespace {
+
+class Max30102SensorTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    Wire.attach(MAX30102_ADDRESS, &chip);
+    ASSERT_TRUE(sensor.begin());
+  }
+
+  void TearDown() override {
+    Wire.detach(MAX30102_ADDRESS);
+  }
+
+  // Значения с разными старшим, средним и младшим байтом у каждого канала
+  static uint32_t red(uint32_t i) {
+    return (0x10000 * (i % 4)) | (0x100 * (0x20 + i)) | (0x80 + i);
+  }
+  static uint32_t ir(uint32_t i) {
+    return (0x10000 * (3 - i % 4)) | (0x100 * (0x60 + i)) | (0x01 + i);
+  }
+
+  void push(uint32_t first, uint32_t count) {
+    for (uint32_t i = first; i < first + count; i++) {
+      chip.pushSample(red(i), ir(i));
+    }
+  }
+
+  FakeMax30102 chip;
+  FakeClock clock;
+  Max30102Sensor sensor{ Wire, clock };
+};
+
+TEST_F(Max30102SensorTest, BeginEnablesRollover) {
+  EXPECT_TRUE(chip.reg(0x08) & 0x10);
+  EXPECT_EQ(chip.reg(MAX30102_FIFO_WR_PTR), chip.reg(MAX30102_FIFO_RD_PTR));
+}
+
+TEST_F(Max30102SensorTest, ReadsSamplesInFifoOrder) {
+  push(0, 10);
+  clock.advance(100);
+  PpgSample samples[MAX30102_FIFO_DEPTH];
+  ASSERT_EQ(sensor.read(samples, MAX30102_FIFO_DEPTH), 10u);
+  for (uint32_t i = 0; i < 10; i++) {
+    EXPECT_EQ(samples[i].red, red(i)) << i;
+    EXPECT_EQ(samples[i].ir, ir(i)) << i;
+  }
+  // Последний отсчёт - текущий момент, предыдущие через период
+  EXPECT_EQ(samples[9].timestamp, clock.millis());
+  for (uint32_t i = 1; i < 10; i++) {
+    EXPECT_EQ(samples[i].timestamp - samples[i - 1].timestamp, (uint32_t)SAMPLE_PERIOD_MS);
+  }
+  EXPECT_EQ(sensor.read(samples, MAX30102_FIFO_DEPTH), 0u);
+  EXPECT_EQ(sensor.lostSamples(), 0u);
+}
+
+TEST_F(Max30102SensorTest, ReadsBeyondWireBufferInChunks) {
+  // 31 отсчёт = 186 байт, больше буфера Wire (128 байт)
+  push(0, 31);
+  PpgSample samples[MAX30102_FIFO_DEPTH];
+  ASSERT_EQ(sensor.read(samples, MAX30102_FIFO_DEPTH), 31u);
+  for (uint32_t i = 0; i < 31; i++) {
+    EXPECT_EQ(samples[i].red, red(i)) << i;
+    EXPECT_EQ(samples[i].ir, ir(i)) << i;
+  }
+  EXPECT_EQ(chip.fifoReads(), 31u);
+}
+
+TEST_F(Max30102SensorTest, LeavesRestForNextRead) {
+  push(0, 20);
+  PpgSample samples[MAX30102_FIFO_DEPTH];
+  ASSERT_EQ(sensor.read(samples, 5), 5u);
+  EXPECT_EQ(samples[4].red, red(4));
+  clock.advance(10);
+  ASSERT_EQ(sensor.read(samples, MAX30102_FIFO_DEPTH), 15u);
+  EXPECT_EQ(samples[0].red, red(5));
+  EXPECT_EQ(samples[14].ir, ir(19));
+}
+
+TEST_F(Max30102SensorTest, OverflowCountsLostSamplesAndKeepsNewest) {
+  // 40 отсчётов в FIFO на 32: с rollover затираются 8 самых старых
+  push(0, 40);
+  EXPECT_EQ(chip.reg(MAX30102_OVF_COUNTER), 8);
+  PpgSample samples[MAX30102_FIFO_DEPTH];
+  ASSERT_EQ(sensor.read(samples, MAX30102_FIFO_DEPTH), (size_t)MAX30102_FIFO_DEPTH);
+  EXPECT_EQ(sensor.lostSamples(), 8u);
+  for (uint32_t i = 0; i < MAX30102_FIFO_DEPTH; i++) {
+    EXPECT_EQ(samples[i].red, red(i + 8)) << i;
+    EXPECT_EQ(samples[i].ir, ir(i + 8)) << i;
+  }
+  EXPECT_EQ(chip.reg(MAX30102_OVF_COUNTER), 0);
+
+  // Следующее чтение снова обычное, потери не накапливаются повторно
+  push(40, 3);
+  ASSERT_EQ(sensor.read(samples, MAX30102_FIFO_DEPTH), 3u);
+  EXPECT_EQ(samples[0].red, red(40));
+  EXPECT_EQ(sensor.lostSamples(), 8u);
+}
+
+TEST_F(Max30102SensorTest, TimestampsNeverGoBackwards) {
+  push(0, 20);
+  PpgSample samples[MAX30102_FIFO_DEPTH];
+  ASSERT_EQ(sensor.read(samples, MAX30102_FIFO_DEPTH), 20u);
+  uint32_t last = samples[19].timestamp;
+  // Новые отсчёты пришли раньше, чем прошёл их период по часам
+  push(20, 5);
+  ASSERT_EQ(sensor.read(samples, MAX30102_FIFO_DEPTH), 5u);
+  EXPECT_GT((int32_t)(samples[0].timestamp - last), 0);
+  for (uint32_t i = 1; i < 5; i++) {
+    EXPECT_GT((int32_t)(samples[i].timestamp - samples[i - 1].timestamp), 0);
+  }
+}
+
+}  // namespace
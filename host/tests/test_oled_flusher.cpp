@@ -0,0 +1,153 @@
+// OledFlusher против модели SSD1306 на шине: после каждого кадра ОЗУ дисплея
+// совпадает с кадром, а по шине идут только изменившиеся участки
+#include <gtest/gtest.h>
+#include <random>
+#include "fake_hal.h"
+#include "firmware_host.h"
+#include "oled_renderer.h"
+#include "run_device.h"
+
+#define OLED_ADDRESS 0x3C
+#define WINDOW_BYTES 8                               // адрес, управляющий байт, 6 байт команд окна
+#define FULL_FRAME_BYTES (OLED_PAGES * (WINDOW_BYTES + 2 + (BUFFER_LENGTH - 1) + 2 + 1))
+
+namespace {
+
+class OledFlusherTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    Wire.attach(OLED_ADDRESS, &oled);
+    memset(frame, 0, sizeof(frame));
+  }
+
+  void TearDown() override {
+    Wire.detach(OLED_ADDRESS);
+  }
+
+  // Отправляет кадр и сверяет счёт байт с тем, что реально ушло по шине
+  size_t flush() {
+    HostWireStats before = Wire.stats(OLED_ADDRESS);
+    size_t bytes = flusher.flush(frame);
+    HostWireStats after = Wire.stats(OLED_ADDRESS);
+    // Wire не считает байт адреса, по одному на транзакцию
+    uint64_t onWire = (after.bytesWritten - before.bytesWritten) + (after.writeTransactions - before.writeTransactions);
+    EXPECT_EQ(bytes, onWire);
+    EXPECT_EQ(memcmp(oled.gddram(), frame, OLED_FRAME_SIZE), 0);
+    return bytes;
+  }
+
+  FakeSsd1306 oled;
+  OledFlusher flusher{ Wire, OLED_ADDRESS };
+  uint8_t frame[OLED_FRAME_SIZE];
+};
+
+TEST_F(OledFlusherTest, FirstFrameIsSentWhole) {
+  frame[5] = 0xAA;
+  EXPECT_EQ(flush(), (size_t)FULL_FRAME_BYTES);
+  EXPECT_EQ(oled.dataBytes(), (uint64_t)OLED_FRAME_SIZE);
+}
+
+TEST_F(OledFlusherTest, UnchangedFrameSendsNothing) {
+  flush();
+  EXPECT_EQ(flush(), 0u);
+  EXPECT_EQ(flusher.lastFrameBytes(), 0u);
+}
+
+TEST_F(OledFlusherTest, SinglePixelSendsOneColumn) {
+  flush();
+  frame[3 * OLED_WIDTH + 77] |= 0x10;
+  EXPECT_EQ(flush(), (size_t)(WINDOW_BYTES + 2 + 1));
+}
+
+TEST_F(OledFlusherTest, RangeSpansFirstToLastChangedColumn) {
+  flush();
+  frame[2 * OLED_WIDTH + 10] = 1;
+  frame[2 * OLED_WIDTH + 40] = 1;
+  frame[6 * OLED_WIDTH + 127] = 1;
+  EXPECT_EQ(flush(), (size_t)(WINDOW_BYTES + 2 + 31 + WINDOW_BYTES + 2 + 1));
+}
+
+TEST_F(OledFlusherTest, ClockDigitChangeIsSmall) {
+  oledGlyphCacheInit();
+  oledDrawNumber(frame, 0, 0, 12, 2);
+  oledDrawText(frame, 0, 12, ":");
+  oledDrawNumber(frame, 0, 18, 59, 2);
+  flush();
+  oledDrawNumber(frame, 0, 0, 13, 2);
+  oledDrawNumber(frame, 0, 18, 0, 2);
+  size_t bytes = flush();
+  // Одна страница, столбцы от второй цифры часов до конца минут
+  EXPECT_LE(bytes, (size_t)(WINDOW_BYTES + 2 + 4 * OLED_GLYPH_WIDTH));
+  EXPECT_LT(bytes * 20, (size_t)FULL_FRAME_BYTES);
+}
+
+TEST_F(OledFlusherTest, PeriodicFullRefresh) {
+  flush();
+  for (int i = 1; i < OLED_FULL_REFRESH_FRAMES; i++) {
+    EXPECT_EQ(flush(), 0u) << i;
+  }
+  EXPECT_EQ(flush(), (size_t)FULL_FRAME_BYTES);
+}
+
+TEST_F(OledFlusherTest, InvalidateSendsWholeFrame) {
+  flush();
+  flusher.invalidate();
+  EXPECT_EQ(flush(), (size_t)FULL_FRAME_BYTES);
+}
+
+TEST_F(OledFlusherTest, RandomEditsKeepDisplayInSync) {
+  std::mt19937 random(5);
+  flush();
+  uint64_t total = 0;
+  for (int i = 0; i < 500; i++) {
+    int edits = random() % 6;
+    size_t expected = 0;
+    uint8_t first[OLED_PAGES];
+    uint8_t last[OLED_PAGES];
+    memset(first, 0xFF, sizeof(first));
+    memset(last, 0, sizeof(last));
+    for (int e = 0; e < edits; e++) {
+      uint8_t page = random() % OLED_PAGES;
+      uint8_t column = random() % OLED_WIDTH;
+      uint8_t value = random();
+      if (frame[page * OLED_WIDTH + column] == value) {
+        continue;
+      }
+      frame[page * OLED_WIDTH + column] = value;
+      first[page] = column < first[page] ? column : first[page];
+      last[page] = column > last[page] ? column : last[page];
+    }
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+      if (first[page] != 0xFF) {
+        size_t length = last[page] - first[page] + 1;
+        expected += WINDOW_BYTES + length + 2 * ((length + BUFFER_LENGTH - 2) / (BUFFER_LENGTH - 1));
+      }
+    }
+    size_t bytes = flush();
+    if (bytes != (size_t)FULL_FRAME_BYTES) {  // плановая полная перерисовка
+      EXPECT_EQ(bytes, expected) << "frame " << i;
+    }
+    total += bytes;
+  }
+  EXPECT_LT(total, 500u * FULL_FRAME_BYTES / 4);
+}
+
+// Экран прошивки в обычной работе: сколько байт уходит на кадр
+TEST(OledFlusherFirmware, SteadyStateBytesPerFrame) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    host.run(5000);
+    uint32_t frames = host.frames.frames();
+    uint64_t bytes = host.frames.bytesSent();
+    host.run(60000);
+    frames = host.frames.frames() - frames;
+    bytes = host.frames.bytesSent() - bytes;
+    ASSERT_GT(frames, 0u);
+    // Полные перерисовки по OLED_FULL_REFRESH_FRAMES входят в среднее
+    EXPECT_LT(bytes / frames, (uint64_t)FULL_FRAME_BYTES / 4) << bytes / frames << " bytes per frame";
+    EXPECT_EQ(memcmp(host.oled.gddram(), host.frames.lastFrame(), OLED_FRAME_SIZE), 0);
+  });
+}
+
+}  // namespace
@@ -0,0 +1,91 @@
+// Вывод текста глифами прямо в буфер кадра SSD1306
+#include <gtest/gtest.h>
+#include "oled_renderer.h"
+
+namespace {
+
+class OledGlyphsTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    oledGlyphCacheInit();
+    memset(frame, 0, sizeof(frame));
+  }
+
+  const uint8_t* column(uint8_t page, uint8_t x) const {
+    return frame + page * OLED_WIDTH + x;
+  }
+
+  uint8_t frame[OLED_FRAME_SIZE];
+};
+
+TEST_F(OledGlyphsTest, GlyphsAreFiveColumnsAndASpace) {
+  memset(frame, 0xFF, sizeof(frame));
+  EXPECT_EQ(oledDrawText(frame, 2, 10, "AB"), 10 + 2 * OLED_GLYPH_WIDTH);
+  EXPECT_EQ(*column(2, 10 + OLED_GLYPH_COLUMNS), 0);
+  EXPECT_EQ(*column(2, 10 + OLED_GLYPH_WIDTH + OLED_GLYPH_COLUMNS), 0);
+  EXPECT_NE(memcmp(column(2, 10), column(2, 10 + OLED_GLYPH_WIDTH), OLED_GLYPH_COLUMNS), 0);
+  // Соседние страницы и столбцы не тронуты
+  EXPECT_EQ(*column(2, 9), 0xFF);
+  EXPECT_EQ(*column(2, 10 + 2 * OLED_GLYPH_WIDTH), 0xFF);
+  EXPECT_EQ(*column(1, 10), 0xFF);
+  EXPECT_EQ(*column(3, 10), 0xFF);
+}
+
+TEST_F(OledGlyphsTest, DigitCacheMatchesFont) {
+  uint8_t fromText[OLED_FRAME_SIZE] = {};
+  oledDrawText(fromText, 0, 0, "0123456789");
+  oledDrawNumber(frame, 0, 0, 123456789, 10);
+  EXPECT_EQ(memcmp(frame, fromText, OLED_WIDTH), 0);
+}
+
+TEST_F(OledGlyphsTest, FlashAndRamTextMatch) {
+  uint8_t fromRam[OLED_FRAME_SIZE] = {};
+  oledDrawText(fromRam, 4, 0, "SpO2: 97%");
+  oledDrawText_P(frame, 4, 0, PSTR("SpO2: 97%"));
+  EXPECT_EQ(memcmp(frame, fromRam, OLED_FRAME_SIZE), 0);
+}
+
+TEST_F(OledGlyphsTest, UnknownSymbolsDrawQuestionMark) {
+  uint8_t question[OLED_FRAME_SIZE] = {};
+  oledDrawText(question, 0, 0, "??");
+  oledDrawText(frame, 0, 0, "\x01\xC8");
+  EXPECT_EQ(memcmp(frame, question, OLED_WIDTH), 0);
+}
+
+TEST_F(OledGlyphsTest, NumbersArePaddedAndComplete) {
+  uint8_t expected[OLED_FRAME_SIZE] = {};
+  oledDrawText(expected, 1, 0, "07");
+  EXPECT_EQ(oledDrawNumber(frame, 1, 0, 7, 2), 2 * OLED_GLYPH_WIDTH);
+  EXPECT_EQ(memcmp(frame, expected, OLED_FRAME_SIZE), 0);
+
+  memset(expected, 0, sizeof(expected));
+  memset(frame, 0, sizeof(frame));
+  oledDrawText(expected, 1, 0, "4294967295");
+  oledDrawNumber(frame, 1, 0, UINT32_MAX, 1);
+  EXPECT_EQ(memcmp(frame, expected, OLED_FRAME_SIZE), 0);
+}
+
+TEST_F(OledGlyphsTest, TextIsClippedAtScreenEdge) {
+  // 21 символ по 6 столбцов = 126; 22-й уже не помещается
+  uint8_t end = oledDrawText(frame, 7, 0, "ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+  EXPECT_EQ(end, OLED_WIDTH);
+  EXPECT_EQ(*column(7, 126), 0);
+  EXPECT_EQ(*column(7, 127), 0);
+  EXPECT_EQ(oledDrawNumber(frame, 6, 125, 5, 1), OLED_WIDTH);
+  for (uint8_t x = 0; x < OLED_WIDTH; x++) {
+    EXPECT_EQ(*column(6, x), 0) << (int)x;
+  }
+}
+
+TEST_F(OledGlyphsTest, HorizontalLineSetsOneRow) {
+  oledDrawText(frame, 1, 0, "Title");
+  uint8_t before = *column(1, 0);
+  oledDrawHLine(frame, 9);
+  for (uint8_t x = 0; x < OLED_WIDTH; x++) {
+    EXPECT_TRUE(*column(1, x) & 0x02) << (int)x;
+  }
+  EXPECT_EQ(*column(1, 0), before | 0x02);
+  EXPECT_EQ(*column(0, 0), 0);
+}
+
+}  // namespace
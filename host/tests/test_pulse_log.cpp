@@ -0,0 +1,201 @@
+// Журнал пульса на файловой системе хоста: запись не открывает файл на
+// каждую запись, чтение ничего не меняет на флеш, после сбоя питания
+// недописанный хвост отрезается. Время журнала не идёт назад между загрузками
+#include <gtest/gtest.h>
+#include <LittleFS.h>
+#include "firmware_host.h"
+#include "log_clock.h"
+#include "pulse_log.h"
+
+#define TEST_USER 3
+#define OTHER_USER 4
+
+namespace {
+
+class PulseLogTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    hostFsMount(dir.path());
+    LittleFS.begin();
+    log.begin(LittleFS, 4, 0);
+  }
+
+  void appendSeries(PulseLog& target, uint16_t userId, uint32_t start, int count) {
+    for (int i = 0; i < count; i++) {
+      ASSERT_TRUE(target.append(userId, start + 5 * i, 60 + i % 40, 95 + i % 5, i % 3 != 0)) << i;
+    }
+  }
+
+  std::vector<PulseSample> readAll(PulseLog& source, uint16_t userId) {
+    std::vector<PulseSample> samples;
+    PulseLogReader reader(source, userId, 0, UINT32_MAX);
+    PulseSample sample;
+    while (reader.next(sample)) {
+      samples.push_back(sample);
+    }
+    return samples;
+  }
+
+  std::string segmentFile(uint16_t userId, uint16_t sequence) {
+    char path[32];
+    logSegmentPath(path, sizeof(path), userId, sequence);
+    return dir.path() + path;
+  }
+
+  TempDir dir;
+  PulseLog log;
+};
+
+TEST_F(PulseLogTest, AppendsKeepSegmentOpen) {
+  appendSeries(log, TEST_USER, 1000, 1);
+  hostFsResetStats();
+  appendSeries(log, TEST_USER, 2000, 2 * LOG_SEGMENT_RECORDS);
+  HostFsStats stats = hostFsStats();
+  // Файл открывается на сегмент, а не на запись: новый сегмент и его индекс
+  EXPECT_LE(stats.opensWrite + stats.opensAppend + stats.opensUpdate, 2u * 2 + 1);
+  EXPECT_EQ(stats.writeCalls, 2u * LOG_SEGMENT_RECORDS + 2 * 2);
+  EXPECT_EQ(stats.openHandles, 1);  // открыт только активный сегмент
+  EXPECT_EQ(log.recordCount(TEST_USER), 2u * LOG_SEGMENT_RECORDS + 1);
+}
+
+TEST_F(PulseLogTest, WriterSeesOwnRecordsRightAway) {
+  appendSeries(log, TEST_USER, 1000, 5);
+  EXPECT_EQ(readAll(log, TEST_USER).size(), 5u);
+  EXPECT_EQ(log.lastTime(TEST_USER), 1000u + 5 * 4);
+  appendSeries(log, TEST_USER, 2000, 1);
+  EXPECT_EQ(readAll(log, TEST_USER).size(), 6u);
+  EXPECT_EQ(log.recordCount(TEST_USER), 6u);
+}
+
+TEST_F(PulseLogTest, ReadsDoNotTouchFlash) {
+  appendSeries(log, TEST_USER, 1000, 10);
+  appendSeries(log, OTHER_USER, 1000, 10);
+  hostFsResetStats();
+
+  // Другой пользователь, пользователь без журнала, пишущий пользователь
+  EXPECT_EQ(readAll(log, TEST_USER).size(), 10u);
+  EXPECT_EQ(log.recordCount(TEST_USER), 10u);
+  EXPECT_EQ(log.lastTime(7), 0u);
+  EXPECT_EQ(log.recordCount(7), 0u);
+  EXPECT_TRUE(readAll(log, 7).empty());
+  EXPECT_EQ(readAll(log, OTHER_USER).size(), 10u);
+
+  HostFsStats stats = hostFsStats();
+  EXPECT_EQ(stats.opensWrite + stats.opensAppend + stats.opensUpdate, 0u);
+  EXPECT_EQ(stats.mkdirs, 0u);
+  EXPECT_EQ(stats.removes, 0u);
+  EXPECT_EQ(stats.writeCalls, 0u);
+  EXPECT_FALSE(LittleFS.exists(LOG_DIRECTORY "/7"));
+
+  // Чтение не вытеснило пишущего: следующая запись не перечитывает сегмент
+  hostFsResetStats();
+  appendSeries(log, OTHER_USER, 2000, 1);
+  EXPECT_EQ(hostFsStats().readCalls, 0u);
+}
+
+TEST_F(PulseLogTest, TornTailIsIgnoredByReadsAndCutByWriter) {
+  appendSeries(log, TEST_USER, 1000, 10);
+  log.flush();
+  // Сбой питания на середине записи: в сегменте лишние 2 байта
+  FILE* file = fopen(segmentFile(TEST_USER, 0).c_str(), "ab");
+  ASSERT_NE(file, nullptr);
+  fwrite("\x01\x02", 1, 2, file);
+  fclose(file);
+
+  PulseLog rebooted;
+  rebooted.begin(LittleFS, 4, 0);
+  hostFsResetStats();
+  EXPECT_EQ(rebooted.recordCount(TEST_USER), 10u);
+  EXPECT_EQ(rebooted.lastTime(TEST_USER), 1000u + 9 * 5);
+  EXPECT_EQ(readAll(rebooted, TEST_USER).size(), 10u);
+  HostFsStats stats = hostFsStats();
+  EXPECT_EQ(stats.opensWrite + stats.opensAppend + stats.opensUpdate, 0u);
+  EXPECT_EQ(stats.writeCalls, 0u);
+
+  // Первая запись после перезагрузки отрезает хвост
+  appendSeries(rebooted, TEST_USER, 2000, 1);
+  std::vector<PulseSample> samples = readAll(rebooted, TEST_USER);
+  ASSERT_EQ(samples.size(), 11u);
+  EXPECT_EQ(samples.back().time, 2000u);
+  EXPECT_EQ(samples[9].time, 1045u);
+}
+
+TEST_F(PulseLogTest, CorruptSegmentIsEmptyForReadersUntilRewritten) {
+  appendSeries(log, TEST_USER, 1000, 10);
+  log.flush();
+  FILE* file = fopen(segmentFile(TEST_USER, 0).c_str(), "r+b");
+  ASSERT_NE(file, nullptr);
+  fwrite("XXXX", 1, 4, file);
+  fclose(file);
+
+  PulseLog rebooted;
+  rebooted.begin(LittleFS, 4, 0);
+  hostFsResetStats();
+  EXPECT_EQ(rebooted.recordCount(TEST_USER), 0u);
+  EXPECT_TRUE(readAll(rebooted, TEST_USER).empty());
+  EXPECT_EQ(hostFsStats().removes, 0u);
+  EXPECT_TRUE(LittleFS.exists(LOG_DIRECTORY "/3/00000.seg"));
+
+  appendSeries(rebooted, TEST_USER, 2000, 3);
+  EXPECT_EQ(readAll(rebooted, TEST_USER).size(), 3u);
+}
+
+TEST_F(PulseLogTest, SwitchingWriterClosesSegment) {
+  appendSeries(log, TEST_USER, 1000, 3);
+  appendSeries(log, OTHER_USER, 1000, 3);
+  EXPECT_EQ(hostFsStats().openHandles, 1);
+  appendSeries(log, TEST_USER, 2000, 3);
+  EXPECT_EQ(hostFsStats().openHandles, 1);
+  log.remove(TEST_USER);
+  EXPECT_EQ(hostFsStats().openHandles, 0);
+  EXPECT_EQ(log.recordCount(TEST_USER), 0u);
+  EXPECT_EQ(readAll(log, OTHER_USER).size(), 3u);
+}
+
+TEST_F(PulseLogTest, ClockContinuesAfterReboot) {
+  LogClock clock;
+  EXPECT_FALSE(clock.begin(LittleFS, 123456));
+  uint32_t issued = 0;
+  hostFsResetStats();
+  // Час работы, сохранение границы - каждую секунду, как из persistTask
+  for (uint32_t ms = 123456; ms < 123456 + 3600000; ms += 1000) {
+    issued = clock.now(ms);
+    clock.persist(ms);
+  }
+  EXPECT_GE(issued, 3599u);
+  // Граница продлевается раз в половину срока, а не на каждом вызове
+  EXPECT_LE(hostFsStats().renames, 3600u / (LOG_CLOCK_LEASE / 2) + 1);
+
+  // Новая загрузка: millis снова с нуля, время журнала - нет
+  LogClock rebooted;
+  EXPECT_TRUE(rebooted.begin(LittleFS, 0));
+  EXPECT_GT(rebooted.now(0), issued);
+  EXPECT_LE(rebooted.now(0), issued + LOG_CLOCK_LEASE + 1);
+}
+
+TEST_F(PulseLogTest, ClockSurvivesMillisWraparound) {
+  LogClock clock;
+  clock.begin(LittleFS, UINT32_MAX - 4999);
+  EXPECT_EQ(clock.now(UINT32_MAX - 4999), 0u);
+  EXPECT_EQ(clock.now(5000), 10u);
+  EXPECT_EQ(clock.now(UINT32_MAX), 4294972u);  // полный оборот millis после старта
+}
+
+TEST_F(PulseLogTest, ClockWithoutBoundaryStartsAfterLog) {
+  LogClock clock;
+  clock.begin(LittleFS, 0);
+  LittleFS.remove(LOG_CLOCK_FILE);
+  LogClock rebooted;
+  EXPECT_FALSE(rebooted.begin(LittleFS, 0));
+  rebooted.notBefore(5000, 0);
+  EXPECT_EQ(rebooted.now(0), 5000u);
+  rebooted.notBefore(100, 0);
+  EXPECT_EQ(rebooted.now(2000), 5002u);
+
+  // Граница сохранена и после сдвига
+  LogClock next;
+  EXPECT_TRUE(next.begin(LittleFS, 0));
+  EXPECT_GT(next.now(0), 5002u);
+}
+
+}  // namespace
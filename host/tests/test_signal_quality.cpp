@@ -0,0 +1,111 @@
+// Участки движения в синтетическом сигнале: пока индекс качества низкий или
+// пальца нет, /data и /events показывают пульс и SpO2 нулями, а не последними
+// хорошими значениями; после движения показания возвращаются
+#include <gtest/gtest.h>
+#include <ArduinoJson.h>
+#include <map>
+#include "firmware_host.h"
+#include "run_device.h"
+
+#define MOTION_TEST_MS 120000
+#define MOTION_POLL_MS 250
+#define MOTION_RECOVERY_MS 15000  // окно SQI, кольцо RR и окно SpO2 после движения
+
+namespace {
+
+struct Reading {
+  uint32_t time;
+  int pulse;
+  int spo2;
+  int sqi;
+};
+
+// Последние значения из кадров "vitals": полных снимков и дельт
+void receiveVitals(AsyncEventSourceClient* client, std::map<std::string, int>& fields) {
+  std::string text = client->drain().c_str();
+  for (size_t start = 0, end; (end = text.find("\r\n\r\n", start)) != std::string::npos; start = end + 4) {
+    std::string block = text.substr(start, end - start);
+    size_t data = block.find("data: ");
+    if (block.find("event: vitals") == std::string::npos || data == std::string::npos) {
+      continue;
+    }
+    DynamicJsonDocument json(512);
+    ASSERT_FALSE(deserializeJson(json, block.substr(data + 6).c_str()));
+    for (JsonPair pair : json.as<JsonObject>()) {
+      if (pair.value().is<int>()) {
+        fields[pair.key()] = pair.value().as<int>();
+      }
+    }
+  }
+}
+
+TEST(MotionArtifacts, LowQualityClearsPulseAndSpo2) {
+  PpgSynthConfig signal;
+  signal.bpm = 68;
+  signal.spo2 = 97;
+  signal.seed = 21;
+  signal.motion.push_back({ 40000, 55000, 0.02f });
+  signal.motion.push_back({ 85000, 88000, 0.05f });
+  signal.noFinger.push_back({ 110000, 114000, 0 });
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path(), signal);
+    ASSERT_TRUE(host.login("admin", "admin"));
+    std::unique_ptr<HttpExchange> events = host.open(HTTP_GET, "/events");
+    AsyncEventSourceClient* client = events->request()->eventClient();
+    ASSERT_NE(client, nullptr);
+    std::map<std::string, int> live;
+
+    std::vector<Reading> readings;
+    uint32_t start = millis();
+    while (millis() - start < MOTION_TEST_MS) {
+      host.run(MOTION_POLL_MS);
+      DynamicJsonDocument json(1024);
+      ASSERT_FALSE(deserializeJson(json, host.get("/data")->body().c_str()));
+      Reading reading = { (uint32_t)(millis() - start), json["pulse"], json["spo2"], json["sqi"] };
+      readings.push_back(reading);
+      // Плохое окно не показывает ни прежний пульс, ни прежний SpO2
+      if (reading.sqi < 50) {
+        EXPECT_EQ(reading.pulse, 0) << "at " << reading.time << " ms, sqi " << reading.sqi;
+        EXPECT_EQ(reading.spo2, 0) << "at " << reading.time << " ms, sqi " << reading.sqi;
+      }
+      // Кадры /events идут по своему расписанию: сверяем, когда окно плохое
+      // уже с прошлого опроса
+      receiveVitals(client, live);
+      if (reading.sqi < 50 && readings.size() > 1 && readings[readings.size() - 2].sqi < 50) {
+        EXPECT_EQ(live["pulse"], 0) << "at " << reading.time << " ms";
+        EXPECT_EQ(live["spo2"], 0) << "at " << reading.time << " ms";
+      }
+    }
+
+    for (const PpgSegment& motion : signal.motion) {
+      // Движение распознано...
+      bool flagged = false;
+      bool recovered = false;
+      for (const Reading& reading : readings) {
+        if (reading.time >= motion.start && reading.time < motion.end + 2000 && reading.sqi < 50) {
+          flagged = true;
+        }
+        // ...и после него пульс и SpO2 снова близки к настоящим
+        if (reading.time >= motion.end + MOTION_RECOVERY_MS && reading.time < motion.end + MOTION_RECOVERY_MS + 5000) {
+          EXPECT_NEAR(reading.pulse, signal.bpm, 3) << "at " << reading.time << " ms";
+          EXPECT_NEAR(reading.spo2, signal.spo2, 3) << "at " << reading.time << " ms";
+          recovered = true;
+        }
+      }
+      EXPECT_TRUE(flagged) << motion.start;
+      EXPECT_TRUE(recovered) << motion.start;
+    }
+
+    // Палец убрали: показания гаснут сразу, не дожидаясь окна качества
+    const PpgSegment& removed = signal.noFinger.front();
+    for (const Reading& reading : readings) {
+      if (reading.time >= removed.start + 500 && reading.time < removed.end) {
+        EXPECT_EQ(reading.pulse, 0) << "at " << reading.time << " ms";
+        EXPECT_EQ(reading.spo2, 0) << "at " << reading.time << " ms";
+      }
+    }
+  });
+}
+
+}  // namespace
@@ -0,0 +1,101 @@
+// Прогон прошивки на записанном сигнале: повторяемость и разбор записи
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include "firmware_host.h"
+#include "ppg_synth.h"
+#include "run_device.h"
+#include "simulation.h"
+#include "trace_sensor.h"
+
+static std::string readFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream text;
+  text << file.rdbuf();
+  return text.str();
+}
+
+static void writeScript(const std::string& path) {
+  std::ofstream script(path);
+  script << "# вход и показания\n"
+         << "1000 POST /login?username=admin&password=admin\n"
+         << "30000 /data\n"
+         << "\n"
+         << "59000 GET /data\n";
+}
+
+static void simulate(const SimulationOptions& options) {
+  runDevice([&]() {
+    SimulationResult result = runSimulation(options);
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.requests, 3u);
+    EXPECT_EQ(result.dropped, 0u);
+  });
+}
+
+TEST(Simulation, ReplayIsDeterministic) {
+  TempDir dir;
+  PpgSynth synth(PpgSynthConfig{});
+  ASSERT_TRUE(writeTrace(dir.path() + "/trace.ppgt", 60000, 10, [&](uint32_t t, uint32_t& red, uint32_t& ir) {
+    synth.sample(t, red, ir);
+  }));
+  writeScript(dir.path() + "/script.txt");
+
+  SimulationOptions options;
+  options.trace = dir.path() + "/trace.ppgt";
+  options.script = dir.path() + "/script.txt";
+  options.out = dir.path() + "/first";
+  simulate(options);
+  options.out = dir.path() + "/second";
+  simulate(options);
+
+  std::string first = readFile(dir.path() + "/first/output.txt");
+  EXPECT_NE(first.find("/data 200 {"), std::string::npos) << first;
+  EXPECT_NE(first.find(" frame "), std::string::npos);
+  EXPECT_NE(first.find("end samples=6000 dropped=0"), std::string::npos) << first;
+  EXPECT_EQ(first, readFile(dir.path() + "/second/output.txt"));
+  EXPECT_EQ(readFile(dir.path() + "/first/fs/users.json"), readFile(dir.path() + "/second/fs/users.json"));
+}
+
+TEST(Simulation, CsvAndBinaryTracesMatch) {
+  TempDir dir;
+  PpgSynth binary(PpgSynthConfig{});
+  ASSERT_TRUE(writeTrace(dir.path() + "/trace.ppgt", 60000, 10, [&](uint32_t t, uint32_t& red, uint32_t& ir) {
+    binary.sample(t, red, ir);
+  }));
+  PpgSynth text(PpgSynthConfig{});
+  {
+    std::ofstream csv(dir.path() + "/trace.csv");
+    csv << "t_ms,red,ir\n";
+    for (uint32_t t = 0; t < 60000; t += 10) {
+      uint32_t red;
+      uint32_t ir;
+      text.sample(t, red, ir);
+      csv << t << "," << red << "," << ir << "\n";
+    }
+  }
+  writeScript(dir.path() + "/script.txt");
+
+  SimulationOptions options;
+  options.script = dir.path() + "/script.txt";
+  options.trace = dir.path() + "/trace.ppgt";
+  options.out = dir.path() + "/binary";
+  simulate(options);
+  options.trace = dir.path() + "/trace.csv";
+  options.out = dir.path() + "/csv";
+  simulate(options);
+
+  EXPECT_EQ(readFile(dir.path() + "/binary/output.txt"), readFile(dir.path() + "/csv/output.txt"));
+}
+
+TEST(Simulation, MissingTraceIsReported) {
+  TempDir dir;
+  runDevice([&]() {
+    SimulationOptions options;
+    options.trace = dir.path() + "/missing.csv";
+    options.out = dir.path() + "/out";
+    SimulationResult result = runSimulation(options);
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.error.find("missing.csv"), std::string::npos);
+  });
+}
@@ -0,0 +1,94 @@
+// Потоковый Spo2Engine против прежнего пакетного расчёта Maxim на одном и
+// том же синтетическом сигнале
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <spo2_algorithm.h>
+#include "firmware_host.h"
+#include "run_device.h"
+
+#define SPO2_TEST_MS 60000
+#define SPO2_SETTLE_MS 10000
+
+namespace {
+
+int median(std::vector<int> values) {
+  if (values.empty()) {
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+// Прежняя прошивка: буфер на 4 секунды, расчёт раз в секунду. Алгоритм
+// рассчитан на 25 Гц, поэтому отсчёты 100 Гц усредняются по четыре.
+std::vector<int> referenceSpo2(const PpgSynthConfig& signal) {
+  PpgSynth synth(signal);
+  std::vector<uint32_t> red;
+  std::vector<uint32_t> ir;
+  std::vector<int> results;
+  const uint32_t decimation = SENSOR_OUTPUT_RATE / FreqS;
+  uint64_t redSum = 0;
+  uint64_t irSum = 0;
+  for (uint32_t i = 0; i * SAMPLE_PERIOD_MS < SPO2_TEST_MS; i++) {
+    uint32_t redValue;
+    uint32_t irValue;
+    synth.sample(i * SAMPLE_PERIOD_MS, redValue, irValue);
+    redSum += redValue;
+    irSum += irValue;
+    if ((i + 1) % decimation != 0) {
+      continue;
+    }
+    red.push_back(redSum / decimation);
+    ir.push_back(irSum / decimation);
+    redSum = 0;
+    irSum = 0;
+    if (red.size() < BUFFER_SIZE || red.size() % FreqS != 0 ||
+        red.size() * 1000 / FreqS < SPO2_SETTLE_MS) {
+      continue;
+    }
+    int32_t spo2;
+    int8_t spo2Valid;
+    int32_t heartRate;
+    int8_t heartRateValid;
+    maxim_heart_rate_and_oxygen_saturation(&ir[ir.size() - BUFFER_SIZE], BUFFER_SIZE, &red[red.size() - BUFFER_SIZE],
+                                           &spo2, &spo2Valid, &heartRate, &heartRateValid);
+    if (spo2Valid && spo2 > 0 && spo2 <= 100) {
+      results.push_back(spo2);
+    }
+  }
+  return results;
+}
+
+class Spo2Equivalence : public ::testing::TestWithParam<int> {};
+
+TEST_P(Spo2Equivalence, StreamingMatchesBatchRoutine) {
+  PpgSynthConfig signal;
+  signal.spo2 = GetParam();
+  signal.seed = 11 + GetParam();
+  std::vector<int> reference = referenceSpo2(signal);
+  ASSERT_GT(reference.size(), (size_t)(SPO2_TEST_MS - SPO2_SETTLE_MS) / 2000);
+  int expected = median(reference);
+
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path(), signal);
+    host.run(SPO2_SETTLE_MS);
+    std::vector<int> streaming;
+    for (uint32_t t = SPO2_SETTLE_MS; t < SPO2_TEST_MS; t += 1000) {
+      host.run(1000);
+      streaming.push_back((int)spo2);
+    }
+    int measured = median(streaming);
+    EXPECT_NEAR(measured, expected, 2) << "batch " << expected << ", streaming " << measured;
+    EXPECT_NEAR(measured, GetParam(), 2);
+    // Почти каждое ежесекундное значение рядом с пакетным расчётом
+    size_t close = std::count_if(streaming.begin(), streaming.end(),
+                                 [&](int value) { return abs(value - expected) <= 2; });
+    EXPECT_GE(close * 10, streaming.size() * 9);
+  });
+  EXPECT_NEAR(expected, GetParam(), 3);
+}
+
+INSTANTIATE_TEST_SUITE_P(Levels, Spo2Equivalence, ::testing::Values(88, 92, 95, 97, 99));
+
+}  // namespace
@@ -0,0 +1,118 @@
+// Раздача интерфейса из LittleFS: сжатый файл, ETag и ответ 304 без тела.
+// Архив собирает tools/build_assets.py, как для образа LittleFS.
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+#include "firmware_host.h"
+#include "run_device.h"
+
+namespace {
+
+std::string readFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+}
+
+// FNV-1a, как loadStaticAssets() и build_assets.py
+String etagOf(const std::string& content) {
+  uint32_t hash = 2166136261UL;
+  for (unsigned char byte : content) {
+    hash = (hash ^ byte) * 16777619UL;
+  }
+  char etag[11];
+  snprintf(etag, sizeof(etag), "\"%08lx\"", (unsigned long)hash);
+  return String(etag);
+}
+
+class StaticAssets : public ::testing::Test {
+protected:
+  void SetUp() override {
+    packed = readFile(std::string(WEB_ASSETS_DIR) + "/index.html.gz");
+    raw = readFile(std::string(WEB_SOURCE_DIR) + "/index.html");
+    ASSERT_GT(packed.size(), 0u);
+    ASSERT_GT(raw.size(), 0u);
+  }
+
+  void install() {
+    mkdir((dir.path() + "/www").c_str(), 0755);
+    writeFile(dir.path() + "/www/index.html.gz", packed);
+  }
+
+  TempDir dir;
+  std::string packed;
+  std::string raw;
+};
+
+TEST_F(StaticAssets, ServesGzipWithEtag) {
+  install();
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    std::unique_ptr<HttpExchange> page = host.get("/");
+    ASSERT_TRUE(page->complete());
+    EXPECT_EQ(page->status(), 200);
+    EXPECT_EQ(page->header("Content-Encoding"), "gzip");
+    EXPECT_EQ(page->header("Cache-Control"), "no-cache");
+    EXPECT_EQ(page->header("ETag"), etagOf(packed));
+    EXPECT_TRUE(page->body() == packed);
+
+    // На проводе - сжатый файл и заголовки, а не исходная страница
+    EXPECT_LT(page->wireBytes(), packed.size() + 512);
+    EXPECT_LT(page->wireBytes() * 3, raw.size());
+  });
+}
+
+TEST_F(StaticAssets, MatchingEtagGetsEmpty304) {
+  install();
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    std::unique_ptr<HttpExchange> page = host.open(HTTP_GET, "/", String(), { { "If-None-Match", etagOf(packed) } });
+    ASSERT_TRUE(host.finish(*page));
+    EXPECT_EQ(page->status(), 304);
+    EXPECT_TRUE(page->body().empty());
+    EXPECT_EQ(page->header("ETag"), etagOf(packed));
+    EXPECT_LT(page->wireBytes(), 256u);
+  });
+}
+
+TEST_F(StaticAssets, StaleEtagGetsFullPage) {
+  install();
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    std::unique_ptr<HttpExchange> page = host.open(HTTP_GET, "/", String(), { { "If-None-Match", "\"00000000\"" } });
+    ASSERT_TRUE(host.finish(*page));
+    EXPECT_EQ(page->status(), 200);
+    EXPECT_TRUE(page->body() == packed);
+  });
+}
+
+TEST_F(StaticAssets, EtagFollowsFileContent) {
+  install();
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    EXPECT_EQ(host.get("/")->header("ETag"), etagOf(packed));
+  });
+  // Новый образ LittleFS - новый ETag после перезагрузки
+  packed[packed.size() - 1] ^= 0x55;
+  install();
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    EXPECT_EQ(host.get("/")->header("ETag"), etagOf(packed));
+  });
+}
+
+TEST_F(StaticAssets, MissingImageIsReported) {
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    std::unique_ptr<HttpExchange> page = host.get("/");
+    EXPECT_EQ(page->status(), 503);
+    EXPECT_NE(page->body().find("build_assets.py"), std::string::npos);
+  });
+}
+
+}  // namespace
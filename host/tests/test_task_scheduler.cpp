@@ -0,0 +1,183 @@
+// TaskScheduler на поддельных часах: задержка запуска (джиттер) периодических
+// задач, приоритеты, отсутствие дрейфа и догоняющих пачек после простоя
+#include <gtest/gtest.h>
+#include <vector>
+#include "task_scheduler.h"
+
+namespace {
+
+uint64_t fakeUs = 0;  // millis() и micros() переполняются независимо, как на плате
+
+unsigned long fakeMillis() {
+  return (uint32_t)(fakeUs / 1000);
+}
+
+unsigned long fakeMicros() {
+  return (uint32_t)fakeUs;
+}
+
+// Задачи - функции без аргументов, поэтому их поведение задаётся глобально
+struct TaskLog {
+  std::vector<uint32_t> starts;  // мс
+  uint32_t runtimeUs = 0;
+};
+
+TaskLog fastLog;
+TaskLog slowLog;
+TaskLog otherLog;
+
+void record(TaskLog& log) {
+  log.starts.push_back(fakeMillis());
+  fakeUs += log.runtimeUs;
+}
+
+void fastTask() {
+  record(fastLog);
+}
+
+void slowTask() {
+  record(slowLog);
+}
+
+void otherTask() {
+  record(otherLog);
+}
+
+class TaskSchedulerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    fakeUs = 1000000;
+    fastLog = TaskLog();
+    slowLog = TaskLog();
+    otherLog = TaskLog();
+  }
+
+  // Основной цикл прошивки: одна задача за проход, в паузах - сон до срока
+  void runFor(uint32_t ms) {
+    uint32_t end = fakeMillis() + ms;
+    while ((int32_t)(fakeMillis() - end) < 0) {
+      if (!scheduler.runNext()) {
+        uint32_t idle = scheduler.timeUntilNextDue();
+        fakeUs += (idle > 0 ? idle : 1) * 1000;
+      }
+    }
+  }
+
+  // Наибольшее опоздание запуска относительно сетки first + k * period
+  static uint32_t maxJitter(const TaskLog& log, uint32_t period) {
+    uint32_t worst = 0;
+    for (size_t k = 0; k < log.starts.size(); k++) {
+      uint32_t late = log.starts[k] - (log.starts[0] + k * period);
+      worst = late > worst ? late : worst;
+    }
+    return worst;
+  }
+
+  TaskScheduler scheduler{ fakeMillis, fakeMicros };
+};
+
+TEST_F(TaskSchedulerTest, IdleTaskRunsOnItsGrid) {
+  fastLog.runtimeUs = 200;
+  scheduler.addTask("fast", fastTask, 10, 0);
+  runFor(10000);
+  ASSERT_EQ(fastLog.starts.size(), 1000u);
+  EXPECT_EQ(maxJitter(fastLog, 10), 0u);
+  EXPECT_EQ(scheduler.task(0).stats.missedDeadlines, 0u);
+}
+
+TEST_F(TaskSchedulerTest, JitterIsBoundedByLongestOtherTask) {
+  // Планировщик не вытесняет задачи: срочная ждёт не дольше самой долгой чужой
+  fastLog.runtimeUs = 300;
+  slowLog.runtimeUs = 7000;
+  otherLog.runtimeUs = 2500;
+  scheduler.addTask("fast", fastTask, 10, 0, 10);
+  scheduler.addTask("slow", slowTask, 33, 2);
+  scheduler.addTask("other", otherTask, 17, 1);
+  runFor(60000);
+
+  EXPECT_GE(fastLog.starts.size(), 5990u);
+  EXPECT_LE(maxJitter(fastLog, 10), 7u + 1);
+  EXPECT_EQ(scheduler.task(0).stats.missedDeadlines, 0u);
+  // Фаза сохраняется: за минуту задача не отстаёт от сетки
+  EXPECT_LE(fastLog.starts.back() - fastLog.starts.front(), 59990u + 8);
+}
+
+TEST_F(TaskSchedulerTest, HigherPriorityRunsFirst) {
+  scheduler.addTask("slow", slowTask, 100, 3);
+  scheduler.addTask("fast", fastTask, 100, 0);
+  ASSERT_TRUE(scheduler.runNext());
+  EXPECT_EQ(fastLog.starts.size(), 1u);
+  EXPECT_TRUE(slowLog.starts.empty());
+  ASSERT_TRUE(scheduler.runNext());
+  EXPECT_EQ(slowLog.starts.size(), 1u);
+  EXPECT_FALSE(scheduler.runNext());
+}
+
+TEST_F(TaskSchedulerTest, EqualPriorityRunsMostOverdueFirst) {
+  scheduler.addTask("slow", slowTask, 50, 1);
+  fakeUs -= 20000;
+  scheduler.addTask("fast", fastTask, 50, 1);  // срок на 20 мс раньше
+  fakeUs += 100000;
+  ASSERT_TRUE(scheduler.runNext());
+  EXPECT_EQ(fastLog.starts.size(), 1u);
+  EXPECT_TRUE(slowLog.starts.empty());
+}
+
+TEST_F(TaskSchedulerTest, StallDoesNotCauseCatchUpBurst) {
+  fastLog.runtimeUs = 100;
+  scheduler.addTask("fast", fastTask, 10, 0);
+  runFor(100);
+  size_t before = fastLog.starts.size();
+
+  fakeUs += 250000;  // цикл завис на 250 мс
+  runFor(5);
+  EXPECT_EQ(fastLog.starts.size(), before + 1);
+  EXPECT_EQ(scheduler.task(0).stats.missedDeadlines, 1u);
+
+  // После простоя - снова ровно через период
+  uint32_t restart = fastLog.starts.back();
+  runFor(100);
+  for (size_t k = before + 1; k < fastLog.starts.size(); k++) {
+    EXPECT_EQ(fastLog.starts[k], restart + (k - before) * 10);
+  }
+}
+
+TEST_F(TaskSchedulerTest, TriggerMakesTaskReadyNow) {
+  scheduler.addTask("fast", fastTask, 1000, 0);
+  ASSERT_TRUE(scheduler.runNext());
+  EXPECT_EQ(scheduler.timeUntilNextDue(), 1000u);
+  fakeUs += 300000;
+  EXPECT_EQ(scheduler.timeUntilNextDue(), 700u);
+  scheduler.trigger(0);
+  EXPECT_EQ(scheduler.timeUntilNextDue(), 0u);
+  ASSERT_TRUE(scheduler.runNext());
+  EXPECT_EQ(fastLog.starts.size(), 2u);
+}
+
+TEST_F(TaskSchedulerTest, CountsBudgetOverrunsAndRuntime) {
+  slowLog.runtimeUs = 6000;
+  scheduler.addTask("slow", slowTask, 100, 0, 0, 5000);
+  runFor(1000);
+  const TaskStats& stats = scheduler.task(0).stats;
+  EXPECT_EQ(stats.runs, 10u);
+  EXPECT_EQ(stats.budgetOverruns, 10u);
+  EXPECT_EQ(stats.maxRuntime, 6000u);
+  EXPECT_EQ(stats.totalRuntime, 60000u);
+}
+
+TEST_F(TaskSchedulerTest, SurvivesMillisWraparound) {
+  fakeUs = ((uint64_t)UINT32_MAX - 50) * 1000;  // millis() переполнится через 50 мс
+  scheduler.addTask("fast", fastTask, 10, 0);
+  runFor(200);
+  EXPECT_GE(fastLog.starts.size(), 19u);
+  EXPECT_EQ(scheduler.task(0).stats.missedDeadlines, 0u);
+}
+
+TEST_F(TaskSchedulerTest, TableIsBounded) {
+  for (int i = 0; i < MAX_TASKS; i++) {
+    EXPECT_EQ(scheduler.addTask("task", otherTask, 10, 0), i);
+  }
+  EXPECT_EQ(scheduler.addTask("extra", otherTask, 10, 0), -1);
+}
+
+}  // namespace
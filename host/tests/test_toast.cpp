@@ -0,0 +1,152 @@
+// Очередь уведомлений на экране: будильник вытесняет мотивационные
+// сообщения, время показа идёт с первого появления на экране, полная очередь
+// вытесняет самое старое менее важное. Уведомления от входа, выхода и
+// будильника не останавливают чтение датчика
+#include <gtest/gtest.h>
+#include <string.h>
+#include "firmware_host.h"
+#include "run_device.h"
+
+#define DISPLAY_PERIOD_MS 500  // displayInterval в file.cpp
+
+namespace {
+
+const Toast* findToast(const char* text) {
+  for (int i = 0; i < TOAST_QUEUE_SIZE; i++) {
+    if (toasts.at(i).active && strcmp(toasts.at(i).text, text) == 0) {
+      return &toasts.at(i);
+    }
+  }
+  return nullptr;
+}
+
+// Рамка уведомления: левый край экрана от строки 14 до низа
+bool toastDrawn(FirmwareHost& host) {
+  const uint8_t* frame = host.frames.lastFrame();
+  if (frame == nullptr) {
+    return false;
+  }
+  for (int y = 14; y < OLED_PAGES * 8; y++) {
+    if (!(frame[(y / 8) * OLED_WIDTH] & (1 << (y % 8)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Уведомления загрузки (точка доступа) уже показаны и истекли
+void settle(FirmwareHost& host) {
+  host.run(10000);
+  ASSERT_EQ(toasts.current(millis()), nullptr);
+  toasts.clear();
+}
+
+TEST(Toast, AlarmPreemptsMotivationalAndTimersStartOnScreen) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    settle(host);
+    EXPECT_FALSE(toastDrawn(host));
+
+    uint32_t queued = millis();
+    ASSERT_TRUE(showToast("Tip:", "first", TOAST_INFO, 3000, 1));
+    ASSERT_TRUE(showToast("Tip:", "second", TOAST_INFO, 3000, 1));
+    host.run(100);
+    // Кадр перерисован сразу, а не через период дисплея; второе ждёт
+    EXPECT_TRUE(toastDrawn(host));
+    const Toast* first = findToast("first");
+    const Toast* second = findToast("second");
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_GE(first->expiresAt, queued + 3000);
+    EXPECT_LE(first->expiresAt, queued + 3100);
+    EXPECT_EQ(second->expiresAt, 0u);
+
+    host.run(1000);
+    uint32_t alarmQueued = millis();
+    ASSERT_TRUE(showToast("Time to wake up!", "ALARM!", TOAST_ALARM, 5000, 2));
+    host.run(100);
+    const Toast* alarm = findToast("ALARM!");
+    ASSERT_NE(alarm, nullptr);
+    EXPECT_EQ(toasts.current(millis()), alarm);
+    EXPECT_GE(alarm->expiresAt, alarmQueued);
+    EXPECT_LE(alarm->expiresAt, alarmQueued + 5100);
+    unsigned long alarmEnds = alarm->expiresAt;
+    // Время первого идёт и под будильником, второе ещё не показывалось
+    EXPECT_EQ(second->expiresAt, 0u);
+
+    host.run(alarmEnds - millis() + DISPLAY_PERIOD_MS + 100);
+    EXPECT_EQ(findToast("ALARM!"), nullptr);
+    EXPECT_EQ(findToast("first"), nullptr);
+    // Второе показано после будильника и живёт свои 3 с с этого момента
+    ASSERT_EQ(findToast("second"), second);
+    EXPECT_GE(second->expiresAt, alarmEnds + 3000);
+    EXPECT_LE(second->expiresAt, alarmEnds + DISPLAY_PERIOD_MS + 3000);
+    EXPECT_TRUE(toastDrawn(host));
+
+    host.run(3000 + DISPLAY_PERIOD_MS);
+    EXPECT_EQ(findToast("second"), nullptr);
+    EXPECT_FALSE(toastDrawn(host));
+  });
+}
+
+TEST(Toast, FullQueueEvictsOldestLessImportant) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    settle(host);
+    const char* tips[TOAST_QUEUE_SIZE] = { "tip0", "tip1", "tip2", "tip3", "tip4", "tip5" };
+    for (int i = 0; i < TOAST_QUEUE_SIZE; i++) {
+      ASSERT_TRUE(showToast("Tip:", tips[i], TOAST_INFO, 3000, 1));
+    }
+    // Самое старое мотивационное уступает место
+    ASSERT_TRUE(showToast("Alarm set to:", "07:30", TOAST_NOTICE, 2000, 2));
+    EXPECT_EQ(findToast("tip0"), nullptr);
+    EXPECT_NE(findToast("tip1"), nullptr);
+
+    const char* alarms[TOAST_QUEUE_SIZE - 1] = { "a1", "a2", "a3", "a4", "a5" };
+    for (const char* text : alarms) {
+      ASSERT_TRUE(showToast("Time to wake up!", text, TOAST_ALARM, 5000, 2));
+    }
+    EXPECT_EQ(findToast("tip5"), nullptr);
+    EXPECT_NE(findToast("07:30"), nullptr);
+    // Менее важное в очередь будильников не попадает, будильник вытесняет уведомление
+    EXPECT_FALSE(showToast("Tip:", "late", TOAST_INFO, 3000, 1));
+    ASSERT_TRUE(showToast("Time to wake up!", "a6", TOAST_ALARM, 5000, 2));
+    EXPECT_EQ(findToast("07:30"), nullptr);
+    // Среди равных первым показывается самое раннее
+    host.run(100);
+    EXPECT_EQ(toasts.current(millis()), findToast("a1"));
+  });
+}
+
+// Раньше каждое такое уведомление держало основной цикл delay() на 1-3 с,
+// и FIFO датчика переполнялось
+TEST(Toast, WebRequestsDoNotLoseSamples) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    host.run(2000);
+    uint32_t produced = host.ppg.produced();
+    uint32_t acquired = samplesAcquired;
+    for (int i = 0; i < 10; i++) {
+      ASSERT_TRUE(host.login("admin", "admin"));
+      EXPECT_NE(findToast("admin"), nullptr);
+      host.run(300);
+      EXPECT_EQ(host.get("/setAlarm?h=7&m=30")->status(), 200);
+      EXPECT_NE(findToast("07:30"), nullptr);
+      host.run(300);
+      EXPECT_EQ(host.get("/clearAlarm")->status(), 200);
+      host.run(300);
+      host.get("/logout");
+      host.run(300);
+    }
+    host.run(1000);
+    EXPECT_EQ(host.ppg.lostSamples(), 0u);
+    EXPECT_EQ(ringDroppedSamples, 0u);
+    // Каждый отсчёт, выданный датчиком, прочитан прошивкой
+    EXPECT_EQ(samplesAcquired - acquired, host.ppg.produced() - produced);
+  });
+}
+
+}  // namespace
@@ -0,0 +1,293 @@
+// users.json на файловой системе хоста: перенос файлов старого формата,
+// сохранение при пропадании питания на любом байте записи, файлы больше
+// 4 КБ и время загрузки на 10, 100 и 1000 записей
+#include <gtest/gtest.h>
+#include <ArduinoJson.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "firmware_host.h"
+#include "run_device.h"
+
+namespace {
+
+std::string readFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream text;
+  text << file.rdbuf();
+  return text.str();
+}
+
+// Файл, который писала прошивка до учётных записей с хешами: пароли открытым
+// текстом, история в записях, флага isAdmin нет ни у кого
+void writeLegacyUsers(const std::string& root) {
+  std::ofstream file(root + "/users.json", std::ios::binary);
+  file << "{\"count\":2,\"users\":["
+       << "{\"username\":\"admin\",\"password\":\"admin\",\"bedtimeHour\":-1,\"bedtimeMinute\":-1,"
+       << "\"wakeupHour\":-1,\"wakeupMinute\":-1,\"recordCount\":0,\"records\":[]},"
+       << "{\"username\":\"bob\",\"password\":\"secret\",\"bedtimeHour\":22,\"bedtimeMinute\":30,"
+       << "\"wakeupHour\":7,\"wakeupMinute\":0,\"recordCount\":1,"
+       << "\"records\":[{\"timestamp\":60000,\"pulse\":64,\"spo2\":97}]}"
+       << "]}";
+}
+
+bool sessionIsAdmin(FirmwareHost& host) {
+  DynamicJsonDocument json(512);
+  EXPECT_FALSE(deserializeJson(json, host.get("/data")->body().c_str()));
+  return json["isAdmin"].as<bool>();
+}
+
+TEST(UsersFile, LegacyAdminKeepsAdminRights) {
+  TempDir dir;
+  writeLegacyUsers(dir.path());
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    ASSERT_EQ(users.count(), 2);
+    ASSERT_TRUE(host.login("admin", "admin"));
+    EXPECT_TRUE(sessionIsAdmin(host));
+    EXPECT_EQ(host.get("/admin")->status(), 200);
+
+    ASSERT_TRUE(host.login("bob", "secret"));
+    EXPECT_FALSE(sessionIsAdmin(host));
+    EXPECT_EQ(host.get("/admin")->status(), 303);
+    EXPECT_EQ(pulseLog.recordCount(users.id(findUser("bob"))), 1u);
+    host.run(60000);  // перенесённый файл записывается заново
+  });
+
+  // В новом формате флаг уже сохранён
+  std::string saved = readFile(dir.path() + "/users.json");
+  EXPECT_EQ(saved.find("\"password\""), std::string::npos);
+  EXPECT_NE(saved.find("\"isAdmin\":true"), std::string::npos);
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    ASSERT_TRUE(host.login("admin", "admin"));
+    EXPECT_TRUE(sessionIsAdmin(host));
+    ASSERT_TRUE(host.login("bob", "secret"));
+    EXPECT_FALSE(sessionIsAdmin(host));
+  });
+}
+
+// Сохранённый без прав "admin" получает их обратно при загрузке
+TEST(UsersFile, AdminWithoutFlagIsRepaired) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    users.setAdmin(findUser("admin"), false);
+    saveUsers();
+  });
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    EXPECT_TRUE(users.isAdmin(findUser("admin")));
+    ASSERT_TRUE(host.login("admin", "admin"));
+    EXPECT_EQ(host.get("/admin")->status(), 200);
+  });
+}
+
+std::vector<std::string> loadedUsers;
+
+// Запись старого формата, как её распознаёт loadUser(): без номера, флага
+// администратора или хеша пароля либо с историей внутри
+bool legacyEntry(JsonObject entry) {
+  return entry["id"].isNull() || entry["isAdmin"].isNull() || entry["hash"].isNull() || !entry["records"].isNull();
+}
+
+void collectUser(JsonObject entry, bool& migrated) {
+  if (legacyEntry(entry)) {
+    migrated = true;
+  }
+  String user = entry["username"].as<String>() + " " + entry["id"].as<String>() + " " +
+                entry["hash"].as<String>() + " " + String(entry["bedtimeHour"].as<int>()) + " " +
+                String(entry["isAdmin"].as<bool>());
+  loadedUsers.push_back(user.c_str());
+}
+
+// Учётные записи, которые прочитает следующая загрузка; migrated - файл
+// старого формата, загрузка перепишет его
+std::vector<std::string> usersOnFlash(bool& migrated) {
+  loadedUsers.clear();
+  migrated = false;
+  readUsersFile(collectUser, migrated);
+  return loadedUsers;
+}
+
+// То же для файлов, которые записала сама прошивка: они уже в новом формате
+std::vector<std::string> usersOnFlash() {
+  bool migrated;
+  std::vector<std::string> users = usersOnFlash(migrated);
+  EXPECT_FALSE(migrated);
+  return users;
+}
+
+void writeFile(const std::string& path, const std::string& content) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file << content;
+}
+
+// Питание пропадает после каждого байта (и каждой операции с метаданными)
+// сохранения: на флеш всегда целиком либо прежний набор учётных записей, либо новый
+TEST(UsersFile, PowerCutAtEveryByteKeepsOldOrNewUsers) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    for (int i = 1; i <= 5; i++) {
+      char form[64];
+      snprintf(form, sizeof(form), "username=sleeper%02d&password=secret%02d", i, i);
+      ASSERT_EQ(host.post("/register", form)->status(), 303);
+    }
+    saveUsers();
+    std::vector<std::string> before = usersOnFlash();
+    ASSERT_EQ(before.size(), 6u);
+    const std::string path = dir.path() + "/users.json";
+    std::string saved = readFile(path);
+
+    // Новый набор: ещё один пользователь и изменённое расписание
+    ASSERT_EQ(host.post("/register", "username=newcomer&password=secret")->status(), 303);
+    users.schedule(findUser("sleeper02")).bedtimeHour = 23;
+
+    // Бюджет растёт, пока сохранение не пройдёт без сбоя
+    std::vector<std::vector<std::string>> outcomes;
+    for (uint64_t budget = 0; budget < 100000; budget++) {
+      writeFile(path, saved);
+      std::remove((path + ".tmp").c_str());
+      hostFsCutPowerAfter(budget);
+      saveUsers();
+      bool lost = hostFsPowerLost();
+      hostFsRestorePower();
+      outcomes.push_back(usersOnFlash());
+      if (!lost) {
+        break;
+      }
+    }
+    std::vector<std::string> after = outcomes.back();
+    ASSERT_EQ(after.size(), 7u);
+    EXPECT_GT(outcomes.size(), saved.size());
+    for (size_t budget = 0; budget < outcomes.size(); budget++) {
+      ASSERT_TRUE(outcomes[budget] == before || outcomes[budget] == after) << "power cut after " << budget;
+    }
+  });
+}
+
+// Старый формат с историей в записях: 10 пользователей по 20 записей - больше 4 КБ
+TEST(UsersFile, LargeLegacyFileMigratesEveryUser) {
+  TempDir dir;
+  std::ofstream file(dir.path() + "/users.json", std::ios::binary);
+  file << "{\"count\":" << MAX_USERS << ",\"users\":[";
+  for (int i = 0; i < MAX_USERS; i++) {
+    file << (i > 0 ? "," : "") << "{\"username\":\"" << (i == 0 ? std::string("admin") : "sleeper" + std::to_string(i))
+         << "\",\"password\":\"secret" << i << "\",\"bedtimeHour\":22,\"bedtimeMinute\":" << i
+         << ",\"wakeupHour\":7,\"wakeupMinute\":0,\"recordCount\":20,\"records\":[";
+    for (int r = 0; r < 20; r++) {
+      file << (r > 0 ? "," : "") << "{\"timestamp\":" << (r + 1) * 5000 << ",\"pulse\":" << 60 + r
+           << ",\"spo2\":" << 90 + r % 10 << "}";
+    }
+    file << "]}";
+  }
+  file << "]}";
+  file.close();
+  ASSERT_GT(readFile(dir.path() + "/users.json").size(), 4096u * 2);
+
+  runDevice([&]() {
+    // До загрузки на флеш старый формат у всех записей
+    hostFsMount(dir.path());
+    bool migrated;
+    EXPECT_EQ(usersOnFlash(migrated).size(), (size_t)MAX_USERS);
+    EXPECT_TRUE(migrated);
+
+    FirmwareHost host(dir.path());
+    // Загрузка перенесла записи и сразу переписала файл в новом формате
+    EXPECT_EQ(usersOnFlash().size(), (size_t)MAX_USERS);
+    ASSERT_EQ(users.count(), MAX_USERS);
+    for (int i = 1; i < MAX_USERS; i++) {
+      int slot = findUser(String("sleeper") + String(i));
+      ASSERT_GE(slot, 0) << i;
+      EXPECT_EQ(users.schedule(slot).bedtimeMinute, i);
+      EXPECT_EQ(pulseLog.recordCount(users.id(slot)), 20u) << i;
+    }
+    EXPECT_EQ(pulseLog.recordCount(users.id(findUser("admin"))), 20u);
+    ASSERT_TRUE(host.login("sleeper9", "secret9"));
+  });
+}
+
+// users.json текущего формата на count записей; подписи нет - поколение 0
+std::string usersJson(int count) {
+  std::string json = "{\"count\":" + std::to_string(count) + ",\"users\":[";
+  for (int i = 0; i < count; i++) {
+    char entry[256];
+    snprintf(entry, sizeof(entry),
+             "%s{\"id\":%d,\"username\":\"sleeper%04d\",\"salt\":\"%016x\",\"hash\":\"%064x\","
+             "\"bedtimeHour\":%d,\"bedtimeMinute\":30,\"wakeupHour\":7,\"wakeupMinute\":0,\"isAdmin\":false}",
+             i > 0 ? "," : "", i + 1, i, i * 7919, i, 20 + i % 4);
+    json += entry;
+  }
+  return json + "]}";
+}
+
+int countedUsers = 0;
+char lastUser[USER_NAME_SIZE];
+
+// Без копий в куче: пик памяти - только разбор прошивки
+void countUser(JsonObject entry, bool& migrated) {
+  if (legacyEntry(entry)) {
+    migrated = true;
+  }
+  countedUsers++;
+  snprintf(lastUser, sizeof(lastUser), "%s", entry["username"] | "");
+}
+
+// Файл разбирается по одной записи: память не зависит от числа пользователей,
+// чтение растёт с размером файла линейно. Время загрузки печатается для
+// сравнения, замер без прочих тестов - BM_LoadUsers в firmware_bench
+TEST(UsersFile, LoadScalesLinearlyWithFileSize) {
+  TempDir dir;
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    const int counts[] = { 10, 100, 1000 };
+    int64_t peak[3] = {};
+    size_t largest[3] = {};
+    for (int n = 0; n < 3; n++) {
+      std::string content = usersJson(counts[n]);
+      writeFile(dir.path() + "/users.json", content);
+
+      hostFsResetStats();
+      hostHeapResetCounters();
+      int64_t live = hostHeapStats().liveBytes;
+      countedUsers = 0;
+      bool migrated = false;
+      auto start = std::chrono::steady_clock::now();
+      size_t length = readUsersFile(countUser, migrated);
+      auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+      HostHeapStats heap = hostHeapStats();
+      HostFsStats fs = hostFsStats();
+
+      EXPECT_EQ(length, content.size());
+      ASSERT_EQ(countedUsers, counts[n]);
+      char expected[USER_NAME_SIZE];
+      snprintf(expected, sizeof(expected), "sleeper%04d", counts[n] - 1);
+      EXPECT_STREQ(lastUser, expected);
+      EXPECT_FALSE(migrated);
+      peak[n] = heap.peakLiveBytes - live;
+      largest[n] = heap.largestAllocation;
+      // Проверка подписи и разбор: файл читается дважды, не больше
+      EXPECT_LE(fs.bytesRead, 2 * content.size()) << counts[n];
+      printf("[ users.json ] %4d users, %6zu bytes: %6lld us, %llu reads\n", counts[n], content.size(),
+             (long long)elapsed.count(), (unsigned long long)fs.readCalls);
+    }
+    // Документ разбора один и того же размера, файл целиком в память не попадает
+    EXPECT_EQ(peak[1], peak[0]);
+    EXPECT_EQ(peak[2], peak[0]);
+    EXPECT_EQ(largest[2], largest[0]);
+    EXPECT_LT(largest[2], usersJson(100).size());
+  });
+
+  // 1000 записей при загрузке: в таблице MAX_USERS, остальные пропущены
+  writeFile(dir.path() + "/users.json", usersJson(1000));
+  runDevice([&]() {
+    FirmwareHost host(dir.path());
+    EXPECT_EQ(users.count(), MAX_USERS);
+    EXPECT_GE(findUser("sleeper0000"), 0);
+    EXPECT_LT(findUser("sleeper0999"), 0);
+  });
+}
+
+}  // namespace
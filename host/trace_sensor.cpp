@@ -0,0 +1,140 @@
+#include "trace_sensor.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t readLe32(const uint8_t* data) {
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static void writeLe32(uint8_t* data, uint32_t value) {
+  data[0] = value;
+  data[1] = value >> 8;
+  data[2] = value >> 16;
+  data[3] = value >> 24;
+}
+
+TraceSensor::TraceSensor(const std::string& path, Clock& clock) : _path(path), _clock(clock) {
+}
+
+TraceSensor::~TraceSensor() {
+  if (_file != nullptr) {
+    fclose(_file);
+  }
+}
+
+bool TraceSensor::begin() {
+  _file = fopen(_path.c_str(), "rb");
+  if (_file == nullptr) {
+    return false;
+  }
+  uint8_t magic[4];
+  _binary = fread(magic, 1, sizeof(magic), _file) == sizeof(magic) && memcmp(magic, TRACE_MAGIC, 4) == 0;
+  if (!_binary) {
+    rewind(_file);
+  }
+  _start = _clock.millis();
+  _samplesRead = 0;
+  _hasNext = fetch();
+  return true;
+}
+
+bool TraceSensor::fetch() {
+  if (_binary) {
+    uint8_t record[12];
+    if (fread(record, 1, sizeof(record), _file) != sizeof(record)) {
+      return false;
+    }
+    _next.timestamp = _start + readLe32(record);
+    _next.red = readLe32(record + 4) & 0x3FFFF;
+    _next.ir = readLe32(record + 8) & 0x3FFFF;
+    return true;
+  }
+
+  char line[64];
+  while (fgets(line, sizeof(line), _file) != nullptr) {
+    if (line[0] < '0' || line[0] > '9') {
+      continue; // заголовок или комментарий
+    }
+    char* end;
+    uint32_t t = strtoul(line, &end, 10);
+    if (*end != ',') {
+      continue;
+    }
+    uint32_t red = strtoul(end + 1, &end, 10);
+    if (*end != ',') {
+      continue;
+    }
+    _next.timestamp = _start + t;
+    _next.red = red & 0x3FFFF;
+    _next.ir = strtoul(end + 1, nullptr, 10) & 0x3FFFF;
+    return true;
+  }
+  return false;
+}
+
+size_t TraceSensor::read(PpgSample* samples, size_t maxCount) {
+  uint32_t now = _clock.millis();
+  size_t count = 0;
+  while (_hasNext && count < maxCount && (int32_t)(now - _next.timestamp) >= 0) {
+    samples[count++] = _next;
+    _hasNext = fetch();
+  }
+  _samplesRead += count;
+  if (!_hasNext && _file != nullptr) {
+    fclose(_file);
+    _file = nullptr;
+  }
+  return count;
+}
+
+bool writeTrace(const std::string& path, uint32_t durationMs, uint32_t periodMs,
+                const std::function<void(uint32_t t, uint32_t& red, uint32_t& ir)>& generator) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  fwrite(TRACE_MAGIC, 1, 4, file);
+  for (uint32_t t = 0; t < durationMs; t += periodMs) {
+    uint32_t red;
+    uint32_t ir;
+    generator(t, red, ir);
+    uint8_t record[12];
+    writeLe32(record, t);
+    writeLe32(record + 4, red);
+    writeLe32(record + 8, ir);
+    fwrite(record, 1, sizeof(record), file);
+  }
+  return fclose(file) == 0;
+}
+
+namespace {
+
+// Часы, которые стоят, пока их не переставят
+class ManualClock : public Clock {
+public:
+  uint32_t millis() override {
+    return now;
+  }
+  uint32_t micros() override {
+    return now * 1000;
+  }
+  uint32_t now = 0;
+};
+
+}  // namespace
+
+bool readTrace(const std::string& path, std::vector<PpgSample>& samples) {
+  ManualClock clock;
+  TraceSensor trace(path, clock);
+  if (!trace.begin()) {
+    return false;
+  }
+  clock.now = UINT32_MAX / 2;
+  PpgSample block[64];
+  size_t count;
+  while ((count = trace.read(block, 64)) > 0) {
+    samples.insert(samples.end(), block, block + count);
+  }
+  return true;
+}
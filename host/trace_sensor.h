@@ -0,0 +1,55 @@
+// Записанный сигнал датчика из файла хоста.
+//
+// Формат записи: текст "t_ms,red,ir" по строке на отсчёт (строки, не
+// начинающиеся с цифры, пропускаются) или двоичный: "PPGT", затем записи
+// по 12 байт - t_ms, red, ir (uint32, little-endian). t_ms отсчитывается
+// от начала записи.
+#pragma once
+
+#include <stdio.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "hal.h"
+
+#define TRACE_MAGIC "PPGT"
+
+class TraceSensor : public PpgSensor {
+public:
+  TraceSensor(const std::string& path, Clock& clock);
+  ~TraceSensor();
+
+  bool begin() override;
+  // Отдаёт отсчёты, время которых по часам уже наступило
+  size_t read(PpgSample* samples, size_t maxCount) override;
+  uint32_t lostSamples() const override {
+    return 0;
+  }
+
+  bool finished() const {
+    return !_hasNext;
+  }
+  uint32_t samplesRead() const {
+    return _samplesRead;
+  }
+
+private:
+  bool fetch();
+
+  std::string _path;
+  Clock& _clock;
+  FILE* _file = nullptr;
+  bool _binary = false;
+  bool _hasNext = false;
+  PpgSample _next = {};
+  uint32_t _start = 0;
+  uint32_t _samplesRead = 0;
+};
+
+// Пишет двоичную запись PPGT: generator даёт каналы на каждые periodMs
+// за durationMs. false - файл не создать
+bool writeTrace(const std::string& path, uint32_t durationMs, uint32_t periodMs,
+                const std::function<void(uint32_t t, uint32_t& red, uint32_t& ir)>& generator);
+
+// Читает запись целиком; время отсчётов - от начала записи
+bool readTrace(const std::string& path, std::vector<PpgSample>& samples);
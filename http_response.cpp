@@ -0,0 +1,212 @@
+#include "http_response.h"
+
+#define HTTP_DYNAMIC_RESERVE (2 * HTTP_BATCH_BYTES)  // пакет и длинная строка, на которой он заполнился
+
+// Ответы, строки которых ещё печатаются; ответом владеет сервер, поэтому
+// после отключения клиента слот пустеет сам
+static std::weak_ptr<ResponsePlan> streams[HTTP_MAX_STREAMS];
+
+void ResponsePlan::sampleHeap() {
+  uint32_t freeHeap = ESP.getFreeHeap();
+  if (freeHeap < minFreeHeap) {
+    minFreeHeap = freeHeap;
+  }
+}
+
+size_t ResponsePlan::fill(uint8_t* buffer, size_t maxLength) {
+  if (!ready.load(std::memory_order_acquire)) {
+    return RESPONSE_TRY_AGAIN;
+  }
+  size_t written = 0;
+  while (written < maxLength && segment < count) {
+    const ResponseSegment& part = segments[segment];
+    size_t length = part.length - offset;
+    if (length > maxLength - written) {
+      length = maxLength - written;
+    }
+    if (part.flash != nullptr) {
+      memcpy_P(buffer + written, part.flash + offset, length);
+    } else {
+      memcpy(buffer + written, dynamic.c_str() + part.offset + offset, length);
+    }
+    written += length;
+    offset += length;
+    if (offset == part.length) {
+      segment++;
+      offset = 0;
+    }
+  }
+  sampleHeap();
+
+  // Пакет отдан целиком, следующий готовит основной цикл
+  if (segment == count && more.load(std::memory_order_relaxed)) {
+    ready.store(false, std::memory_order_release);
+    return written > 0 ? written : RESPONSE_TRY_AGAIN;
+  }
+
+  // Последний чанк отдан - записываем пик потребления кучи
+  if (written == 0 && stats != nullptr) {
+    uint32_t used = startFreeHeap > minFreeHeap ? startFreeHeap - minFreeHeap : 0;
+    stats->requests++;
+    stats->lastPeakBytes = used;
+    if (used > stats->peakBytes) {
+      stats->peakBytes = used;
+    }
+    stats = nullptr;
+  }
+  return written;
+}
+
+ChunkedResponse::ChunkedResponse(RequestQueue& queue, RouteHeapStats* stats)
+  : _queue(&queue), _stats(stats) {
+}
+
+ChunkedResponse::ChunkedResponse(const std::shared_ptr<ResponsePlan>& plan)
+  : _queue(nullptr), _stats(nullptr), _plan(plan) {
+}
+
+void ChunkedResponse::begin(int code, const char* contentType) {
+  uint32_t freeHeap = ESP.getFreeHeap();
+  _code = code;
+  _contentType = contentType;
+  _plan = std::make_shared<ResponsePlan>();
+  _plan->stats = _stats;
+  _plan->startFreeHeap = freeHeap;
+  _plan->minFreeHeap = freeHeap;
+  _plan->dynamic.reserve(HTTP_DYNAMIC_RESERVE);
+  _plan->sampleHeap();
+}
+
+void ChunkedResponse::print_P(PGM_P text) {
+  size_t length = strlen_P(text);
+  if (_plan->count < HTTP_MAX_SEGMENTS - 1 && length <= UINT16_MAX) {
+    // Большие фрагменты из флеш-памяти не копируем, а запоминаем ссылкой
+    ResponseSegment& part = _plan->segments[_plan->count++];
+    part.flash = text;
+    part.offset = 0;
+    part.length = length;
+    return;
+  }
+  // Фрагментов слишком много - копируем текст во вставки
+  char chunk[64];
+  while (length > 0) {
+    size_t part = length < sizeof(chunk) ? length : sizeof(chunk);
+    memcpy_P(chunk, text, part);
+    append(chunk, part);
+    text += part;
+    length -= part;
+  }
+}
+
+void ChunkedResponse::print(const char* text) {
+  append(text, strlen(text));
+}
+
+void ChunkedResponse::print(const String& text) {
+  append(text.c_str(), text.length());
+}
+
+void ChunkedResponse::print(long value) {
+  printPadded(value, 1);
+}
+
+void ChunkedResponse::printPadded(long value, uint8_t width) {
+  char text[16];
+  snprintf(text, sizeof(text), "%0*ld", width, value);
+  append(text, strlen(text));
+}
+
+void ChunkedResponse::end() {
+  _plan->sampleHeap();
+  send();
+}
+
+void ChunkedResponse::end(ResponseRows rows) {
+  _plan->rows = std::move(rows);
+  produce(_plan);
+  if (_plan->more) {
+    std::weak_ptr<ResponsePlan>* free = nullptr;
+    for (std::weak_ptr<ResponsePlan>& stream : streams) {
+      if (stream.expired()) {
+        free = &stream;
+      }
+    }
+    if (free == nullptr) {
+      _plan.reset();
+      _queue->sendHeader("Retry-After", "1");
+      _queue->send(503, "text/plain", "Too many responses in progress");
+      return;
+    }
+    *free = _plan;
+  }
+  send();
+}
+
+void ChunkedResponse::pump() {
+  for (std::weak_ptr<ResponsePlan>& stream : streams) {
+    std::shared_ptr<ResponsePlan> plan = stream.lock();
+    if (!plan || plan->ready.load(std::memory_order_acquire)) {
+      continue;
+    }
+    // Сервер забрал пакет целиком и сейчас его не читает: буфер свободен
+    plan->count = 0;
+    plan->segment = 0;
+    plan->offset = 0;
+    plan->dynamic = "";
+    produce(plan);
+    if (!plan->more) {
+      stream.reset();
+    }
+  }
+}
+
+void ChunkedResponse::produce(const std::shared_ptr<ResponsePlan>& plan) {
+  ChunkedResponse writer(plan);
+  bool more = true;
+  while (more && plan->dynamic.length() < HTTP_BATCH_BYTES) {
+    more = plan->rows(writer);
+  }
+  if (!more) {
+    plan->rows = nullptr;  // освобождаем состояние строк (открытые файлы и т.п.)
+  }
+  plan->sampleHeap();
+  plan->more.store(more, std::memory_order_relaxed);
+  plan->ready.store(true, std::memory_order_release);
+}
+
+void ChunkedResponse::send() {
+  AsyncWebServerRequest* request = _queue->current();
+  if (request == nullptr) {
+    _plan.reset();
+    return;
+  }
+
+  // Сервер вызывает filler, когда в сокете есть место; план живёт вместе с лямбдой
+  std::shared_ptr<ResponsePlan> plan = _plan;
+  AsyncWebServerResponse* response = request->beginChunkedResponse(_contentType,
+    [plan](uint8_t* buffer, size_t maxLength, size_t) -> size_t {
+      return plan->fill(buffer, maxLength);
+    });
+  response->setCode(_code);
+  _queue->send(response);
+  _plan.reset();
+}
+
+void ChunkedResponse::append(const char* data, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  ResponsePlan& plan = *_plan;
+  ResponseSegment* last = plan.count > 0 ? &plan.segments[plan.count - 1] : nullptr;
+  // Подряд идущие вставки склеиваем в один фрагмент.
+  // print_P() всегда оставляет свободное место под него
+  if (last == nullptr || last->flash != nullptr) {
+    last = &plan.segments[plan.count++];
+    last->flash = nullptr;
+    last->offset = plan.dynamic.length();
+    last->length = 0;
+  }
+  plan.dynamic.concat(data, length);
+  last->length += length;
+  plan.sampleHeap();
+}
@@ -0,0 +1,99 @@
+// Потоковый HTTP-ответ с chunked transfer encoding.
+//
+// Обработчик описывает ответ последовательностью фрагментов: большие куски
+// из PROGMEM запоминаются ссылкой, короткие вставки (имена, числа) копятся
+// в одной строке. Асинхронный сервер сам забирает чанки по мере того, как
+// в сокете есть место, копируя фрагменты из флеш-памяти прямо в свой буфер,
+// поэтому страница целиком в ОЗУ не собирается. Попутно замеряется, сколько
+// кучи было занято во время ответа.
+//
+// Строки таблиц (история, пользователи) печатает функция ResponseRows, которую
+// основной цикл вызывает пакетами по HTTP_BATCH_BYTES: следующий пакет
+// готовится, только когда сервер забрал предыдущий. В ОЗУ лежит один пакет,
+// а медленный клиент задерживает только свой ответ.
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "request_queue.h"
+
+#define HTTP_MAX_SEGMENTS 8
+#define HTTP_BATCH_BYTES 512  // вставок в одном пакете строк
+#define HTTP_MAX_STREAMS 4    // ответов, которые дописываются одновременно
+
+class ChunkedResponse;
+
+// Печатает следующую строку ответа; false - строк больше нет (хвост ответа
+// уже напечатан). Вызывается из основного цикла
+typedef std::function<bool(ChunkedResponse& response)> ResponseRows;
+
+// Пиковое потребление кучи маршрутом
+struct RouteHeapStats {
+  const char* route;
+  uint32_t requests;
+  uint32_t peakBytes;     // максимум по всем запросам
+  uint32_t lastPeakBytes; // последний запрос
+};
+
+// Фрагмент ответа: текст во флеш-памяти или участок строки вставок
+struct ResponseSegment {
+  PGM_P flash;      // nullptr - участок dynamic
+  uint16_t offset;
+  uint16_t length;
+};
+
+// Описание ответа; живёт, пока сервер не заберёт последний чанк
+struct ResponsePlan {
+  ResponseSegment segments[HTTP_MAX_SEGMENTS];
+  uint8_t count = 0;
+  String dynamic;
+  uint8_t segment = 0;   // позиция чтения
+  uint16_t offset = 0;
+  ResponseRows rows;     // ещё не напечатанные строки; трогает только основной цикл
+  // Пакет отдаётся сервером; false - сервер забрал его и ждёт следующий
+  std::atomic<bool> ready{true};
+  std::atomic<bool> more{false};  // за текущим пакетом будут ещё
+  RouteHeapStats* stats = nullptr;
+  uint32_t startFreeHeap = 0;
+  uint32_t minFreeHeap = 0;
+
+  size_t fill(uint8_t* buffer, size_t maxLength);
+  void sampleHeap();
+};
+
+class ChunkedResponse {
+public:
+  ChunkedResponse(RequestQueue& queue, RouteHeapStats* stats);
+
+  void begin(int code, const char* contentType);
+  void print_P(PGM_P text);
+  void print(const char* text);
+  void print(const String& text);
+  void print(long value);
+  // Число с ведущими нулями до заданной ширины (например, минуты "07")
+  void printPadded(long value, uint8_t width);
+  void end();
+  // Отправляет напечатанное начало, а строки дописываются пакетами по мере
+  // отдачи. Если дописывается уже HTTP_MAX_STREAMS ответов - 503
+  void end(ResponseRows rows);
+
+  // Основной цикл: готовит следующие пакеты ответов, отправленных через end(rows)
+  static void pump();
+
+private:
+  explicit ChunkedResponse(const std::shared_ptr<ResponsePlan>& plan);
+
+  // Печатает строки плана, пока не наберётся пакет
+  static void produce(const std::shared_ptr<ResponsePlan>& plan);
+  void append(const char* data, size_t length);
+  void send();
+
+  RequestQueue* _queue;
+  RouteHeapStats* _stats;
+  std::shared_ptr<ResponsePlan> _plan;
+  int _code = 200;
+  const char* _contentType = "text/html";
+};
@@ -0,0 +1,158 @@
+#include "json_writer.h"
+
+JsonWriter::JsonWriter(char* buffer, size_t capacity)
+  : _buffer(buffer), _capacity(capacity) {
+  if (_capacity > 0) {
+    _buffer[0] = '\0';
+  }
+}
+
+void JsonWriter::put(char c) {
+  // Один байт оставляем под завершающий ноль
+  if (_length + 1 >= _capacity) {
+    _overflow = true;
+    return;
+  }
+  _buffer[_length++] = c;
+  _buffer[_length] = '\0';
+}
+
+void JsonWriter::separator() {
+  if (_afterKey) {
+    _afterKey = false;
+    return;
+  }
+  if (_depth > 0) {
+    if (_hasItems[_depth - 1]) {
+      put(',');
+    }
+    _hasItems[_depth - 1] = true;
+  }
+}
+
+void JsonWriter::open(char c) {
+  separator();
+  put(c);
+  if (_depth < JSON_MAX_DEPTH) {
+    _hasItems[_depth++] = false;
+  } else {
+    _overflow = true;
+  }
+}
+
+void JsonWriter::close(char c) {
+  if (_depth > 0) {
+    _depth--;
+  }
+  put(c);
+}
+
+void JsonWriter::beginObject() {
+  open('{');
+}
+
+void JsonWriter::endObject() {
+  close('}');
+}
+
+void JsonWriter::beginArray() {
+  open('[');
+}
+
+void JsonWriter::endArray() {
+  close(']');
+}
+
+void JsonWriter::key(const char* name) {
+  separator();
+  put('"');
+  while (*name) {
+    put(*name++);
+  }
+  put('"');
+  put(':');
+  _afterKey = true;
+}
+
+void JsonWriter::putDigits(uint32_t number, uint8_t minDigits) {
+  // Цифры собираются с конца во временный буфер на стеке
+  char digits[10];
+  uint8_t count = 0;
+  do {
+    digits[count++] = '0' + number % 10;
+    number /= 10;
+  } while (number > 0);
+  while (count < minDigits && count < sizeof(digits)) {
+    digits[count++] = '0';
+  }
+  while (count > 0) {
+    put(digits[--count]);
+  }
+}
+
+void JsonWriter::value(int32_t number) {
+  separator();
+  uint32_t magnitude = (uint32_t)number;
+  if (number < 0) {
+    put('-');
+    magnitude = 0u - magnitude;
+  }
+  putDigits(magnitude, 1);
+}
+
+void JsonWriter::value(uint32_t number) {
+  separator();
+  putDigits(number, 1);
+}
+
+void JsonWriter::value(bool flag) {
+  separator();
+  const char* text = flag ? "true" : "false";
+  while (*text) {
+    put(*text++);
+  }
+}
+
+void JsonWriter::value(const char* text) {
+  separator();
+  put('"');
+  static const char hex[] = "0123456789abcdef";
+  for (; *text; text++) {
+    uint8_t c = (uint8_t)*text;
+    if (c == '"' || c == '\\') {
+      put('\\');
+      put((char)c);
+    } else if (c < 0x20) {
+      put('\\');
+      put('u');
+      put('0');
+      put('0');
+      put(hex[c >> 4]);
+      put(hex[c & 0x0F]);
+    } else {
+      put((char)c);
+    }
+  }
+  put('"');
+}
+
+void JsonWriter::null() {
+  separator();
+  put('n');
+  put('u');
+  put('l');
+  put('l');
+}
+
+void JsonWriter::time(int hours, int minutes, int seconds) {
+  separator();
+  put('"');
+  putDigits((uint32_t)hours, 1);
+  put(':');
+  putDigits((uint32_t)minutes, 2);
+  if (seconds >= 0) {
+    put(':');
+    putDigits((uint32_t)seconds, 2);
+  }
+  put('"');
+}
@@ -0,0 +1,67 @@
+// Сериализатор JSON в заранее выделенный буфер без обращений к куче.
+//
+// Запятые между элементами расставляются автоматически, строки
+// экранируются, целые числа форматируются вручную. Если буфер кончился,
+// запись прекращается и overflow() возвращает true - ответ не отправляют.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define JSON_MAX_DEPTH 4
+
+class JsonWriter {
+public:
+  JsonWriter(char* buffer, size_t capacity);
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+
+  void key(const char* name);
+  void value(int32_t number);
+  void value(uint32_t number);
+  void value(bool flag);
+  void value(const char* text);
+  void null();
+  // Время "Ч:ММ" или "Ч:ММ:СС" (seconds < 0 - без секунд)
+  void time(int hours, int minutes, int seconds);
+
+  const char* data() const {
+    return _buffer;
+  }
+
+  size_t length() const {
+    return _length;
+  }
+
+  bool overflow() const {
+    return _overflow;
+  }
+
+private:
+  void separator();
+  void put(char c);
+  void putDigits(uint32_t number, uint8_t minDigits);
+  void open(char c);
+  void close(char c);
+
+  char* _buffer;
+  size_t _capacity;
+  size_t _length = 0;
+  bool _overflow = false;
+  bool _afterKey = false;
+  uint8_t _depth = 0;
+  bool _hasItems[JSON_MAX_DEPTH];
+};
+
+// Длина строки на этапе компиляции: для проверки размера буфера по схеме полей
+constexpr size_t jsonLiteralLength(const char* text) {
+  return *text ? 1 + jsonLiteralLength(text + 1) : 0;
+}
+
+// Сумма длин ключей схемы вместе с кавычками, двоеточием и запятой
+constexpr size_t jsonSchemaKeyBytes(const char* const* names, size_t count) {
+  return count == 0 ? 0 : jsonLiteralLength(names[0]) + 4 + jsonSchemaKeyBytes(names + 1, count - 1);
+}
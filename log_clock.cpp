@@ -0,0 +1,59 @@
+#include "log_clock.h"
+#include "safe_file.h"
+
+bool LogClock::begin(FS& fs, uint32_t ms) {
+  _fs = &fs;
+  _millis = 0;
+  _lastMs = ms;
+  _base = 0;
+  _horizon = 0;
+  _generation = 0;
+
+  size_t length = 0;
+  File file = safeFileOpen(fs, LOG_CLOCK_FILE, _generation, length);
+  bool found = file;
+  if (found) {
+    char text[12] = {0};
+    file.read((uint8_t*)text, length < sizeof(text) - 1 ? length : sizeof(text) - 1);
+    file.close();
+    _base = strtoul(text, nullptr, 10);
+  }
+  // До сохранения новой границы время не должно её перейти
+  save(_base + LOG_CLOCK_LEASE);
+  return found;
+}
+
+uint32_t LogClock::now(uint32_t ms) {
+  _millis += (uint32_t)(ms - _lastMs);
+  _lastMs = ms;
+  return _base + (uint32_t)(_millis / 1000);
+}
+
+void LogClock::notBefore(uint32_t time, uint32_t ms) {
+  uint32_t current = now(ms);
+  if (time > current) {
+    _base += time - current;
+    persist(ms);
+  }
+}
+
+void LogClock::persist(uint32_t ms) {
+  uint32_t current = now(ms);
+  if (_fs != nullptr && current + LOG_CLOCK_LEASE / 2 >= _horizon) {
+    save(current + LOG_CLOCK_LEASE);
+  }
+}
+
+bool LogClock::save(uint32_t horizon) {
+  SafeFileWriter writer(*_fs, LOG_CLOCK_FILE, _generation + 1);
+  if (!writer.begin()) {
+    return false;
+  }
+  writer.print(horizon);
+  if (!writer.commit()) {
+    return false;
+  }
+  _generation++;
+  _horizon = horizon;
+  return true;
+}
@@ -0,0 +1,42 @@
+// Время журнала: секунды, которые не идут назад ни при перезагрузке, ни при
+// установке часов на экране. Им помечаются записи журнала и корзины сводок,
+// поэтому данные разных загрузок не попадают в одни и те же периоды.
+//
+// Во флеш-памяти лежит граница, дальше которой время ещё не выдавалось;
+// она продлевается на LOG_CLOCK_LEASE вперёд, когда до неё остаётся меньше
+// половины срока. После перезагрузки отсчёт продолжается с этой границы:
+// промежуток не длиннее LOG_CLOCK_LEASE пропадает, повторов нет. Запись -
+// раз в LOG_CLOCK_LEASE / 2 секунд.
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#define LOG_CLOCK_FILE "/log/clock.txt"
+#define LOG_CLOCK_LEASE 600  // с
+
+class LogClock {
+public:
+  // Продолжает время с сохранённой границы; ms - millis() в момент вызова.
+  // false - границы нет (первая загрузка или файл потерян), время с нуля
+  bool begin(FS& fs, uint32_t ms);
+
+  // Текущее время; вызывать чаще, чем раз в 49 суток (переполнение millis)
+  uint32_t now(uint32_t ms);
+
+  // Время не меньше time: для журналов, записанных без сохранённой границы
+  void notBefore(uint32_t time, uint32_t ms);
+
+  // Продлевает сохранённую границу, если она близко; вызывается периодически
+  void persist(uint32_t ms);
+
+private:
+  bool save(uint32_t horizon);
+
+  FS* _fs = nullptr;
+  uint32_t _base = 0;      // с, время на _millis == 0
+  uint64_t _millis = 0;    // мс от begin() без переполнения
+  uint32_t _lastMs = 0;
+  uint32_t _horizon = 0;   // сохранённая граница
+  uint32_t _generation = 0;
+};
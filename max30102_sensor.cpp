@@ -0,0 +1,111 @@
+#include "max30102_sensor.h"
+
+#if SENSOR_INT_PIN >= 0
+static volatile bool fifoReady = false;
+
+// Датчик опускает INT, когда в FIFO накопилось заданное число отсчётов
+static void IRAM_ATTR onSensorInterrupt() {
+  fifoReady = true;
+}
+#endif
+
+Max30102Sensor::Max30102Sensor(TwoWire& wire, Clock& clock)
+  : _wire(wire), _clock(clock) {
+}
+
+bool Max30102Sensor::begin() {
+  if (!_driver.begin(_wire, I2C_SPEED_FAST)) {
+    return false;
+  }
+  _driver.setup(50, SENSOR_SAMPLE_AVERAGE, 2, SENSOR_SAMPLE_RATE, 411, 4096);
+  _driver.setPulseAmplitudeRed(0x0A);
+  _driver.setPulseAmplitudeIR(0x0A);
+
+#if SENSOR_INT_PIN >= 0
+  // Прерывание "FIFO почти полон": 0x0F = осталось 15 свободных ячеек, т.е. 17 отсчётов
+  _driver.setFIFOAlmostFull(0x0F);
+  _driver.enableAFULL();
+  pinMode(SENSOR_INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(SENSOR_INT_PIN), onSensorInterrupt, FALLING);
+#endif
+  _driver.clearFIFO();
+  return true;
+}
+
+bool Max30102Sensor::pending() {
+#if SENSOR_INT_PIN >= 0
+  return fifoReady;
+#else
+  return false;
+#endif
+}
+
+// Вычитывает весь накопленный FIFO датчика за одну пакетную транзакцию
+size_t Max30102Sensor::read(PpgSample* samples, size_t maxCount) {
+#if SENSOR_INT_PIN >= 0
+  if (fifoReady) {
+    fifoReady = false;
+    _driver.getINT1(); // чтение статуса сбрасывает прерывание
+  }
+#endif
+
+  // Указатели FIFO и счётчик переполнения идут подряд: WR_PTR, OVF_COUNTER, RD_PTR
+  _wire.beginTransmission(MAX30102_ADDRESS);
+  _wire.write(MAX30102_FIFO_WR_PTR);
+  _wire.endTransmission(false);
+  _wire.requestFrom((uint8_t)MAX30102_ADDRESS, (size_t)3);
+  if (_wire.available() < 3) {
+    return 0;
+  }
+  uint8_t writePtr = _wire.read() & 0x1F;
+  uint8_t overflow = _wire.read() & 0x1F;
+  uint8_t readPtr = _wire.read() & 0x1F;
+
+  uint8_t count = (writePtr - readPtr) & (MAX30102_FIFO_DEPTH - 1);
+  if (overflow > 0) {
+    // FIFO был заполнен полностью, часть отсчётов перезаписана
+    _overflowSamples += overflow;
+    count = MAX30102_FIFO_DEPTH;
+  }
+  if (count > maxCount) {
+    count = maxCount; // остальное заберёт следующий вызов
+  }
+  if (count == 0) {
+    return 0;
+  }
+
+  // Метки времени: последний отсчёт получен только что, предыдущие - с шагом периода
+  uint32_t now = _clock.millis();
+  uint8_t remaining = count;
+  const uint8_t samplesPerChunk = BUFFER_LENGTH / MAX30102_BYTES_PER_SAMPLE;
+
+  _wire.beginTransmission(MAX30102_ADDRESS);
+  _wire.write(MAX30102_FIFO_DATA);
+  _wire.endTransmission(false);
+
+  while (remaining > 0) {
+    uint8_t chunk = remaining < samplesPerChunk ? remaining : samplesPerChunk;
+    _wire.requestFrom((uint8_t)MAX30102_ADDRESS, (size_t)(chunk * MAX30102_BYTES_PER_SAMPLE));
+
+    for (uint8_t i = 0; i < chunk; i++) {
+      PpgSample& sample = samples[count - remaining];
+      // Байты читаются по одному: порядок вычисления операндов в выражении не задан
+      uint8_t raw[MAX30102_BYTES_PER_SAMPLE];
+      for (uint8_t b = 0; b < MAX30102_BYTES_PER_SAMPLE; b++) {
+        raw[b] = _wire.read();
+      }
+      sample.red = ((uint32_t)raw[0] << 16) | ((uint32_t)raw[1] << 8) | raw[2];
+      sample.ir = ((uint32_t)raw[3] << 16) | ((uint32_t)raw[4] << 8) | raw[5];
+      sample.red &= 0x3FFFF; // 18-битный АЦП
+      sample.ir &= 0x3FFFF;
+
+      remaining--;
+      sample.timestamp = now - (uint32_t)remaining * SAMPLE_PERIOD_MS;
+      if ((int32_t)(sample.timestamp - _lastTimestamp) <= 0) {
+        sample.timestamp = _lastTimestamp + 1;
+      }
+      _lastTimestamp = sample.timestamp;
+    }
+  }
+  return count;
+}
@@ -0,0 +1,42 @@
+// MAX30102 за интерфейсом PpgSensor: пакетное чтение FIFO по I2C.
+//
+// Регистры FIFO читаются напрямую, одной транзакцией на весь накопленный
+// FIFO, а не по отсчёту через библиотеку. Настройка датчика - через MAX30105.
+#pragma once
+
+#include <Wire.h>
+#include "MAX30105.h"
+#include "hal.h"
+
+#define SENSOR_INT_PIN -1          // пин INT датчика (например D5), -1 = опрос по таймеру
+#define SENSOR_SAMPLE_RATE 400     // частота АЦП датчика, Гц
+#define SENSOR_SAMPLE_AVERAGE 4    // усреднение в FIFO: 400 / 4 = 100 отсчётов в секунду
+#define SENSOR_OUTPUT_RATE (SENSOR_SAMPLE_RATE / SENSOR_SAMPLE_AVERAGE)
+#define SAMPLE_PERIOD_MS (1000 / SENSOR_OUTPUT_RATE)
+#define MAX30102_ADDRESS 0x57
+#define MAX30102_FIFO_WR_PTR 0x04
+#define MAX30102_OVF_COUNTER 0x05
+#define MAX30102_FIFO_RD_PTR 0x06
+#define MAX30102_FIFO_DATA 0x07
+#define MAX30102_FIFO_DEPTH 32
+#define MAX30102_BYTES_PER_SAMPLE 6 // RED + IR по 3 байта
+
+class Max30102Sensor : public PpgSensor {
+public:
+  Max30102Sensor(TwoWire& wire, Clock& clock);
+
+  bool begin() override;
+  bool pending() override;
+  size_t read(PpgSample* samples, size_t maxCount) override;
+
+  uint32_t lostSamples() const override {
+    return _overflowSamples;
+  }
+
+private:
+  TwoWire& _wire;
+  Clock& _clock;
+  MAX30105 _driver;
+  uint32_t _lastTimestamp = 0;
+  uint32_t _overflowSamples = 0;
+};
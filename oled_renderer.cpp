@@ -0,0 +1,269 @@
+#include "oled_renderer.h"
+
+#define SSD1306_COLUMN_ADDR 0x21
+#define SSD1306_PAGE_ADDR 0x22
+#define SSD1306_CONTROL_COMMANDS 0x00
+#define SSD1306_CONTROL_DATA 0x40
+
+#define OLED_FIRST_CHAR 0x20
+#define OLED_LAST_CHAR 0x7E
+
+// Шрифт 5x7 для символов 0x20..0x7E, по 5 байт-столбцов на символ
+static const uint8_t oledFont[] PROGMEM = {
+  0x00, 0x00, 0x00, 0x00, 0x00, // ' '
+  0x00, 0x00, 0x5F, 0x00, 0x00, // '!'
+  0x00, 0x07, 0x00, 0x07, 0x00, // '"'
+  0x14, 0x7F, 0x14, 0x7F, 0x14, // '#'
+  0x24, 0x2A, 0x7F, 0x2A, 0x12, // '$'
+  0x23, 0x13, 0x08, 0x64, 0x62, // '%'
+  0x36, 0x49, 0x55, 0x22, 0x50, // '&'
+  0x00, 0x05, 0x03, 0x00, 0x00, // '\''
+  0x00, 0x1C, 0x22, 0x41, 0x00, // '('
+  0x00, 0x41, 0x22, 0x1C, 0x00, // ')'
+  0x08, 0x2A, 0x1C, 0x2A, 0x08, // '*'
+  0x08, 0x08, 0x3E, 0x08, 0x08, // '+'
+  0x00, 0x50, 0x30, 0x00, 0x00, // ','
+  0x08, 0x08, 0x08, 0x08, 0x08, // '-'
+  0x00, 0x60, 0x60, 0x00, 0x00, // '.'
+  0x20, 0x10, 0x08, 0x04, 0x02, // '/'
+  0x3E, 0x51, 0x49, 0x45, 0x3E, // '0'
+  0x00, 0x42, 0x7F, 0x40, 0x00, // '1'
+  0x42, 0x61, 0x51, 0x49, 0x46, // '2'
+  0x21, 0x41, 0x45, 0x4B, 0x31, // '3'
+  0x18, 0x14, 0x12, 0x7F, 0x10, // '4'
+  0x27, 0x45, 0x45, 0x45, 0x39, // '5'
+  0x3C, 0x4A, 0x49, 0x49, 0x30, // '6'
+  0x01, 0x71, 0x09, 0x05, 0x03, // '7'
+  0x36, 0x49, 0x49, 0x49, 0x36, // '8'
+  0x06, 0x49, 0x49, 0x29, 0x1E, // '9'
+  0x00, 0x36, 0x36, 0x00, 0x00, // ':'
+  0x00, 0x56, 0x36, 0x00, 0x00, // ';'
+  0x08, 0x14, 0x22, 0x41, 0x00, // '<'
+  0x14, 0x14, 0x14, 0x14, 0x14, // '='
+  0x00, 0x41, 0x22, 0x14, 0x08, // '>'
+  0x02, 0x01, 0x51, 0x09, 0x06, // '?'
+  0x32, 0x49, 0x79, 0x41, 0x3E, // '@'
+  0x7E, 0x11, 0x11, 0x11, 0x7E, // 'A'
+  0x7F, 0x49, 0x49, 0x49, 0x36, // 'B'
+  0x3E, 0x41, 0x41, 0x41, 0x22, // 'C'
+  0x7F, 0x41, 0x41, 0x22, 0x1C, // 'D'
+  0x7F, 0x49, 0x49, 0x49, 0x41, // 'E'
+  0x7F, 0x09, 0x09, 0x09, 0x01, // 'F'
+  0x3E, 0x41, 0x49, 0x49, 0x7A, // 'G'
+  0x7F, 0x08, 0x08, 0x08, 0x7F, // 'H'
+  0x00, 0x41, 0x7F, 0x41, 0x00, // 'I'
+  0x20, 0x40, 0x41, 0x3F, 0x01, // 'J'
+  0x7F, 0x08, 0x14, 0x22, 0x41, // 'K'
+  0x7F, 0x40, 0x40, 0x40, 0x40, // 'L'
+  0x7F, 0x02, 0x0C, 0x02, 0x7F, // 'M'
+  0x7F, 0x04, 0x08, 0x10, 0x7F, // 'N'
+  0x3E, 0x41, 0x41, 0x41, 0x3E, // 'O'
+  0x7F, 0x09, 0x09, 0x09, 0x06, // 'P'
+  0x3E, 0x41, 0x51, 0x21, 0x5E, // 'Q'
+  0x7F, 0x09, 0x19, 0x29, 0x46, // 'R'
+  0x46, 0x49, 0x49, 0x49, 0x31, // 'S'
+  0x01, 0x01, 0x7F, 0x01, 0x01, // 'T'
+  0x3F, 0x40, 0x40, 0x40, 0x3F, // 'U'
+  0x1F, 0x20, 0x40, 0x20, 0x1F, // 'V'
+  0x3F, 0x40, 0x38, 0x40, 0x3F, // 'W'
+  0x63, 0x14, 0x08, 0x14, 0x63, // 'X'
+  0x07, 0x08, 0x70, 0x08, 0x07, // 'Y'
+  0x61, 0x51, 0x49, 0x45, 0x43, // 'Z'
+  0x00, 0x7F, 0x41, 0x41, 0x00, // '['
+  0x02, 0x04, 0x08, 0x10, 0x20, // backslash
+  0x00, 0x41, 0x41, 0x7F, 0x00, // ']'
+  0x04, 0x02, 0x01, 0x02, 0x04, // '^'
+  0x40, 0x40, 0x40, 0x40, 0x40, // '_'
+  0x00, 0x01, 0x02, 0x04, 0x00, // '`'
+  0x20, 0x54, 0x54, 0x54, 0x78, // 'a'
+  0x7F, 0x48, 0x44, 0x44, 0x38, // 'b'
+  0x38, 0x44, 0x44, 0x44, 0x20, // 'c'
+  0x38, 0x44, 0x44, 0x48, 0x7F, // 'd'
+  0x38, 0x54, 0x54, 0x54, 0x18, // 'e'
+  0x08, 0x7E, 0x09, 0x01, 0x02, // 'f'
+  0x0C, 0x52, 0x52, 0x52, 0x3E, // 'g'
+  0x7F, 0x08, 0x04, 0x04, 0x78, // 'h'
+  0x00, 0x44, 0x7D, 0x40, 0x00, // 'i'
+  0x20, 0x40, 0x44, 0x3D, 0x00, // 'j'
+  0x7F, 0x10, 0x28, 0x44, 0x00, // 'k'
+  0x00, 0x41, 0x7F, 0x40, 0x00, // 'l'
+  0x7C, 0x04, 0x18, 0x04, 0x78, // 'm'
+  0x7C, 0x08, 0x04, 0x04, 0x78, // 'n'
+  0x38, 0x44, 0x44, 0x44, 0x38, // 'o'
+  0x7C, 0x14, 0x14, 0x14, 0x08, // 'p'
+  0x08, 0x14, 0x14, 0x18, 0x7C, // 'q'
+  0x7C, 0x08, 0x04, 0x04, 0x08, // 'r'
+  0x48, 0x54, 0x54, 0x54, 0x20, // 's'
+  0x04, 0x3F, 0x44, 0x40, 0x20, // 't'
+  0x3C, 0x40, 0x40, 0x20, 0x7C, // 'u'
+  0x1C, 0x20, 0x40, 0x20, 0x1C, // 'v'
+  0x3C, 0x40, 0x30, 0x40, 0x3C, // 'w'
+  0x44, 0x28, 0x10, 0x28, 0x44, // 'x'
+  0x0C, 0x50, 0x50, 0x50, 0x3C, // 'y'
+  0x44, 0x64, 0x54, 0x4C, 0x44, // 'z'
+  0x00, 0x08, 0x36, 0x41, 0x00, // '{'
+  0x00, 0x00, 0x7F, 0x00, 0x00, // '|'
+  0x00, 0x41, 0x36, 0x08, 0x00, // '}'
+  0x08, 0x04, 0x08, 0x10, 0x08, // '~'
+};
+
+// Цифры выводятся на каждом кадре, поэтому держим их в ОЗУ
+static uint8_t digitGlyphs[10][OLED_GLYPH_COLUMNS];
+
+uint8_t oledFindDirtyRanges(const uint8_t* frame, const uint8_t* shadow, OledDirtyRange* ranges) {
+  uint8_t count = 0;
+  for (uint8_t page = 0; page < OLED_PAGES; page++) {
+    const uint8_t* row = frame + page * OLED_WIDTH;
+    const uint8_t* sent = shadow + page * OLED_WIDTH;
+
+    int first = 0;
+    while (first < OLED_WIDTH && row[first] == sent[first]) {
+      first++;
+    }
+    if (first == OLED_WIDTH) {
+      continue;
+    }
+    int last = OLED_WIDTH - 1;
+    while (row[last] == sent[last]) {
+      last--;
+    }
+
+    ranges[count].page = page;
+    ranges[count].firstColumn = first;
+    ranges[count].lastColumn = last;
+    count++;
+  }
+  return count;
+}
+
+OledFlusher::OledFlusher(TwoWire& wire, uint8_t address)
+  : _wire(wire), _address(address) {
+}
+
+size_t OledFlusher::flush(const uint8_t* frame) {
+  OledDirtyRange ranges[OLED_PAGES];
+  uint8_t count;
+
+  if (!_valid || ++_framesSinceFull >= OLED_FULL_REFRESH_FRAMES) {
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+      ranges[page].page = page;
+      ranges[page].firstColumn = 0;
+      ranges[page].lastColumn = OLED_WIDTH - 1;
+    }
+    count = OLED_PAGES;
+    _framesSinceFull = 0;
+  } else {
+    count = oledFindDirtyRanges(frame, _shadow, ranges);
+  }
+
+  size_t bytes = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    const OledDirtyRange& range = ranges[i];
+    // Окно записи: диапазон столбцов в одной странице
+    const uint8_t commands[] = {
+      SSD1306_COLUMN_ADDR, range.firstColumn, range.lastColumn,
+      SSD1306_PAGE_ADDR, range.page, range.page
+    };
+    bytes += sendCommands(commands, sizeof(commands));
+
+    size_t offset = range.page * OLED_WIDTH + range.firstColumn;
+    size_t length = range.lastColumn - range.firstColumn + 1;
+    bytes += sendData(frame + offset, length);
+    memcpy(_shadow + offset, frame + offset, length);
+  }
+
+  _valid = true;
+  _lastFrameBytes = bytes;
+  _totalBytes += bytes;
+  return bytes;
+}
+
+size_t OledFlusher::sendCommands(const uint8_t* commands, uint8_t count) {
+  _wire.beginTransmission(_address);
+  _wire.write(SSD1306_CONTROL_COMMANDS);
+  _wire.write(commands, count);
+  _wire.endTransmission();
+  return 2 + count; // адрес, управляющий байт и команды
+}
+
+size_t OledFlusher::sendData(const uint8_t* data, size_t count) {
+  // Одна транзакция не может превышать буфер Wire вместе с управляющим байтом
+  const size_t chunkSize = BUFFER_LENGTH - 1;
+  size_t bytes = 0;
+  while (count > 0) {
+    size_t chunk = count < chunkSize ? count : chunkSize;
+    _wire.beginTransmission(_address);
+    _wire.write(SSD1306_CONTROL_DATA);
+    _wire.write(data, chunk);
+    _wire.endTransmission();
+    bytes += 2 + chunk;
+    data += chunk;
+    count -= chunk;
+  }
+  return bytes;
+}
+
+void oledGlyphCacheInit() {
+  for (uint8_t digit = 0; digit < 10; digit++) {
+    memcpy_P(digitGlyphs[digit], oledFont + ('0' + digit - OLED_FIRST_CHAR) * OLED_GLYPH_COLUMNS,
+             OLED_GLYPH_COLUMNS);
+  }
+}
+
+static inline uint8_t drawGlyph(uint8_t* frame, uint8_t page, uint8_t column, char symbol) {
+  if (column > OLED_WIDTH - OLED_GLYPH_WIDTH) {
+    return OLED_WIDTH; // символ не помещается, дальше выводить некуда
+  }
+  uint8_t* target = frame + page * OLED_WIDTH + column;
+  uint8_t code = (uint8_t)symbol;
+  if (code >= '0' && code <= '9') {
+    memcpy(target, digitGlyphs[code - '0'], OLED_GLYPH_COLUMNS);
+  } else {
+    if (code < OLED_FIRST_CHAR || code > OLED_LAST_CHAR) {
+      code = '?';
+    }
+    memcpy_P(target, oledFont + (code - OLED_FIRST_CHAR) * OLED_GLYPH_COLUMNS, OLED_GLYPH_COLUMNS);
+  }
+  target[OLED_GLYPH_COLUMNS] = 0;
+  return column + OLED_GLYPH_WIDTH;
+}
+
+uint8_t oledDrawText(uint8_t* frame, uint8_t page, uint8_t column, const char* text) {
+  while (*text != '\0' && column < OLED_WIDTH) {
+    column = drawGlyph(frame, page, column, *text++);
+  }
+  return column;
+}
+
+uint8_t oledDrawText_P(uint8_t* frame, uint8_t page, uint8_t column, PGM_P text) {
+  char symbol;
+  while ((symbol = pgm_read_byte(text++)) != '\0' && column < OLED_WIDTH) {
+    column = drawGlyph(frame, page, column, symbol);
+  }
+  return column;
+}
+
+uint8_t oledDrawNumber(uint8_t* frame, uint8_t page, uint8_t column, uint32_t value, uint8_t minDigits) {
+  // Цифры собираются с конца делением на 10, без printf
+  char digits[10];
+  uint8_t count = 0;
+  do {
+    digits[count++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0 && count < sizeof(digits));
+  while (count < minDigits && count < sizeof(digits)) {
+    digits[count++] = '0';
+  }
+  while (count > 0 && column < OLED_WIDTH) {
+    column = drawGlyph(frame, page, column, digits[--count]);
+  }
+  return column;
+}
+
+void oledDrawHLine(uint8_t* frame, uint8_t y) {
+  uint8_t* row = frame + (y / 8) * OLED_WIDTH;
+  uint8_t mask = 1 << (y & 7);
+  for (uint8_t x = 0; x < OLED_WIDTH; x++) {
+    row[x] |= mask;
+  }
+}
@@ -0,0 +1,77 @@
+// Вывод кадра на SSD1306 с передачей только изменившихся участков.
+//
+// Дисплей и MAX30102 висят на одной шине I2C, поэтому полный кадр (1 КБ)
+// на каждое обновление отнимает шину у датчика. OledFlusher хранит копию
+// последнего отправленного кадра и для каждой страницы (8 строк) передаёт
+// только диапазон столбцов, где есть отличия.
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "hal.h"
+
+#define OLED_WIDTH 128
+#define OLED_PAGES 8
+#define OLED_FRAME_SIZE (OLED_WIDTH * OLED_PAGES)
+#define OLED_FULL_REFRESH_FRAMES 120 // полная перерисовка раз в 120 кадров на случай сбоя ОЗУ дисплея
+#define OLED_GLYPH_COLUMNS 5
+#define OLED_GLYPH_WIDTH 6           // 5 столбцов символа и 1 столбец интервала
+
+struct OledDirtyRange {
+  uint8_t page;
+  uint8_t firstColumn;
+  uint8_t lastColumn;
+};
+
+// Сравнивает кадр с отправленной копией и возвращает число изменившихся страниц
+uint8_t oledFindDirtyRanges(const uint8_t* frame, const uint8_t* shadow, OledDirtyRange* ranges);
+
+class OledFlusher : public FrameSink {
+public:
+  OledFlusher(TwoWire& wire, uint8_t address);
+
+  // Следующий flush() отправит кадр целиком
+  void invalidate() {
+    _valid = false;
+  }
+
+  // Отправляет изменения кадра (буфер Adafruit_SSD1306::getBuffer()).
+  // Возвращает число байт, переданных по шине.
+  size_t flush(const uint8_t* frame) override;
+
+  uint32_t lastFrameBytes() const {
+    return _lastFrameBytes;
+  }
+
+  uint32_t totalBytes() const {
+    return _totalBytes;
+  }
+
+private:
+  size_t sendCommands(const uint8_t* commands, uint8_t count);
+  size_t sendData(const uint8_t* data, size_t count);
+
+  TwoWire& _wire;
+  uint8_t _address;
+  uint8_t _shadow[OLED_FRAME_SIZE];
+  bool _valid = false;
+  uint16_t _framesSinceFull = 0;
+  uint32_t _lastFrameBytes = 0;
+  uint32_t _totalBytes = 0;
+};
+
+// Быстрый текстовый вывод для экрана с фиксированной разметкой.
+// Символы 5x7 хранятся в PROGMEM по столбцам - ровно в формате страницы
+// SSD1306, поэтому символ копируется в кадр пятью байтами без попиксельной
+// отрисовки. Строки выровнены по страницам (y кратно 8).
+
+// Копирует глифы цифр из PROGMEM в ОЗУ (вызвать один раз в setup)
+void oledGlyphCacheInit();
+
+// Возвращают столбец, следующий за выведенным текстом
+uint8_t oledDrawText(uint8_t* frame, uint8_t page, uint8_t column, const char* text);
+uint8_t oledDrawText_P(uint8_t* frame, uint8_t page, uint8_t column, PGM_P text);
+uint8_t oledDrawNumber(uint8_t* frame, uint8_t page, uint8_t column, uint32_t value, uint8_t minDigits);
+
+// Горизонтальная линия на строке пикселей y через весь экран
+void oledDrawHLine(uint8_t* frame, uint8_t y);
@@ -0,0 +1,221 @@
+#include "ppg_dsp.h"
+
+#include <string.h>
+
+// DSP_FORCE_SCALAR отключает ветки SSE2/AVX2: так на хосте собирается эталон для сверки
+#if !defined(DSP_FORCE_SCALAR) && defined(__AVX2__)
+#define DSP_USE_AVX2
+#elif !defined(DSP_FORCE_SCALAR) && defined(__SSE2__)
+#define DSP_USE_SSE2
+#endif
+
+#if defined(DSP_USE_AVX2) || defined(DSP_USE_SSE2)
+#include <immintrin.h>
+#endif
+
+void dspDcRemoveInit(DcRemoveState* state, uint8_t shift) {
+  state->dc = 0;
+  state->shift = shift;
+  state->primed = false;
+}
+
+void dspDcRemove(DcRemoveState* state, const uint32_t* in, q15_t* out, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  // Первый отсчёт сразу задаёт DC, чтобы фильтр не разгонялся с нуля
+  if (!state->primed) {
+    state->dc = (int32_t)in[0] << state->shift;
+    state->primed = true;
+  }
+
+  int32_t dc = state->dc;
+  const uint8_t shift = state->shift;
+  for (size_t i = 0; i < count; i++) {
+    int32_t x = (int32_t)in[i];
+    dc += x - (dc >> shift);
+    out[i] = dspSaturateQ15(x - (dc >> shift));
+  }
+  state->dc = dc;
+}
+
+void dspFirInit(FirStateQ15* state, const q15_t* coeffs, uint8_t taps) {
+  if (taps > DSP_MAX_FIR_TAPS) {
+    taps = DSP_MAX_FIR_TAPS;
+  }
+  state->coeffs = coeffs;
+  state->taps = taps;
+  memset(state->history, 0, sizeof(state->history));
+}
+
+// Скалярное произведение с накоплением по модулю 2^32: так же переполняются
+// и векторные ветки, поэтому результат одинаков на всех платформах
+static inline int32_t dotQ15(const q15_t* a, const q15_t* b, size_t n) {
+  uint32_t acc = 0;
+  size_t j = 0;
+#if defined(DSP_USE_AVX2)
+  __m256i sum = _mm256_setzero_si256();
+  for (; j + 16 <= n; j += 16) {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a + j));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b + j));
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(va, vb));
+  }
+  uint32_t lanes[8];
+  _mm256_storeu_si256((__m256i*)lanes, sum);
+  for (int k = 0; k < 8; k++) {
+    acc += lanes[k];
+  }
+#elif defined(DSP_USE_SSE2)
+  __m128i sum = _mm_setzero_si128();
+  for (; j + 8 <= n; j += 8) {
+    __m128i va = _mm_loadu_si128((const __m128i*)(a + j));
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(va, vb));
+  }
+  uint32_t lanes[4];
+  _mm_storeu_si128((__m128i*)lanes, sum);
+  for (int k = 0; k < 4; k++) {
+    acc += lanes[k];
+  }
+#endif
+  for (; j < n; j++) {
+    acc += (uint32_t)((int32_t)a[j] * b[j]);
+  }
+  return (int32_t)acc;
+}
+
+void dspFir(FirStateQ15* state, const q15_t* in, q15_t* out, size_t count) {
+  const uint8_t taps = state->taps;
+  q15_t* buffer = state->history;
+
+  while (count > 0) {
+    size_t block = count < DSP_MAX_BLOCK ? count : DSP_MAX_BLOCK;
+    // В буфере taps-1 прошлых отсчётов, за ними текущий блок
+    memcpy(buffer + taps - 1, in, block * sizeof(q15_t));
+
+    // Коэффициенты хранятся в прямом порядке, окно - от старого к новому,
+    // поэтому фильтр с симметричными коэффициентами не требует разворота
+    for (size_t n = 0; n < block; n++) {
+      out[n] = dspSaturateQ15(dotQ15(buffer + n, state->coeffs, taps) >> 15);
+    }
+
+    memmove(buffer, buffer + block, (taps - 1) * sizeof(q15_t));
+    in += block;
+    out += block;
+    count -= block;
+  }
+}
+
+void dspBiquadInit(BiquadStateQ15* state, const q15_t* coeffs) {
+  state->coeffs = coeffs;
+  state->x1 = state->x2 = 0;
+  state->y1 = state->y2 = 0;
+}
+
+void dspBiquad(BiquadStateQ15* state, const q15_t* in, q15_t* out, size_t count) {
+  const int32_t b0 = state->coeffs[0];
+  const int32_t b1 = state->coeffs[1];
+  const int32_t b2 = state->coeffs[2];
+  const int32_t a1 = state->coeffs[3];
+  const int32_t a2 = state->coeffs[4];
+  q15_t x1 = state->x1, x2 = state->x2, y1 = state->y1, y2 = state->y2;
+
+  for (size_t i = 0; i < count; i++) {
+    q15_t x = in[i];
+    int64_t acc = (int64_t)b0 * x + (int64_t)b1 * x1 + (int64_t)b2 * x2
+                - (int64_t)a1 * y1 - (int64_t)a2 * y2;
+    q15_t y = dspSaturateQ15((int32_t)(acc >> 14));
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+    out[i] = y;
+  }
+
+  state->x1 = x1;
+  state->x2 = x2;
+  state->y1 = y1;
+  state->y2 = y2;
+}
+
+void dspMovingAverageInit(MovingAverageStateQ15* state, uint8_t length) {
+  if (length == 0) {
+    length = 1;
+  }
+  if (length > DSP_MAX_AVERAGE_WINDOW) {
+    length = DSP_MAX_AVERAGE_WINDOW;
+  }
+  memset(state->window, 0, sizeof(state->window));
+  state->sum = 0;
+  state->length = length;
+  state->position = 0;
+}
+
+void dspMovingAverage(MovingAverageStateQ15* state, const q15_t* in, q15_t* out, size_t count) {
+  int32_t sum = state->sum;
+  uint8_t position = state->position;
+  const uint8_t length = state->length;
+
+  for (size_t i = 0; i < count; i++) {
+    sum += in[i] - state->window[position];
+    state->window[position] = in[i];
+    if (++position == length) {
+      position = 0;
+    }
+    out[i] = (q15_t)(sum / length);
+  }
+
+  state->sum = sum;
+  state->position = position;
+}
+
+void dspDerivative(DerivativeStateQ15* state, const q15_t* in, q15_t* out, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  // Обход с конца позволяет фильтровать на месте (out == in)
+  q15_t first = in[0];
+  q15_t previous = state->previous;
+  state->previous = in[count - 1];
+  for (size_t i = count - 1; i > 0; i--) {
+    out[i] = dspSaturateQ15((int32_t)in[i] - in[i - 1]);
+  }
+  out[0] = dspSaturateQ15((int32_t)first - previous);
+}
+
+void dspPeakDetectInit(PeakDetectStateQ15* state) {
+  state->previous = -32768;
+  state->beforePrevious = -32768;
+  state->sampleIndex = 0;
+  state->lastPeakIndex = 0;
+  state->hasPeak = false;
+}
+
+size_t dspFindPeaks(PeakDetectStateQ15* state, const q15_t* in, size_t count,
+                    q15_t threshold, uint16_t minDistance,
+                    uint32_t* peaks, size_t maxPeaks) {
+  size_t found = 0;
+  q15_t previous = state->previous;
+  q15_t beforePrevious = state->beforePrevious;
+
+  for (size_t i = 0; i < count; i++) {
+    q15_t x = in[i];
+    // Пик - предыдущий отсчёт, если он выше соседей и порога
+    uint32_t candidate = state->sampleIndex + i - 1;
+    if (previous > beforePrevious && previous >= x && previous > threshold &&
+        (!state->hasPeak || candidate - state->lastPeakIndex >= minDistance)) {
+      state->lastPeakIndex = candidate;
+      state->hasPeak = true;
+      if (found < maxPeaks) {
+        peaks[found++] = candidate;
+      }
+    }
+    beforePrevious = previous;
+    previous = x;
+  }
+
+  state->previous = previous;
+  state->beforePrevious = beforePrevious;
+  state->sampleIndex += count;
+  return found;
+}
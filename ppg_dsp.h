@@ -0,0 +1,96 @@
+// Блочные фильтры пульсовой волны (PPG) в фиксированной точке Q15/Q31.
+//
+// Одни и те же функции собираются на ESP8266 (без FPU) и на x86, где
+// циклы векторизуются компилятором, а для КИХ-фильтра есть ветки SSE2/AVX2.
+// Результаты на всех платформах совпадают бит в бит: в ядрах нет плавающей
+// точки, а переполнение накопителя везде обрабатывается одинаково.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DSP_MAX_BLOCK 32         // максимальный размер блока (глубина FIFO датчика)
+#define DSP_MAX_FIR_TAPS 32
+#define DSP_MAX_AVERAGE_WINDOW 64
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+// Q15 из вещественной константы (только для констант времени компиляции)
+#define Q15(x) ((q15_t)((x) * 32768.0 + ((x) >= 0 ? 0.5 : -0.5)))
+// Коэффициенты биквада хранятся в Q14, чтобы |a1| < 2 помещался в int16
+#define Q14(x) ((q15_t)((x) * 16384.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+static inline q15_t dspSaturateQ15(int32_t value) {
+  if (value > 32767) return 32767;
+  if (value < -32768) return -32768;
+  return (q15_t)value;
+}
+
+// Удаление постоянной составляющей: y = x - dc, dc += (x - dc) / 2^shift.
+// Вход - сырые отсчёты АЦП, выход - переменная составляющая в Q15 с насыщением.
+struct DcRemoveState {
+  int32_t dc;       // оценка DC, сдвинутая на shift бит
+  uint8_t shift;
+  bool primed;
+};
+
+void dspDcRemoveInit(DcRemoveState* state, uint8_t shift);
+void dspDcRemove(DcRemoveState* state, const uint32_t* in, q15_t* out, size_t count);
+static inline int32_t dspDcValue(const DcRemoveState* state) {
+  return state->dc >> state->shift;
+}
+
+// КИХ-фильтр с коэффициентами Q15. Сумма |h[k]| должна быть меньше 2,
+// тогда накопитель int32 не переполняется.
+struct FirStateQ15 {
+  const q15_t* coeffs;
+  uint8_t taps;
+  q15_t history[DSP_MAX_FIR_TAPS - 1 + DSP_MAX_BLOCK];
+};
+
+void dspFirInit(FirStateQ15* state, const q15_t* coeffs, uint8_t taps);
+void dspFir(FirStateQ15* state, const q15_t* in, q15_t* out, size_t count);
+
+// Биквадратное звено (прямая форма I), коэффициенты b0 b1 b2 a1 a2 в Q14.
+// Полосовой фильтр набирается из нескольких звеньев.
+struct BiquadStateQ15 {
+  const q15_t* coeffs;
+  q15_t x1, x2, y1, y2;
+};
+
+void dspBiquadInit(BiquadStateQ15* state, const q15_t* coeffs);
+void dspBiquad(BiquadStateQ15* state, const q15_t* in, q15_t* out, size_t count);
+
+// Скользящее среднее по окну произвольной длины до DSP_MAX_AVERAGE_WINDOW
+struct MovingAverageStateQ15 {
+  q15_t window[DSP_MAX_AVERAGE_WINDOW];
+  int32_t sum;
+  uint8_t length;
+  uint8_t position;
+};
+
+void dspMovingAverageInit(MovingAverageStateQ15* state, uint8_t length);
+void dspMovingAverage(MovingAverageStateQ15* state, const q15_t* in, q15_t* out, size_t count);
+
+// Первая разность y[n] = x[n] - x[n-1] с насыщением
+struct DerivativeStateQ15 {
+  q15_t previous;
+};
+
+void dspDerivative(DerivativeStateQ15* state, const q15_t* in, q15_t* out, size_t count);
+
+// Поиск локальных максимумов выше порога с минимальным расстоянием между ними.
+// Позиции пиков возвращаются как номера отсчётов от начала потока.
+struct PeakDetectStateQ15 {
+  q15_t previous;
+  q15_t beforePrevious;
+  uint32_t sampleIndex;    // номер следующего отсчёта в потоке
+  uint32_t lastPeakIndex;
+  bool hasPeak;
+};
+
+void dspPeakDetectInit(PeakDetectStateQ15* state);
+size_t dspFindPeaks(PeakDetectStateQ15* state, const q15_t* in, size_t count,
+                    q15_t threshold, uint16_t minDistance,
+                    uint32_t* peaks, size_t maxPeaks);
@@ -0,0 +1,427 @@
+#include "pulse_log.h"
+
+#define LOG_READ_CHUNK 16  // записей за одно чтение из файла
+
+void logSegmentPath(char* path, size_t size, uint16_t userId, uint16_t sequence) {
+  snprintf(path, size, LOG_DIRECTORY "/%u/%05u.seg", userId, sequence);
+}
+
+void logIndexPath(char* path, size_t size, uint16_t userId) {
+  snprintf(path, size, LOG_DIRECTORY "/%u/index.bin", userId);
+}
+
+static void logUserDirectory(char* path, size_t size, uint16_t userId) {
+  snprintf(path, size, LOG_DIRECTORY "/%u", userId);
+}
+
+void PulseLog::begin(FS& fs, uint16_t maxUsers, uint32_t reservePerUser) {
+  _fs = &fs;
+  if (_active) {
+    _active.close();
+  }
+  _unsynced = 0;
+  _cursor.valid = false;
+  _fs->mkdir(LOG_DIRECTORY);
+
+  // Бюджет: всё свободное место файловой системы за вычетом запаса, поровну
+  FSInfo info;
+  uint32_t budget = 0;
+  if (_fs->info(info) && info.totalBytes > info.usedBytes + LOG_FS_RESERVE) {
+    budget = info.totalBytes - info.usedBytes - LOG_FS_RESERVE;
+  }
+  uint32_t share = budget / (maxUsers > 0 ? maxUsers : 1);
+  uint32_t segments = share > reservePerUser ? (share - reservePerUser) / LOG_SEGMENT_BYTES : 0;
+  _maxSegments = segments > LOG_MIN_SEGMENTS ? (segments < UINT16_MAX ? segments : UINT16_MAX) : LOG_MIN_SEGMENTS;
+}
+
+// Для чтения: пишущему пользователю - его кешированное положение (после
+// фиксации, чтобы открытый сегмент был виден читателю), остальным - скан
+// без записи в файловую систему. Кеш пишущего не вытесняется
+bool PulseLog::readCursor(uint16_t userId, LogCursor& cursor) {
+  if (_fs == nullptr) {
+    return false;
+  }
+  if (_cursor.valid && _cursor.userId == userId) {
+    flush();
+    cursor = _cursor;
+    return true;
+  }
+  size_t activeBytes;
+  return scanCursor(userId, cursor, activeBytes);
+}
+
+// Восстанавливает положение записи по списку сегментов и размеру последнего.
+// Файлы только читаются: недописанная запись в хвосте не считается, сегмент
+// с повреждённым заголовком - пустой (activeBytes = 0)
+bool PulseLog::scanCursor(uint16_t userId, LogCursor& cursor, size_t& activeBytes) {
+  char path[32];
+  cursor = LogCursor();
+  cursor.userId = userId;
+  activeBytes = 0;
+
+  logUserDirectory(path, sizeof(path), userId);
+  bool found = false;
+  Dir dir = _fs->openDir(path);
+  while (dir.next()) {
+    String name = dir.fileName();
+    if (!name.endsWith(".seg")) {
+      continue;
+    }
+    uint16_t sequence = name.toInt();
+    if (!found || sequence < cursor.firstSequence) {
+      cursor.firstSequence = sequence;
+    }
+    if (!found || sequence > cursor.activeSequence) {
+      cursor.activeSequence = sequence;
+    }
+    found = true;
+  }
+  cursor.valid = true;
+  if (!found) {
+    return true;
+  }
+
+  logSegmentPath(path, sizeof(path), userId, cursor.activeSequence);
+  File file = _fs->open(path, "r");
+  LogSegmentHeader header;
+  if (file && file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+      header.magic == LOG_SEGMENT_MAGIC && header.version == LOG_FORMAT_VERSION) {
+    activeBytes = file.size();
+    cursor.activeCount = (activeBytes - sizeof(header)) / sizeof(PulseRecord);
+    cursor.activeBase = header.base;
+    cursor.lastTime = header.base;
+    PulseRecord records[LOG_READ_CHUNK];
+    for (uint16_t done = 0; done < cursor.activeCount;) {
+      uint16_t chunk = cursor.activeCount - done;
+      if (chunk > LOG_READ_CHUNK) {
+        chunk = LOG_READ_CHUNK;
+      }
+      file.read((uint8_t*)records, chunk * sizeof(PulseRecord));
+      for (uint16_t i = 0; i < chunk; i++) {
+        cursor.lastTime += records[i].delta;
+      }
+      done += chunk;
+    }
+  }
+  if (file) {
+    file.close();
+  }
+  return true;
+}
+
+// Пишущий пользователь: положение по скану, затем починка после сбоя питания -
+// хвост активного сегмента отрезается, сегмент без заголовка пишется заново
+bool PulseLog::loadCursor(uint16_t userId) {
+  LogCursor cursor;
+  size_t activeBytes;
+  if (!scanCursor(userId, cursor, activeBytes)) {
+    return false;
+  }
+
+  char path[32];
+  logSegmentPath(path, sizeof(path), userId, cursor.activeSequence);
+  size_t expected = sizeof(LogSegmentHeader) + cursor.activeCount * sizeof(PulseRecord);
+  if (activeBytes == 0) {
+    if (_fs->exists(path)) {
+      _fs->remove(path);
+    } else {
+      logUserDirectory(path, sizeof(path), userId);
+      _fs->mkdir(path);
+    }
+  } else if (activeBytes != expected) {
+    File file = _fs->open(path, "r+");
+    if (file) {
+      file.truncate(expected);
+      file.close();
+    }
+  }
+
+  _cursor = cursor;
+  return true;
+}
+
+bool PulseLog::startSegment(uint32_t time) {
+  char path[32];
+  logSegmentPath(path, sizeof(path), _cursor.userId, _cursor.activeSequence);
+  _active = _fs->open(path, "w");
+  if (!_active) {
+    return false;
+  }
+  LogSegmentHeader header = {LOG_SEGMENT_MAGIC, LOG_FORMAT_VERSION, 0, _cursor.activeSequence, time};
+  if (_active.write((const uint8_t*)&header, sizeof(header)) != sizeof(header)) {
+    _active.close();
+    return false;
+  }
+  _cursor.activeBase = time;
+  _cursor.lastTime = time;
+  return true;
+}
+
+// Закрытый сегмент попадает в индекс, запись продолжается в следующем
+void PulseLog::closeSegment() {
+  if (_active) {
+    _active.close();
+  }
+  _unsynced = 0;
+  char path[32];
+  logIndexPath(path, sizeof(path), _cursor.userId);
+  File index = _fs->open(path, "a");
+  if (index) {
+    LogIndexEntry entry = {_cursor.activeSequence, _cursor.activeCount, _cursor.activeBase, _cursor.lastTime};
+    index.write((const uint8_t*)&entry, sizeof(entry));
+    index.close();
+  }
+  _cursor.activeSequence++;
+  _cursor.activeCount = 0;
+  dropOldestSegments();
+}
+
+// Ротация: держим не больше _maxSegments сегментов, включая активный
+void PulseLog::dropOldestSegments() {
+  char path[32];
+  bool dropped = false;
+  while ((uint16_t)(_cursor.activeSequence - _cursor.firstSequence) + 1 > _maxSegments) {
+    logSegmentPath(path, sizeof(path), _cursor.userId, _cursor.firstSequence);
+    _fs->remove(path);
+    _cursor.firstSequence++;
+    dropped = true;
+  }
+  if (!dropped) {
+    return;
+  }
+
+  // Индекс переписываем, только когда в нём вдвое больше записей, чем сегментов
+  logIndexPath(path, sizeof(path), _cursor.userId);
+  File index = _fs->open(path, "r");
+  if (!index || index.size() / sizeof(LogIndexEntry) < 2u * _maxSegments) {
+    if (index) {
+      index.close();
+    }
+    return;
+  }
+  char temporary[36];
+  snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+  File compacted = _fs->open(temporary, "w");
+  LogIndexEntry entry;
+  while (compacted && index.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry)) {
+    if (entry.sequence >= _cursor.firstSequence) {
+      compacted.write((const uint8_t*)&entry, sizeof(entry));
+    }
+  }
+  index.close();
+  if (compacted) {
+    compacted.close();
+    _fs->remove(path);
+    _fs->rename(temporary, path);
+  }
+}
+
+bool PulseLog::append(uint16_t userId, uint32_t time, uint8_t pulse, uint8_t spo2, bool quality) {
+  if (_fs == nullptr) {
+    return false;
+  }
+  if (!(_cursor.valid && _cursor.userId == userId)) {
+    // Запись переходит к другому пользователю: прежний сегмент закрывается
+    if (_active) {
+      _active.close();
+    }
+    _unsynced = 0;
+    _cursor.valid = false;
+    if (!loadCursor(userId)) {
+      return false;
+    }
+  }
+
+  // Новый сегмент: текущий заполнен, время пошло назад (перезагрузка, установка часов)
+  // или разрыв не помещается в 16-битную разность
+  if (_cursor.activeCount > 0 &&
+      (_cursor.activeCount >= LOG_SEGMENT_RECORDS || time < _cursor.lastTime ||
+       time - _cursor.lastTime > UINT16_MAX)) {
+    closeSegment();
+  }
+  if (_cursor.activeCount == 0 && !startSegment(time)) {
+    return false;
+  }
+  if (!_active) {
+    char path[32];
+    logSegmentPath(path, sizeof(path), userId, _cursor.activeSequence);
+    _active = _fs->open(path, "a");
+    if (!_active) {
+      return false;
+    }
+  }
+
+  PulseRecord record;
+  record.delta = time - _cursor.lastTime;
+  record.pulse = pulse;
+  record.spo2 = (spo2 & ~LOG_QUALITY_FLAG) | (quality ? LOG_QUALITY_FLAG : 0);
+  if (_active.write((const uint8_t*)&record, sizeof(record)) != sizeof(record)) {
+    return false;
+  }
+  _cursor.activeCount++;
+  _cursor.lastTime = time;
+  if (_unsynced++ == 0) {
+    _unsyncedSince = time;
+  }
+  if (_unsynced >= LOG_SYNC_RECORDS) {
+    flush();
+  }
+  return true;
+}
+
+void PulseLog::sync(uint32_t now) {
+  if (_unsynced > 0 && now - _unsyncedSince >= LOG_SYNC_SECONDS) {
+    flush();
+  }
+}
+
+void PulseLog::flush() {
+  if (_active && _unsynced > 0) {
+    _active.flush();
+  }
+  _unsynced = 0;
+}
+
+void PulseLog::remove(uint16_t userId) {
+  if (_fs == nullptr) {
+    return;
+  }
+  if (_cursor.userId == userId) {
+    if (_active) {
+      _active.close();
+    }
+    _unsynced = 0;
+    _cursor.valid = false;
+  }
+  char path[32];
+  logUserDirectory(path, sizeof(path), userId);
+  Dir dir = _fs->openDir(path);
+  while (dir.next()) {
+    char file[48];
+    snprintf(file, sizeof(file), "%s/%s", path, dir.fileName().c_str());
+    _fs->remove(file);
+  }
+  _fs->rmdir(path);
+}
+
+uint32_t PulseLog::recordCount(uint16_t userId) {
+  LogCursor cursor;
+  if (!readCursor(userId, cursor)) {
+    return 0;
+  }
+  uint32_t count = cursor.activeCount;
+  char path[32];
+  logIndexPath(path, sizeof(path), userId);
+  File index = _fs->open(path, "r");
+  LogIndexEntry entry;
+  while (index && index.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry)) {
+    if (entry.sequence >= cursor.firstSequence && entry.sequence < cursor.activeSequence) {
+      count += entry.count;
+    }
+  }
+  if (index) {
+    index.close();
+  }
+  return count;
+}
+
+uint32_t PulseLog::lastTime(uint16_t userId) {
+  LogCursor cursor;
+  if (!readCursor(userId, cursor) || (cursor.activeCount == 0 && cursor.activeSequence == cursor.firstSequence)) {
+    return 0;
+  }
+  return cursor.lastTime;
+}
+
+PulseLogReader::PulseLogReader(PulseLog& log, uint16_t userId, uint32_t from, uint32_t to)
+  : _log(log), _userId(userId), _from(from), _to(to) {
+  if (log.readCursor(userId, _cursor)) {
+    char path[32];
+    logIndexPath(path, sizeof(path), userId);
+    _index = log._fs->open(path, "r");
+  } else {
+    _cursor = LogCursor();
+    _activeDone = true;
+  }
+}
+
+PulseLogReader::~PulseLogReader() {
+  if (_segment) {
+    _segment.close();
+  }
+  if (_index) {
+    _index.close();
+  }
+}
+
+bool PulseLogReader::openSegment(uint16_t sequence, uint16_t count) {
+  char path[32];
+  logSegmentPath(path, sizeof(path), _userId, sequence);
+  _segment = _log._fs->open(path, "r");
+  LogSegmentHeader header;
+  if (!_segment || _segment.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+      header.magic != LOG_SEGMENT_MAGIC) {
+    if (_segment) {
+      _segment.close();
+    }
+    return false;
+  }
+  _time = header.base;
+  _remaining = count;
+  return true;
+}
+
+// По индексу пропускаем сегменты вне диапазона, последним читаем активный
+bool PulseLogReader::openNextSegment() {
+  LogIndexEntry entry;
+  while (_index && _index.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry)) {
+    // Время журнала (log_clock.h) не идёт назад, но сегменты, записанные до
+    // него, начинались заново с каждой загрузкой - на первом сегменте позже to
+    // не останавливаемся
+    if (entry.sequence < _cursor.firstSequence || entry.sequence >= _cursor.activeSequence ||
+        entry.last < _from || entry.first > _to) {
+      continue;
+    }
+    if (openSegment(entry.sequence, entry.count)) {
+      return true;
+    }
+  }
+
+  if (!_activeDone) {
+    _activeDone = true;
+    if (_cursor.activeCount > 0 && _cursor.lastTime >= _from && _cursor.activeBase <= _to) {
+      return openSegment(_cursor.activeSequence, _cursor.activeCount);
+    }
+  }
+  return false;
+}
+
+bool PulseLogReader::next(PulseSample& sample) {
+  while (true) {
+    if (_remaining == 0) {
+      if (_segment) {
+        _segment.close();
+      }
+      if (!openNextSegment()) {
+        return false;
+      }
+      continue;
+    }
+
+    PulseRecord record;
+    if (_segment.read((uint8_t*)&record, sizeof(record)) != sizeof(record)) {
+      _remaining = 0;
+      continue;
+    }
+    _remaining--;
+    _time += record.delta;
+    if (_time < _from || _time > _to) {
+      continue;
+    }
+    sample.time = _time;
+    sample.pulse = record.pulse;
+    sample.spo2 = record.spo2 & ~LOG_QUALITY_FLAG;
+    sample.quality = (record.spo2 & LOG_QUALITY_FLAG) != 0;
+    return true;
+  }
+}
@@ -0,0 +1,149 @@
+// Журнал измерений пульса и SpO2 на LittleFS, отдельный для каждого пользователя.
+//
+// Записи фиксированного размера дописываются в конец текущего сегмента
+// /log/<id>/<номер>.seg, поэтому добавление не зависит от длины истории.
+// Заполненный сегмент закрывается, его сводка (время первой и последней
+// записи) дописывается в /log/<id>/index.bin, и начинается новый сегмент.
+// Когда у пользователя кончается его доля флеш-памяти, удаляется самый
+// старый сегмент. Чтение диапазона по индексу пропускает лишние сегменты
+// и не разбирает JSON.
+//
+// Активный сегмент пишущего пользователя остаётся открытым: запись - это
+// 4 байта в открытый файл, а фиксация (sync LittleFS) - раз в
+// LOG_SYNC_RECORDS записей или по sync() не позже LOG_SYNC_SECONDS. При
+// пропаже питания теряются только незафиксированные записи, недописанная
+// отрезается при следующей загрузке. Чтение файловую систему не меняет.
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#define LOG_DIRECTORY "/log"
+#define LOG_SEGMENT_MAGIC 0x474C5050UL  // "PPLG"
+#define LOG_FORMAT_VERSION 1
+#define LOG_SEGMENT_BYTES 4096          // один блок флеш-памяти
+#define LOG_FS_RESERVE 65536            // не занимаем последние 64 КБ файловой системы
+#define LOG_MIN_SEGMENTS 2
+#define LOG_QUALITY_FLAG 0x80           // старший бит поля spo2
+#define LOG_SYNC_RECORDS 6              // записей между фиксациями
+#define LOG_SYNC_SECONDS 30             // дольше запись не остаётся незафиксированной
+
+// Заголовок сегмента: абсолютное время отсчитывается от base
+struct __attribute__((packed)) LogSegmentHeader {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t sequence;
+  uint32_t base;       // с, время первой записи
+};
+
+// Измерение в журнале и в кольце последних записей: 4 байта
+struct __attribute__((packed)) PulseRecord {
+  uint16_t delta;      // с от предыдущей записи (от base для первой)
+  uint8_t pulse;       // уд/мин
+  uint8_t spo2;        // %, старший бит - флаг качества сигнала
+};
+
+// Сводка закрытого сегмента в индексе
+struct __attribute__((packed)) LogIndexEntry {
+  uint16_t sequence;
+  uint16_t count;
+  uint32_t first;      // с
+  uint32_t last;       // с
+};
+
+#define LOG_SEGMENT_RECORDS ((LOG_SEGMENT_BYTES - sizeof(LogSegmentHeader)) / sizeof(PulseRecord))
+
+static_assert(sizeof(PulseRecord) == 4, "PulseRecord must stay packed");
+static_assert(sizeof(LogSegmentHeader) + LOG_SEGMENT_RECORDS * sizeof(PulseRecord) <= LOG_SEGMENT_BYTES,
+              "segment must fit one flash block");
+
+// Измерение с абсолютным временем, как его видит читатель журнала
+struct PulseSample {
+  uint32_t time;       // с
+  uint8_t pulse;
+  uint8_t spo2;
+  bool quality;
+};
+
+// Положение записи для одного пользователя
+struct LogCursor {
+  uint16_t userId;
+  uint16_t firstSequence;  // самый старый сохранившийся сегмент
+  uint16_t activeSequence; // сегмент, в который идёт запись
+  uint16_t activeCount;    // записей в активном сегменте, 0 - сегмент ещё не создан
+  uint32_t activeBase;     // с, время первой записи активного сегмента
+  uint32_t lastTime;
+  bool valid;
+};
+
+class PulseLog {
+public:
+  // maxUsers - на сколько пользователей делится бюджет флеш-памяти,
+  // reservePerUser - сколько из доли каждого занято другими файлами
+  void begin(FS& fs, uint16_t maxUsers, uint32_t reservePerUser);
+
+  bool append(uint16_t userId, uint32_t time, uint8_t pulse, uint8_t spo2, bool quality);
+  // Фиксирует дописанные записи, если первой из них LOG_SYNC_SECONDS; вызывается периодически
+  void sync(uint32_t now);
+  // Фиксирует дописанные записи сразу
+  void flush();
+  // Удаляет всю историю пользователя
+  void remove(uint16_t userId);
+
+  // Сколько записей у пользователя (без учёта удалённых ротацией)
+  uint32_t recordCount(uint16_t userId);
+  // Время последней записи или 0, если журнал пуст
+  uint32_t lastTime(uint16_t userId);
+
+  uint16_t segmentBudget() const {
+    return _maxSegments;
+  }
+
+private:
+  friend class PulseLogReader;
+
+  // Положение записи для чтения: без изменений файловой системы
+  bool readCursor(uint16_t userId, LogCursor& cursor);
+  bool scanCursor(uint16_t userId, LogCursor& cursor, size_t& activeBytes);
+  // Положение записи для пишущего пользователя: с починкой после сбоя
+  bool loadCursor(uint16_t userId);
+  bool startSegment(uint32_t time);
+  void closeSegment();
+  void dropOldestSegments();
+
+  FS* _fs = nullptr;
+  uint16_t _maxSegments = LOG_MIN_SEGMENTS;
+  LogCursor _cursor = {};  // кешируется один пользователь - тот, кто сейчас пишет
+  File _active;            // его активный сегмент, открыт на дозапись
+  uint8_t _unsynced = 0;   // записей после последней фиксации
+  uint32_t _unsyncedSince = 0;
+};
+
+// Последовательное чтение записей пользователя в диапазоне времени [from, to]
+class PulseLogReader {
+public:
+  PulseLogReader(PulseLog& log, uint16_t userId, uint32_t from, uint32_t to);
+  ~PulseLogReader();
+
+  bool next(PulseSample& sample);
+
+private:
+  bool openNextSegment();
+  bool openSegment(uint16_t sequence, uint16_t count);
+
+  PulseLog& _log;
+  uint16_t _userId;
+  uint32_t _from;
+  uint32_t _to;
+  LogCursor _cursor;
+  File _index;
+  File _segment;
+  uint16_t _remaining = 0;  // непрочитанных записей в открытом сегменте
+  uint32_t _time = 0;
+  bool _activeDone = false;
+};
+
+// Имена файлов журнала
+void logSegmentPath(char* path, size_t size, uint16_t userId, uint16_t sequence);
+void logIndexPath(char* path, size_t size, uint16_t userId);
@@ -0,0 +1,222 @@
+#include "pulse_rollup.h"
+#include "pulse_log.h"
+
+#define ROLLUP_READ_CHUNK 16  // ячеек за одно чтение из файла
+
+const RollupLevelInfo rollupLevels[ROLLUP_LEVELS] = {
+  {"minute", 60, 720},   // 12 часов - одна ночь
+  {"hour", 3600, 336},   // 14 суток
+  {"day", 86400, 366}    // год
+};
+
+void rollupPath(char* path, size_t size, uint16_t userId, RollupLevel level) {
+  snprintf(path, size, LOG_DIRECTORY "/%u/rollup-%s.bin", userId, rollupLevels[level].name);
+}
+
+static uint32_t periodStart(RollupLevel level, uint32_t time) {
+  return time - time % rollupLevels[level].period;
+}
+
+static uint32_t slotOffset(RollupLevel level, uint32_t start) {
+  return (start / rollupLevels[level].period) % rollupLevels[level].capacity * sizeof(RollupBucket);
+}
+
+static void bucketAdd(RollupBucket& bucket, uint8_t pulse, uint8_t spo2) {
+  if (bucket.count == 0) {
+    bucket.pulseMin = bucket.pulseMax = pulse;
+    bucket.spo2Min = bucket.spo2Max = spo2;
+  } else {
+    if (pulse < bucket.pulseMin) bucket.pulseMin = pulse;
+    if (pulse > bucket.pulseMax) bucket.pulseMax = pulse;
+    if (spo2 < bucket.spo2Min) bucket.spo2Min = spo2;
+    if (spo2 > bucket.spo2Max) bucket.spo2Max = spo2;
+  }
+  bucket.count++;
+  bucket.pulseSum += pulse;
+  bucket.spo2Sum += spo2;
+}
+
+void PulseRollup::begin(FS& fs) {
+  _fs = &fs;
+  _selected = false;
+}
+
+uint32_t PulseRollup::bytesPerUser() {
+  uint32_t bytes = 0;
+  for (uint8_t level = 0; level < ROLLUP_LEVELS; level++) {
+    bytes += (uint32_t)rollupLevels[level].capacity * sizeof(RollupBucket);
+  }
+  return bytes;
+}
+
+bool PulseRollup::readSlot(uint16_t userId, RollupLevel level, uint32_t start, RollupBucket& bucket) {
+  char path[40];
+  rollupPath(path, sizeof(path), userId, level);
+  File file = _fs->open(path, "r");
+  if (!file) {
+    return false;
+  }
+  bool found = file.seek(slotOffset(level, start)) &&
+               file.read((uint8_t*)&bucket, sizeof(bucket)) == sizeof(bucket) &&
+               bucket.count > 0 && bucket.start == start;
+  file.close();
+  return found;
+}
+
+void PulseRollup::writeSlot(RollupLevel level, const RollupBucket& bucket) {
+  char path[40];
+  rollupPath(path, sizeof(path), _userId, level);
+  File file = _fs->open(path, "r+");
+  if (!file) {
+    // Файл-кольцо создаётся сразу полного размера, чтобы ячейки писались на место
+    file = _fs->open(path, "w");
+    if (!file) {
+      return;
+    }
+    uint8_t zeros[128] = {0};
+    uint32_t size = (uint32_t)rollupLevels[level].capacity * sizeof(RollupBucket);
+    for (uint32_t written = 0; written < size; written += sizeof(zeros)) {
+      file.write(zeros, size - written < sizeof(zeros) ? size - written : sizeof(zeros));
+    }
+  }
+  file.seek(slotOffset(level, bucket.start));
+  file.write((const uint8_t*)&bucket, sizeof(bucket));
+  file.close();
+}
+
+void PulseRollup::flush() {
+  for (uint8_t level = 0; level < ROLLUP_LEVELS; level++) {
+    if (_open[level].count > 0) {
+      writeSlot((RollupLevel)level, _open[level]);
+    }
+  }
+}
+
+void PulseRollup::select(uint16_t userId, uint32_t now) {
+  deselect();
+  if (_fs == nullptr) {
+    return;
+  }
+  _userId = userId;
+  _selected = true;
+  // Незакрытые корзины текущих периодов продолжаем с того, что уже сохранено
+  for (uint8_t level = 0; level < ROLLUP_LEVELS; level++) {
+    RollupBucket& bucket = _open[level];
+    uint32_t start = periodStart((RollupLevel)level, now);
+    if (!readSlot(userId, (RollupLevel)level, start, bucket)) {
+      memset(&bucket, 0, sizeof(bucket));
+      bucket.start = start;
+    }
+  }
+}
+
+void PulseRollup::deselect() {
+  if (_selected) {
+    flush();
+    _selected = false;
+  }
+}
+
+void PulseRollup::add(uint32_t time, uint8_t pulse, uint8_t spo2) {
+  if (!_selected) {
+    return;
+  }
+  bool minuteClosed = false;
+  for (uint8_t level = 0; level < ROLLUP_LEVELS; level++) {
+    RollupBucket& bucket = _open[level];
+    uint32_t start = periodStart((RollupLevel)level, time);
+    if (start != bucket.start) {
+      // Период кончился (или часы переставили) - корзина уходит в файл
+      if (bucket.count > 0) {
+        writeSlot((RollupLevel)level, bucket);
+      }
+      if (level == ROLLUP_MINUTE) {
+        minuteClosed = true;
+      }
+      memset(&bucket, 0, sizeof(bucket));
+      bucket.start = start;
+    }
+    bucketAdd(bucket, pulse, spo2);
+  }
+
+  // Раз в минуту сохраняем и открытые часовую и суточную корзины:
+  // после перезагрузки теряется не больше минуты
+  if (minuteClosed) {
+    for (uint8_t level = ROLLUP_HOUR; level < ROLLUP_LEVELS; level++) {
+      writeSlot((RollupLevel)level, _open[level]);
+    }
+  }
+}
+
+size_t PulseRollup::query(uint16_t userId, RollupLevel level, uint32_t from, uint32_t to,
+                          RollupBucket* out, size_t maxBuckets, uint32_t& next) {
+  next = 0;
+  if (_fs == nullptr || from > to || maxBuckets == 0) {
+    return 0;
+  }
+  const uint32_t period = rollupLevels[level].period;
+  const uint16_t capacity = rollupLevels[level].capacity;
+  const uint32_t span = period * capacity;
+  const bool live = _selected && _userId == userId;
+
+  // Старше одного оборота кольца данных нет: их ячейки уже перезаписаны
+  uint32_t latest = live ? _open[level].start : periodStart(level, to);
+  if (to > latest && to - latest >= period) {
+    to = latest + period - 1;
+  }
+  uint32_t start = periodStart(level, from);
+  if (latest >= span && start < latest - span + period) {
+    start = latest - span + period;
+  }
+  if (start > to) {
+    return 0;
+  }
+
+  // В окне не больше оборота кольца, поэтому в каждой ячейке не больше одного
+  // его периода и ячейки от ячейки start по кругу идут по возрастанию времени.
+  // Файл читается пачками подряд; пустые и устаревшие ячейки пропускаются
+  uint32_t periods = (to - start) / period + 1;
+  uint16_t slots = periods < capacity ? periods : capacity;
+  uint16_t slot = slotOffset(level, start) / sizeof(RollupBucket);
+  uint16_t openSlot = live ? slotOffset(level, _open[level].start) / sizeof(RollupBucket) : capacity;
+
+  char path[40];
+  rollupPath(path, sizeof(path), userId, level);
+  File file = _fs->open(path, "r");
+  RollupBucket chunk[ROLLUP_READ_CHUNK];
+  uint16_t loaded = 0;
+  uint16_t used = 0;
+  size_t found = 0;
+  for (uint16_t i = 0; i < slots; i++, slot = slot + 1 == capacity ? 0 : slot + 1) {
+    if (used == loaded) {
+      // Пачка - до конца файла или окна, дальше чтение с начала кольца
+      loaded = capacity - slot;
+      if (loaded > slots - i) {
+        loaded = slots - i;
+      }
+      if (loaded > ROLLUP_READ_CHUNK) {
+        loaded = ROLLUP_READ_CHUNK;
+      }
+      used = 0;
+      size_t bytes = loaded * sizeof(RollupBucket);
+      if (!(file && file.seek(slot * sizeof(RollupBucket)) && file.read((uint8_t*)chunk, bytes) == bytes)) {
+        memset(chunk, 0, bytes);
+      }
+    }
+    // Открытая корзина в ОЗУ новее сохранённой
+    const RollupBucket& bucket = slot == openSlot ? _open[level] : chunk[used];
+    used++;
+    if (bucket.count == 0 || bucket.start < start || bucket.start > to) {
+      continue;
+    }
+    if (found == maxBuckets) {
+      next = bucket.start;
+      break;
+    }
+    out[found++] = bucket;
+  }
+  if (file) {
+    file.close();
+  }
+  return found;
+}
@@ -0,0 +1,75 @@
+// Сводки измерений по минутам, часам и суткам для графиков трендов.
+//
+// Каждая запись addPulseRecord() добавляется в три открытые корзины
+// (минута, час, сутки): count, min, max и сумма для пульса и SpO2, поэтому
+// среднее получается точным. Закрытые корзины лежат в файлах-кольцах
+// фиксированного размера /log/<id>/rollup-<уровень>.bin: номер ячейки -
+// номер периода по модулю ёмкости, так что запись и чтение одной корзины
+// обходятся одним seek. Запрос за диапазон читает подряд, пачками, только
+// ячейки периодов из этого диапазона и пропускает пустые.
+//
+// Время - время журнала (log_clock.h): оно не начинается заново с каждой
+// загрузкой, поэтому корзины разных загрузок не совпадают по началу периода.
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+enum RollupLevel : uint8_t {
+  ROLLUP_MINUTE,
+  ROLLUP_HOUR,
+  ROLLUP_DAY,
+  ROLLUP_LEVELS
+};
+
+struct __attribute__((packed)) RollupBucket {
+  uint32_t start;     // с, начало периода; 0 вместе с count == 0 - пустая ячейка
+  uint16_t count;
+  uint8_t pulseMin;
+  uint8_t pulseMax;
+  uint8_t spo2Min;
+  uint8_t spo2Max;
+  uint32_t pulseSum;
+  uint32_t spo2Sum;
+};
+
+struct RollupLevelInfo {
+  const char* name;   // значение параметра res
+  uint32_t period;    // с
+  uint16_t capacity;  // ячеек в файле
+};
+
+extern const RollupLevelInfo rollupLevels[ROLLUP_LEVELS];
+
+class PulseRollup {
+public:
+  void begin(FS& fs);
+
+  // Переключает запись на пользователя: открытые корзины прежнего
+  // сохраняются, для нового читаются из файлов
+  void select(uint16_t userId, uint32_t now);
+  void deselect();
+
+  void add(uint32_t time, uint8_t pulse, uint8_t spo2);
+
+  // Корзины уровня в [from, to] по возрастанию времени, не больше maxBuckets.
+  // Возвращает их число; next - с какого времени продолжить, 0 - больше нет
+  size_t query(uint16_t userId, RollupLevel level, uint32_t from, uint32_t to,
+               RollupBucket* out, size_t maxBuckets, uint32_t& next);
+
+  // Место во флеш-памяти под сводки одного пользователя
+  static uint32_t bytesPerUser();
+
+private:
+  bool readSlot(uint16_t userId, RollupLevel level, uint32_t start, RollupBucket& bucket);
+  void writeSlot(RollupLevel level, const RollupBucket& bucket);
+  void flush();
+
+  FS* _fs = nullptr;
+  uint16_t _userId = 0;
+  bool _selected = false;
+  RollupBucket _open[ROLLUP_LEVELS];
+};
+
+// Имя файла сводок уровня
+void rollupPath(char* path, size_t size, uint16_t userId, RollupLevel level);
@@ -0,0 +1,173 @@
+#include "request_queue.h"
+
+void RequestQueue::on(AsyncWebServer& server, const char* uri, WebRequestMethodComposite method, RequestHandler handler) {
+  server.on(uri, method, [this, handler](AsyncWebServerRequest* request) {
+    if (!enqueue(request, handler)) {
+      _stats.rejected++;
+      request->send(503, "text/plain", "Server busy");
+    }
+  });
+}
+
+bool RequestQueue::enqueue(AsyncWebServerRequest* request, RequestHandler handler) {
+  if (_count >= REQUEST_QUEUE_SIZE) {
+    return false;
+  }
+  uint8_t index = (_head + _count) % REQUEST_QUEUE_SIZE;
+  PendingRequest& slot = _slots[index];
+  slot.request = request;
+  slot.handler = handler;
+  slot.queuedAt = micros();
+  _count++;
+  if (_count > _stats.maxDepth) {
+    _stats.maxDepth = _count;
+  }
+
+  // После отключения сервер удалит запрос - забываем указатель и освобождаем
+  // буфер ответа. Обработчик у запроса один: библиотека хранит только последний
+  request->onDisconnect([this, index, request]() {
+    if (_slots[index].request == request) {
+      _slots[index].request = nullptr;
+    }
+    for (uint8_t i = 0; i < RESPONSE_BUFFERS; i++) {
+      if (_bufferOwner[i] == request) {
+        _bufferOwner[i] = nullptr;
+        _bufferBusy[i] = false;
+      }
+    }
+  });
+  return true;
+}
+
+size_t RequestQueue::dispatch(size_t maxRequests) {
+  size_t done = 0;
+  while (_count > 0 && done < maxRequests) {
+    PendingRequest& slot = _slots[_head];
+    _current = _head;
+    _headerCount = 0;
+
+    if (slot.request == nullptr) {
+      _stats.cancelled++;
+    } else {
+      uint32_t wait = micros() - slot.queuedAt;
+      _stats.handled++;
+      _stats.totalWait += wait;
+      if (wait > _stats.maxWait) {
+        _stats.maxWait = wait;
+      }
+      slot.handler();
+      // Обработчик не ответил - запрос не должен висеть до таймаута клиента
+      if (slot.request != nullptr) {
+        send(500, "text/plain", "No response");
+      }
+    }
+
+    _current = -1;
+    _head = (_head + 1) % REQUEST_QUEUE_SIZE;
+    _count--;
+    done++;
+  }
+  return done;
+}
+
+AsyncWebServerRequest* RequestQueue::current() const {
+  return _current >= 0 ? _slots[_current].request : nullptr;
+}
+
+bool RequestQueue::hasArg(const char* name) const {
+  AsyncWebServerRequest* request = current();
+  return request != nullptr && request->hasArg(name);
+}
+
+String RequestQueue::arg(const char* name) const {
+  AsyncWebServerRequest* request = current();
+  return request != nullptr ? request->arg(name) : String();
+}
+
+const String& RequestQueue::header(const char* name) const {
+  static const String empty;
+  AsyncWebServerRequest* request = current();
+  AsyncWebHeader* header = request != nullptr ? request->getHeader(name) : nullptr;
+  return header != nullptr ? header->value() : empty;
+}
+
+void RequestQueue::sendHeader(const char* name, const String& value) {
+  if (_headerCount < REQUEST_MAX_HEADERS) {
+    _headerNames[_headerCount] = name;
+    _headerValues[_headerCount] = value;
+    _headerCount++;
+  }
+}
+
+void RequestQueue::applyHeaders(AsyncWebServerResponse* response) {
+  for (uint8_t i = 0; i < _headerCount; i++) {
+    response->addHeader(_headerNames[i], _headerValues[i]);
+    _headerValues[i] = String();
+  }
+  _headerCount = 0;
+}
+
+void RequestQueue::send(int code) {
+  send(code, "text/plain", String());
+}
+
+void RequestQueue::send(int code, const char* contentType, const String& content) {
+  AsyncWebServerRequest* request = current();
+  if (request == nullptr) {
+    _headerCount = 0;
+    return;
+  }
+  send(request->beginResponse(code, contentType, content));
+}
+
+void RequestQueue::send(AsyncWebServerResponse* response) {
+  AsyncWebServerRequest* request = current();
+  if (request == nullptr) {
+    delete response;
+    _headerCount = 0;
+    return;
+  }
+  applyHeaders(response);
+  request->send(response);
+  // Ответ отдан серверу; второй send() для этого запроса ничего не сделает
+  _slots[_current].request = nullptr;
+}
+
+char* RequestQueue::responseBuffer() {
+  for (uint8_t i = 0; i < RESPONSE_BUFFERS; i++) {
+    if (!_bufferBusy[i]) {
+      _bufferBusy[i] = true;
+      return _buffers[i];
+    }
+  }
+  return nullptr;
+}
+
+void RequestQueue::releaseBuffer(char* buffer) {
+  for (uint8_t i = 0; i < RESPONSE_BUFFERS; i++) {
+    if (buffer == _buffers[i]) {
+      _bufferBusy[i] = false;
+      _bufferOwner[i] = nullptr;
+    }
+  }
+}
+
+void RequestQueue::send(int code, const char* contentType, char* buffer, size_t length) {
+  AsyncWebServerRequest* request = current();
+  if (request == nullptr) {
+    releaseBuffer(buffer);
+    _headerCount = 0;
+    return;
+  }
+  // Буфер освободит обработчик отключения, поставленный в enqueue()
+  for (uint8_t i = 0; i < RESPONSE_BUFFERS; i++) {
+    if (buffer == _buffers[i]) {
+      _bufferOwner[i] = request;
+    }
+  }
+  send(request->beginResponse_P(code, contentType, (const uint8_t*)buffer, length));
+}
+
+void RequestQueue::resetStats() {
+  _stats = RequestQueueStats();
+}
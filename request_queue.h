@@ -0,0 +1,87 @@
+// Очередь HTTP-запросов от асинхронного сервера к основному циклу.
+//
+// ESPAsyncWebServer разбирает запросы в контексте сетевого стека, пока
+// loop() занят своими делами. Обработчики же работают с общим состоянием
+// (users[], pulse, будильник), поэтому колбэк сервера только ставит запрос
+// в очередь, а выполняет его dispatch() из задачи основного цикла.
+// На время выполнения обработчик видит текущий запрос через arg()/send(),
+// как раньше через ESP8266WebServer.
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+#define REQUEST_QUEUE_SIZE 8
+#define REQUEST_MAX_HEADERS 3
+#define RESPONSE_BUFFERS 2       // тела, которые сервер отдаёт одновременно без копии
+#define RESPONSE_BUFFER_SIZE 512
+
+typedef void (*RequestHandler)();
+
+struct PendingRequest {
+  AsyncWebServerRequest* request; // nullptr - клиент отключился, отвечать некому
+  RequestHandler handler;
+  uint32_t queuedAt;              // мкс
+};
+
+struct RequestQueueStats {
+  uint32_t handled;
+  uint32_t rejected;   // очередь была полна, ответили 503
+  uint32_t cancelled;  // клиент ушёл, не дождавшись обработки
+  uint32_t maxDepth;
+  uint32_t maxWait;    // мкс от постановки в очередь до запуска обработчика
+  uint64_t totalWait;  // мкс
+};
+
+class RequestQueue {
+public:
+  // Регистрирует маршрут, обработчик которого выполнится в основном цикле
+  void on(AsyncWebServer& server, const char* uri, WebRequestMethodComposite method, RequestHandler handler);
+
+  // Выполняет до maxRequests запросов из очереди; возвращает число выполненных
+  size_t dispatch(size_t maxRequests);
+
+  // Доступ к текущему запросу из обработчика
+  bool hasArg(const char* name) const;
+  String arg(const char* name) const;
+  // Значение заголовка запроса или пустая строка; без копии, ссылка живёт
+  // до конца обработчика
+  const String& header(const char* name) const;
+  void sendHeader(const char* name, const String& value);
+  void send(int code);
+  void send(int code, const char* contentType, const String& content);
+  // Готовый ответ, созданный через current()->beginResponse...()
+  void send(AsyncWebServerResponse* response);
+
+  // Статический буфер под тело ответа или nullptr, если все ещё отдаются.
+  // Буфер передаётся серверу через send() ниже и остаётся занят, пока клиент
+  // не отключится: сервер забирает тело порциями прямо из него, без копии в куче.
+  char* responseBuffer();
+  void send(int code, const char* contentType, char* buffer, size_t length);
+  // Возвращает буфер, если ответ из него так и не отправлен
+  void releaseBuffer(char* buffer);
+  // Текущий запрос или nullptr, если клиент уже отключился или ответ отправлен
+  AsyncWebServerRequest* current() const;
+
+  const RequestQueueStats& stats() const {
+    return _stats;
+  }
+
+  void resetStats();
+
+private:
+  bool enqueue(AsyncWebServerRequest* request, RequestHandler handler);
+  void applyHeaders(AsyncWebServerResponse* response);
+
+  PendingRequest _slots[REQUEST_QUEUE_SIZE];
+  uint8_t _head = 0;  // следующий на выполнение
+  uint8_t _count = 0;
+  int8_t _current = -1;
+  const char* _headerNames[REQUEST_MAX_HEADERS];
+  String _headerValues[REQUEST_MAX_HEADERS];
+  uint8_t _headerCount = 0;
+  char _buffers[RESPONSE_BUFFERS][RESPONSE_BUFFER_SIZE];
+  bool _bufferBusy[RESPONSE_BUFFERS] = {};
+  AsyncWebServerRequest* _bufferOwner[RESPONSE_BUFFERS] = {};  // кому отдан буфер
+  RequestQueueStats _stats = {};
+};
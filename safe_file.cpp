@@ -0,0 +1,133 @@
+#include "safe_file.h"
+#include "crc32.h"
+
+static void tempPath(char* out, const char* path) {
+  snprintf(out, SAFE_FILE_PATH_MAX, "%s.tmp", path);
+}
+
+SafeFileWriter::SafeFileWriter(FS& fs, const char* path, uint32_t generation)
+  : _fs(fs), _path(path), _generation(generation) {
+  tempPath(_tempPath, path);
+}
+
+bool SafeFileWriter::begin() {
+  _file = _fs.open(_tempPath, "w");
+  _failed = !_file;
+  _crc = 0;
+  _length = 0;
+  return !_failed;
+}
+
+size_t SafeFileWriter::write(uint8_t byte) {
+  return write(&byte, 1);
+}
+
+size_t SafeFileWriter::write(const uint8_t* data, size_t length) {
+  if (_failed) {
+    return 0;
+  }
+  size_t written = _file.write(data, length);
+  _crc = crc32Update(_crc, data, written);
+  _length += written;
+  if (written != length) {
+    _failed = true; // место кончилось - такую копию не подставляем
+  }
+  return written;
+}
+
+bool SafeFileWriter::commit() {
+  if (!_failed) {
+    char footer[SAFE_FILE_FOOTER_BYTES + 1];
+    snprintf(footer, sizeof(footer), "\n#crc=%08x gen=%08x\n", (unsigned)_crc, (unsigned)_generation);
+    _failed = _file.write((const uint8_t*)footer, SAFE_FILE_FOOTER_BYTES) != SAFE_FILE_FOOTER_BYTES;
+  }
+  if (_file) {
+    _file.close();
+  }
+  if (_failed || !_fs.rename(_tempPath, _path)) {
+    _fs.remove(_tempPath);
+    return false;
+  }
+  return true;
+}
+
+void SafeFileWriter::abort() {
+  if (_file) {
+    _file.close();
+  }
+  _fs.remove(_tempPath);
+  _failed = true;
+}
+
+// Проверяет подпись копии. legacy - файл без подписи принимается как поколение 0
+static bool validate(FS& fs, const char* path, bool legacy, uint32_t& generation, size_t& length) {
+  File file = fs.open(path, "r");
+  if (!file) {
+    return false;
+  }
+  size_t size = file.size();
+  char footer[SAFE_FILE_FOOTER_BYTES + 1] = "";
+  if (size >= SAFE_FILE_FOOTER_BYTES) {
+    file.seek(size - SAFE_FILE_FOOTER_BYTES, SeekSet);
+    file.read((uint8_t*)footer, SAFE_FILE_FOOTER_BYTES);
+    footer[SAFE_FILE_FOOTER_BYTES] = '\0';
+  }
+
+  unsigned expected = 0;
+  unsigned stored = 0;
+  if (sscanf(footer, "\n#crc=%8x gen=%8x\n", &expected, &stored) != 2) {
+    file.close();
+    if (!legacy || size == 0) {
+      return false;
+    }
+    generation = 0;
+    length = size;
+    return true;
+  }
+
+  length = size - SAFE_FILE_FOOTER_BYTES;
+  uint32_t crc = 0;
+  uint8_t buffer[64];
+  file.seek(0, SeekSet);
+  for (size_t done = 0; done < length;) {
+    size_t chunk = length - done < sizeof(buffer) ? length - done : sizeof(buffer);
+    if (file.read(buffer, chunk) != chunk) {
+      break;
+    }
+    crc = crc32Update(crc, buffer, chunk);
+    done += chunk;
+  }
+  file.close();
+  generation = stored;
+  return crc == expected;
+}
+
+File safeFileOpen(FS& fs, const char* path, uint32_t& generation, size_t& length) {
+  char temp[SAFE_FILE_PATH_MAX];
+  tempPath(temp, path);
+
+  uint32_t mainGeneration = 0;
+  size_t mainLength = 0;
+  bool mainValid = validate(fs, path, true, mainGeneration, mainLength);
+  uint32_t tempGeneration = 0;
+  size_t tempLength = 0;
+  bool tempValid = fs.exists(temp) && validate(fs, temp, false, tempGeneration, tempLength);
+
+  if (tempValid && (!mainValid || tempGeneration > mainGeneration)) {
+    // Питание пропало между записью и переименованием - завершаем замену
+    if (fs.rename(temp, path)) {
+      mainValid = true;
+      mainGeneration = tempGeneration;
+      mainLength = tempLength;
+    }
+  } else if (fs.exists(temp)) {
+    fs.remove(temp);
+  }
+
+  if (!mainValid) {
+    return File();
+  }
+  generation = mainGeneration;
+  length = mainLength;
+  return fs.open(path, "r");
+}
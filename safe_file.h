@@ -0,0 +1,50 @@
+// Запись небольших файлов, переживающая пропадание питания.
+//
+// Новая версия пишется целиком в <path>.tmp, в конце - подпись
+// "\n#crc=xxxxxxxx gen=xxxxxxxx\n" с CRC-32 содержимого и номером поколения,
+// и только потом переименовывается поверх <path> (rename в LittleFS атомарен).
+// Оборванная запись оставляет недописанный .tmp с неверной подписью, а старый
+// файл - нетронутым. При чтении из двух копий берётся целая с большим
+// поколением; файл без подписи (старого формата) считается поколением 0.
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#define SAFE_FILE_FOOTER_BYTES 28
+#define SAFE_FILE_PATH_MAX 40
+
+class SafeFileWriter : public Print {
+public:
+  SafeFileWriter(FS& fs, const char* path, uint32_t generation);
+
+  bool begin();
+  size_t write(uint8_t byte) override;
+  size_t write(const uint8_t* data, size_t length) override;
+
+  // Дописывает подпись и заменяет основной файл.
+  // false - запись не удалась, прежняя копия осталась целой
+  bool commit();
+
+  // Отказ от записи: временный файл удаляется, основной не меняется
+  void abort();
+
+  // Сколько байт данных записано (без подписи)
+  size_t length() const {
+    return _length;
+  }
+
+private:
+  FS& _fs;
+  const char* _path;
+  char _tempPath[SAFE_FILE_PATH_MAX];
+  File _file;
+  uint32_t _generation;
+  uint32_t _crc = 0;
+  size_t _length = 0;
+  bool _failed = false;
+};
+
+// Открывает для чтения самую новую целую копию; length - размер данных без
+// подписи. Пустой File - целой копии нет
+File safeFileOpen(FS& fs, const char* path, uint32_t& generation, size_t& length);
@@ -0,0 +1,155 @@
+#include "session_table.h"
+
+static const char hexDigits[] = "0123456789abcdef";
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+bool sessionTokenFromCookie(const String& cookies, char* token) {
+  const char* name = SESSION_COOKIE "=";
+  const size_t nameLength = strlen(name);
+  int position = 0;
+  while (position < (int)cookies.length()) {
+    // Пары "имя=значение" разделены "; "
+    while (cookies[position] == ' ' || cookies[position] == ';') {
+      position++;
+    }
+    if (strncmp(cookies.c_str() + position, name, nameLength) == 0) {
+      const char* value = cookies.c_str() + position + nameLength;
+      size_t length = 0;
+      while (value[length] != '\0' && value[length] != ';' && length <= SESSION_TOKEN_LENGTH) {
+        length++;
+      }
+      if (length != SESSION_TOKEN_LENGTH) {
+        return false;
+      }
+      memcpy(token, value, length);
+      token[length] = '\0';
+      return true;
+    }
+    int next = cookies.indexOf(';', position);
+    if (next < 0) {
+      break;
+    }
+    position = next + 1;
+  }
+  return false;
+}
+
+bool SessionTable::alive(const Session& session, uint32_t now) const {
+  return session.user >= 0 && now - session.lastSeen < SESSION_IDLE_TIMEOUT;
+}
+
+void SessionTable::create(int16_t user, uint32_t now, char* token) {
+  // Свободная или просроченная ячейка, иначе - самая давно не активная
+  int slot = 0;
+  for (int i = 0; i < SESSION_SLOTS; i++) {
+    if (!alive(_sessions[i], now)) {
+      slot = i;
+      break;
+    }
+    if (now - _sessions[i].lastSeen > now - _sessions[slot].lastSeen) {
+      slot = i;
+    }
+  }
+
+  Session& session = _sessions[slot];
+  for (int i = 0; i < SESSION_SECRET_BYTES; i += 4) {
+    uint32_t random = ESP.random();
+    memcpy(session.secret + i, &random, 4);
+  }
+  session.user = user;
+  session.lastSeen = now;
+
+  token[0] = hexDigits[slot >> 4];
+  token[1] = hexDigits[slot & 0x0F];
+  for (int i = 0; i < SESSION_SECRET_BYTES; i++) {
+    token[2 + i * 2] = hexDigits[session.secret[i] >> 4];
+    token[3 + i * 2] = hexDigits[session.secret[i] & 0x0F];
+  }
+  token[SESSION_TOKEN_LENGTH] = '\0';
+}
+
+int SessionTable::find(const char* token) const {
+  int high = hexValue(token[0]);
+  int low = hexValue(token[1]);
+  if (high < 0 || low < 0) {
+    return -1;
+  }
+  int slot = (high << 4) | low;
+  if (slot >= SESSION_SLOTS || _sessions[slot].user < 0) {
+    return -1;
+  }
+
+  // Сравнение без раннего выхода: время ответа не подсказывает верные символы
+  uint8_t difference = 0;
+  for (int i = 0; i < SESSION_SECRET_BYTES; i++) {
+    int h = hexValue(token[2 + i * 2]);
+    int l = hexValue(token[3 + i * 2]);
+    difference |= (h < 0 || l < 0) ? 1 : (uint8_t)(((h << 4) | l) ^ _sessions[slot].secret[i]);
+  }
+  return difference == 0 ? slot : -1;
+}
+
+int16_t SessionTable::resolve(const char* token, uint32_t now) {
+  int slot = find(token);
+  if (slot < 0) {
+    return -1;
+  }
+  Session& session = _sessions[slot];
+  if (!alive(session, now)) {
+    session.user = -1;
+    return -1;
+  }
+  session.lastSeen = now;
+  return session.user;
+}
+
+void SessionTable::close(const char* token) {
+  int slot = find(token);
+  if (slot >= 0) {
+    _sessions[slot].user = -1;
+  }
+}
+
+bool SessionTable::hasUser(int16_t user, uint32_t now) const {
+  for (int i = 0; i < SESSION_SLOTS; i++) {
+    if (_sessions[i].user == user && alive(_sessions[i], now)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SessionTable::removeUser(int16_t user) {
+  for (int i = 0; i < SESSION_SLOTS; i++) {
+    if (_sessions[i].user == user) {
+      _sessions[i].user = -1;
+    }
+  }
+}
+
+void SessionTable::moveUser(int16_t from, int16_t to) {
+  for (int i = 0; i < SESSION_SLOTS; i++) {
+    if (_sessions[i].user == from) {
+      _sessions[i].user = to;
+    }
+  }
+}
+
+uint8_t SessionTable::activeCount(uint32_t now) const {
+  uint8_t count = 0;
+  for (int i = 0; i < SESSION_SLOTS; i++) {
+    if (alive(_sessions[i], now)) {
+      count++;
+    }
+  }
+  return count;
+}
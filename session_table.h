@@ -0,0 +1,51 @@
+// Сессии веб-интерфейса: несколько клиентов могут войти одновременно.
+//
+// Вход выдаёт cookie session=<токен>: два hex-символа номера ячейки таблицы
+// и SESSION_SECRET_BYTES случайных байт от аппаратного генератора. По номеру
+// сессия находится сразу, случайная часть сравнивается за постоянное время.
+// Сессия живёт SESSION_IDLE_TIMEOUT мс с последнего запроса; когда таблица
+// полна, новая вытесняет самую давно не активную.
+#pragma once
+
+#include <Arduino.h>
+
+#define SESSION_SLOTS 8
+#define SESSION_SECRET_BYTES 16
+#define SESSION_TOKEN_LENGTH (2 + SESSION_SECRET_BYTES * 2)
+#define SESSION_IDLE_TIMEOUT (7UL * 24 * 3600 * 1000) // мс, неделя
+#define SESSION_COOKIE "session"
+
+struct Session {
+  uint8_t secret[SESSION_SECRET_BYTES];
+  int16_t user = -1;     // ячейка users[], -1 - сессия свободна
+  uint32_t lastSeen = 0; // мс
+};
+
+// Ищет токен сессии в заголовке Cookie; token - SESSION_TOKEN_LENGTH + 1 байт
+bool sessionTokenFromCookie(const String& cookies, char* token);
+
+class SessionTable {
+public:
+  // Открывает сессию пользователя и пишет её токен с '\0' в token
+  void create(int16_t user, uint32_t now, char* token);
+
+  // Пользователь по токену или -1; продлевает сессию
+  int16_t resolve(const char* token, uint32_t now);
+
+  void close(const char* token);
+
+  // Есть ли у пользователя другие живые сессии
+  bool hasUser(int16_t user, uint32_t now) const;
+
+  // Удаление пользователя из users[] и перенос последнего на его место
+  void removeUser(int16_t user);
+  void moveUser(int16_t from, int16_t to);
+
+  uint8_t activeCount(uint32_t now) const;
+
+private:
+  int find(const char* token) const;
+  bool alive(const Session& session, uint32_t now) const;
+
+  Session _sessions[SESSION_SLOTS];
+};
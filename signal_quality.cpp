@@ -0,0 +1,199 @@
+#include "signal_quality.h"
+
+// Целый корень для нормировки корреляции
+static uint32_t isqrt64(uint64_t value) {
+  uint64_t result = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (value >= result + bit) {
+      value -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)result;
+}
+
+// Линейная оценка 0..100 между порогами low и high
+static uint8_t scoreBetween(int32_t value, int32_t low, int32_t high) {
+  if (value <= low) {
+    return 0;
+  }
+  if (value >= high) {
+    return 100;
+  }
+  return (uint8_t)((value - low) * 100 / (high - low));
+}
+
+SignalQuality::SignalQuality() {
+  reset();
+}
+
+void SignalQuality::reset() {
+  dspDcRemoveInit(&_irDc, SQI_DC_SHIFT);
+  dspDcRemoveInit(&_redDc, SQI_DC_SHIFT);
+  _sampleCount = 0;
+  _hasBeat = false;
+  _hasTemplate = false;
+  _mismatches = 0;
+  _windowSamples = 0;
+  _irSum = 0;
+  _redSum = 0;
+  _clipped = 0;
+  _correlationSum = 0;
+  _beats = 0;
+  _lastRatio = 0;
+  _scores = SignalQualityScores();
+}
+
+bool SignalQuality::addBlock(const uint32_t* red, const uint32_t* ir, size_t count,
+                             const int8_t* beats, size_t beatCount) {
+  if (count > DSP_MAX_BLOCK) {
+    count = DSP_MAX_BLOCK;
+  }
+  q15_t irAc[DSP_MAX_BLOCK];
+  q15_t redAc[DSP_MAX_BLOCK];
+  dspDcRemove(&_irDc, ir, irAc, count);
+  dspDcRemove(&_redDc, red, redAc, count);
+
+  uint32_t first = _sampleCount;
+  size_t nextBeat = 0;
+  bool finished = false;
+  for (size_t i = 0; i < count; i++) {
+    if (_windowSamples == 0) {
+      _irMin = _irMax = irAc[i];
+      _redMin = _redMax = redAc[i];
+    }
+    if (irAc[i] < _irMin) _irMin = irAc[i];
+    if (irAc[i] > _irMax) _irMax = irAc[i];
+    if (redAc[i] < _redMin) _redMin = redAc[i];
+    if (redAc[i] > _redMax) _redMax = redAc[i];
+    _irSum += ir[i];
+    _redSum += red[i];
+    if (ir[i] >= SQI_CLIP_LEVEL || red[i] >= SQI_CLIP_LEVEL) {
+      _clipped++;
+    }
+    _history[_sampleCount % SQI_BEAT_MAX_SAMPLES] = irAc[i];
+    _sampleCount++;
+
+    // Удар сравнивается, когда его отсчёт уже в истории
+    while (nextBeat < beatCount && beats[nextBeat] <= (int)i) {
+      addBeat(first + beats[nextBeat]);
+      nextBeat++;
+    }
+
+    if (++_windowSamples >= SQI_WINDOW_SAMPLES) {
+      finishWindow();
+      finished = true;
+    }
+  }
+  return finished;
+}
+
+void SignalQuality::addBeat(uint32_t position) {
+  if (_hasBeat) {
+    uint32_t length = position - _lastBeat;
+    // Слишком длинный удар уже вытеснен из истории
+    if (length >= SQI_TEMPLATE_POINTS / 4 && length < SQI_BEAT_MAX_SAMPLES) {
+      // Удар приводится к SQI_TEMPLATE_POINTS точкам и центрируется
+      int32_t points[SQI_TEMPLATE_POINTS];
+      int32_t sum = 0;
+      for (uint8_t k = 0; k < SQI_TEMPLATE_POINTS; k++) {
+        uint32_t sample = _lastBeat + k * length / SQI_TEMPLATE_POINTS;
+        points[k] = _history[sample % SQI_BEAT_MAX_SAMPLES];
+        sum += points[k];
+      }
+      int32_t mean = sum / SQI_TEMPLATE_POINTS;
+      for (uint8_t k = 0; k < SQI_TEMPLATE_POINTS; k++) {
+        points[k] -= mean;
+      }
+
+      if (_hasTemplate) {
+        int64_t cov = 0;
+        uint64_t beatEnergy = 0;
+        uint64_t templateEnergy = 0;
+        for (uint8_t k = 0; k < SQI_TEMPLATE_POINTS; k++) {
+          cov += (int64_t)points[k] * _template[k];
+          beatEnergy += (int64_t)points[k] * points[k];
+          templateEnergy += (int64_t)_template[k] * _template[k];
+        }
+        uint64_t norm = (uint64_t)isqrt64(beatEnergy) * isqrt64(templateEnergy);
+        int32_t correlation = norm > 0 ? (int32_t)(cov * 100 / (int64_t)norm) : 0;
+        _correlationSum += correlation;
+        _beats++;
+        // Шаблон следует за формой хороших ударов с весом 1/4. Помехи его не
+        // портят, а если форма сменилась надолго - шаблон берётся с нового удара
+        if (correlation >= SQI_CORRELATION_MIN) {
+          _mismatches = 0;
+          for (uint8_t k = 0; k < SQI_TEMPLATE_POINTS; k++) {
+            _template[k] = dspSaturateQ15(_template[k] + (points[k] - _template[k]) / 4);
+          }
+        } else if (++_mismatches >= SQI_TEMPLATE_RESET) {
+          _mismatches = 0;
+          _hasTemplate = false;
+        }
+      }
+      if (!_hasTemplate) {
+        for (uint8_t k = 0; k < SQI_TEMPLATE_POINTS; k++) {
+          _template[k] = dspSaturateQ15(points[k]);
+        }
+        _hasTemplate = true;
+      }
+    }
+  }
+  _lastBeat = position;
+  _hasBeat = true;
+}
+
+void SignalQuality::finishWindow() {
+  uint32_t irDc = (uint32_t)(_irSum / _windowSamples);
+  uint32_t redDc = (uint32_t)(_redSum / _windowSamples);
+  uint32_t irAc = (uint32_t)(_irMax - _irMin);
+  uint32_t redAc = (uint32_t)(_redMax - _redMin);
+
+  SignalQualityScores scores;
+  uint64_t perfusion = irDc > 0 ? (uint64_t)irAc * 10000 / irDc : 0;
+  scores.perfusion = perfusion > UINT16_MAX ? UINT16_MAX : (uint16_t)perfusion;
+  scores.clipped = _clipped > UINT8_MAX ? UINT8_MAX : (uint8_t)_clipped;
+  int32_t correlation = _beats > 0 ? _correlationSum / _beats : 0;
+  scores.correlation = correlation > 0 ? (uint8_t)correlation : 0;
+
+  // R = (AC/DC red) / (AC/DC ir), x1000
+  uint32_t ratio = 0;
+  if (irAc > 0 && redDc > 0) {
+    ratio = (uint32_t)((uint64_t)redAc * irDc * 1000 / ((uint64_t)irAc * redDc));
+  }
+  uint32_t change = 0;
+  if (_lastRatio > 0) {
+    uint32_t difference = ratio > _lastRatio ? ratio - _lastRatio : _lastRatio - ratio;
+    change = (uint32_t)((uint64_t)difference * 100 / _lastRatio);
+  }
+  scores.ratioChange = change > UINT8_MAX ? UINT8_MAX : (uint8_t)change;
+  _lastRatio = ratio;
+
+  uint8_t perfusionScore = scoreBetween(scores.perfusion, SQI_PI_MIN, SQI_PI_GOOD);
+  uint8_t overScore = 100 - scoreBetween(scores.perfusion, SQI_PI_HIGH, SQI_PI_MAX);
+  if (overScore < perfusionScore) perfusionScore = overScore;
+  uint8_t correlationScore = scoreBetween(correlation, SQI_CORRELATION_MIN, SQI_CORRELATION_GOOD);
+  uint8_t clipScore = 100 - scoreBetween(_clipped, 0, SQI_CLIP_MAX_SAMPLES);
+  uint8_t ratioScore = 100 - scoreBetween(change, SQI_RATIO_TOLERANCE, SQI_RATIO_MAX_CHANGE);
+
+  uint8_t index = perfusionScore;
+  if (correlationScore < index) index = correlationScore;
+  if (clipScore < index) index = clipScore;
+  if (ratioScore < index) index = ratioScore;
+  scores.index = index;
+  _scores = scores;
+
+  _windowSamples = 0;
+  _irSum = 0;
+  _redSum = 0;
+  _clipped = 0;
+  _correlationSum = 0;
+  _beats = 0;
+}
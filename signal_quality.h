@@ -0,0 +1,91 @@
+// Индекс качества сигнала (SQI) для отбраковки движений и плохого контакта.
+//
+// Считается по окнам SQI_WINDOW_SAMPLES отсчётов, попутно с потоком PPG,
+// без хранения окна целиком. В каждом окне оцениваются четыре признака,
+// каждый от 0 до 100:
+//   - индекс перфузии IR (AC/DC): слишком слабая пульсация - нет контакта,
+//     слишком сильная - палец двигается;
+//   - корреляция формы каждого удара с шаблоном (средним прошлых ударов);
+//   - отсутствие отсчётов у границы шкалы АЦП (засветка);
+//   - стабильность отношения R = (AC/DC red) / (AC/DC ir) между окнами,
+//     от которого зависит SpO2.
+// Индекс окна - минимум из четырёх: сигнал плох, если плох любой признак.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ppg_dsp.h"
+
+#define SQI_WINDOW_SAMPLES 200     // 2 с при 100 Гц: хотя бы один удар даже при 30 уд/мин
+#define SQI_BEAT_MAX_SAMPLES 200   // самый длинный удар, который сравнивается с шаблоном
+#define SQI_TEMPLATE_POINTS 32     // удар приводится к 32 точкам
+#define SQI_DC_SHIFT 6
+#define SQI_PI_MIN 5               // индекс перфузии в сотых долях процента: 0.05%...
+#define SQI_PI_GOOD 20             // ...до 0.2% оценка растёт от 0 до 100
+#define SQI_PI_HIGH 500            // от 5% оценка падает...
+#define SQI_PI_MAX 1000            // ...и к 10% становится 0: это уже движение, а не пульс
+#define SQI_CORRELATION_MIN 50     // корреляция с шаблоном, %: 50 - оценка 0...
+#define SQI_CORRELATION_GOOD 90    // ...90 - оценка 100
+#define SQI_TEMPLATE_RESET 4       // столько непохожих ударов подряд - шаблон строится заново
+#define SQI_CLIP_LEVEL 0x3FF00     // у верхней границы 18-битного АЦП
+#define SQI_CLIP_MAX_SAMPLES 4     // столько отсчётов у границы за окно - оценка 0
+#define SQI_RATIO_TOLERANCE 10     // изменение R между окнами до 10% не штрафуется...
+#define SQI_RATIO_MAX_CHANGE 50    // ...от 50% - оценка 0
+
+// Признаки последнего завершённого окна
+struct SignalQualityScores {
+  uint16_t perfusion;     // индекс перфузии IR, сотые доли процента
+  uint8_t correlation;    // средняя корреляция ударов с шаблоном, %
+  uint8_t clipped;        // отсчётов у границы шкалы
+  uint8_t ratioChange;    // изменение R относительно прошлого окна, %
+  uint8_t index;          // итоговый SQI 0..100
+};
+
+class SignalQuality {
+public:
+  SignalQuality();
+
+  void reset();
+
+  // Блок отсчётов (не больше DSP_MAX_BLOCK) и номера отсчётов с ударами в нём
+  // (BeatDetector::beatPositions(), -1 - последний отсчёт прошлого блока).
+  // Возвращает true, если в блоке закончилось окно и индекс обновился
+  bool addBlock(const uint32_t* red, const uint32_t* ir, size_t count,
+                const int8_t* beats, size_t beatCount);
+
+  // SQI последнего окна; 0, пока не набрано ни одного окна
+  uint8_t index() const {
+    return _scores.index;
+  }
+
+  const SignalQualityScores& scores() const {
+    return _scores;
+  }
+
+private:
+  void addBeat(uint32_t position);
+  void finishWindow();
+
+  DcRemoveState _irDc;
+  DcRemoveState _redDc;
+  // Переменная составляющая IR за последние SQI_BEAT_MAX_SAMPLES отсчётов
+  q15_t _history[SQI_BEAT_MAX_SAMPLES];
+  uint32_t _sampleCount = 0;
+  uint32_t _lastBeat = 0;
+  bool _hasBeat = false;
+  q15_t _template[SQI_TEMPLATE_POINTS];
+  bool _hasTemplate = false;
+  uint8_t _mismatches = 0;  // подряд ударов с корреляцией ниже SQI_CORRELATION_MIN
+
+  // Накопители текущего окна
+  uint16_t _windowSamples = 0;
+  q15_t _irMin, _irMax, _redMin, _redMax;
+  uint64_t _irSum = 0;
+  uint64_t _redSum = 0;
+  uint16_t _clipped = 0;
+  int32_t _correlationSum = 0;
+  uint8_t _beats = 0;
+
+  uint32_t _lastRatio = 0;  // R прошлого окна x1000, 0 - ещё не было
+  SignalQualityScores _scores = {};
+};
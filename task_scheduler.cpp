@@ -0,0 +1,99 @@
+#include "task_scheduler.h"
+
+#include <string.h>
+
+TaskScheduler::TaskScheduler(SchedulerClock clockMs, SchedulerClock clockUs)
+  : _clockMs(clockMs), _clockUs(clockUs) {
+}
+
+int TaskScheduler::addTask(const char* name, TaskFunction function, uint32_t period,
+                           uint8_t priority, uint32_t deadline, uint32_t budget) {
+  if (_count >= MAX_TASKS) {
+    return -1;
+  }
+
+  Task& task = _tasks[_count];
+  task.name = name;
+  task.function = function;
+  task.period = period;
+  task.deadline = deadline > 0 ? deadline : period;
+  task.budget = budget;
+  task.priority = priority;
+  task.nextDue = _clockMs();
+  memset(&task.stats, 0, sizeof(task.stats));
+  return _count++;
+}
+
+bool TaskScheduler::runNext() {
+  uint32_t now = _clockMs();
+
+  // Среди готовых задач выбираем наивысший приоритет, при равенстве - самую просроченную
+  int selected = -1;
+  for (uint8_t i = 0; i < _count; i++) {
+    const Task& task = _tasks[i];
+    if ((int32_t)(now - task.nextDue) < 0) {
+      continue;
+    }
+    if (selected < 0 || task.priority < _tasks[selected].priority ||
+        (task.priority == _tasks[selected].priority &&
+         (int32_t)(task.nextDue - _tasks[selected].nextDue) < 0)) {
+      selected = i;
+    }
+  }
+  if (selected < 0) {
+    return false;
+  }
+
+  Task& task = _tasks[selected];
+  if (now - task.nextDue > task.deadline) {
+    task.stats.missedDeadlines++;
+  }
+
+  uint32_t started = _clockUs();
+  task.function();
+  uint32_t runtime = _clockUs() - started;
+
+  task.stats.runs++;
+  task.stats.totalRuntime += runtime;
+  if (runtime > task.stats.maxRuntime) {
+    task.stats.maxRuntime = runtime;
+  }
+  if (task.budget > 0 && runtime > task.budget) {
+    task.stats.budgetOverruns++;
+  }
+
+  // Сохраняем фазу периода; если отстали больше чем на период, не догоняем пачкой
+  task.nextDue += task.period;
+  now = _clockMs();
+  if ((int32_t)(now - task.nextDue) > (int32_t)task.period) {
+    task.nextDue = now + task.period;
+  }
+  return true;
+}
+
+void TaskScheduler::trigger(int taskId) {
+  if (taskId >= 0 && taskId < _count) {
+    _tasks[taskId].nextDue = _clockMs();
+  }
+}
+
+uint32_t TaskScheduler::timeUntilNextDue() const {
+  uint32_t now = _clockMs();
+  uint32_t earliest = UINT32_MAX;
+  for (uint8_t i = 0; i < _count; i++) {
+    int32_t remaining = (int32_t)(_tasks[i].nextDue - now);
+    if (remaining <= 0) {
+      return 0;
+    }
+    if ((uint32_t)remaining < earliest) {
+      earliest = remaining;
+    }
+  }
+  return earliest;
+}
+
+void TaskScheduler::resetStats() {
+  for (uint8_t i = 0; i < _count; i++) {
+    memset(&_tasks[i].stats, 0, sizeof(_tasks[i].stats));
+  }
+}
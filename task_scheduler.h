@@ -0,0 +1,69 @@
+// Кооперативный планировщик задач без динамической памяти.
+//
+// Задачи регистрируются в setup() с периодом, приоритетом, сроком выполнения
+// и бюджетом времени. loop() вызывает runNext(), который запускает одну самую
+// срочную готовую задачу, а в паузах может спать timeUntilNextDue() мс.
+// Часы передаются в конструкторе, поэтому планировщик работает и с
+// millis()/micros(), и с поддельными часами.
+#pragma once
+
+#include <stdint.h>
+
+#define MAX_TASKS 12
+
+typedef void (*TaskFunction)();
+typedef unsigned long (*SchedulerClock)();
+
+struct TaskStats {
+  uint32_t runs;
+  uint32_t maxRuntime;      // мкс
+  uint64_t totalRuntime;    // мкс
+  uint32_t missedDeadlines; // задача запущена позже nextDue + deadline
+  uint32_t budgetOverruns;  // задача работала дольше бюджета
+};
+
+struct Task {
+  const char* name;
+  TaskFunction function;
+  uint32_t period;   // мс
+  uint32_t deadline; // мс после наступления срока, 0 - равен периоду
+  uint32_t budget;   // мкс, 0 - без ограничения
+  uint8_t priority;  // 0 - наивысший
+  uint32_t nextDue;  // мс
+  TaskStats stats;
+};
+
+class TaskScheduler {
+public:
+  TaskScheduler(SchedulerClock clockMs, SchedulerClock clockUs);
+
+  // Возвращает номер задачи или -1, если таблица заполнена
+  int addTask(const char* name, TaskFunction function, uint32_t period,
+              uint8_t priority, uint32_t deadline = 0, uint32_t budget = 0);
+
+  // Запускает одну готовую задачу с наивысшим приоритетом.
+  // Возвращает false, если готовых задач нет.
+  bool runNext();
+
+  // Делает задачу готовой немедленно (например, по прерыванию датчика)
+  void trigger(int taskId);
+
+  // Сколько мс можно спать до ближайшего срока
+  uint32_t timeUntilNextDue() const;
+
+  uint8_t taskCount() const {
+    return _count;
+  }
+
+  const Task& task(uint8_t index) const {
+    return _tasks[index];
+  }
+
+  void resetStats();
+
+private:
+  Task _tasks[MAX_TASKS];
+  uint8_t _count = 0;
+  SchedulerClock _clockMs;
+  SchedulerClock _clockUs;
+};
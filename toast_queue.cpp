@@ -0,0 +1,66 @@
+#include "toast_queue.h"
+
+bool ToastQueue::push(const char* title, const char* text, uint8_t priority, unsigned long duration,
+                      uint8_t textSize) {
+  int slot = -1;
+  for (int i = 0; i < TOAST_QUEUE_SIZE; i++) {
+    if (!_toasts[i].active) {
+      slot = i;
+      break;
+    }
+    if (_toasts[i].priority <= priority &&
+        (slot < 0 || _toasts[i].priority < _toasts[slot].priority ||
+         (_toasts[i].priority == _toasts[slot].priority && _toasts[i].sequence < _toasts[slot].sequence))) {
+      slot = i;
+    }
+  }
+  if (slot < 0) {
+    return false;
+  }
+
+  Toast& toast = _toasts[slot];
+  strncpy(toast.title, title, TOAST_TEXT_LENGTH - 1);
+  toast.title[TOAST_TEXT_LENGTH - 1] = '\0';
+  strncpy(toast.text, text, TOAST_TEXT_LENGTH - 1);
+  toast.text[TOAST_TEXT_LENGTH - 1] = '\0';
+  toast.textSize = textSize;
+  toast.priority = priority;
+  toast.duration = duration;
+  toast.expiresAt = 0;
+  toast.sequence = _sequence++;
+  toast.active = true;
+  return true;
+}
+
+Toast* ToastQueue::current(unsigned long now) {
+  Toast* selected = nullptr;
+  for (int i = 0; i < TOAST_QUEUE_SIZE; i++) {
+    Toast& toast = _toasts[i];
+    if (!toast.active) {
+      continue;
+    }
+    if (toast.expiresAt != 0 && (long)(now - toast.expiresAt) >= 0) {
+      toast.active = false;
+      continue;
+    }
+    if (selected == nullptr || toast.priority > selected->priority ||
+        (toast.priority == selected->priority && toast.sequence < selected->sequence)) {
+      selected = &toast;
+    }
+  }
+
+  // Время показа отсчитывается с момента первого появления на экране
+  if (selected != nullptr && selected->expiresAt == 0) {
+    selected->expiresAt = now + selected->duration;
+    if (selected->expiresAt == 0) {
+      selected->expiresAt = 1;
+    }
+  }
+  return selected;
+}
+
+void ToastQueue::clear() {
+  for (int i = 0; i < TOAST_QUEUE_SIZE; i++) {
+    _toasts[i].active = false;
+  }
+}
@@ -0,0 +1,52 @@
+// Всплывающие уведомления поверх основного экрана.
+//
+// Источники ставят сообщение в очередь и сразу возвращаются, показывает их
+// updateDisplay(). На экране - уведомление с наивысшим приоритетом, среди
+// равных - самое раннее. Время показа отсчитывается с первого появления на
+// экране; вытесненное более важным уведомление дожидается своей очереди, если
+// его время ещё не вышло. В полной очереди новое уведомление занимает место
+// самого старого с меньшим или равным приоритетом.
+#pragma once
+
+#include <Arduino.h>
+
+#define TOAST_QUEUE_SIZE 6
+#define TOAST_TEXT_LENGTH 40 // байт UTF-8 вместе с завершающим нулём
+
+enum ToastPriority : uint8_t {
+  TOAST_INFO = 0,     // мотивационные сообщения
+  TOAST_NOTICE = 1,   // вход, выход, настройки
+  TOAST_REMINDER = 2, // сон и пробуждение
+  TOAST_ALARM = 3     // будильник вытесняет все остальные
+};
+
+struct Toast {
+  char title[TOAST_TEXT_LENGTH];
+  char text[TOAST_TEXT_LENGTH];
+  uint8_t textSize;
+  uint8_t priority;
+  unsigned long duration;  // мс показа
+  unsigned long expiresAt; // 0 - ещё не показывалось
+  uint32_t sequence;       // порядок постановки в очередь
+  bool active;
+};
+
+class ToastQueue {
+public:
+  // false - очередь занята более важными уведомлениями
+  bool push(const char* title, const char* text, uint8_t priority, unsigned long duration, uint8_t textSize);
+
+  // Уведомление для показа в момент now или nullptr; запускает его время показа
+  Toast* current(unsigned long now);
+
+  // Ячейка очереди 0..TOAST_QUEUE_SIZE-1, в том числе неактивная
+  const Toast& at(int index) const {
+    return _toasts[index];
+  }
+
+  void clear();
+
+private:
+  Toast _toasts[TOAST_QUEUE_SIZE] = {};
+  uint32_t _sequence = 0;
+};
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Сравнивает замеры firmware_bench с сохранённой базой.
+
+    firmware_bench --benchmark_out=current.json --benchmark_out_format=json
+    bench_compare.py host/bench/baseline.json current.json [--threshold 10]
+
+Для каждого случая печатает время базы и текущее, изменение в процентах и
+выделения на операцию. Код возврата 1, если время выросло больше порога
+(в процентах) или на операцию стало больше выделений памяти, - так сравнение
+можно ставить в проверку перед слиянием. Новую базу сохраняют, скопировав
+current.json на место baseline.json.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, encoding="utf-8") as file:
+        report = json.load(file)
+    cases = {}
+    for case in report.get("benchmarks", []):
+        if case.get("run_type", "iteration") != "iteration":
+            continue
+        cases[case["name"]] = case
+    return cases
+
+
+def nanoseconds(case):
+    scale = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}[case.get("time_unit", "ns")]
+    return case["real_time"] * scale
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0, help="допустимый рост времени, %%")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    failed = False
+    print("%-24s %12s %12s %8s %9s %9s" % ("case", "base ns", "ns", "change", "allocs", "was"))
+    for name, case in current.items():
+        ns = nanoseconds(case)
+        allocs = case.get("allocs", 0.0)
+        base = baseline.get(name)
+        if base is None:
+            print("%-24s %12s %12.0f %8s %9.2f %9s" % (name, "-", ns, "new", allocs, "-"))
+            continue
+        base_ns = nanoseconds(base)
+        base_allocs = base.get("allocs", 0.0)
+        change = (ns - base_ns) * 100.0 / base_ns if base_ns > 0 else 0.0
+        mark = ""
+        if change > args.threshold:
+            mark = "  slower"
+            failed = True
+        if allocs > base_allocs + 0.01:
+            mark += "  more allocations"
+            failed = True
+        print("%-24s %12.0f %12.0f %+7.1f%% %9.2f %9.2f%s" % (name, base_ns, ns, change, allocs, base_allocs, mark))
+    for name in baseline:
+        if name not in current:
+            print("%-24s missing from the current run" % name)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+"""Сжимает веб-интерфейс из web/ в data/www/*.gz для загрузки в LittleFS.
+
+    build_assets.py [каталог]   - по умолчанию data/www (сборка на компьютере
+                                  кладёт файлы в свой каталог для тестов)
+
+gzip пишется без имени файла и с нулевым mtime, поэтому при неизменных
+исходниках архив (и его ETag на устройстве) остаётся тем же.
+Печатает размеры и ETag - FNV-1a от сжатого файла, как в loadStaticAssets().
+"""
+import gzip
+import pathlib
+import sys
+
+ROOT = pathlib.Path(__file__).resolve().parent.parent
+SOURCE = ROOT / "web"
+TARGET = ROOT / "data" / "www"
+
+
+def fnv1a(data):
+    value = 2166136261
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def main():
+    target = pathlib.Path(sys.argv[1]) if len(sys.argv) > 1 else TARGET
+    target.mkdir(parents=True, exist_ok=True)
+    for path in sorted(SOURCE.iterdir()):
+        if not path.is_file():
+            continue
+        raw = path.read_bytes()
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)
+        (target / (path.name + ".gz")).write_bytes(packed)
+        print("%-20s %7d -> %6d bytes  ETag \"%08x\"" % (path.name, len(raw), len(packed), fnv1a(packed)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,289 @@
+#!/usr/bin/env python3
+"""Декодер двоичной выгрузки /export (формат описан в export_stream.h).
+
+  ppg_export.py csv pulse.ppgx [-o out.csv]      строки time,pulse,spo2,quality
+  ppg_export.py columns pulse.ppgx -o out.json   столбцы {"time": [...], ...};
+                                                 с pyarrow и -o *.parquet - Parquet
+  ppg_export.py fetch http://192.168.4.1 -o pulse.ppgx
+                                                 скачивание с докачкой по offset
+  ppg_export.py check [--hours 24] [--nights 3]  проверка декодера на синтетике
+
+Повреждённый блок (CRC) останавливает разбор с ошибкой: данные до него верны.
+Сжатие и скорость самой выгрузки на устройстве - BM_ExportDay в firmware_bench.
+"""
+import argparse
+import csv
+import json
+import math
+import random
+import struct
+import sys
+import time
+import urllib.request
+import zlib
+
+MAGIC = b"PPGX"
+VERSION = 1
+HEADER = struct.Struct("<4sBBHII")
+BLOCK = struct.Struct("<IHH")
+BLOCK_RECORDS = 128
+QUALITY_FLAG = 0x80
+
+
+class ExportError(Exception):
+    pass
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        if pos >= len(data):
+            raise ExportError("varint past end of block")
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decode(data):
+    """Возвращает (заголовок, записи, время продолжения) - записи (time, pulse, spo2, quality)."""
+    if len(data) < HEADER.size:
+        raise ExportError("truncated header")
+    magic, version, _flags, user_id, start, end = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ExportError("not a PPGX stream")
+    if version != VERSION:
+        raise ExportError("unsupported version %d" % version)
+    header = {"user": user_id, "from": start, "to": end}
+
+    records = []
+    pos = HEADER.size
+    resume = None
+    while resume is None:
+        if pos + BLOCK.size + 4 > len(data):
+            raise ExportError("truncated at byte %d after %d records" % (pos, len(records)))
+        first, count, length = BLOCK.unpack_from(data, pos)
+        end_of_block = pos + BLOCK.size + length
+        if end_of_block + 4 > len(data):
+            raise ExportError("truncated at byte %d after %d records" % (pos, len(records)))
+        (crc,) = struct.unpack_from("<I", data, end_of_block)
+        if zlib.crc32(data[pos:end_of_block]) != crc:
+            raise ExportError("bad CRC in block at byte %d" % pos)
+        if count == 0:
+            resume = first
+            break
+        t, pulse, spo2 = first, 0, 0
+        p = pos + BLOCK.size
+        for _ in range(count):
+            packed, p = read_varint(data, p)
+            dp, p = read_varint(data, p)
+            ds, p = read_varint(data, p)
+            t += packed >> 1
+            pulse += unzigzag(dp)
+            spo2 += unzigzag(ds)
+            records.append((t, pulse, spo2, packed & 1))
+        if p != end_of_block:
+            raise ExportError("block at byte %d has %d stray bytes" % (pos, end_of_block - p))
+        pos = end_of_block + 4
+    return header, records, resume
+
+
+def write_varint(out, value):
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+
+
+def zigzag(value):
+    return (value << 1) ^ (value >> 31)
+
+
+def encode(records, user_id=0, start=0, end=0xFFFFFFFF):
+    """То же кодирование, что ExportSession на устройстве (для проверки декодера)."""
+    out = bytearray(HEADER.pack(MAGIC, VERSION, 0, user_id, start, end))
+    i = 0
+    last = None
+    while True:
+        payload = bytearray()
+        count = 0
+        first = prev_t = prev_p = prev_s = 0
+        while count < BLOCK_RECORDS and i < len(records):
+            t, pulse, spo2, quality = records[i]
+            if count > 0 and (t < prev_t or t - prev_t > 0xFFFF):
+                break
+            if count == 0:
+                first = prev_t = t
+            write_varint(payload, ((t - prev_t) << 1) | (1 if quality else 0))
+            write_varint(payload, zigzag(pulse - prev_p))
+            write_varint(payload, zigzag(spo2 - prev_s))
+            prev_t, prev_p, prev_s = t, pulse, spo2
+            last = t
+            count += 1
+            i += 1
+        if count == 0:
+            first = last + 1 if last is not None else start
+        block = BLOCK.pack(first, count, len(payload)) + payload
+        out += block + struct.pack("<I", zlib.crc32(block))
+        if count == 0:
+            return bytes(out)
+
+
+def columns(records):
+    names = ("time", "pulse", "spo2", "quality")
+    return {name: [r[k] for r in records] for k, name in enumerate(names)}
+
+
+def read_input(path):
+    if path == "-":
+        return sys.stdin.buffer.read()
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def cmd_csv(args):
+    _, records, _ = decode(read_input(args.input))
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = csv.writer(out)
+    writer.writerow(["time", "pulse", "spo2", "quality"])
+    writer.writerows(records)
+    if args.output:
+        out.close()
+    return 0
+
+
+def cmd_columns(args):
+    header, records, resume = decode(read_input(args.input))
+    data = columns(records)
+    if args.output.endswith(".parquet"):
+        try:
+            import pyarrow
+            import pyarrow.parquet
+        except ImportError:
+            print("pyarrow is required for Parquet output", file=sys.stderr)
+            return 1
+        table = pyarrow.table({
+            "time": pyarrow.array(data["time"], pyarrow.uint32()),
+            "pulse": pyarrow.array(data["pulse"], pyarrow.uint8()),
+            "spo2": pyarrow.array(data["spo2"], pyarrow.uint8()),
+            "quality": pyarrow.array(data["quality"], pyarrow.bool_()),
+        })
+        pyarrow.parquet.write_table(table, args.output)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(dict(header, resume=resume, columns=data), f)
+    return 0
+
+
+def cmd_fetch(args):
+    """Скачивает выгрузку, при обрыве продолжает с полученного offset.
+
+    Докачка должна кодировать тот же диапазон, поэтому to передаётся всегда:
+    заданный --to или взятый из заголовка первого ответа (без --to устройство
+    выгружает до своего текущего времени)."""
+    data = bytearray()
+    end = args.to
+    for attempt in range(args.retries + 1):
+        if end is None and len(data) >= HEADER.size:
+            end = HEADER.unpack_from(data)[5]
+        if end is None:
+            data = bytearray()  # заголовка нет - начинаем заново
+            query = "from=%d" % args.since
+        else:
+            query = "from=%d&to=%d" % (args.since, end)
+        url = "%s/export?%s&offset=%d" % (args.url.rstrip("/"), query, len(data))
+        try:
+            with urllib.request.urlopen(url, timeout=30) as response:
+                while True:
+                    chunk = response.read(4096)
+                    if not chunk:
+                        break
+                    data += chunk
+            decode(bytes(data))
+            break
+        except (OSError, ExportError) as error:
+            print("attempt %d: %s, have %d bytes" % (attempt + 1, error, len(data)), file=sys.stderr)
+            if attempt == args.retries:
+                return 1
+            time.sleep(1)
+    with open(args.output, "wb") as f:
+        f.write(data)
+    return 0
+
+
+def synthetic_night(hours, interval, seed):
+    """Пульс и SpO2 с медленным дрейфом, шумом, пропусками (палец снят) и сбоями качества."""
+    rng = random.Random(seed)
+    records = []
+    t = rng.randrange(0, 100000)
+    end = t + hours * 3600
+    while t < end:
+        phase = 2 * math.pi * (t % 86400) / 86400
+        pulse = int(62 + 8 * math.sin(phase) + rng.gauss(0, 2))
+        spo2 = int(min(100, 96 + math.cos(phase * 3) + rng.gauss(0, 0.7)))
+        records.append((t, max(30, min(220, pulse)), max(70, spo2), int(rng.random() > 0.05)))
+        t += interval
+        if rng.random() < 0.002:
+            t += rng.randrange(60, 1800)  # палец снят
+    return records
+
+
+def cmd_check(args):
+    """Декодер читает то, что закодировал encode(): сверка записей один к одному."""
+    total = 0
+    for night in range(args.nights):
+        records = synthetic_night(args.hours, args.interval, night)
+        _, decoded, resume = decode(encode(records))
+        if decoded != records or resume != records[-1][0] + 1:
+            print("round trip mismatch in night %d" % night, file=sys.stderr)
+            return 1
+        total += len(records)
+    print("%d x %d h, %d records decoded" % (args.nights, args.hours, total))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    p = commands.add_parser("csv")
+    p.add_argument("input")
+    p.add_argument("-o", "--output")
+    p.set_defaults(run=cmd_csv)
+
+    p = commands.add_parser("columns")
+    p.add_argument("input")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(run=cmd_columns)
+
+    p = commands.add_parser("fetch")
+    p.add_argument("url")
+    p.add_argument("--since", type=int, default=0)
+    p.add_argument("--to", type=int)
+    p.add_argument("--retries", type=int, default=3)
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(run=cmd_fetch)
+
+    p = commands.add_parser("check")
+    p.add_argument("--hours", type=int, default=24)
+    p.add_argument("--nights", type=int, default=3)
+    p.add_argument("--interval", type=int, default=5)
+    p.set_defaults(run=cmd_check)
+
+    args = parser.parse_args()
+    try:
+        return args.run(args)
+    except ExportError as error:
+        print("error: %s" % error, file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
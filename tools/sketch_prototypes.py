@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""Готовит скетч к обычному компилятору C++, как это делает Arduino IDE.
+
+Прошивка полагается на автоматические прототипы: функции в file.cpp
+вызываются раньше, чем определены. Скрипт вставляет их объявления перед
+первой функцией и добавляет #include <Arduino.h> и директивы #line, чтобы
+ошибки указывали на строки исходного файла.
+
+    sketch_prototypes.py file.cpp build/file_sketch.cpp
+"""
+import pathlib
+import re
+import sys
+
+FUNCTION = re.compile(
+    r"^(?!(?:if|for|while|switch|return|else|static_assert)\b)"
+    r"([A-Za-z_][\w:<>\*&, ]*?[\s\*&]+)(\w+)\s*\(([^;{}]*)\)\s*(const\s*)?\{\s*(//.*)?$")
+DEFAULT_ARGUMENT = re.compile(r"\s*=\s*[^,)]+")
+
+
+def prototypes(lines):
+    """Возвращает объявления функций верхнего уровня и номер строки первой из них."""
+    found = []
+    first = None
+    depth = 0
+    for number, line in enumerate(lines):
+        if line.startswith("#if"):
+            depth += 1
+        elif line.startswith("#endif"):
+            depth -= 1
+        match = FUNCTION.match(line)
+        if match is None or line.startswith((" ", "\t", "template")) or "operator" in line:
+            continue
+        if "::" in match.group(2) or (number > 0 and lines[number - 1].startswith("template")):
+            continue
+        if first is None and depth == 0:
+            first = number
+        arguments = DEFAULT_ARGUMENT.sub("", match.group(3))
+        found.append("%s%s(%s);" % (match.group(1), match.group(2), arguments))
+    return found, first
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    source = pathlib.Path(sys.argv[1]).resolve()
+    target = pathlib.Path(sys.argv[2])
+    lines = source.read_text(encoding="utf-8").split("\n")
+    declared, first = prototypes(lines)
+    path = source.as_posix()
+    output = ["#include <Arduino.h>", '#line 1 "%s"' % path]
+    if first is None:
+        output += lines
+    else:
+        output += lines[:first]
+        output += declared
+        output.append('#line %d "%s"' % (first + 1, path))
+        output += lines[first:]
+    text = "\n".join(output)
+    # Не трогаем файл без изменений, чтобы сборка не пересобирала его зря
+    if not target.exists() or target.read_text(encoding="utf-8") != text:
+        target.parent.mkdir(parents=True, exist_ok=True)
+        target.write_text(text, encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
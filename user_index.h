@@ -0,0 +1,122 @@
+// Хеш-индекс имён пользователей вместо перебора users[] со сравнением String.
+//
+// Открытая адресация с линейным пробированием. В ячейке таблицы - номер
+// ячейки users[] и младшие 16 бит хеша имени: по ним отсеиваются чужие имена
+// без strcmp, и по ним же находится домашняя ячейка при удалении со сдвигом
+// (без надгробий, поэтому поиск не деградирует после удалений).
+// Сами имена индекс не хранит - берёт их через функцию nameOf.
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// FNV-1a, как у хеша статических файлов
+inline uint32_t hashName(const char* name) {
+  uint32_t hash = 2166136261UL;
+  while (*name) {
+    hash = (hash ^ (uint8_t)*name++) * 16777619UL;
+  }
+  return hash;
+}
+
+template <uint16_t SIZE>
+class UserIndex {
+  static_assert((SIZE & (SIZE - 1)) == 0, "UserIndex size must be a power of two");
+
+public:
+  typedef const char* (*NameFunction)(int16_t slot);
+
+  explicit UserIndex(NameFunction nameOf) : _nameOf(nameOf) {
+    clear();
+  }
+
+  void clear() {
+    for (uint16_t i = 0; i < SIZE; i++) {
+      _entries[i].slot = -1;
+    }
+    _count = 0;
+  }
+
+  // Имя должно отсутствовать в индексе; false - таблица заполнена
+  bool insert(const char* name, int16_t slot) {
+    if (_count >= SIZE - 1) {
+      return false;
+    }
+    uint16_t tag = hashName(name);
+    uint16_t i = tag & (SIZE - 1);
+    while (_entries[i].slot >= 0) {
+      i = (i + 1) & (SIZE - 1);
+    }
+    _entries[i].tag = tag;
+    _entries[i].slot = slot;
+    _count++;
+    return true;
+  }
+
+  // Номер ячейки users[] или -1
+  int16_t find(const char* name) const {
+    int position = locate(name);
+    return position >= 0 ? _entries[position].slot : -1;
+  }
+
+  // Пользователь переехал в другую ячейку users[]
+  bool update(const char* name, int16_t slot) {
+    int position = locate(name);
+    if (position < 0) {
+      return false;
+    }
+    _entries[position].slot = slot;
+    return true;
+  }
+
+  bool remove(const char* name) {
+    int position = locate(name);
+    if (position < 0) {
+      return false;
+    }
+    // Сдвигаем назад следующие записи цепочки, чей путь от домашней ячейки
+    // проходит через освободившуюся
+    uint16_t hole = position;
+    uint16_t i = hole;
+    while (true) {
+      i = (i + 1) & (SIZE - 1);
+      if (_entries[i].slot < 0) {
+        break;
+      }
+      uint16_t home = _entries[i].tag & (SIZE - 1);
+      if (((i - home) & (SIZE - 1)) >= ((i - hole) & (SIZE - 1))) {
+        _entries[hole] = _entries[i];
+        hole = i;
+      }
+    }
+    _entries[hole].slot = -1;
+    _count--;
+    return true;
+  }
+
+  uint16_t size() const {
+    return _count;
+  }
+
+private:
+  int locate(const char* name) const {
+    uint16_t tag = hashName(name);
+    uint16_t i = tag & (SIZE - 1);
+    while (_entries[i].slot >= 0) {
+      if (_entries[i].tag == tag && strcmp(_nameOf(_entries[i].slot), name) == 0) {
+        return i;
+      }
+      i = (i + 1) & (SIZE - 1);
+    }
+    return -1;
+  }
+
+  struct Entry {
+    uint16_t tag;
+    int16_t slot; // -1 - свободна
+  };
+
+  Entry _entries[SIZE];
+  uint16_t _count = 0;
+  NameFunction _nameOf;
+};
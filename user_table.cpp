@@ -0,0 +1,92 @@
+#include "user_table.h"
+#include <bearssl/bearssl_hash.h>
+
+static const char hexDigits[] = "0123456789abcdef";
+
+void userHexEncode(const uint8_t* data, size_t length, char* out) {
+  for (size_t i = 0; i < length; i++) {
+    out[i * 2] = hexDigits[data[i] >> 4];
+    out[i * 2 + 1] = hexDigits[data[i] & 0x0F];
+  }
+  out[length * 2] = '\0';
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool userHexDecode(const char* hex, uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    int high = hexValue(hex[i * 2]);
+    int low = high >= 0 ? hexValue(hex[i * 2 + 1]) : -1;
+    if (low < 0) {
+      return false;
+    }
+    data[i] = (high << 4) | low;
+  }
+  return hex[length * 2] == '\0';
+}
+
+static void hashPassword(const uint8_t* salt, const char* password, uint8_t* hash) {
+  br_sha256_context context;
+  br_sha256_init(&context);
+  br_sha256_update(&context, salt, USER_SALT_BYTES);
+  br_sha256_update(&context, password, strlen(password));
+  br_sha256_out(&context, hash);
+}
+
+int16_t UserTable::add(uint16_t id, const char* name) {
+  size_t length = strlen(name);
+  if (full() || length == 0 || length > USER_NAME_MAX) {
+    return -1;
+  }
+  int16_t slot = _count++;
+  _ids[slot] = id;
+  memcpy(_names[slot], name, length + 1);
+  _flags[slot] = 0;
+  _schedules[slot] = UserSchedule();
+  memset(&_credentials[slot], 0, sizeof(UserCredentials));
+  return slot;
+}
+
+int16_t UserTable::remove(int16_t slot) {
+  int16_t last = --_count;
+  if (slot == last) {
+    return -1;
+  }
+  _ids[slot] = _ids[last];
+  memcpy(_names[slot], _names[last], USER_NAME_SIZE);
+  _flags[slot] = _flags[last];
+  _schedules[slot] = _schedules[last];
+  _credentials[slot] = _credentials[last];
+  return last;
+}
+
+void UserTable::setPassword(int16_t slot, const char* password) {
+  UserCredentials& credentials = _credentials[slot];
+  for (int i = 0; i < USER_SALT_BYTES; i += 4) {
+    uint32_t random = ESP.random();
+    memcpy(credentials.salt + i, &random, 4);
+  }
+  hashPassword(credentials.salt, password, credentials.hash);
+}
+
+bool UserTable::checkPassword(int16_t slot, const char* password) const {
+  uint8_t hash[USER_HASH_BYTES];
+  hashPassword(_credentials[slot].salt, password, hash);
+  // Сравнение без раннего выхода
+  uint8_t difference = 0;
+  for (int i = 0; i < USER_HASH_BYTES; i++) {
+    difference |= hash[i] ^ _credentials[slot].hash[i];
+  }
+  return difference == 0;
+}
@@ -0,0 +1,107 @@
+// Таблица пользователей в виде структуры массивов.
+//
+// Поля, которые нужны входу, экрану и /data (номер, имя, флаги, расписание
+// сна), лежат отдельными плотными массивами; соль и хеш пароля - отдельно,
+// их читает только проверка пароля. Имена фиксированной ширины хранятся прямо
+// в таблице, поэтому учётные записи не занимают кучу и не дробят её.
+// Пароль хранится как SHA-256(соль || пароль) со случайной солью.
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef MAX_USERS
+#define MAX_USERS 10           // переопределяется при сборке (-DMAX_USERS=...)
+#endif
+#define USER_NAME_SIZE 24      // с завершающим '\0'
+#define USER_NAME_MAX (USER_NAME_SIZE - 1)
+#define USER_SALT_BYTES 8
+#define USER_HASH_BYTES 32
+#define USER_TIME_UNSET 0xFF   // время в расписании не задано
+#define USER_FLAG_ADMIN 0x01
+
+// Ячейки таблицы и индекса имён - int16_t
+static_assert(MAX_USERS <= INT16_MAX, "MAX_USERS must fit an int16_t slot");
+
+struct UserSchedule {
+  uint8_t bedtimeHour = USER_TIME_UNSET;
+  uint8_t bedtimeMinute = USER_TIME_UNSET;
+  uint8_t wakeupHour = USER_TIME_UNSET;
+  uint8_t wakeupMinute = USER_TIME_UNSET;
+};
+
+struct UserCredentials {
+  uint8_t salt[USER_SALT_BYTES];
+  uint8_t hash[USER_HASH_BYTES];
+};
+
+// Шестнадцатеричная запись для users.json; out - 2 * length + 1 байт
+void userHexEncode(const uint8_t* data, size_t length, char* out);
+bool userHexDecode(const char* hex, uint8_t* data, size_t length);
+
+class UserTable {
+public:
+  int16_t count() const {
+    return _count;
+  }
+
+  bool full() const {
+    return _count >= MAX_USERS;
+  }
+
+  // Добавляет пользователя без пароля и с пустым расписанием; возвращает
+  // его ячейку или -1, если таблица полна или имя пустое либо длиннее USER_NAME_MAX
+  int16_t add(uint16_t id, const char* name);
+
+  // Удаляет пользователя, перенося на его место последнего. Возвращает
+  // прежнюю ячейку перенесённого или -1, если переносить было некого
+  int16_t remove(int16_t slot);
+
+  uint16_t id(int16_t slot) const {
+    return _ids[slot];
+  }
+
+  void setId(int16_t slot, uint16_t id) {
+    _ids[slot] = id;
+  }
+
+  const char* name(int16_t slot) const {
+    return _names[slot];
+  }
+
+  bool isAdmin(int16_t slot) const {
+    return (_flags[slot] & USER_FLAG_ADMIN) != 0;
+  }
+
+  void setAdmin(int16_t slot, bool admin) {
+    _flags[slot] = admin ? (_flags[slot] | USER_FLAG_ADMIN) : (_flags[slot] & ~USER_FLAG_ADMIN);
+  }
+
+  UserSchedule& schedule(int16_t slot) {
+    return _schedules[slot];
+  }
+
+  const UserSchedule& schedule(int16_t slot) const {
+    return _schedules[slot];
+  }
+
+  // Новая случайная соль и хеш пароля
+  void setPassword(int16_t slot, const char* password);
+  bool checkPassword(int16_t slot, const char* password) const;
+
+  // Соль и хеш как есть - для сохранения и загрузки
+  UserCredentials& credentials(int16_t slot) {
+    return _credentials[slot];
+  }
+
+  static constexpr size_t bytesPerUser() {
+    return sizeof(uint16_t) + USER_NAME_SIZE + sizeof(uint8_t) + sizeof(UserSchedule) + sizeof(UserCredentials);
+  }
+
+private:
+  uint16_t _ids[MAX_USERS];
+  char _names[MAX_USERS][USER_NAME_SIZE];
+  uint8_t _flags[MAX_USERS];
+  UserSchedule _schedules[MAX_USERS];
+  UserCredentials _credentials[MAX_USERS];
+  int16_t _count = 0;
+};